@@ -3,6 +3,9 @@
 #include <iostream>
 #include <string>
 #include <array>
+#include <vector>
+#include <algorithm> // count
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -78,7 +81,8 @@ namespace ArraysExamples
 
     // C++ defines arrays in row major order which puts members of the right-most index next 
     // to each other in memory e.g. a[0][0] and a[0][1] are stored in adjacent memory locations.
-    // Accessing an array in the wrong order degrades performance significantly.
+    // Accessing an array in the wrong order degrades performance significantly: RegisterBenchmarks
+    // measures both orders on a 4096x4096 array, with the hardware counters under --counters.
     void RowMajorOrderVsColumnMajorOrder()
     {
         // Array[how_many_elements][the_length_of_element]
@@ -130,4 +134,40 @@ namespace ArraysExamples
         RowMajorOrderVsColumnMajorOrder();
         CStyleArrays();
     }
+
+    // Registers the benchmarks of adding up a 4096x4096 array of ints (64 MB) by rows and by columns.
+    // A row is 16 KB, so each step of the column walk touches another cache line and, every 256 rows,
+    // another 4 KB page: run with --counters to see the L1, LLC and TLB misses per element.
+    void RegisterBenchmarks()
+    {
+        const std::size_t size = 4096;
+
+        Benchmark::Register("Arrays", "row major sum 4096x4096", [size](Benchmark::State& state)
+        {
+            std::vector<int> a(size * size, 1);
+            state.SetItemsPerIteration(size * size);
+            while (state.KeepRunning())
+            {
+                long long sum = 0;
+                for (std::size_t i = 0; i < size; ++i)
+                    for (std::size_t j = 0; j < size; ++j)
+                        sum += a[i * size + j];
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Arrays", "column major sum 4096x4096", [size](Benchmark::State& state)
+        {
+            std::vector<int> a(size * size, 1);
+            state.SetItemsPerIteration(size * size);
+            while (state.KeepRunning())
+            {
+                long long sum = 0;
+                for (std::size_t j = 0; j < size; ++j)
+                    for (std::size_t i = 0; i < size; ++i)
+                        sum += a[i * size + j];
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+    }
 }
\ No newline at end of file
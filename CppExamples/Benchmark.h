@@ -0,0 +1,381 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <functional> // std::function
+#include <algorithm> // sort, max, min
+#include <chrono>
+#include <cstdint> // uint64_t
+#include <memory> // unique_ptr
+#include "PerfCounters.h" // PerfCounters::CounterGroup, Counts
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h> // _ReadWriteBarrier
+#endif
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+/*
+    A micro-benchmark harness built on ChronoExamples::TimeElapsedFunc.
+
+    TimeElapsedFunc times a single call (in whole milliseconds by default). That's useless for anything
+    that runs in less than a millisecond and it gives no idea about the variance. The harness:
+    - runs the code for a while before measuring (warm-up) to fill caches and let the CPU clock up
+    - calibrates the number of iterations per sample so that each sample lasts long enough
+      to be measured accurately with steady_clock (nanosecond resolution)
+    - collects many samples and reports min, median, p99 and mean time per iteration
+    - provides DoNotOptimize so the compiler does not remove the code under test
+    - with Options::Counters, reads the hardware counters (PerfCounters.h) over the measured batches and
+      reports the cycles, instructions, cache and TLB misses and branch mispredictions per iteration
+
+    A benchmark case is a function taking a Benchmark::State. The code before the loop is setup
+    and is not measured:
+
+        Benchmark::Register("Strings", "Trim", [](Benchmark::State& state)
+        {
+            string s = "  abc  ";              // setup
+            while (state.KeepRunning())      // measured
+                Benchmark::DoNotOptimize(StringsExamples::Trim(s));
+        });
+
+    Each *Examples namespace registers its cases in a RegisterBenchmarks function.
+    Main.cpp runs them with the --bench command-line option.
+*/
+namespace Benchmark
+{
+    // DoNotOptimize forces the compiler to materialize a value, so a computation whose result
+    // is never used is not optimized away.
+    template <typename T>
+    inline void DoNotOptimize(T const & value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r,m"(value) : "memory");
+#else
+        // Store the address of the value in a volatile sink. The compiler has to assume that
+        // the value is read through the pointer.
+        static char const volatile * sink;
+        sink = reinterpret_cast<char const volatile *>(&value);
+        _ReadWriteBarrier();
+#endif
+    }
+
+    // ClobberMemory forces the compiler to assume that all memory may have been read or written,
+    // so stores to memory are not optimized away.
+    inline void ClobberMemory()
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : : "memory");
+#else
+        _ReadWriteBarrier();
+#endif
+    }
+
+    // Options control how long a case is measured.
+    struct Options
+    {
+        std::chrono::nanoseconds Warmup = std::chrono::milliseconds(50);        // run without measuring for at least this long
+        std::chrono::nanoseconds SampleTime = std::chrono::milliseconds(2);     // the minimum duration of a sample
+        std::chrono::nanoseconds MaxTime = std::chrono::seconds(2);             // stop sampling after this long...
+        unsigned MinSamples = 3;                                                // ...if there are at least this many samples
+        unsigned Samples = 50;                                                  // the number of samples
+        bool Counters = false;                                                  // read the hardware counters while measuring
+    };
+
+    // Result holds the statistics of a case. Times are in nanoseconds per iteration.
+    struct Result
+    {
+        string Group;
+        string Name;
+        std::uint64_t Iterations = 0; // per sample
+        std::size_t Samples = 0;
+        double Min = 0;
+        double Median = 0;
+        double P99 = 0;
+        double Mean = 0;
+        double ItemsPerSecond = 0; // 0 if the case does not report items
+        PerfCounters::Counts Counters; // per iteration, with Options::Counters
+    };
+
+    // State drives the measurement loop of a case. KeepRunning returns true as long as the harness
+    // needs more iterations. The time is read from the clock only between batches of iterations,
+    // so the overhead per iteration is a decrement and a comparison.
+    class State
+    {
+    public:
+        explicit State(Options const & options) : m_options{ options } {}
+
+        bool KeepRunning()
+        {
+            if (m_left != 0)
+            {
+                --m_left;
+                return true;
+            }
+
+            return NextBatch();
+        }
+
+        // SetItemsPerIteration tells the harness how many items (bytes, words, pixels, ...)
+        // one iteration processes. The harness then reports the throughput.
+        void SetItemsPerIteration(double items)
+        {
+            m_items = items;
+        }
+
+        std::uint64_t Iterations() const { return m_batch; }
+        vector<double> const & Samples() const { return m_samples; }
+        double ItemsPerIteration() const { return m_items; }
+
+        // Counters returns the counts of the measured iterations per iteration.
+        PerfCounters::Counts Counters() const
+        {
+            if (!m_counters)
+                return PerfCounters::Counts{};
+            return m_counters->Read().Per(static_cast<double>(m_batch) * m_samples.size());
+        }
+
+    private:
+        typedef std::chrono::steady_clock clock;
+
+        enum class Phase { Start, Warmup, Measure, Done };
+
+        Options m_options;
+        Phase m_phase = Phase::Start;
+        std::uint64_t m_batch = 1;          // the number of iterations in the current batch
+        std::uint64_t m_left = 0;           // the number of iterations left in the current batch
+        clock::time_point m_batchStart;
+        clock::time_point m_phaseStart;
+        vector<double> m_samples;           // ns per iteration
+        double m_items = 0;
+        std::unique_ptr<PerfCounters::CounterGroup> m_counters; // counting during the Measure phase
+
+        bool NextBatch()
+        {
+            auto now = clock::now();
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_batchStart);
+
+            switch (m_phase)
+            {
+            case Phase::Start:
+                m_phase = Phase::Warmup;
+                m_phaseStart = now;
+                break;
+
+            case Phase::Warmup:
+                // Calibrate the batch size so that a batch lasts at least SampleTime.
+                if (elapsed < m_options.SampleTime)
+                {
+                    auto factor = elapsed.count() > 0 ? 1.2 * m_options.SampleTime.count() / elapsed.count() : 10.0;
+                    m_batch = std::max<std::uint64_t>(m_batch + 1, static_cast<std::uint64_t>(m_batch * std::min(factor, 10.0)));
+                }
+                else if (now - m_phaseStart >= m_options.Warmup)
+                {
+                    m_phase = Phase::Measure;
+                    m_phaseStart = now;
+                    if (m_options.Counters)
+                    {
+                        m_counters = std::make_unique<PerfCounters::CounterGroup>();
+                        m_counters->Start();
+                    }
+                }
+                break;
+
+            case Phase::Measure:
+                m_samples.push_back(static_cast<double>(elapsed.count()) / m_batch);
+
+                if (m_samples.size() >= m_options.Samples ||
+                    (now - m_phaseStart >= m_options.MaxTime && m_samples.size() >= m_options.MinSamples))
+                {
+                    m_phase = Phase::Done;
+                    if (m_counters)
+                        m_counters->Stop();
+                    return false;
+                }
+                break;
+
+            case Phase::Done:
+                return false;
+            }
+
+            // Start the next batch. This call to KeepRunning counts as the first iteration of the batch.
+            m_left = m_batch - 1;
+            m_batchStart = clock::now();
+            return true;
+        }
+    };
+
+    typedef std::function<void(State&)> Case;
+
+    struct Registration
+    {
+        string Group;
+        string Name;
+        Case Function;
+    };
+
+    // Registry returns all the registered cases in the order of registration.
+    inline vector<Registration>& Registry()
+    {
+        static vector<Registration> registry;
+        return registry;
+    }
+
+    // Register adds a case to the registry. The group is usually the name of the *Examples topic.
+    inline void Register(string group, string name, Case function)
+    {
+        Registry().push_back(Registration{ std::move(group), std::move(name), std::move(function) });
+    }
+
+    // Percentile returns the p-th percentile (0..100) of sorted values using the nearest-rank method.
+    inline double Percentile(vector<double> const & sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+
+        auto rank = static_cast<std::size_t>(p / 100.0 * sorted.size() + 0.999999);
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+
+    // Run measures a single case.
+    inline Result Run(Registration const & registration, Options const & options = Options{})
+    {
+        State state(options);
+        registration.Function(state);
+
+        auto samples = state.Samples();
+        std::sort(begin(samples), end(samples));
+
+        Result result;
+        result.Group = registration.Group;
+        result.Name = registration.Name;
+        result.Iterations = state.Iterations();
+        result.Samples = samples.size();
+
+        if (!samples.empty())
+        {
+            double sum = 0;
+            for (auto s : samples)
+                sum += s;
+
+            result.Min = samples.front();
+            result.Median = Percentile(samples, 50);
+            result.P99 = Percentile(samples, 99);
+            result.Mean = sum / samples.size();
+
+            if (state.ItemsPerIteration() > 0 && result.Median > 0)
+                result.ItemsPerSecond = state.ItemsPerIteration() * 1e9 / result.Median;
+
+            result.Counters = state.Counters();
+        }
+
+        return result;
+    }
+
+    // RunAll measures the registered cases whose "Group/Name" contains the filter string.
+    inline vector<Result> RunAll(string const & filter = string{}, Options const & options = Options{})
+    {
+        vector<Result> results;
+        for (auto const & r : Registry())
+        {
+            if (filter.empty() || (r.Group + "/" + r.Name).find(filter) != string::npos)
+                results.push_back(Run(r, options));
+        }
+        return results;
+    }
+
+    // EscapeJson escapes a string for a JSON string literal.
+    inline string EscapeJson(string const & s)
+    {
+        string result;
+        for (char c : s)
+        {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result;
+    }
+
+    // EscapeCsv quotes a CSV field if it contains a separator or a quote.
+    inline string EscapeCsv(string const & s)
+    {
+        if (s.find_first_of(",\"") == string::npos)
+            return s;
+
+        string result = "\"";
+        for (char c : s)
+        {
+            if (c == '"')
+                result += '"';
+            result += c;
+        }
+        return result + "\"";
+    }
+
+    // PrintTable prints the results in a human-readable form.
+    inline void PrintTable(std::ostream& os, vector<Result> const & results)
+    {
+        for (auto const & r : results)
+        {
+            os << r.Group << "/" << r.Name << ": median " << r.Median << " ns, min " << r.Min
+               << " ns, p99 " << r.P99 << " ns";
+            if (r.ItemsPerSecond > 0)
+                os << ", " << r.ItemsPerSecond / 1e6 << " M items/s";
+            os << " (" << r.Samples << " x " << r.Iterations << ")" << endl;
+            if (r.Counters.Any())
+                os << "    per iteration: " << PerfCounters::Format(r.Counters) << endl;
+        }
+    }
+
+    // PrintCsv prints the results as CSV with a header row. The counters per iteration follow the times;
+    // a counter that wasn't read is an empty field.
+    inline void PrintCsv(std::ostream& os, vector<Result> const & results)
+    {
+        os << "group,name,iterations,samples,min_ns,median_ns,p99_ns,mean_ns,items_per_second";
+        for (std::size_t i = 0; i < PerfCounters::EventCount; ++i)
+        {
+            string name = PerfCounters::EventName(static_cast<PerfCounters::Event>(i));
+            std::replace(begin(name), end(name), ' ', '_');
+            os << "," << name;
+        }
+        os << endl;
+
+        for (auto const & r : results)
+        {
+            os << EscapeCsv(r.Group) << "," << EscapeCsv(r.Name) << "," << r.Iterations << "," << r.Samples << ","
+               << r.Min << "," << r.Median << "," << r.P99 << "," << r.Mean << "," << r.ItemsPerSecond;
+            for (std::size_t i = 0; i < PerfCounters::EventCount; ++i)
+            {
+                os << ",";
+                if (r.Counters.Available[i])
+                    os << r.Counters.Values[i];
+            }
+            os << endl;
+        }
+    }
+
+    // PrintJson prints the results as a JSON array of objects.
+    inline void PrintJson(std::ostream& os, vector<Result> const & results)
+    {
+        os << "[" << endl;
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            auto const & r = results[i];
+            os << "  { \"group\": \"" << EscapeJson(r.Group) << "\", \"name\": \"" << EscapeJson(r.Name)
+               << "\", \"iterations\": " << r.Iterations << ", \"samples\": " << r.Samples
+               << ", \"min_ns\": " << r.Min << ", \"median_ns\": " << r.Median << ", \"p99_ns\": " << r.P99
+               << ", \"mean_ns\": " << r.Mean << ", \"items_per_second\": " << r.ItemsPerSecond;
+            for (std::size_t e = 0; e < PerfCounters::EventCount; ++e)
+            {
+                if (r.Counters.Available[e])
+                    os << ", \"" << EscapeJson(PerfCounters::EventName(static_cast<PerfCounters::Event>(e))) << "\": " << r.Counters.Values[e];
+            }
+            os << " }" << (i + 1 < results.size() ? "," : "") << endl;
+        }
+        os << "]" << endl;
+    }
+}
@@ -2,6 +2,11 @@
 
 #include <iostream>
 #include <chrono>
+#include "Benchmark.h" // Benchmark::Register
+#include "Profiler.h" // PROFILE_SCOPE, Profiling::Ticks
+#include "Examples/Sequences.h" // Fibonacci and factorial algorithms
+#include "Examples/Hanoi.h" // Tower of Hanoi moves
+#include <vector>
 
 using std::cout;
 using std::endl;
@@ -11,6 +16,7 @@ using std::chrono::steady_clock;
 using std::chrono::duration_cast;
 using std::chrono::duration;
 using std::chrono::milliseconds;
+using std::chrono::nanoseconds;
 
 /*
     The chrono library provides clocks with different tick rates.
@@ -39,16 +45,193 @@ namespace ChronoExamples
         return SlowFunction(n - 2) * SlowFunction(n - 1);
     }
 
-    // Measures running time in milliseconds of the function passed as the parameter.
+    // Measures running time of the function passed as the parameter. The time is in milliseconds 
+    // unless a different duration is specified, e.g. TimeElapsedFunc<nanoseconds>(f).
     // The parameter f has to support the round brackets ().
-    template <typename Func>
+    // A single measurement is noisy; use the Benchmark harness (Benchmark.h) to get statistics.
+    template <typename Duration = milliseconds, typename Func>
     long long TimeElapsedFunc(Func f)
     {
         auto begin = steady_clock::now();
         f();
         auto end = steady_clock::now();
 
-        return duration_cast<milliseconds>(end - begin).count();
+        return duration_cast<Duration>(end - begin).count();
+    }
+
+    // The same Fibonacci number computed in different ways. SlowFunction is the exponential recursion.
+    void AlgorithmChoice()
+    {
+        unsigned n = 30;
+        auto slow = TimeElapsedFunc<nanoseconds>([&]() { Benchmark::DoNotOptimize(Sequences::FibonacciRecursive(n)); });
+        auto iterative = TimeElapsedFunc<nanoseconds>([&]() { Benchmark::DoNotOptimize(Sequences::FibonacciIterative(n)); });
+        auto fast = TimeElapsedFunc<nanoseconds>([&]() { Benchmark::DoNotOptimize(Sequences::FibonacciFastDoubling(n)); });
+        cout << "F(30)[ns] recursive:" << slow << " iterative:" << iterative << " fast doubling:" << fast << " ";
+
+        // Beyond 64 bits.
+        cout << "F(100)=" << Sequences::FibonacciBig(100).ToString() << " "; // 354224848179261915075
+        cout << "25!=" << Sequences::FactorialBig(25).ToString() << " ";     // 15511210043330985984000000
+    }
+
+    // Registers the benchmark cases of the Chrono examples.
+    void RegisterBenchmarks()
+    {
+        Benchmark::Register("Chrono", "SlowFunction(20)", [](Benchmark::State& state)
+        {
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(SlowFunction(20));
+        });
+
+        Benchmark::Register("Chrono", "steady_clock::now", [](Benchmark::State& state)
+        {
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(steady_clock::now());
+        });
+
+        Benchmark::Register("Chrono", "Profiling::Ticks", [](Benchmark::State& state)
+        {
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Profiling::Ticks());
+        });
+
+        // Fibonacci algorithms side by side. The argument goes through DoNotOptimize so the compiler
+        // can't compute the result at compile time.
+        Benchmark::Register("Chrono", "Fibonacci recursive F(25)", [](Benchmark::State& state)
+        {
+            unsigned n = 25;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FibonacciRecursive(n));
+            }
+        });
+
+        const unsigned n64 = 90;
+        Benchmark::Register("Chrono", "Fibonacci memoized F(90)", [n64](Benchmark::State& state)
+        {
+            auto n = n64;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FibonacciMemoized(n));
+            }
+        });
+
+        Benchmark::Register("Chrono", "Fibonacci iterative F(90)", [n64](Benchmark::State& state)
+        {
+            auto n = n64;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FibonacciIterative(n));
+            }
+        });
+
+        Benchmark::Register("Chrono", "Fibonacci fast doubling F(90)", [n64](Benchmark::State& state)
+        {
+            auto n = n64;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FibonacciFastDoubling(n));
+            }
+        });
+
+        Benchmark::Register("Chrono", "Fibonacci table F(90)", [n64](Benchmark::State& state)
+        {
+            auto n = n64;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FibonacciTable[n]);
+            }
+        });
+
+        Benchmark::Register("Chrono", "Fibonacci big iterative F(10000)", [](Benchmark::State& state)
+        {
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Sequences::FibonacciBigIterative(10000));
+        });
+
+        Benchmark::Register("Chrono", "Fibonacci big fast doubling F(10000)", [](Benchmark::State& state)
+        {
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Sequences::FibonacciBig(10000));
+        });
+
+        Benchmark::Register("Chrono", "Factorial iterative 20!", [](Benchmark::State& state)
+        {
+            unsigned n = 20;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FactorialIterative(n));
+            }
+        });
+
+        Benchmark::Register("Chrono", "Factorial table 20!", [](Benchmark::State& state)
+        {
+            unsigned n = 20;
+            while (state.KeepRunning())
+            {
+                Benchmark::DoNotOptimize(n);
+                Benchmark::DoNotOptimize(Sequences::FactorialTable[n]);
+            }
+        });
+
+        // Tower of Hanoi moves for 20 disks (about a million moves), consumed without any I/O.
+        const int disks = 20;
+        const auto moves = static_cast<double>(Hanoi::MoveCount(disks));
+
+        Benchmark::Register("Chrono", "Hanoi recursive 20 disks", [disks, moves](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(moves);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                Hanoi::MovesRecursive(disks, 1, 3, 2, [&sum](Hanoi::Move move) { sum += move.Disk + move.To; });
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Chrono", "Hanoi iterative range 20 disks", [disks, moves](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(moves);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto move : Hanoi::Moves(disks))
+                    sum += move.Disk + move.To;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Chrono", "Hanoi batch 20 disks", [disks, moves](Benchmark::State& state)
+        {
+            std::vector<Hanoi::Move> buffer(4096);
+            state.SetItemsPerIteration(moves);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                std::uint64_t first = 0;
+                while (auto n = Hanoi::GenerateMoves(disks, first, buffer.data(), buffer.size()))
+                {
+                    for (std::size_t i = 0; i < n; ++i)
+                        sum += buffer[i].Disk + buffer[i].To;
+                    first += n;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        // The cost of an empty zone: two clock reads and recording a duration.
+        Benchmark::Register("Chrono", "PROFILE_SCOPE", [](Benchmark::State& state)
+        {
+            while (state.KeepRunning())
+            {
+                PROFILE_SCOPE("Benchmark zone");
+            }
+        });
     }
 
     void Test()
@@ -59,5 +242,10 @@ namespace ChronoExamples
 
         auto time = TimeElapsedFunc([&]() { SlowFunction(30); });
         cout << "TimeElapsedFunc[ms]:" << time << " ";
+
+        time = TimeElapsedFunc<nanoseconds>([&]() { SlowFunction(10); });
+        cout << "TimeElapsedFunc[ns]:" << time << " ";
+
+        AlgorithmChoice();
     }
 }
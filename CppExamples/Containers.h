@@ -2,13 +2,29 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <list>
 #include <map>
 #include <set>
 #include <unordered_map>
 #include <algorithm> // for_each, find_if, sort, etc.
-#include <numeric> // std::accumulate
+#include <numeric> // std::accumulate, iota
+#include <random> // mt19937, shuffle
+#include <cstdint> // uint32_t, int64_t
+#include <memory_resource> // pmr containers, monotonic_buffer_resource, unsynchronized_pool_resource
+#include <memory> // make_shared, make_unique
+#include "Examples/Matrix2D.h" // Matrix2D, RotateClockwiseInPlace
+#include "Examples/FlatHashMap.h" // FlatHashMap
+#include "Examples/Hashing.h" // Hashing::HashString, Hashing::HashCombine
+#include "Examples/Arena.h" // ArenaResource, NodePoolResource
+#include "Examples/FlatMap.h" // FlatMap, FlatSet
+#include "Examples/ParallelAlgorithms.h" // Parallel::Sort, Count, Reduce, RemoveIf, Unique
+#include "Examples/RadixSort.h" // RadixSort, StringRadixSort
+#include "Examples/EraseRemove.h" // UnstableEraseIf, CompactEraseIf, EraseIndices
+#include "Examples/SmallVector.h" // SmallVector
+#include "Examples/SoaVector.h" // SoaVector
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -149,6 +165,60 @@ bool operator==(FileKey const & left, FileKey const & right)
         left.Id == right.Id;
 }
 
+// A non-owning view of a FileKey. It is used to look up a FileKey without constructing one
+// (and allocating a string for its name).
+struct FileKeyView
+{
+    std::string_view Name;
+    int Id;
+};
+
+// FileKeyHash hashes the name and mixes the id into the hash of the name with Hashing::HashCombine.
+// FileKey and FileKeyView produce the same hash for the same name and id.
+//
+// Combining std::hash<string> and std::hash<int> with exclusive-or does not mix the bits: with an identity
+// std::hash<int>, a name whose hash differs from another one in the same bits as two ids do produces a
+// collision. With a good string hash that is rare (FileKeyHashDistribution measures both hashes), but
+// HashCombine doesn't depend on the quality of std::hash<int>.
+//
+// is_transparent tells the containers that support heterogeneous lookup (such as FlatHashMap)
+// that the hash accepts other key types.
+struct FileKeyHash
+{
+    typedef void is_transparent;
+
+    std::size_t operator()(FileKeyView key) const
+    {
+        return static_cast<std::size_t>(Hashing::HashCombine(Hashing::HashString(key.Name), static_cast<std::uint32_t>(key.Id)));
+    }
+
+    std::size_t operator()(FileKey const & key) const
+    {
+        return (*this)(FileKeyView{ key.Name, key.Id });
+    }
+};
+
+// FileKeyEqual compares FileKeys and FileKeyViews in any combination.
+struct FileKeyEqual
+{
+    typedef void is_transparent;
+
+    bool operator()(FileKeyView left, FileKeyView right) const
+    {
+        return left.Name == right.Name && left.Id == right.Id;
+    }
+
+    bool operator()(FileKey const & left, FileKeyView right) const
+    {
+        return (*this)(FileKeyView{ left.Name, left.Id }, right);
+    }
+
+    bool operator()(FileKey const & left, FileKey const & right) const
+    {
+        return left == right;
+    }
+};
+
 // Specialize the standard hash class template for FileKey. 
 namespace std
 {
@@ -161,13 +231,12 @@ namespace std
     struct std::hash<FileKey>
     {
         // Because std::hash is a function object we need to define a call operator.
-        // The standard C++ library provides specializations for common types. We can just on these as building blocks. 
-        // Here, we delegate the hash specialization for strings and integers. We combine the hash values using exclusive-or
-        // to preserve their distribution properties.
+        // The standard C++ library provides specializations for common types that could be used as building blocks,
+        // but they would then need to be combined (see FileKeyHash for why not with exclusive-or).
+        // Here, we delegate to FileKeyHash.
         std::size_t operator()(FileKey const & fk) const
         {
-            return std::hash<string> {} (fk.Name) ^
-                   std::hash<int> {} (fk.Id);
+            return FileKeyHash{}(fk);
         }
     };
 }
@@ -389,6 +458,31 @@ namespace ContainerExamples
 
     } // ~A() ~A() a1 and a2 destr; ~A() ~A() temp objects in the vector destr
 
+    // SmallVector: the first N elements are stored in the object, more go to the heap.
+    void SmallVectorContainer()
+    {
+        SmallVector<int, 4> v{ 1, 2, 3 };
+        cout << v.IsInline() << v.capacity() << " "; // 14
+
+        v.push_back(4);
+        v.emplace_back(5); // the 5th element spills to the heap
+        cout << v.IsInline() << v.capacity() << " "; // 08
+
+        // Moving a spilled SmallVector takes its heap buffer; an inline one moves the elements.
+        auto moved = std::move(v);
+        cout << moved.size() << v.size() << " "; // 50
+
+        moved.erase(moved.begin(), moved.begin() + 2);
+        for (auto n : moved)
+            cout << n; // 345
+        cout << " ";
+
+        struct Order { int Number; };
+        SmallVector<Order, 2> orders;
+        orders.push_back(Order{ 7 });
+        cout << orders.at(0).Number << " "; // 7
+    }
+
     void ListContainer()
     {
         auto c = list<int>{}; // default ctor called
@@ -742,6 +836,31 @@ namespace ContainerExamples
         cout << "Found2:" << b2.Id << b2.Title << b2.Author << " ";
     }
 
+    // SoaVector: the fields of the Books in separate arrays (columns).
+    void SoaVectorContainer()
+    {
+        SoaVector<int, string, string> books;
+        books.push_back({ 3, "Dune", "Herbert" });
+        books.emplace_back(1, "Emma", "Austen");
+        books.emplace_back(2, "Ulysses", "Joyce");
+
+        // A loop over one column reads only that column.
+        int sum = 0;
+        for (int id : books.column<0>())
+            sum += id;
+        cout << sum << " "; // 6
+
+        // The records are References to the fields, which work with structured bindings and algorithms.
+        for (auto [id, title, author] : books)
+            title += "!";
+        std::sort(books.begin(), books.end(), [](auto const & a, auto const & b) { return get<0>(a) < get<0>(b); });
+        for (auto book : books)
+            cout << get<0>(book) << get<1>(book) << " "; // 1Emma! 2Ulysses! 3Dune!
+
+        auto it = std::find_if(books.begin(), books.end(), [](auto const & book) { return get<2>(book) == "Joyce"; });
+        cout << get<0>(*it) << " "; // 2
+    }
+
     void MultimapContainer()
     {
         // Initialize a multimap with a few elements.
@@ -810,10 +929,80 @@ namespace ContainerExamples
         auto k = FileKey{ "D", 2 };
         f[k] = 44;
 
-        // 1-A11,2-B22,2-D44,3-C33
+        // The order depends on the hash function, e.g. 1-A11,2-B22,2-D44,3-C33
         for (auto & v : f)
             cout << v.first.Id << "-" << v.first.Name << v.second << ",";
         cout << " ";
+
+        // FlatHashMap is an open-addressing alternative to unordered_map. With the transparent FileKeyHash 
+        // and FileKeyEqual, it can be searched with a FileKeyView, so the lookup does not create a string.
+        auto ff = FlatHashMap<FileKey, int, FileKeyHash, FileKeyEqual>
+        {
+            { { "A", 1 }, 11 },
+            { { "B", 2 }, 22 },
+        };
+        ff[{"C", 3}] = 33;
+
+        std::string_view name = "B";
+        auto it = ff.find(FileKeyView{ name, 2 });
+        if (it != ff.end())
+            cout << it->first.Id << "-" << it->first.Name << it->second << " "; // 2-B22
+    }
+
+    // The original hash of FileKey: the hashes of the parts combined with exclusive-or.
+    // It's kept here to compare with FileKeyHash.
+    struct XorFileKeyHash
+    {
+        std::size_t operator()(FileKey const & fk) const
+        {
+            return std::hash<string> {} (fk.Name) ^
+                   std::hash<int> {} (fk.Id);
+        }
+    };
+
+    // MakeFileKeys creates keys with similar names and small ids, as real file keys tend to be.
+    vector<FileKey> MakeFileKeys(std::size_t count)
+    {
+        vector<FileKey> keys;
+        keys.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            keys.emplace_back("file" + std::to_string(i % 1000), static_cast<int>(i / 1000));
+        return keys;
+    }
+
+    // PrintHashDistribution prints how a hash distributes keys over the buckets of unordered_map.
+    template <typename Hash, typename Key>
+    void PrintHashDistribution(char const * name, vector<Key> const & keys)
+    {
+        auto m = unordered_map<Key, int, Hash>{};
+        for (auto const & k : keys)
+            m[k] = 0;
+
+        std::size_t maxBucket = 0, usedBuckets = 0;
+        for (std::size_t b = 0; b < m.bucket_count(); ++b)
+        {
+            maxBucket = std::max(maxBucket, m.bucket_size(b));
+            usedBuckets += m.bucket_size(b) != 0;
+        }
+
+        auto hashes = set<std::size_t>{};
+        for (auto const & k : keys)
+            hashes.insert(Hash{}(k));
+
+        // With a uniform hash, about 1 - 1/e = 63% of the buckets are used when there are as many keys as buckets.
+        cout << name << ":collisions=" << keys.size() - hashes.size() << ",buckets="
+             << 100 * usedBuckets / m.bucket_count() << "%,chain=" << maxBucket << " ";
+    }
+
+    // FileKeyHashDistribution compares the original xor hash with FileKeyHash on 200k FileKeys. With
+    // libstdc++ neither has a collision and they use as many buckets: std::hash<string> mixes the name
+    // well and the prime number of buckets spreads the ids, so on these keys xor loses nothing. Its
+    // weaknesses (Hashing.h) show when parts of a key can cancel out or be swapped, not here.
+    void FileKeyHashDistribution()
+    {
+        auto keys = MakeFileKeys(200'000);
+        PrintHashDistribution<XorFileKeyHash>("xor", keys);      // xor:collisions=0,buckets=43%,chain=5
+        PrintHashDistribution<FileKeyHash>("HashCombine", keys); // HashCombine:collisions=0,buckets=43%,chain=7
     }
 
     struct Person
@@ -964,6 +1153,73 @@ namespace ContainerExamples
         std::generate_n(std::back_inserter(v), 5, [&]() { return n++; }); // v = {0,0,0,0,0,1,2,3,4,5}
     }
 
+    // The algorithms of ContainerAlgorithms on several threads. Parallel::Backend picks the std::execution
+    // policy (if the standard library has one) or the work-stealing thread pool.
+    void ParallelContainerAlgorithms()
+    {
+        vector<int> vec(200'000);
+        for (std::size_t i = 0; i < vec.size(); ++i)
+            vec[i] = static_cast<int>((i * 7919) % 1000);
+
+        for (auto backend : { Parallel::Backend::Sequential, Parallel::Backend::Par, Parallel::Backend::Pool })
+        {
+            auto v = vec;
+            Parallel::Sort(backend, begin(v), end(v));
+            auto isSorted = std::is_sorted(begin(v), end(v));
+            auto threes = Parallel::Count(backend, begin(v), end(v), 3);
+            auto sum = Parallel::Reduce(backend, begin(v), end(v), 0LL);
+
+            // unique on a sorted range leaves one of each value.
+            auto u = v;
+            u.erase(Parallel::Unique(backend, begin(u), end(u)), end(u));
+
+            // The erase-remove idiom with a parallel remove_if.
+            v.erase(Parallel::RemoveIf(backend, begin(v), end(v), [](int n) { return n % 2 != 0; }), end(v));
+
+            cout << Parallel::BackendName(backend) << ":" << isSorted << " " << threes << " "
+                << sum << " " << u.size() << " " << v.size() << " "; // 1 200 99900000 1000 100000
+        }
+
+        // A pool of a given size; pools of 1 run everything on the calling thread.
+        Tasks::ThreadPool pool(2);
+        vector<long long> squares(1000);
+        pool.ParallelFor(squares.size(), 0, [&squares](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                squares[i] = static_cast<long long>(i) * static_cast<long long>(i);
+        });
+        cout << Parallel::Reduce(Parallel::Backend::Pool, begin(squares), end(squares), 0LL, std::plus<>(), pool) << " "; // 332833500
+    }
+
+    // Radix sorts: by integer keys (LSD) and by strings (MSD), with a projection to sort structs by a member.
+    void RadixSorting()
+    {
+        vector<int> vec = { 3, -4, 1, 3, 2, -5, 1000000 };
+        RadixSort(begin(vec), end(vec));
+        for (auto n : vec)
+            cout << n << ","; // -5,-4,1,2,3,3,1000000,
+        cout << " ";
+
+        // Stable: the people of the same age keep their order.
+        vector<Person> people{ { "A", 5 }, { "B", 3 }, { "C", 5 }, { "D", 1 } };
+        RadixSort(begin(people), end(people), [](Person const & p) { return p.Age; });
+        for (auto const & p : people)
+            cout << p; // D1 B3 A5 C5
+
+        vector<Book> books{ { 30, "Z", "C" }, { 10, "X", "A" }, { 20, "Y", "B" } };
+        RadixSort(begin(books), end(books), [](Book const & b) { return b.Id; });
+        cout << books.front().Title << books.back().Title << " "; // XZ
+
+        vector<string> words{ "pear", "apple", "plum", "app", "peach", "" };
+        StringRadixSort(begin(words), end(words));
+        for (auto const & w : words)
+            cout << w << ","; // ,app,apple,peach,pear,plum,
+        cout << " ";
+
+        StringRadixSort(begin(books), end(books), [](Book const & b) -> string const & { return b.Author; });
+        cout << books.front().Author << " "; // A
+    }
+
     void RemovingElements()
     {
         vector<int> v = { 3,4,1,3,2,5 };
@@ -983,6 +1239,27 @@ namespace ContainerExamples
 
         // More compact - in a single line.
         v2.erase(std::remove_if(begin(v2), end(v2), [](int elem) { return (elem == 3); }), end(v2));
+
+        // Swap-and-pop: the holes are filled with the elements from the back, so the order changes.
+        auto v3 = v;
+        UnstableEraseIf(v3, [](int elem) { return elem == 3; });
+        for (auto n : v3)
+            cout << n; // 5412
+        cout << " ";
+
+        // Stable and branch-free, for trivially copyable types (SIMD with AVX2).
+        auto v4 = v;
+        CompactEraseIf(v4, [](int elem) { return elem == 3; });
+        for (auto n : v4)
+            cout << n; // 4125
+        cout << " ";
+
+        // Remove the elements at sorted indices.
+        auto v5 = v;
+        EraseIndices(v5, vector<std::size_t>{ 0, 2, 5 });
+        for (auto n : v5)
+            cout << n; // 432
+        cout << " ";
     }
 
     void Vector2D()
@@ -1036,6 +1313,949 @@ namespace ContainerExamples
                 m[i][n - j - 1] = tmp;
             }
         }
+
+        // The same rotation on a contiguous matrix (Examples/Matrix2D.h): a single allocation 
+        // and a single pass that rotates each element together with its three images.
+        Matrix2D<int> m2 = { {1,2,3,4}, {5,6,7,8}, {9,10,11,12}, {13,14,15,16} };
+        RotateClockwiseInPlace(m2.View());
+
+        // Both rotations give 13,9,5,1,14,10,6,2,...
+        for (auto i = 0; i < m.size(); ++i)
+            for (auto j = 0; j < m[i].size(); ++j)
+                assert(m[i][j] == m2(i, j));
+
+        // A 5x3 field stored contiguously. A non-square matrix cannot be rotated in place, 
+        // so RotateClockwise returns a new 3x5 matrix.
+        Matrix2D<int> field2(rows, cols);
+        n = 0;
+        for (auto& e : field2)
+            e = n++;
+
+        auto rotated = RotateClockwise(field2);
+        assert(rotated.Rows() == 3 && rotated.Cols() == 5);
+        assert(rotated(0, 0) == field2(4, 0));
+
+        // A view of the 2x2 block in the middle of m2, without copying it.
+        auto center = m2.View().Sub(1, 1, 2, 2);
+        cout << center(0, 0) << center(0, 1) << center(1, 0) << center(1, 1) << " "; // 10 6 11 7
+    }
+
+    // FlatMap and FlatSet: sorted vectors with the interface of map and set.
+    void FlatContainers()
+    {
+        // Build the map in bulk: one sort instead of an insert per book.
+        vector<std::pair<int, Book>> list{ { 3, Book{ 3, "Z", "C" } }, { 1, Book{ 1, "X", "A" } }, { 2, Book{ 2, "Y", "B" } } };
+        FlatMap<int, Book> books(list);
+
+        // The elements are pairs of references to a key and a value.
+        for (auto b : books)
+            cout << b.first << b.second.Title << " "; // 1X 2Y 3Z
+
+        auto b2 = books.find(2);
+        cout << "Found:" << b2->second.Author << " "; // B
+
+        // Transparent comparison: look up a string key by string_view without creating a string.
+        FlatMap<string, int, std::less<>> counts{ { "apple", 3 }, { "pear", 1 } };
+        counts["plum"] = 5;
+        cout << counts.find(std::string_view("pear"))->second << counts.size() << " "; // 13
+
+        // The Eytzinger layout searches a copy of the keys in BFS order.
+        FlatSet<int, std::less<int>, SearchLayout::Eytzinger> primes{ 7, 2, 5, 3, 11, 13 };
+        cout << primes.contains(11) << primes.contains(12) << " "; // 10
+    }
+
+    // The node-based containers with their nodes allocated from an arena or a node pool.
+    // std::pmr::list<T> is std::list<T, std::pmr::polymorphic_allocator<T>>, and the same for the others.
+    void PmrContainers()
+    {
+        ArenaResource arena;
+        {
+            std::pmr::list<int> l({ 3, 1, 2 }, &arena);
+            l.sort();
+
+            // The strings are constructed with the map's allocator too (uses-allocator construction),
+            // so both the nodes and the characters of long keys come from the arena.
+            std::pmr::map<std::pmr::string, int> m(&arena);
+            m["a key long enough not to fit in the string object"] = 1;
+            m["B"] = 2;
+
+            cout << l.front() << l.back() << " " << m.size() << " "; // 13 2
+        }
+        // The containers are gone, so the arena can be reused.
+        arena.Reset();
+
+        NodePoolResource pool;
+        {
+            std::pmr::set<int> s({ 5, 3, 8 }, &pool);
+            std::pmr::multimap<int, int> mm(&pool);
+            mm.insert({ { 1, 10 }, { 1, 11 }, { 2, 20 } });
+
+            // An erased node goes on the pool's free list; the next insert reuses it.
+            s.erase(3);
+            s.insert(4);
+
+            cout << *s.begin() << " " << mm.count(1) << " "; // 4 2
+        }
+
+        std::pmr::list<int> local({ 1, 2, 3 }, ThreadLocalNodePool());
+        cout << local.size() << " "; // 3
+    }
+
+    // BuildMap fills a map with the keys and then destroys it, like a map built for a single request.
+    std::size_t BuildMap(vector<string> const & keys, std::pmr::memory_resource* resource)
+    {
+        std::pmr::map<std::pmr::string, int> m(resource);
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            m.emplace(std::string_view(keys[i]), static_cast<int>(i));
+        return m.size();
+    }
+
+    std::size_t BuildList(std::size_t count, std::pmr::memory_resource* resource)
+    {
+        std::pmr::list<int> l(resource);
+        for (std::size_t i = 0; i < count; ++i)
+            l.push_back(static_cast<int>(i));
+        return l.size();
+    }
+
+    // Registers the allocator benchmarks: building and tearing down a map<string, int> and a list<int>
+    // of 1M nodes with the default allocator and with each memory resource.
+    void RegisterAllocatorBenchmarks()
+    {
+        const std::size_t count = 1'000'000;
+
+        // The keys in random order. "key" + a number is short enough for the small string optimization,
+        // so the map allocates its nodes only. The cases share them.
+        vector<std::size_t> order(count);
+        std::iota(begin(order), end(order), std::size_t{ 0 });
+        std::shuffle(begin(order), end(order), std::mt19937(1));
+        vector<string> shuffled;
+        shuffled.reserve(count);
+        for (auto n : order)
+            shuffled.push_back("key" + std::to_string(n));
+        auto keys = std::make_shared<vector<string> const>(std::move(shuffled));
+
+        Benchmark::Register("Containers", "map<string, int> 1M new/delete", [keys](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(static_cast<double>(keys->size()));
+            while (state.KeepRunning())
+            {
+                map<string, int> m;
+                for (std::size_t i = 0; i < keys->size(); ++i)
+                    m.emplace((*keys)[i], static_cast<int>(i));
+                Benchmark::DoNotOptimize(m.size());
+            }
+        });
+
+        Benchmark::Register("Containers", "list<int> 1M new/delete", [count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                list<int> l;
+                for (std::size_t i = 0; i < count; ++i)
+                    l.push_back(static_cast<int>(i));
+                Benchmark::DoNotOptimize(l.size());
+            }
+        });
+
+        // The same case with each resource. For the resources that live across iterations, reset is
+        // called after each one to reclaim the memory (for the arena) or does nothing (for the pools).
+        auto registerResource = [keys, count](string const & name, auto makeResource, auto reset)
+        {
+            Benchmark::Register("Containers", "pmr::map<pmr::string, int> 1M " + name, [keys, makeResource, reset](Benchmark::State& state)
+            {
+                auto resource = makeResource();
+                state.SetItemsPerIteration(static_cast<double>(keys->size()));
+                while (state.KeepRunning())
+                {
+                    Benchmark::DoNotOptimize(BuildMap(*keys, resource.get()));
+                    reset(*resource);
+                }
+            });
+
+            Benchmark::Register("Containers", "pmr::list<int> 1M " + name, [count, makeResource, reset](Benchmark::State& state)
+            {
+                auto resource = makeResource();
+                state.SetItemsPerIteration(count);
+                while (state.KeepRunning())
+                {
+                    Benchmark::DoNotOptimize(BuildList(count, resource.get()));
+                    reset(*resource);
+                }
+            });
+        };
+
+        auto noReset = [](std::pmr::memory_resource&) {};
+
+        registerResource("monotonic_buffer_resource", []() { return std::make_unique<std::pmr::monotonic_buffer_resource>(); },
+            [](std::pmr::monotonic_buffer_resource& r) { r.release(); });
+        registerResource("ArenaResource", []() { return std::make_unique<ArenaResource>(); },
+            [](ArenaResource& r) { r.Reset(); });
+        registerResource("unsynchronized_pool_resource", []() { return std::make_unique<std::pmr::unsynchronized_pool_resource>(); }, noReset);
+        registerResource("NodePoolResource", []() { return std::make_unique<NodePoolResource>(); }, noReset);
+
+        // The thread's pool isn't owned by the case, so it is wrapped in a unique_ptr that doesn't delete.
+        struct NoDelete { void operator()(NodePoolResource*) const {} };
+        registerResource("ThreadLocalNodePool", []() { return std::unique_ptr<NodePoolResource, NoDelete>(ThreadLocalNodePool()); }, noReset);
+    }
+
+    // Registers the lookup benchmarks of std::map and FlatMap (sorted and Eytzinger) at sizes from 8 to 1M.
+    // Each key looked up depends on the value found by the previous lookup, so the time is the latency
+    // of a lookup rather than the throughput of independent ones.
+    void RegisterFlatMapBenchmarks()
+    {
+        const std::size_t queryCount = 4096;
+
+        for (std::size_t size : { 8, 64, 512, 4096, 32768, 262144, 1 << 20 })
+        {
+            // Odd keys in random order; a key's value is its index, used to pick the next query.
+            vector<std::pair<int, int>> values(size);
+            for (std::size_t i = 0; i < size; ++i)
+                values[i] = { static_cast<int>(2 * i + 1), static_cast<int>(i) };
+            std::shuffle(begin(values), end(values), std::mt19937(1));
+
+            std::mt19937 gen(2);
+            vector<int> queries(queryCount);
+            for (auto& q : queries)
+                q = static_cast<int>(2 * (gen() % size) + 1);
+
+            auto name = std::to_string(size);
+
+            Benchmark::Register("Containers", "map<int, int> find " + name, [values, queries](Benchmark::State& state)
+            {
+                map<int, int> m(begin(values), end(values));
+                std::size_t next = 0;
+                while (state.KeepRunning())
+                {
+                    auto value = m.find(queries[next])->second;
+                    next = (next + 1 + (value & 1)) & (queryCount - 1);
+                }
+                Benchmark::DoNotOptimize(next);
+            });
+
+            Benchmark::Register("Containers", "FlatMap<int, int> find " + name, [values, queries](Benchmark::State& state)
+            {
+                FlatMap<int, int> m(values);
+                std::size_t next = 0;
+                while (state.KeepRunning())
+                {
+                    auto value = m.find(queries[next])->second;
+                    next = (next + 1 + (value & 1)) & (queryCount - 1);
+                }
+                Benchmark::DoNotOptimize(next);
+            });
+
+            Benchmark::Register("Containers", "FlatMap<int, int> Eytzinger find " + name, [values, queries](Benchmark::State& state)
+            {
+                FlatMap<int, int, std::less<int>, SearchLayout::Eytzinger> m(values);
+                std::size_t next = 0;
+                while (state.KeepRunning())
+                {
+                    auto value = m.find(queries[next])->second;
+                    next = (next + 1 + (value & 1)) & (queryCount - 1);
+                }
+                Benchmark::DoNotOptimize(next);
+            });
+        }
+    }
+
+    // Registers the scaling benchmarks of the parallel algorithms on 10M ints: the thread pool with 1, 2, 4, ...
+    // up to the hardware threads, and the std::execution policies. The sort cases include copying the
+    // unsorted data, which is also timed by "copy 10M" for reference.
+    void RegisterParallelBenchmarks()
+    {
+        const std::size_t count = 10'000'000;
+
+        vector<int> data(count);
+        std::mt19937 gen(1);
+        for (auto& x : data)
+            x = static_cast<int>(gen() % 1'000'000);
+
+        vector<int> sorted = data;
+        std::sort(begin(sorted), end(sorted));
+
+        Benchmark::Register("Parallel", "copy 10M", [data](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(data.size());
+            while (state.KeepRunning())
+            {
+                auto v = data;
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        // Registers the cases of one backend; pool is used by Backend::Pool only.
+        auto registerBackend = [data, sorted](std::string const & name, Parallel::Backend backend, unsigned threads)
+        {
+            Benchmark::Register("Parallel", "sort 10M " + name, [data, backend, threads](Benchmark::State& state)
+            {
+                Tasks::ThreadPool pool(threads);
+                state.SetItemsPerIteration(data.size());
+                while (state.KeepRunning())
+                {
+                    auto v = data;
+                    Parallel::Sort(backend, begin(v), end(v), std::less<>(), pool);
+                    Benchmark::DoNotOptimize(v.data());
+                }
+            });
+
+            Benchmark::Register("Parallel", "count 10M " + name, [data, backend, threads](Benchmark::State& state)
+            {
+                Tasks::ThreadPool pool(threads);
+                state.SetItemsPerIteration(data.size());
+                while (state.KeepRunning())
+                    Benchmark::DoNotOptimize(Parallel::Count(backend, begin(data), end(data), 42, pool));
+            });
+
+            Benchmark::Register("Parallel", "reduce 10M " + name, [data, backend, threads](Benchmark::State& state)
+            {
+                Tasks::ThreadPool pool(threads);
+                state.SetItemsPerIteration(data.size());
+                while (state.KeepRunning())
+                    Benchmark::DoNotOptimize(Parallel::Reduce(backend, begin(data), end(data), 0LL, std::plus<>(), pool));
+            });
+
+            // remove_if and unique modify the range, so each iteration works on a copy.
+            Benchmark::Register("Parallel", "remove_if 10M " + name, [data, backend, threads](Benchmark::State& state)
+            {
+                Tasks::ThreadPool pool(threads);
+                state.SetItemsPerIteration(data.size());
+                while (state.KeepRunning())
+                {
+                    auto v = data;
+                    Benchmark::DoNotOptimize(Parallel::RemoveIf(backend, begin(v), end(v), [](int x) { return x % 3 == 0; }, pool) - begin(v));
+                }
+            });
+
+            Benchmark::Register("Parallel", "unique 10M " + name, [sorted, backend, threads](Benchmark::State& state)
+            {
+                Tasks::ThreadPool pool(threads);
+                state.SetItemsPerIteration(sorted.size());
+                while (state.KeepRunning())
+                {
+                    auto v = sorted;
+                    Benchmark::DoNotOptimize(Parallel::Unique(backend, begin(v), end(v), pool) - begin(v));
+                }
+            });
+        };
+
+        registerBackend("sequential", Parallel::Backend::Sequential, 1);
+
+        // ParallelFor over work that grows with the index (element i costs i / 64 steps), in fixed chunks
+        // of 4096 elements and split adaptively. The fixed chunks at the end take longest and finish last.
+        auto registerUneven = [](unsigned threads)
+        {
+            const std::size_t unevenCount = 1 << 16;
+            auto body = [](std::size_t begin, std::size_t end)
+            {
+                std::size_t sum = 0;
+                for (auto i = begin; i < end; ++i)
+                {
+                    for (std::size_t k = 0; k < i / 64; ++k)
+                        sum += k ^ i;
+                }
+                Benchmark::DoNotOptimize(sum);
+            };
+
+            for (std::size_t grain : { std::size_t{ 4096 }, std::size_t{ 0 } })
+            {
+                auto name = "ParallelFor uneven 64K " + std::string(grain == 0 ? "adaptive" : "grain 4096") + " pool " + std::to_string(threads) + " threads";
+                Benchmark::Register("Parallel", name, [threads, grain, body](Benchmark::State& state)
+                {
+                    Tasks::ThreadPool pool(threads);
+                    state.SetItemsPerIteration(unevenCount);
+                    while (state.KeepRunning())
+                        pool.ParallelFor(unevenCount, grain, body);
+                });
+            }
+        };
+
+        auto hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned threads = 1; ; threads *= 2)
+        {
+            threads = std::min(threads, hardwareThreads);
+            registerBackend("pool " + std::to_string(threads) + " threads", Parallel::Backend::Pool, threads);
+            registerUneven(threads);
+            if (threads == hardwareThreads)
+                break;
+        }
+
+#if PARALLEL_STD_EXECUTION
+        registerBackend("std::execution::par", Parallel::Backend::Par, 1);
+        registerBackend("std::execution::par_unseq", Parallel::Backend::ParUnseq, 1);
+#endif
+    }
+
+    // Registers the benchmarks of std::sort and the radix sorts: 4M random 32-bit and 64-bit ints,
+    // 1M Books by Id and 1M random strings. Each iteration sorts a copy of the unsorted data.
+    void RegisterSortBenchmarks()
+    {
+        const std::size_t count = 4'000'000;
+
+        std::mt19937_64 gen(1);
+        vector<std::uint32_t> ints(count);
+        for (auto& x : ints)
+            x = static_cast<std::uint32_t>(gen());
+        vector<std::int64_t> longs(count);
+        for (auto& x : longs)
+            x = static_cast<std::int64_t>(gen());
+
+        Benchmark::Register("Sort", "std::sort 4M uint32", [ints](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(ints.size());
+            while (state.KeepRunning())
+            {
+                auto v = ints;
+                std::sort(begin(v), end(v));
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        Benchmark::Register("Sort", "RadixSort 4M uint32", [ints](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(ints.size());
+            while (state.KeepRunning())
+            {
+                auto v = ints;
+                RadixSort(begin(v), end(v));
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        Benchmark::Register("Sort", "std::sort 4M int64", [longs](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(longs.size());
+            while (state.KeepRunning())
+            {
+                auto v = longs;
+                std::sort(begin(v), end(v));
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        Benchmark::Register("Sort", "RadixSort 4M int64", [longs](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(longs.size());
+            while (state.KeepRunning())
+            {
+                auto v = longs;
+                RadixSort(begin(v), end(v));
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        const std::size_t bookCount = 1'000'000;
+        vector<Book> books(bookCount);
+        for (auto& b : books)
+            b = Book{ static_cast<int>(gen() % 100'000'000), "Title", "Author" };
+
+        Benchmark::Register("Sort", "std::sort 1M Book by Id", [books](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(books.size());
+            while (state.KeepRunning())
+            {
+                auto v = books;
+                std::sort(begin(v), end(v), [](Book const & a, Book const & b) { return a.Id < b.Id; });
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        Benchmark::Register("Sort", "RadixSort 1M Book by Id", [books](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(books.size());
+            while (state.KeepRunning())
+            {
+                auto v = books;
+                RadixSort(begin(v), end(v), [](Book const & b) { return b.Id; });
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        // Random lowercase words of 4 to 19 characters.
+        vector<string> words(bookCount);
+        for (auto& w : words)
+        {
+            w.resize(4 + gen() % 16);
+            for (auto& c : w)
+                c = static_cast<char>('a' + gen() % 26);
+        }
+
+        Benchmark::Register("Sort", "std::sort 1M strings", [words](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(words.size());
+            while (state.KeepRunning())
+            {
+                auto v = words;
+                std::sort(begin(v), end(v));
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        Benchmark::Register("Sort", "StringRadixSort 1M strings", [words](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(words.size());
+            while (state.KeepRunning())
+            {
+                auto v = words;
+                StringRadixSort(begin(v), end(v));
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+    }
+
+    // A trivially copyable element that is not 4 or 8 bytes, so CompactEraseIf compacts it without SIMD.
+    struct Particle
+    {
+        float X, Y, Z;
+        float Life;
+    };
+
+    // Registers the benchmarks of removing elements from 1M-element vectors: half or a tenth of them,
+    // at random, with each of the erase utilities. Each iteration works on a copy, which is timed by
+    // "copy 1M int" for reference.
+    void RegisterEraseBenchmarks()
+    {
+        const std::size_t count = 1'000'000;
+
+        std::mt19937 gen(1);
+        vector<int> ints(count);
+        for (auto& x : ints)
+            x = static_cast<int>(gen() % 100);
+        vector<Particle> particles(count);
+        for (auto& p : particles)
+            p = Particle{ 1.0f, 2.0f, 3.0f, static_cast<float>(gen() % 100) };
+
+        Benchmark::Register("Erase", "copy 1M int", [ints](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(ints.size());
+            while (state.KeepRunning())
+            {
+                auto v = ints;
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        for (int percent : { 50, 10 })
+        {
+            auto name = std::to_string(percent) + "% of 1M ";
+            auto removed = [percent](int x) { return x < percent; };
+
+            Benchmark::Register("Erase", "EraseIf " + name + "int", [ints, removed](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(ints.size());
+                while (state.KeepRunning())
+                {
+                    auto v = ints;
+                    Benchmark::DoNotOptimize(EraseIf(v, removed));
+                }
+            });
+
+            Benchmark::Register("Erase", "UnstableEraseIf " + name + "int", [ints, removed](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(ints.size());
+                while (state.KeepRunning())
+                {
+                    auto v = ints;
+                    Benchmark::DoNotOptimize(UnstableEraseIf(v, removed));
+                }
+            });
+
+            for (auto isa : { ByteSearch::Isa::Scalar, ByteSearch::Isa::AVX2 })
+            {
+                if (isa > ByteSearch::ActiveIsa())
+                    continue;
+
+                Benchmark::Register("Erase", "CompactEraseIf " + name + "int " + ByteSearch::IsaName(isa), [ints, removed, isa](Benchmark::State& state)
+                {
+                    state.SetItemsPerIteration(ints.size());
+                    while (state.KeepRunning())
+                    {
+                        auto v = ints;
+                        Benchmark::DoNotOptimize(CompactEraseIf(v, removed, isa));
+                    }
+                });
+            }
+
+            // The indices of the elements to remove, found beforehand.
+            vector<std::uint32_t> indices;
+            for (std::size_t i = 0; i < ints.size(); ++i)
+            {
+                if (removed(ints[i]))
+                    indices.push_back(static_cast<std::uint32_t>(i));
+            }
+
+            Benchmark::Register("Erase", "EraseIndices " + name + "int", [ints, indices](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(ints.size());
+                while (state.KeepRunning())
+                {
+                    auto v = ints;
+                    Benchmark::DoNotOptimize(EraseIndices(v, indices));
+                }
+            });
+
+            Benchmark::Register("Erase", "UnstableEraseIndices " + name + "int", [ints, indices](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(ints.size());
+                while (state.KeepRunning())
+                {
+                    auto v = ints;
+                    Benchmark::DoNotOptimize(UnstableEraseIndices(v, indices));
+                }
+            });
+
+            auto dead = [percent](Particle const & p) { return p.Life < percent; };
+
+            Benchmark::Register("Erase", "EraseIf " + name + "Particle", [particles, dead](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(particles.size());
+                while (state.KeepRunning())
+                {
+                    auto v = particles;
+                    Benchmark::DoNotOptimize(EraseIf(v, dead));
+                }
+            });
+
+            Benchmark::Register("Erase", "UnstableEraseIf " + name + "Particle", [particles, dead](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(particles.size());
+                while (state.KeepRunning())
+                {
+                    auto v = particles;
+                    Benchmark::DoNotOptimize(UnstableEraseIf(v, dead));
+                }
+            });
+
+            Benchmark::Register("Erase", "CompactEraseIf " + name + "Particle", [particles, dead](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(particles.size());
+                while (state.KeepRunning())
+                {
+                    auto v = particles;
+                    Benchmark::DoNotOptimize(CompactEraseIf(v, dead));
+                }
+            });
+        }
+    }
+
+    // Registers the benchmarks of short sequences (0 to 8 ints, cycling): building, summing and destroying
+    // a std::vector, a std::vector with reserve(8) and a SmallVector<int, 8>, and building 100K of them
+    // in an outer vector (like the Orders of the Customers).
+    void RegisterSmallVectorBenchmarks()
+    {
+        const int sequenceCount = 1000;
+
+        auto registerSequences = [sequenceCount](std::string const & name, auto makeEmpty)
+        {
+            Benchmark::Register("SmallVector", name + " 0-8 elements", [makeEmpty, sequenceCount](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(sequenceCount);
+                while (state.KeepRunning())
+                {
+                    int sum = 0;
+                    for (int i = 0; i < sequenceCount; ++i)
+                    {
+                        auto v = makeEmpty();
+                        for (int k = 0; k < i % 9; ++k)
+                            v.push_back(k);
+                        for (auto x : v)
+                            sum += x;
+                    }
+                    Benchmark::DoNotOptimize(sum);
+                }
+            });
+
+            Benchmark::Register("SmallVector", name + " 100K nested 0-8 elements", [makeEmpty](Benchmark::State& state)
+            {
+                const std::size_t outerCount = 100'000;
+                state.SetItemsPerIteration(outerCount);
+                while (state.KeepRunning())
+                {
+                    vector<decltype(makeEmpty())> outer;
+                    outer.reserve(outerCount);
+                    for (std::size_t i = 0; i < outerCount; ++i)
+                    {
+                        outer.push_back(makeEmpty());
+                        for (std::size_t k = 0; k < i % 9; ++k)
+                            outer.back().push_back(static_cast<int>(k));
+                    }
+                    Benchmark::DoNotOptimize(outer.data());
+                }
+            });
+        };
+
+        registerSequences("vector<int>", []() { return vector<int>{}; });
+        registerSequences("vector<int> reserve(8)", []() { vector<int> v; v.reserve(8); return v; });
+        registerSequences("SmallVector<int, 8>", []() { return SmallVector<int, 8>{}; });
+    }
+
+    // Registers the benchmarks of reading one field of 1M Books stored in a vector<Book> and in a
+    // SoaVector<int, string, string>, and of copying and sorting them by the Id.
+    void RegisterSoaVectorBenchmarks()
+    {
+        const int count = 1'000'000;
+
+        vector<Book> books;
+        SoaVector<int, string, string> columns;
+        columns.reserve(count);
+        std::mt19937 gen(7);
+        for (int i = 0; i < count; ++i)
+        {
+            int id = static_cast<int>(gen() % count);
+            books.push_back(Book{ id, "Title " + std::to_string(i), "Author" });
+            columns.emplace_back(id, "Title " + std::to_string(i), "Author");
+        }
+
+        Benchmark::Register("SoaVector", "vector<Book> sum of Ids", [books, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                long long sum = 0;
+                for (auto const & book : books)
+                    sum += book.Id;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("SoaVector", "SoaVector<int, string, string> sum of Ids", [columns, count](Benchmark::State& state) mutable
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                long long sum = 0;
+                for (int id : columns.column<0>())
+                    sum += id;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("SoaVector", "vector<Book> copy and sort by Id", [books, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                auto v = books;
+                std::sort(v.begin(), v.end(), [](Book const & a, Book const & b) { return a.Id < b.Id; });
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
+
+        Benchmark::Register("SoaVector", "SoaVector<int, string, string> copy and sort by Id", [columns, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                auto v = columns;
+                std::sort(v.begin(), v.end(), [](auto const & a, auto const & b) { return get<0>(a) < get<0>(b); });
+                Benchmark::DoNotOptimize(v.column<0>().data());
+            }
+        });
+    }
+
+    // Registers the benchmark cases of the container examples: a 90 degree rotation of a 2048x2048 
+    // matrix stored as vector<vector<int>> (transpose + reflection) and as Matrix2D (tiled, single pass),
+    // and the sum of a 4096x4096 matrix by columns in both.
+    void RegisterBenchmarks()
+    {
+        const std::size_t size = 2048;
+
+        Benchmark::Register("Containers", "rotate vector<vector<int>> 2048x2048", [size](Benchmark::State& state)
+        {
+            vector<vector<int>> m(size, vector<int>(size, 1));
+            state.SetItemsPerIteration(size * size);
+            while (state.KeepRunning())
+            {
+                for (std::size_t i = 0; i < size; ++i)
+                    for (std::size_t j = i + 1; j < size; ++j)
+                        std::swap(m[i][j], m[j][i]);
+
+                for (std::size_t i = 0; i < size; ++i)
+                    std::reverse(begin(m[i]), end(m[i]));
+
+                Benchmark::ClobberMemory();
+            }
+        });
+
+        Benchmark::Register("Containers", "rotate Matrix2D<int> 2048x2048", [size](Benchmark::State& state)
+        {
+            Matrix2D<int> m(size, size, 1);
+            state.SetItemsPerIteration(size * size);
+            while (state.KeepRunning())
+            {
+                RotateClockwiseInPlace(m.View());
+                Benchmark::ClobberMemory();
+            }
+        });
+
+        // Walking down the columns of a 4096x4096 matrix (64 MB): each step is in another row, and with
+        // vector<vector<int>> also behind another pointer. Run with --counters for the misses per element.
+        const std::size_t largeSize = 4096;
+
+        Benchmark::Register("Containers", "column sum vector<vector<int>> 4096x4096", [largeSize](Benchmark::State& state)
+        {
+            vector<vector<int>> m(largeSize, vector<int>(largeSize, 1));
+            state.SetItemsPerIteration(largeSize * largeSize);
+            while (state.KeepRunning())
+            {
+                long long sum = 0;
+                for (std::size_t j = 0; j < largeSize; ++j)
+                    for (std::size_t i = 0; i < largeSize; ++i)
+                        sum += m[i][j];
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Containers", "column sum Matrix2D<int> 4096x4096", [largeSize](Benchmark::State& state)
+        {
+            Matrix2D<int> m(largeSize, largeSize, 1);
+            state.SetItemsPerIteration(largeSize * largeSize);
+            while (state.KeepRunning())
+            {
+                long long sum = 0;
+                for (std::size_t j = 0; j < largeSize; ++j)
+                    for (std::size_t i = 0; i < largeSize; ++i)
+                        sum += m(i, j);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        const std::size_t keyCount = 200'000;
+
+        Benchmark::Register("Containers", "unordered_map<FileKey> xor hash insert", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                auto m = unordered_map<FileKey, int, XorFileKeyHash>{};
+                for (auto const & k : keys)
+                    m[k] = 1;
+                Benchmark::DoNotOptimize(m.size());
+            }
+        });
+
+        Benchmark::Register("Containers", "unordered_map<FileKey> FileKeyHash insert", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                auto m = unordered_map<FileKey, int, FileKeyHash>{};
+                for (auto const & k : keys)
+                    m[k] = 1;
+                Benchmark::DoNotOptimize(m.size());
+            }
+        });
+
+        Benchmark::Register("Containers", "FlatHashMap<FileKey> insert", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                auto m = FlatHashMap<FileKey, int, FileKeyHash, FileKeyEqual>{};
+                for (auto const & k : keys)
+                    m[k] = 1;
+                Benchmark::DoNotOptimize(m.size());
+            }
+        });
+
+        Benchmark::Register("Containers", "unordered_map<FileKey> xor hash find", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            auto m = unordered_map<FileKey, int, XorFileKeyHash>{};
+            for (auto const & k : keys)
+                m[k] = 1;
+
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto const & k : keys)
+                    sum += m.find(k)->second;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Containers", "unordered_map<FileKey> FileKeyHash find", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            auto m = unordered_map<FileKey, int, FileKeyHash>{};
+            for (auto const & k : keys)
+                m[k] = 1;
+
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto const & k : keys)
+                    sum += m.find(k)->second;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Containers", "FlatHashMap<FileKey> find", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            auto m = FlatHashMap<FileKey, int, FileKeyHash, FileKeyEqual>{};
+            for (auto const & k : keys)
+                m[k] = 1;
+
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto const & k : keys)
+                    sum += m.find(k)->second;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        // Look up by a name that is not a std::string: unordered_map (before C++20) needs a temporary FileKey,
+        // FlatHashMap can take a FileKeyView.
+        Benchmark::Register("Containers", "unordered_map<FileKey> find by char*", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            auto m = unordered_map<FileKey, int, FileKeyHash>{};
+            for (auto const & k : keys)
+                m[k] = 1;
+
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto const & k : keys)
+                    sum += m.find(FileKey{ k.Name.c_str(), k.Id })->second;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Containers", "FlatHashMap<FileKey> find by FileKeyView", [keyCount](Benchmark::State& state)
+        {
+            auto keys = MakeFileKeys(keyCount);
+            auto m = FlatHashMap<FileKey, int, FileKeyHash, FileKeyEqual>{};
+            for (auto const & k : keys)
+                m[k] = 1;
+
+            state.SetItemsPerIteration(keyCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto const & k : keys)
+                    sum += m.find(FileKeyView{ k.Name.c_str(), k.Id })->second;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        RegisterAllocatorBenchmarks();
+        RegisterFlatMapBenchmarks();
+        RegisterParallelBenchmarks();
+        RegisterSortBenchmarks();
+        RegisterEraseBenchmarks();
+        RegisterSmallVectorBenchmarks();
+        RegisterSoaVectorBenchmarks();
     }
 
     void Test()
@@ -1043,13 +2263,20 @@ namespace ContainerExamples
         ContainerIteration();
         ContainerIterationUsingGenericFunction();
         VectorContainer();
+        SmallVectorContainer();
         ListContainer();
         SetContainer();
         MapContainer();
+        SoaVectorContainer();
         MultimapContainer();
         UnorderedMapContainer();
+        FileKeyHashDistribution();
         ContainerAlgorithms();
+        ParallelContainerAlgorithms();
+        RadixSorting();
         RemovingElements();
         Vector2D();
+        FlatContainers();
+        PmrContainers();
     }
 }
\ No newline at end of file
@@ -4,6 +4,11 @@
 #include <string>
 #include <sstream>  // ostringstream, istringstream
 #include <iomanip>  // setiosflags, setprecision
+#include <vector>
+#include <random>   // mt19937_64
+#include <cstdint>  // int64_t
+#include "Examples/NumberConversion.h" // StringToDouble, FormatDouble, ParseInt64
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -13,7 +18,8 @@ using std::string;
     <cstdlib> contains conversion functions for numbers to text and text to numbers.
     
     The following two functions (CovertDoubleToString and ConvertStringToDouble) do not
-    use functions from <cstdlib>.
+    use functions from <cstdlib>. They construct a stream per call; CharConvConversions shows
+    the <charconv> versions, which don't allocate (Examples/NumberConversion.h).
 */
 
 namespace ConversionExamples
@@ -26,6 +32,8 @@ namespace ConversionExamples
         return ostr.str();
     }
 
+    // ConvertStringToDouble returns 0 for a text that isn't a number, which is also a number;
+    // ParseDouble returns an Expected instead (Examples/NumberConversion.h).
     double ConvertStringToDouble(string s)
     {
         double n;
@@ -37,10 +45,225 @@ namespace ConversionExamples
         return n;
     }
 
+    void CharConvConversions()
+    {
+        // The shortest text that reads back as the same double; no stream, no allocation.
+        char buffer[MaxDoubleLength];
+        auto end = FormatDouble(273.1458, buffer, buffer + sizeof(buffer));
+        cout << string(buffer, end) << " "; // 273.1458
+        cout << ToString(0.1 + 0.2) << " ";  // 0.30000000000000004
+        cout << ToString(273.1458, 3) << " "; // 273
+
+        // Errors are reported instead of returning 0.
+        double d = 0;
+        auto ok = StringToDouble("273.1458", d);
+        auto bad = StringToDouble("273.1458x", d);
+        auto big = StringToDouble("1e400", d);
+        cout << (ok == std::errc()) << (bad == std::errc::invalid_argument) << (big == std::errc::result_out_of_range) << " "; // 111
+
+        // Parse numbers from a feed: each call returns where the number ends.
+        string feed = "12345678901234,-42,7";
+        std::int64_t sum = 0;
+        for (char const * p = feed.data(), * last = feed.data() + feed.size(); p < last; )
+        {
+            std::int64_t n;
+            auto r = ParseInt64(p, last, n);
+            if (r.ec != std::errc())
+                break;
+            sum += n;
+            p = r.ptr + 1; // skip the comma
+        }
+        cout << sum << " "; // 12345678901199
+
+        // An Expected holds the number or the error.
+        auto parsed = ParseDouble("2.5");
+        auto failed = ParseDouble("2.5x");
+        cout << *parsed << " " << (failed.Error() == std::errc::invalid_argument) << " " << failed.ValueOr(-1) << " "; // 2.5 1 -1
+        cout << ParseInteger("21").Transform([](std::int64_t n) { return n * 2; }).ValueOr(0) << " "; // 42
+    }
+
+    // Registers the benchmarks of the conversions: parsing and formatting 1M doubles and parsing 1M integers
+    // (of 1 to 18 digits) with the string streams, std::from_chars / std::to_chars, and ParseInt64.
+    void RegisterBenchmarks()
+    {
+        const std::size_t count = 1'000'000;
+
+        std::mt19937_64 gen(1);
+        std::uniform_real_distribution<double> real(-1e6, 1e6);
+        std::vector<double> doubles(count);
+        std::vector<string> doubleTexts(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            doubles[i] = real(gen);
+            doubleTexts[i] = ToString(doubles[i]);
+        }
+
+        std::vector<string> intTexts(count);
+        std::uint64_t powers[19] = { 1 };
+        for (int i = 1; i < 19; ++i)
+            powers[i] = powers[i - 1] * 10;
+        for (auto& t : intTexts)
+            t = std::to_string(gen() % powers[1 + gen() % 18]);
+
+        Benchmark::Register("Conversion", "istringstream 1M doubles", [doubleTexts](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(doubleTexts.size());
+            while (state.KeepRunning())
+            {
+                double sum = 0;
+                for (auto const & t : doubleTexts)
+                    sum += ConvertStringToDouble(t);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Conversion", "from_chars 1M doubles", [doubleTexts](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(doubleTexts.size());
+            while (state.KeepRunning())
+            {
+                double sum = 0;
+                for (auto const & t : doubleTexts)
+                {
+                    double d = 0;
+                    StringToDouble(t, d);
+                    sum += d;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Conversion", "ostringstream 1M doubles", [doubles](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(doubles.size());
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                for (auto d : doubles)
+                    length += CovertDoubleToString(d).size();
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+
+        Benchmark::Register("Conversion", "to_chars 1M doubles shortest", [doubles](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(doubles.size());
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                char buffer[MaxDoubleLength];
+                for (auto d : doubles)
+                    length += FormatDouble(d, buffer, buffer + sizeof(buffer)) - buffer;
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+
+        // The same precision as ostringstream's default.
+        Benchmark::Register("Conversion", "to_chars 1M doubles precision 6", [doubles](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(doubles.size());
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                char buffer[MaxDoubleLength + 6];
+                for (auto d : doubles)
+                    length += FormatDouble(d, buffer, buffer + sizeof(buffer), 6) - buffer;
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+
+        Benchmark::Register("Conversion", "istringstream 1M ints", [intTexts](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(intTexts.size());
+            while (state.KeepRunning())
+            {
+                std::int64_t sum = 0;
+                for (auto const & t : intTexts)
+                {
+                    std::istringstream istr(t);
+                    std::int64_t n = 0;
+                    istr >> n;
+                    sum += n;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Conversion", "from_chars 1M ints", [intTexts](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(intTexts.size());
+            while (state.KeepRunning())
+            {
+                std::int64_t sum = 0;
+                for (auto const & t : intTexts)
+                {
+                    std::int64_t n = 0;
+                    std::from_chars(t.data(), t.data() + t.size(), n);
+                    sum += n;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Conversion", "ParseInt64 1M ints", [intTexts](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(intTexts.size());
+            while (state.KeepRunning())
+            {
+                std::int64_t sum = 0;
+                for (auto const & t : intTexts)
+                {
+                    std::int64_t n = 0;
+                    ParseInt64(t.data(), t.data() + t.size(), n);
+                    sum += n;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        // 16-digit ids in a comma-separated feed, parsed in place: the case the 8-digit chunks are for.
+        string idFeed;
+        for (std::size_t i = 0; i < count; ++i)
+            idFeed += std::to_string(powers[15] + gen() % (9 * powers[15])) + ",";
+
+        Benchmark::Register("Conversion", "from_chars 1M 16-digit feed", [idFeed, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                std::int64_t sum = 0;
+                for (char const * p = idFeed.data(), * last = p + idFeed.size(); p < last; )
+                {
+                    std::int64_t n = 0;
+                    p = std::from_chars(p, last, n).ptr + 1;
+                    sum += n;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Conversion", "ParseInt64 1M 16-digit feed", [idFeed, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                std::int64_t sum = 0;
+                for (char const * p = idFeed.data(), * last = p + idFeed.size(); p < last; )
+                {
+                    std::int64_t n = 0;
+                    p = ParseInt64(p, last, n).ptr + 1;
+                    sum += n;
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+    }
+
     void Test()
     {
         cout << CovertDoubleToString(273.1458) << " ";                            // 273.146
         cout << ConvertStringToDouble("273.1458") << " ";                         // 273.15
         cout << std::setprecision(4) << ConvertStringToDouble("273.1458") << " "; // 273.1458
+        CharConvConversions();
     }
 }
\ No newline at end of file
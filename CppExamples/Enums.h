@@ -1,6 +1,12 @@
 #pragma once
 
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include "Examples/EnumReflection.h" // ToString, FromString, EnumSet
+#include "Benchmark.h"
 
 using std::cout;
 using std::endl;
@@ -40,8 +46,9 @@ namespace EnumExamples
     // Named enums
     //
     // Declare a named enum. 'Opcode' is a type. LDA, STA, PHA are of type 'Opcode'.
-    // The values LDA, STA, PHA are accessible globally.
-    enum Opcode
+    // The values LDA, STA, PHA are accessible globally. The underlying type is fixed (int), so
+    // EnumReflection can list the enumerators (see EnumReflection.h).
+    enum Opcode : int
     {
         LDA,
         STA,
@@ -59,6 +66,66 @@ namespace EnumExamples
     typedef enum { Running, Suspended, NotRunning } AppLifecycle;
 
 
+    // The tags of the records of a log, parsed from text.
+    enum class RecordTag
+    {
+        Begin,
+        End,
+        Info,
+        Warning,
+        Error,
+        Debug,
+        Trace,
+        Metric,
+        Event,
+        Config,
+        Heartbeat,
+        Shutdown
+    };
+
+    // ParseTagIfChain is the usual parser: a comparison with each name until one matches.
+    inline bool ParseTagIfChain(std::string_view text, RecordTag& tag)
+    {
+        if (text == "Begin") tag = RecordTag::Begin;
+        else if (text == "End") tag = RecordTag::End;
+        else if (text == "Info") tag = RecordTag::Info;
+        else if (text == "Warning") tag = RecordTag::Warning;
+        else if (text == "Error") tag = RecordTag::Error;
+        else if (text == "Debug") tag = RecordTag::Debug;
+        else if (text == "Trace") tag = RecordTag::Trace;
+        else if (text == "Metric") tag = RecordTag::Metric;
+        else if (text == "Event") tag = RecordTag::Event;
+        else if (text == "Config") tag = RecordTag::Config;
+        else if (text == "Heartbeat") tag = RecordTag::Heartbeat;
+        else if (text == "Shutdown") tag = RecordTag::Shutdown;
+        else return false;
+        return true;
+    }
+
+    // Conversions between enums and strings with the names found at compile time.
+    void EnumNames()
+    {
+        using namespace EnumReflection;
+
+        cout << ToString(Colors::Green) << " " << ToString(CMYK::Black) << " " << ToString(STA) << " "; // Green Black STA
+        cout << EnumInfo<CMYK>::Count << " "; // 4
+
+        // FromString returns an optional: nullopt for a name that isn't an enumerator.
+        auto yellow = FromString<CMYK>("Yellow");
+        cout << (yellow == CMYK::Yellow) << FromString<CMYK>("Purple").has_value() << " "; // 10
+
+        // The conversions are constexpr.
+        static_assert(ToString(Colors::Blue) == "Blue");
+        static_assert(FromString<TestEnum>("V2") == TestEnum::V2);
+        static_assert(ToString(static_cast<Colors>(7)).empty());
+
+        // A set of enumerators is a bitset.
+        EnumSet<RecordTag> problems{ RecordTag::Warning, RecordTag::Error };
+        auto shown = problems | EnumSet<RecordTag>{ RecordTag::Info };
+        shown.Erase(RecordTag::Warning);
+        cout << shown.ToString() << " " << shown.Contains(RecordTag::Error) << " " << EnumSet<RecordTag>::All().Size() << " "; // Info|Error 1 12
+    }
+
     void Test()
     {
         //
@@ -103,5 +170,85 @@ namespace EnumExamples
         // Automatically converted to int.
         cout << app1 << " "; // 0
         cout << app2 << " "; // 1
+
+        EnumNames();
+    }
+
+    // Registers the benchmarks of parsing 1M tags with an if chain, an unordered_map and FromString,
+    // and of converting them back with ToString.
+    void RegisterBenchmarks()
+    {
+        const std::size_t count = 1'000'000;
+
+        std::vector<std::string_view> texts;
+        std::uint32_t x = 1;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            x = x * 1664525 + 1013904223;
+            texts.push_back(EnumReflection::EnumInfo<RecordTag>::Names[(x >> 16) % EnumReflection::EnumInfo<RecordTag>::Count]);
+        }
+
+        Benchmark::Register("Enums", "parse 1M tags if chain", [texts, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto text : texts)
+                {
+                    RecordTag tag{};
+                    if (ParseTagIfChain(text, tag))
+                        sum += static_cast<int>(tag);
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Enums", "parse 1M tags unordered_map", [texts, count](Benchmark::State& state)
+        {
+            std::unordered_map<std::string_view, RecordTag> tags;
+            for (auto tag : EnumReflection::EnumInfo<RecordTag>::Values)
+                tags.emplace(EnumReflection::ToString(tag), tag);
+
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto text : texts)
+                {
+                    auto it = tags.find(text);
+                    if (it != tags.end())
+                        sum += static_cast<int>(it->second);
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Enums", "parse 1M tags FromString", [texts, count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (auto text : texts)
+                {
+                    if (auto tag = EnumReflection::FromString<RecordTag>(text))
+                        sum += static_cast<int>(*tag);
+                }
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Enums", "1M tags ToString", [count](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                for (std::size_t i = 0; i < count; ++i)
+                    length += EnumReflection::ToString(static_cast<RecordTag>(i % 12)).size();
+                Benchmark::DoNotOptimize(length);
+            }
+        });
     }
 }
\ No newline at end of file
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <memory_resource> // memory_resource, get_default_resource
+#include <memory> // unique_ptr
+#include <vector>
+#include <new> // bad_alloc
+#include <cstdint> // uintptr_t
+#include <cstddef> // size_t, max_align_t
+
+/*
+    Memory resources for node-based containers.
+
+    std::list, std::set and std::map allocate every node separately, by default with new/delete.
+    That's a call into the general-purpose heap per insert and per erase, and the nodes of one container
+    end up spread among everything else the program allocates.
+
+    The std::pmr containers (C++17) take a pointer to a memory_resource, which decides where the nodes
+    come from. The containers have the same interface; only the type changes:
+
+        ArenaResource arena;
+        std::pmr::map<std::pmr::string, int> m(&arena); // the nodes and the strings come from the arena
+
+    - ArenaResource is a monotonic (bump-pointer) arena: allocating moves a pointer, deallocating does
+      nothing, and Reset releases everything at once. Unlike std::pmr::monotonic_buffer_resource::release,
+      Reset keeps the largest block, so a container that is built and thrown away over and over
+      (a per-request map) stops allocating from the heap after the first round.
+    - NodePoolResource keeps a free list per size class (multiples of 16 bytes up to 256), carved out
+      of big blocks, so it reuses the memory of erased nodes. Larger requests go to the upstream resource.
+      That's what std::pmr::unsynchronized_pool_resource does too, in a more general way.
+    - ThreadLocalNodePool returns a NodePoolResource per thread. The resources aren't synchronized, so
+      a container using it must be used (and destroyed) on the thread that created it.
+
+    Destroying a resource frees its memory, so it must outlive the containers that use it.
+*/
+namespace ContainerExamples
+{
+    // AlignUp rounds p up to a multiple of alignment (a power of 2).
+    inline std::uintptr_t AlignUp(std::uintptr_t p, std::size_t alignment)
+    {
+        return (p + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1);
+    }
+
+    class ArenaResource : public std::pmr::memory_resource
+    {
+    public:
+        explicit ArenaResource(std::size_t initialSize = 64 * 1024, std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : m_nextSize{ initialSize }, m_upstream{ upstream }
+        {
+        }
+
+        ArenaResource(ArenaResource const &) = delete;
+        ArenaResource& operator=(ArenaResource const &) = delete;
+
+        ~ArenaResource()
+        {
+            for (auto const & block : m_blocks)
+                m_upstream->deallocate(block.Data, block.Size);
+        }
+
+        // Reset makes all the memory available again. It must only be called when nothing allocated
+        // from the arena is used any more. The largest block is kept, the others are released.
+        void Reset()
+        {
+            if (m_blocks.empty())
+                return;
+
+            std::size_t largest = 0;
+            for (std::size_t i = 1; i < m_blocks.size(); ++i)
+            {
+                if (m_blocks[i].Size > m_blocks[largest].Size)
+                    largest = i;
+            }
+
+            for (std::size_t i = 0; i < m_blocks.size(); ++i)
+            {
+                if (i != largest)
+                    m_upstream->deallocate(m_blocks[i].Data, m_blocks[i].Size);
+            }
+
+            m_blocks[0] = m_blocks[largest];
+            m_blocks.resize(1);
+            m_current = static_cast<unsigned char*>(m_blocks[0].Data);
+            m_end = m_current + m_blocks[0].Size;
+        }
+
+        // The number of bytes taken from upstream.
+        std::size_t Capacity() const
+        {
+            std::size_t capacity = 0;
+            for (auto const & block : m_blocks)
+                capacity += block.Size;
+            return capacity;
+        }
+
+    private:
+        struct Block
+        {
+            void* Data;
+            std::size_t Size;
+        };
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            auto p = AlignUp(reinterpret_cast<std::uintptr_t>(m_current), alignment);
+            if (m_current == nullptr || p + bytes > reinterpret_cast<std::uintptr_t>(m_end))
+            {
+                AddBlock(bytes + alignment);
+                p = AlignUp(reinterpret_cast<std::uintptr_t>(m_current), alignment);
+            }
+
+            m_current = reinterpret_cast<unsigned char*>(p + bytes);
+            return reinterpret_cast<void*>(p);
+        }
+
+        void do_deallocate(void*, std::size_t, std::size_t) override
+        {
+            // Monotonic: the memory is reclaimed by Reset or the destructor.
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        // AddBlock makes a new block of at least minSize bytes current. The block sizes grow geometrically.
+        void AddBlock(std::size_t minSize)
+        {
+            auto size = m_nextSize;
+            while (size < minSize)
+                size *= 2;
+
+            m_blocks.reserve(m_blocks.size() + 1); // so that push_back can't throw after the allocation
+            auto data = m_upstream->allocate(size, alignof(std::max_align_t));
+            m_blocks.push_back(Block{ data, size });
+
+            m_current = static_cast<unsigned char*>(data);
+            m_end = m_current + size;
+            m_nextSize = size * 2;
+        }
+
+        std::size_t m_nextSize;
+        std::pmr::memory_resource* m_upstream;
+        std::vector<Block> m_blocks;
+        unsigned char* m_current = nullptr;
+        unsigned char* m_end = nullptr;
+    };
+
+    class NodePoolResource : public std::pmr::memory_resource
+    {
+    public:
+        static const std::size_t Granularity = 16;
+        static const std::size_t MaxNodeSize = 256;
+
+        explicit NodePoolResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+            : m_arena(64 * 1024, upstream), m_upstream{ upstream }
+        {
+        }
+
+    private:
+        struct FreeNode
+        {
+            FreeNode* Next;
+        };
+
+        static std::size_t SizeClass(std::size_t bytes)
+        {
+            return (bytes + Granularity - 1) / Granularity; // 1 .. MaxNodeSize / Granularity
+        }
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override
+        {
+            if (bytes > MaxNodeSize || alignment > alignof(std::max_align_t))
+                return m_upstream->allocate(bytes, alignment);
+
+            auto& head = m_free[SizeClass(bytes)];
+            if (head != nullptr)
+            {
+                auto node = head;
+                head = node->Next;
+                return node;
+            }
+
+            // The nodes of a size class are carved from the arena. Every node size is a multiple of 16,
+            // so aligning to 16 keeps the nodes next to each other.
+            return m_arena.allocate(SizeClass(bytes) * Granularity, Granularity);
+        }
+
+        void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+        {
+            if (bytes > MaxNodeSize || alignment > alignof(std::max_align_t))
+                return m_upstream->deallocate(p, bytes, alignment);
+
+            auto& head = m_free[SizeClass(bytes)];
+            head = new (p) FreeNode{ head };
+        }
+
+        bool do_is_equal(std::pmr::memory_resource const & other) const noexcept override
+        {
+            return this == &other;
+        }
+
+        ArenaResource m_arena;
+        std::pmr::memory_resource* m_upstream;
+        FreeNode* m_free[MaxNodeSize / Granularity + 1] = {};
+    };
+
+    // ThreadLocalNodePool returns the node pool of the calling thread.
+    inline NodePoolResource* ThreadLocalNodePool()
+    {
+        thread_local NodePoolResource pool;
+        return &pool;
+    }
+}
@@ -0,0 +1,416 @@
+#pragma once
+
+#include <string_view>
+#include <cstring> // memchr, memcmp
+#include <cstdint> // uint32_t
+#include <cstddef> // size_t
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BYTESEARCH_X86
+#include <immintrin.h> // SSE2, AVX2
+#if defined(_MSC_VER)
+#include <intrin.h> // __cpuid, _BitScanForward
+#endif
+#endif
+
+// MSVC compiles AVX2 intrinsics in any function. GCC and Clang need the functions that use them
+// marked with the target instruction set unless the whole program is built with -mavx2.
+#if defined(BYTESEARCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BYTESEARCH_AVX2 __attribute__((target("avx2")))
+#else
+#define BYTESEARCH_AVX2
+#endif
+
+/*
+    Vectorized byte search kernels over string_views.
+
+    std::count, std::find and string::find compare a single byte per iteration. With SSE2 a single
+    instruction compares 16 bytes and with AVX2 32 bytes; the comparison gives a byte mask that is
+    turned into a bit mask (movemask) or accumulated directly.
+
+    - CountByte counts the occurrences of a byte. The 0xFF bytes of the comparison mask are subtracted
+      from per-lane byte counters (0xFF is -1), which are summed with psadbw before they can overflow.
+    - FindFirstOf finds the first byte that belongs to a set. For small sets (up to 16 bytes) each block
+      is compared with each byte of the set; larger sets use a 256-entry table, one byte at a time.
+    - Find finds a substring. Each block of candidate positions is compared with the first and the last
+      character of the pattern at once, and only the positions where both match are verified with memcmp.
+      For text that rarely contains both characters at the right distance that skips almost everything.
+
+    The instruction set is selected at run time (runtime dispatch): the CPU is queried once and the
+    best kernel it supports is used. SSE2 is always present on x64. On other CPUs the scalar kernels
+    are used. Each function also has an overload that takes the instruction set explicitly, which is
+    how the benchmarks compare the kernels.
+*/
+namespace ByteSearch
+{
+    const std::size_t npos = std::string_view::npos;
+
+    enum class Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    inline char const * IsaName(Isa isa)
+    {
+        switch (isa)
+        {
+        case Isa::SSE2: return "SSE2";
+        case Isa::AVX2: return "AVX2";
+        default: return "Scalar";
+        }
+    }
+
+    // DetectIsa returns the best instruction set supported by both the CPU and the operating system.
+    inline Isa DetectIsa()
+    {
+#if defined(BYTESEARCH_X86)
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        bool sse2 = (info[3] & (1 << 26)) != 0;
+
+        // The OS needs to save the YMM registers on a context switch (XCR0 bits 1 and 2).
+        bool ymm = osxsave && avx && (_xgetbv(0) & 6) == 6;
+
+        bool avx2 = false;
+        if (maxLeaf >= 7)
+        {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        if (ymm && avx2)
+            return Isa::AVX2;
+        return sse2 ? Isa::SSE2 : Isa::Scalar;
+#else
+        // __builtin_cpu_supports also checks that the OS enabled the YMM state.
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return Isa::AVX2;
+        return __builtin_cpu_supports("sse2") ? Isa::SSE2 : Isa::Scalar;
+#endif
+#else
+        return Isa::Scalar;
+#endif
+    }
+
+    // ActiveIsa is the instruction set used by the overloads without the Isa parameter.
+    inline Isa ActiveIsa()
+    {
+        static const Isa isa = DetectIsa();
+        return isa;
+    }
+
+    // TrailingZeros returns the index of the lowest set bit. The mask must not be zero.
+    inline int TrailingZeros(std::uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return static_cast<int>(index);
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    //
+    // Scalar kernels. They are also the reference the vectorized kernels are checked against.
+    //
+
+    inline std::size_t CountByteScalar(std::string_view s, char c)
+    {
+        std::size_t count = 0;
+        for (char x : s)
+            count += (x == c);
+        return count;
+    }
+
+    inline std::size_t FindFirstOfScalar(std::string_view s, std::string_view set)
+    {
+        bool table[256] = {};
+        for (char c : set)
+            table[static_cast<unsigned char>(c)] = true;
+
+        for (std::size_t i = 0; i < s.size(); ++i)
+        {
+            if (table[static_cast<unsigned char>(s[i])])
+                return i;
+        }
+        return npos;
+    }
+
+    inline std::size_t FindScalar(std::string_view s, std::string_view pattern)
+    {
+        auto n = pattern.size();
+        if (n == 0)
+            return 0;
+        if (n > s.size())
+            return npos;
+
+        // memchr finds the candidates, memcmp verifies them.
+        auto p = s.data();
+        auto last = s.data() + s.size() - n;
+        while (p <= last)
+        {
+            p = static_cast<char const *>(std::memchr(p, pattern[0], last - p + 1));
+            if (p == nullptr)
+                return npos;
+            if (std::memcmp(p + 1, pattern.data() + 1, n - 1) == 0)
+                return p - s.data();
+            ++p;
+        }
+        return npos;
+    }
+
+#if defined(BYTESEARCH_X86)
+    //
+    // SSE2 kernels.
+    //
+
+    inline std::size_t CountByteSSE2(std::string_view s, char c)
+    {
+        auto p = reinterpret_cast<unsigned char const *>(s.data());
+        auto n = s.size();
+        auto needle = _mm_set1_epi8(c);
+        __m128i total = _mm_setzero_si128();
+        std::size_t i = 0;
+
+        while (n - i >= 16)
+        {
+            // Each byte counter can count up to 255 matches.
+            auto blocks = (n - i) / 16;
+            if (blocks > 255)
+                blocks = 255;
+
+            __m128i counters = _mm_setzero_si128();
+            for (std::size_t b = 0; b < blocks; ++b, i += 16)
+            {
+                auto eq = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p + i)), needle);
+                counters = _mm_sub_epi8(counters, eq);
+            }
+
+            // psadbw sums each group of 8 bytes into a 64-bit lane.
+            total = _mm_add_epi64(total, _mm_sad_epu8(counters, _mm_setzero_si128()));
+        }
+
+        alignas(16) std::uint64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), total);
+        auto count = static_cast<std::size_t>(lanes[0] + lanes[1]);
+        return count + CountByteScalar(s.substr(i), c);
+    }
+
+    inline std::size_t FindFirstOfSSE2(std::string_view s, std::string_view set)
+    {
+        if (set.size() > 16)
+            return FindFirstOfScalar(s, set);
+
+        __m128i needles[16];
+        for (std::size_t k = 0; k < set.size(); ++k)
+            needles[k] = _mm_set1_epi8(set[k]);
+
+        auto p = s.data();
+        std::size_t i = 0;
+        for (; i + 16 <= s.size(); i += 16)
+        {
+            auto block = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + i));
+            __m128i eq = _mm_setzero_si128();
+            for (std::size_t k = 0; k < set.size(); ++k)
+                eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, needles[k]));
+
+            auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(eq));
+            if (mask != 0)
+                return i + TrailingZeros(mask);
+        }
+
+        auto tail = FindFirstOfScalar(s.substr(i), set);
+        return tail == npos ? npos : i + tail;
+    }
+
+    inline std::size_t FindSSE2(std::string_view s, std::string_view pattern)
+    {
+        auto n = pattern.size();
+        if (n < 2 || n > s.size())
+            return FindScalar(s, pattern);
+
+        auto p = s.data();
+        auto first = _mm_set1_epi8(pattern[0]);
+        auto last = _mm_set1_epi8(pattern[n - 1]);
+
+        // i is the first candidate of a block of 16; the block of last characters ends at i + n - 1 + 16.
+        std::size_t i = 0;
+        for (; i + n - 1 + 16 <= s.size(); i += 16)
+        {
+            auto blockFirst = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + i));
+            auto blockLast = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p + i + n - 1));
+            auto eq = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+
+            auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(eq));
+            while (mask != 0)
+            {
+                auto k = i + TrailingZeros(mask);
+                if (std::memcmp(p + k + 1, pattern.data() + 1, n - 2) == 0)
+                    return k;
+                mask &= mask - 1; // clear the lowest bit
+            }
+        }
+
+        auto tail = FindScalar(s.substr(i), pattern);
+        return tail == npos ? npos : i + tail;
+    }
+
+    //
+    // AVX2 kernels. The same as SSE2 with 32-byte blocks.
+    //
+
+    BYTESEARCH_AVX2 inline std::size_t CountByteAVX2(std::string_view s, char c)
+    {
+        auto p = reinterpret_cast<unsigned char const *>(s.data());
+        auto n = s.size();
+        auto needle = _mm256_set1_epi8(c);
+        __m256i total = _mm256_setzero_si256();
+        std::size_t i = 0;
+
+        while (n - i >= 32)
+        {
+            auto blocks = (n - i) / 32;
+            if (blocks > 255)
+                blocks = 255;
+
+            __m256i counters = _mm256_setzero_si256();
+            for (std::size_t b = 0; b < blocks; ++b, i += 32)
+            {
+                auto eq = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + i)), needle);
+                counters = _mm256_sub_epi8(counters, eq);
+            }
+
+            total = _mm256_add_epi64(total, _mm256_sad_epu8(counters, _mm256_setzero_si256()));
+        }
+
+        alignas(32) std::uint64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+        auto count = static_cast<std::size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+        return count + CountByteSSE2(s.substr(i), c);
+    }
+
+    BYTESEARCH_AVX2 inline std::size_t FindFirstOfAVX2(std::string_view s, std::string_view set)
+    {
+        if (set.size() > 16)
+            return FindFirstOfScalar(s, set);
+
+        __m256i needles[16];
+        for (std::size_t k = 0; k < set.size(); ++k)
+            needles[k] = _mm256_set1_epi8(set[k]);
+
+        auto p = s.data();
+        std::size_t i = 0;
+        for (; i + 32 <= s.size(); i += 32)
+        {
+            auto block = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + i));
+            __m256i eq = _mm256_setzero_si256();
+            for (std::size_t k = 0; k < set.size(); ++k)
+                eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, needles[k]));
+
+            auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(eq));
+            if (mask != 0)
+                return i + TrailingZeros(mask);
+        }
+
+        auto tail = FindFirstOfSSE2(s.substr(i), set);
+        return tail == npos ? npos : i + tail;
+    }
+
+    BYTESEARCH_AVX2 inline std::size_t FindAVX2(std::string_view s, std::string_view pattern)
+    {
+        auto n = pattern.size();
+        if (n < 2 || n > s.size())
+            return FindScalar(s, pattern);
+
+        auto p = s.data();
+        auto first = _mm256_set1_epi8(pattern[0]);
+        auto last = _mm256_set1_epi8(pattern[n - 1]);
+
+        std::size_t i = 0;
+        for (; i + n - 1 + 32 <= s.size(); i += 32)
+        {
+            auto blockFirst = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + i));
+            auto blockLast = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(p + i + n - 1));
+            auto eq = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last));
+
+            auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(eq));
+            while (mask != 0)
+            {
+                auto k = i + TrailingZeros(mask);
+                if (std::memcmp(p + k + 1, pattern.data() + 1, n - 2) == 0)
+                    return k;
+                mask &= mask - 1;
+            }
+        }
+
+        auto tail = FindSSE2(s.substr(i), pattern);
+        return tail == npos ? npos : i + tail;
+    }
+#endif
+
+    //
+    // Dispatch.
+    //
+
+    // CountByte returns the number of occurrences of a byte in a string.
+    inline std::size_t CountByte(std::string_view s, char c, Isa isa)
+    {
+#if defined(BYTESEARCH_X86)
+        if (isa == Isa::AVX2)
+            return CountByteAVX2(s, c);
+        if (isa == Isa::SSE2)
+            return CountByteSSE2(s, c);
+#endif
+        return CountByteScalar(s, c);
+    }
+
+    inline std::size_t CountByte(std::string_view s, char c)
+    {
+        return CountByte(s, c, ActiveIsa());
+    }
+
+    // FindFirstOf returns the index of the first byte of a string that is one of the bytes of a set, or npos.
+    inline std::size_t FindFirstOf(std::string_view s, std::string_view set, Isa isa)
+    {
+#if defined(BYTESEARCH_X86)
+        if (isa == Isa::AVX2)
+            return FindFirstOfAVX2(s, set);
+        if (isa == Isa::SSE2)
+            return FindFirstOfSSE2(s, set);
+#endif
+        return FindFirstOfScalar(s, set);
+    }
+
+    inline std::size_t FindFirstOf(std::string_view s, std::string_view set)
+    {
+        return FindFirstOf(s, set, ActiveIsa());
+    }
+
+    // Find returns the index of the first occurrence of a pattern in a string, or npos.
+    // An empty pattern is found at 0, like string::find.
+    inline std::size_t Find(std::string_view s, std::string_view pattern, Isa isa)
+    {
+#if defined(BYTESEARCH_X86)
+        if (isa == Isa::AVX2)
+            return FindAVX2(s, pattern);
+        if (isa == Isa::SSE2)
+            return FindSSE2(s, pattern);
+#endif
+        return FindScalar(s, pattern);
+    }
+
+    inline std::size_t Find(std::string_view s, std::string_view pattern)
+    {
+        return Find(s, pattern, ActiveIsa());
+    }
+}
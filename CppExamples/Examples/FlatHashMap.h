@@ -0,0 +1,404 @@
+#pragma once
+
+#include <memory> // unique_ptr
+#include <utility> // pair, move, forward, swap
+#include <functional> // hash, equal_to
+#include <iterator> // forward_iterator_tag
+#include <initializer_list>
+#include <new> // placement new
+#include <tuple> // forward_as_tuple
+#include <type_traits>
+#include <cstdint> // uint8_t, uint64_t
+#include <cstddef> // size_t, ptrdiff_t
+#include "Hashing.h" // Hashing::Mum
+
+/*
+    FlatHashMap is an open-addressing hash map: the elements are stored directly in one array of slots
+    instead of in separately allocated nodes chained from buckets (as in std::unordered_map).
+    - Inserting an element does not allocate (except when the table grows).
+    - A lookup probes consecutive slots (linear probing), which is cache- and prefetcher-friendly.
+    - Each slot has a control byte: 0 for an empty slot, or 0x80 | the top 7 bits of the hash.
+      The control bytes are kept in their own array, so a probe compares bytes and calls the
+      key equality function only when the 7 bits match.
+    - Erasing uses backward-shift deletion: the following elements of the probe sequence are
+      moved back, so there are no tombstones and lookups don't slow down after many erasures.
+
+    If Hash and KeyEqual both define is_transparent, find, count, and contains accept any key type
+    the two function objects accept (heterogeneous lookup), e.g. a string_view for a string key.
+    std::unordered_map supports heterogeneous lookup only from C++20.
+
+    Differences from std::unordered_map:
+    - value_type is pair<Key, T> rather than pair<const Key, T>. Don't modify the key through an iterator.
+    - Inserting and erasing invalidate all the iterators and references.
+    - There is no bucket interface.
+*/
+namespace ContainerExamples
+{
+    template <typename Key,
+              typename T,
+              typename Hash = std::hash<Key>,
+              typename KeyEqual = std::equal_to<Key>>
+    class FlatHashMap
+    {
+    public:
+        typedef Key key_type;
+        typedef T mapped_type;
+        typedef std::pair<Key, T> value_type;
+        typedef std::size_t size_type;
+
+    private:
+        // Uninitialized storage for an element. Elements are constructed only in occupied slots.
+        struct Slot
+        {
+            alignas(value_type) unsigned char Storage[sizeof(value_type)];
+
+            value_type& Value() { return *reinterpret_cast<value_type*>(Storage); }
+            value_type const & Value() const { return *reinterpret_cast<value_type const *>(Storage); }
+        };
+
+        template <typename F, typename = void>
+        struct IsTransparent : std::false_type {};
+
+        template <typename F>
+        struct IsTransparent<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+        // Enables the heterogeneous overloads of find, count, and contains.
+        template <typename K>
+        using EnableTransparent = typename std::enable_if<IsTransparent<Hash>::value && IsTransparent<KeyEqual>::value, K>::type;
+
+    public:
+        template <bool IsConst>
+        class Iterator
+        {
+            typedef typename std::conditional<IsConst, FlatHashMap const, FlatHashMap>::type map_type;
+
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef typename FlatHashMap::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef typename std::conditional<IsConst, value_type const *, value_type*>::type pointer;
+            typedef typename std::conditional<IsConst, value_type const &, value_type&>::type reference;
+
+            Iterator() = default;
+
+            Iterator(map_type* map, std::size_t index) : m_map{ map }, m_index{ index }
+            {
+                SkipEmpty();
+            }
+
+            // A const_iterator can be constructed from an iterator.
+            template <bool OtherConst, typename = typename std::enable_if<IsConst && !OtherConst>::type>
+            Iterator(Iterator<OtherConst> const & other) : m_map{ other.m_map }, m_index{ other.m_index }
+            {
+            }
+
+            reference operator*() const { return m_map->m_slots[m_index].Value(); }
+            pointer operator->() const { return &m_map->m_slots[m_index].Value(); }
+
+            Iterator& operator++()
+            {
+                ++m_index;
+                SkipEmpty();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(Iterator const & a, Iterator const & b) { return a.m_index == b.m_index; }
+            friend bool operator!=(Iterator const & a, Iterator const & b) { return a.m_index != b.m_index; }
+
+        private:
+            friend class FlatHashMap;
+            template <bool> friend class Iterator;
+
+            map_type* m_map = nullptr;
+            std::size_t m_index = 0;
+
+            void SkipEmpty()
+            {
+                while (m_index < m_map->m_capacity && m_map->m_control[m_index] == 0)
+                    ++m_index;
+            }
+        };
+
+        typedef Iterator<false> iterator;
+        typedef Iterator<true> const_iterator;
+
+        FlatHashMap() = default;
+
+        explicit FlatHashMap(std::size_t capacity)
+        {
+            reserve(capacity);
+        }
+
+        FlatHashMap(std::initializer_list<value_type> values)
+        {
+            reserve(values.size());
+            for (auto const & v : values)
+                insert(v);
+        }
+
+        FlatHashMap(FlatHashMap const & other) : m_hash{ other.m_hash }, m_equal{ other.m_equal }
+        {
+            reserve(other.size());
+            for (auto const & v : other)
+                insert(v);
+        }
+
+        FlatHashMap(FlatHashMap&& other) noexcept
+        {
+            swap(other);
+        }
+
+        FlatHashMap& operator=(FlatHashMap other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~FlatHashMap()
+        {
+            clear();
+        }
+
+        void swap(FlatHashMap& other) noexcept
+        {
+            using std::swap;
+            swap(m_slots, other.m_slots);
+            swap(m_control, other.m_control);
+            swap(m_capacity, other.m_capacity);
+            swap(m_size, other.m_size);
+            swap(m_hash, other.m_hash);
+            swap(m_equal, other.m_equal);
+        }
+
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        std::size_t capacity() const { return m_capacity; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, m_capacity); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_capacity); }
+
+        void clear()
+        {
+            for (std::size_t i = 0; i < m_capacity; ++i)
+            {
+                if (m_control[i] != 0)
+                {
+                    m_slots[i].Value().~value_type();
+                    m_control[i] = 0;
+                }
+            }
+            m_size = 0;
+        }
+
+        // reserve makes room for at least count elements without growing.
+        void reserve(std::size_t count)
+        {
+            std::size_t capacity = 16;
+            while (capacity * MaxLoadNumerator / MaxLoadDenominator < count)
+                capacity *= 2;
+
+            if (capacity > m_capacity)
+                Rehash(capacity);
+        }
+
+        iterator find(Key const & key) { return iterator(this, Find(key)); }
+        const_iterator find(Key const & key) const { return const_iterator(this, Find(key)); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        iterator find(K const & key) { return iterator(this, Find(key)); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        const_iterator find(K const & key) const { return const_iterator(this, Find(key)); }
+
+        bool contains(Key const & key) const { return Find(key) != m_capacity; }
+
+        template <typename K, typename = EnableTransparent<K>>
+        bool contains(K const & key) const { return Find(key) != m_capacity; }
+
+        std::size_t count(Key const & key) const { return contains(key) ? 1 : 0; }
+
+        template <typename K, typename = EnableTransparent<K>>
+        std::size_t count(K const & key) const { return contains(key) ? 1 : 0; }
+
+        // try_emplace inserts an element constructed from the key and args if the key is not in the map.
+        // The key is looked up first: a key that is already in the map doesn't make the table grow,
+        // and a key that refers to an element of the map is still valid when it is compared.
+        template <typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+        {
+            auto hash = HashOf(key);
+            auto i = Find(key, hash);
+            if (i != m_capacity)
+                return { iterator(this, i), false };
+
+            GrowIfNeeded();
+
+            auto mask = m_capacity - 1;
+            i = hash & mask;
+            while (m_control[i] != 0)
+                i = (i + 1) & mask;
+
+            new (m_slots[i].Storage) value_type(std::piecewise_construct,
+                std::forward_as_tuple(std::forward<K>(key)),
+                std::forward_as_tuple(std::forward<Args>(args)...));
+            m_control[i] = ControlOf(hash);
+            ++m_size;
+            return { iterator(this, i), true };
+        }
+
+        std::pair<iterator, bool> insert(value_type const & value)
+        {
+            return try_emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return try_emplace(std::move(value.first), std::move(value.second));
+        }
+
+        T& operator[](Key const & key)
+        {
+            return try_emplace(key).first->second;
+        }
+
+        T& operator[](Key&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+
+        std::size_t erase(Key const & key)
+        {
+            auto i = Find(key);
+            if (i == m_capacity)
+                return 0;
+
+            EraseAt(i);
+            return 1;
+        }
+
+        // LoadFactor returns the ratio of the number of elements to the number of slots.
+        double LoadFactor() const
+        {
+            return m_capacity != 0 ? static_cast<double>(m_size) / m_capacity : 0.0;
+        }
+
+    private:
+        // The table grows when it is 3/4 full. Linear probing degrades quickly above that.
+        static const std::size_t MaxLoadNumerator = 3;
+        static const std::size_t MaxLoadDenominator = 4;
+
+        std::unique_ptr<Slot[]> m_slots;
+        std::unique_ptr<std::uint8_t[]> m_control;
+        std::size_t m_capacity = 0; // always 0 or a power of 2, so a mask replaces the modulo operator
+        std::size_t m_size = 0;
+        Hash m_hash;
+        KeyEqual m_equal;
+
+        // The user's hash is mixed once more so that even an identity hash (std::hash<int> in some
+        // standard libraries) spreads the keys over the whole table and fills the control bits.
+        template <typename K>
+        std::uint64_t HashOf(K const & key) const
+        {
+            return Hashing::Mum(static_cast<std::uint64_t>(m_hash(key)), Hashing::Secret1);
+        }
+
+        static std::uint8_t ControlOf(std::uint64_t hash)
+        {
+            return static_cast<std::uint8_t>(0x80 | (hash >> 57));
+        }
+
+        template <typename K>
+        std::size_t Find(K const & key) const
+        {
+            return Find(key, HashOf(key));
+        }
+
+        // Find returns the slot of the key, or m_capacity if the key is not in the map.
+        template <typename K>
+        std::size_t Find(K const & key, std::uint64_t hash) const
+        {
+            if (m_size == 0)
+                return m_capacity;
+
+            auto control = ControlOf(hash);
+            auto mask = m_capacity - 1;
+
+            // The loop ends because the table always has empty slots.
+            for (auto i = hash & mask; m_control[i] != 0; i = (i + 1) & mask)
+            {
+                if (m_control[i] == control && m_equal(m_slots[i].Value().first, key))
+                    return i;
+            }
+
+            return m_capacity;
+        }
+
+        void EraseAt(std::size_t i)
+        {
+            auto mask = m_capacity - 1;
+
+            m_slots[i].Value().~value_type();
+            m_control[i] = 0;
+            --m_size;
+
+            // Move back the elements that would not be found anymore because of the hole at i.
+            // An element at j can fill the hole unless its home slot lies cyclically in (i, j].
+            for (auto j = (i + 1) & mask; m_control[j] != 0; j = (j + 1) & mask)
+            {
+                auto home = HashOf(m_slots[j].Value().first) & mask;
+                bool reachable = i <= j ? (i < home && home <= j) : (i < home || home <= j);
+                if (reachable)
+                    continue;
+
+                new (m_slots[i].Storage) value_type(std::move(m_slots[j].Value()));
+                m_control[i] = m_control[j];
+                m_slots[j].Value().~value_type();
+                m_control[j] = 0;
+                i = j;
+            }
+        }
+
+        void GrowIfNeeded()
+        {
+            if (m_capacity == 0)
+                Rehash(16);
+            else if ((m_size + 1) * MaxLoadDenominator > m_capacity * MaxLoadNumerator)
+                Rehash(m_capacity * 2);
+        }
+
+        void Rehash(std::size_t capacity)
+        {
+            std::unique_ptr<Slot[]> slots(new Slot[capacity]);
+            std::unique_ptr<std::uint8_t[]> control(new std::uint8_t[capacity]());
+            auto mask = capacity - 1;
+
+            for (std::size_t i = 0; i < m_capacity; ++i)
+            {
+                if (m_control[i] == 0)
+                    continue;
+
+                auto& value = m_slots[i].Value();
+                auto j = HashOf(value.first) & mask;
+                while (control[j] != 0)
+                    j = (j + 1) & mask;
+
+                new (slots[j].Storage) value_type(std::move(value));
+                control[j] = m_control[i];
+                value.~value_type();
+            }
+
+            m_slots = std::move(slots);
+            m_control = std::move(control);
+            m_capacity = capacity;
+        }
+    };
+}
@@ -0,0 +1,398 @@
+#pragma once
+
+#include <vector>
+#include <utility> // pair, move, forward
+#include <functional> // less
+#include <algorithm> // sort, stable_sort
+#include <iterator> // random_access_iterator_tag
+#include <bit> // countr_zero
+#include <initializer_list>
+#include <type_traits>
+#include <stdexcept> // out_of_range
+#include <cstdint> // uint64_t, uintptr_t
+#include <cstddef> // size_t, ptrdiff_t
+#include "ByteSearch.h" // BYTESEARCH_X86, _mm_prefetch
+
+/*
+    FlatMap and FlatSet are ordered containers stored in sorted vectors instead of the nodes of
+    a red-black tree (std::map, std::set):
+    - The keys are in one contiguous array and the mapped values in another. A lookup only touches
+      the keys, so more of them fit in each cache line, and there is no pointer chasing.
+    - No allocation per element. Iterating is walking two arrays.
+    - Inserting or erasing moves the elements after the position: O(n). They fit maps that are built
+      once, or rarely changed, and read a lot. Building from a whole range at once (the bulk constructor)
+      sorts once: O(n log n), instead of n inserts.
+
+    The lookup is a binary search written without a branch on the comparison: the comparison selects the
+    next position with a conditional move, so there are no mispredictions, at the cost of always doing
+    the full log2(n) steps.
+
+    With SearchLayout::Eytzinger the container also keeps a copy of the keys in the Eytzinger (BFS) order
+    of a complete binary tree: the root at index 1 and the children of k at 2k and 2k + 1. A search walks
+    down from the root, and the next 4 levels of the tree it will visit (16 nodes) are contiguous, so
+    they can be prefetched. That pays off once the keys don't fit in the cache anymore. The copy costs
+    memory and is rebuilt on each change.
+
+    As in C++23 std::flat_map, dereferencing an iterator gives a pair of references, not a reference
+    to a pair, because the keys and the values are in separate arrays.
+
+    If Compare defines is_transparent (e.g. std::less<>), find and contains accept
+    any type comparable with the keys, e.g. a string_view for a string key.
+*/
+namespace ContainerExamples
+{
+    enum class SearchLayout
+    {
+        Sorted,
+        Eytzinger
+    };
+
+    // SortedKeys holds the sorted keys and does the searching for FlatMap and FlatSet.
+    template <typename Key, typename Compare, SearchLayout Layout>
+    class SortedKeys
+    {
+    public:
+        SortedKeys() = default;
+        explicit SortedKeys(Compare const & compare) : m_compare{ compare } {}
+
+        std::vector<Key> const & keys() const { return m_keys; }
+        Compare const & key_comp() const { return m_compare; }
+
+        // LowerBound returns the index of the first key that is not less than key.
+        template <typename K>
+        std::size_t LowerBound(K const & key) const
+        {
+            if constexpr (Layout == SearchLayout::Eytzinger)
+                return EytzingerLowerBound(key);
+
+            auto n = m_keys.size();
+            if (n == 0)
+                return 0;
+
+            // The answer is in [base, base + n]. Each step halves n; the comparison only moves base.
+            auto base = m_keys.data();
+            while (n > 1)
+            {
+                auto half = n / 2;
+                base = m_compare(base[half], key) ? base + half : base;
+                n -= half;
+            }
+            return (base - m_keys.data()) + (m_compare(*base, key) ? 1 : 0);
+        }
+
+        // Find returns the index of key, or size() if it is not there.
+        template <typename K>
+        std::size_t Find(K const & key) const
+        {
+            auto i = LowerBound(key);
+            return i < m_keys.size() && !m_compare(key, m_keys[i]) ? i : m_keys.size();
+        }
+
+    protected:
+        std::vector<Key> m_keys;
+        Compare m_compare;
+
+        template <typename F, typename = void>
+        struct IsTransparent : std::false_type {};
+
+        template <typename F>
+        struct IsTransparent<F, std::void_t<typename F::is_transparent>> : std::true_type {};
+
+        // Enables the heterogeneous overloads of find and contains.
+        template <typename K>
+        using EnableTransparent = typename std::enable_if<IsTransparent<Compare>::value, K>::type;
+
+        // The keys changed.
+        void Rebuild()
+        {
+            if constexpr (Layout != SearchLayout::Eytzinger)
+                return;
+
+            m_tree.assign(m_keys.size() + 1, Key{});
+            m_rank.assign(m_keys.size() + 1, 0);
+            std::size_t next = 0;
+            BuildTree(1, next);
+        }
+
+    private:
+        // m_tree[1..n] are the keys in Eytzinger order and m_rank[k] is the index of m_tree[k] in m_keys.
+        std::vector<Key> m_tree;
+        std::vector<std::size_t> m_rank;
+
+        // An in-order walk of the implicit tree visits the nodes in sorted order.
+        void BuildTree(std::size_t k, std::size_t& next)
+        {
+            if (k >= m_tree.size())
+                return;
+            BuildTree(2 * k, next);
+            m_tree[k] = m_keys[next];
+            m_rank[k] = next++;
+            BuildTree(2 * k + 1, next);
+        }
+
+        template <typename K>
+        std::size_t EytzingerLowerBound(K const & key) const
+        {
+            auto n = m_keys.size();
+            std::size_t k = 1;
+            while (k <= n)
+            {
+#if defined(BYTESEARCH_X86)
+                // The descendants of k four levels down are 16k .. 16k + 15. The address may be past the end;
+                // prefetching does not fault.
+                _mm_prefetch(reinterpret_cast<char const *>(reinterpret_cast<std::uintptr_t>(m_tree.data()) + 16 * k * sizeof(Key)), _MM_HINT_T0);
+#endif
+                k = 2 * k + (m_compare(m_tree[k], key) ? 1 : 0);
+            }
+
+            // The walk went right (1 bits) after the last node not less than key. Drop those moves and
+            // the final left move; k == 0 means all the keys are less than key.
+            k >>= std::countr_zero(~static_cast<std::uint64_t>(k)) + 1;
+            return k == 0 ? n : m_rank[k];
+        }
+    };
+
+    template <typename Key, typename Compare = std::less<Key>, SearchLayout Layout = SearchLayout::Sorted>
+    class FlatSet : public SortedKeys<Key, Compare, Layout>
+    {
+        typedef SortedKeys<Key, Compare, Layout> Base;
+
+        template <typename K>
+        using EnableTransparent = typename Base::template EnableTransparent<K>;
+
+    public:
+        typedef Key key_type;
+        typedef Key value_type;
+        typedef typename std::vector<Key>::const_iterator iterator;
+        typedef typename std::vector<Key>::const_iterator const_iterator;
+
+        FlatSet() = default;
+
+        // Bulk construction: sort once and drop the duplicates.
+        explicit FlatSet(std::vector<Key> keys, Compare const & compare = Compare()) : Base(compare)
+        {
+            this->m_keys = std::move(keys);
+            auto& c = this->m_compare;
+            std::sort(this->m_keys.begin(), this->m_keys.end(), c);
+            this->m_keys.erase(std::unique(this->m_keys.begin(), this->m_keys.end(), [&c](Key const & a, Key const & b) { return !c(a, b); }), this->m_keys.end());
+            this->Rebuild();
+        }
+
+        FlatSet(std::initializer_list<Key> keys) : FlatSet(std::vector<Key>(keys)) {}
+
+        std::size_t size() const { return this->m_keys.size(); }
+        bool empty() const { return this->m_keys.empty(); }
+
+        const_iterator begin() const { return this->m_keys.begin(); }
+        const_iterator end() const { return this->m_keys.end(); }
+
+        const_iterator find(Key const & key) const { return begin() + this->Find(key); }
+        bool contains(Key const & key) const { return this->Find(key) != size(); }
+        std::size_t count(Key const & key) const { return contains(key) ? 1 : 0; }
+        const_iterator lower_bound(Key const & key) const { return begin() + this->LowerBound(key); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        const_iterator find(K const & key) const { return begin() + this->Find(key); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        bool contains(K const & key) const { return this->Find(key) != size(); }
+
+        std::pair<const_iterator, bool> insert(Key key)
+        {
+            auto i = this->LowerBound(key);
+            if (i < size() && !this->m_compare(key, this->m_keys[i]))
+                return { begin() + i, false };
+
+            this->m_keys.insert(this->m_keys.begin() + i, std::move(key));
+            this->Rebuild();
+            return { begin() + i, true };
+        }
+
+        std::size_t erase(Key const & key)
+        {
+            auto i = this->Find(key);
+            if (i == size())
+                return 0;
+
+            this->m_keys.erase(this->m_keys.begin() + i);
+            this->Rebuild();
+            return 1;
+        }
+    };
+
+    template <typename Key, typename T, typename Compare = std::less<Key>, SearchLayout Layout = SearchLayout::Sorted>
+    class FlatMap : public SortedKeys<Key, Compare, Layout>
+    {
+        typedef SortedKeys<Key, Compare, Layout> Base;
+
+        template <typename K>
+        using EnableTransparent = typename Base::template EnableTransparent<K>;
+
+    public:
+        typedef Key key_type;
+        typedef T mapped_type;
+        typedef std::pair<Key, T> value_type;
+
+        template <bool IsConst>
+        class Iterator
+        {
+            typedef typename std::conditional<IsConst, FlatMap const, FlatMap>::type map_type;
+            typedef typename std::conditional<IsConst, T const &, T&>::type mapped_reference;
+
+        public:
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef typename FlatMap::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::pair<Key const &, mapped_reference> reference;
+
+            // operator-> needs to return something that has an operator-> itself.
+            struct pointer
+            {
+                reference Pair;
+                reference const * operator->() const { return &Pair; }
+            };
+
+            Iterator() = default;
+            Iterator(map_type* map, std::size_t index) : m_map{ map }, m_index{ index } {}
+
+            // A const_iterator can be constructed from an iterator.
+            template <bool OtherConst, typename = typename std::enable_if<IsConst && !OtherConst>::type>
+            Iterator(Iterator<OtherConst> const & other) : m_map{ other.m_map }, m_index{ other.m_index }
+            {
+            }
+
+            reference operator*() const { return reference(m_map->m_keys[m_index], m_map->m_values[m_index]); }
+            pointer operator->() const { return pointer{ **this }; }
+            reference operator[](difference_type n) const { return *(*this + n); }
+
+            Iterator& operator++() { ++m_index; return *this; }
+            Iterator& operator--() { --m_index; return *this; }
+            Iterator operator++(int) { auto tmp = *this; ++m_index; return tmp; }
+            Iterator operator--(int) { auto tmp = *this; --m_index; return tmp; }
+            Iterator& operator+=(difference_type n) { m_index += n; return *this; }
+            Iterator& operator-=(difference_type n) { m_index -= n; return *this; }
+
+            friend Iterator operator+(Iterator it, difference_type n) { return it += n; }
+            friend Iterator operator+(difference_type n, Iterator it) { return it += n; }
+            friend Iterator operator-(Iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(Iterator const & a, Iterator const & b) { return static_cast<difference_type>(a.m_index) - static_cast<difference_type>(b.m_index); }
+
+            friend bool operator==(Iterator const & a, Iterator const & b) { return a.m_index == b.m_index; }
+            friend bool operator!=(Iterator const & a, Iterator const & b) { return a.m_index != b.m_index; }
+            friend bool operator<(Iterator const & a, Iterator const & b) { return a.m_index < b.m_index; }
+            friend bool operator>(Iterator const & a, Iterator const & b) { return a.m_index > b.m_index; }
+            friend bool operator<=(Iterator const & a, Iterator const & b) { return a.m_index <= b.m_index; }
+            friend bool operator>=(Iterator const & a, Iterator const & b) { return a.m_index >= b.m_index; }
+
+            std::size_t Index() const { return m_index; }
+
+        private:
+            friend class FlatMap;
+            template <bool> friend class Iterator;
+
+            map_type* m_map = nullptr;
+            std::size_t m_index = 0;
+        };
+
+        typedef Iterator<false> iterator;
+        typedef Iterator<true> const_iterator;
+
+        FlatMap() = default;
+
+        // Bulk construction: the pairs are sorted by key once. For equal keys the first one is kept, as
+        // inserting them one by one would.
+        explicit FlatMap(std::vector<value_type> values, Compare const & compare = Compare()) : Base(compare)
+        {
+            auto& c = this->m_compare;
+            std::stable_sort(values.begin(), values.end(), [&c](value_type const & a, value_type const & b) { return c(a.first, b.first); });
+
+            this->m_keys.reserve(values.size());
+            m_values.reserve(values.size());
+            for (auto& v : values)
+            {
+                if (!this->m_keys.empty() && !c(this->m_keys.back(), v.first))
+                    continue;
+                this->m_keys.push_back(std::move(v.first));
+                m_values.push_back(std::move(v.second));
+            }
+            this->Rebuild();
+        }
+
+        FlatMap(std::initializer_list<value_type> values) : FlatMap(std::vector<value_type>(values)) {}
+
+        template <typename InputIt>
+        FlatMap(InputIt first, InputIt last) : FlatMap(std::vector<value_type>(first, last)) {}
+
+        std::size_t size() const { return this->m_keys.size(); }
+        bool empty() const { return this->m_keys.empty(); }
+
+        std::vector<T> const & values() const { return m_values; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, size()); }
+
+        iterator find(Key const & key) { return iterator(this, this->Find(key)); }
+        const_iterator find(Key const & key) const { return const_iterator(this, this->Find(key)); }
+        bool contains(Key const & key) const { return this->Find(key) != size(); }
+        std::size_t count(Key const & key) const { return contains(key) ? 1 : 0; }
+        const_iterator lower_bound(Key const & key) const { return const_iterator(this, this->LowerBound(key)); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        iterator find(K const & key) { return iterator(this, this->Find(key)); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        const_iterator find(K const & key) const { return const_iterator(this, this->Find(key)); }
+
+        template <typename K, typename = EnableTransparent<K>>
+        bool contains(K const & key) const { return this->Find(key) != size(); }
+
+        // try_emplace inserts an element constructed from the key and args if the key is not in the map.
+        template <typename K, typename... Args>
+        std::pair<iterator, bool> try_emplace(K&& key, Args&&... args)
+        {
+            auto i = this->LowerBound(key);
+            if (i < size() && !this->m_compare(key, this->m_keys[i]))
+                return { iterator(this, i), false };
+
+            this->m_keys.emplace(this->m_keys.begin() + i, std::forward<K>(key));
+            m_values.emplace(m_values.begin() + i, std::forward<Args>(args)...);
+            this->Rebuild();
+            return { iterator(this, i), true };
+        }
+
+        std::pair<iterator, bool> insert(value_type value)
+        {
+            return try_emplace(std::move(value.first), std::move(value.second));
+        }
+
+        T& operator[](Key const & key)
+        {
+            return m_values[try_emplace(key).first.Index()];
+        }
+
+        T& at(Key const & key)
+        {
+            auto i = this->Find(key);
+            if (i == size())
+                throw std::out_of_range("FlatMap::at: key not found");
+            return m_values[i];
+        }
+
+        std::size_t erase(Key const & key)
+        {
+            auto i = this->Find(key);
+            if (i == size())
+                return 0;
+
+            this->m_keys.erase(this->m_keys.begin() + i);
+            m_values.erase(m_values.begin() + i);
+            this->Rebuild();
+            return 1;
+        }
+
+    private:
+        std::vector<T> m_values;
+    };
+}
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <bit>       // countr_zero
+#include <limits>    // numeric_limits
+#include <stdexcept> // overflow_error
+#include <utility>   // swap
+#include <cstdint>   // uint32_t, uint64_t, int32_t
+#include <cstddef>   // size_t
+#include "ByteSearch.h" // Isa, ActiveIsa, BYTESEARCH_AVX2
+
+/*
+    Greatest common divisor without division.
+
+    Euclid's algorithm, gcd(a, b) = gcd(b, a % b), needs a division per step, and an integer
+    division costs 20-90 cycles. The binary GCD (Stein's algorithm) uses the identities
+        gcd(2a, 2b) = 2 gcd(a, b)
+        gcd(2a, b)  = gcd(a, b)         if b is odd
+        gcd(a, b)   = gcd(a, b - a)     if a <= b
+    Both numbers are kept odd by shifting out their trailing zeros (a single instruction: tzcnt/bsf),
+    so each step is a subtraction, a comparison and a shift. It takes more steps than Euclid's
+    algorithm, so it wins when the steps are cheap and don't branch.
+
+    TrailingZeros is std::countr_zero (C++20), which compiles to tzcnt or bsf.
+
+    Gcd over an array stops as soon as the running gcd is 1. GcdPairs computes the gcds of many pairs
+    at once (for example to reduce fractions), and with AVX2 it runs the binary GCD on 8 pairs of
+    32-bit numbers in parallel: the trailing zeros of all the lanes are counted with a single float
+    conversion (the exponent of the lowest set bit) and shifted out with a per-lane variable shift.
+    The lanes that finished early are masked out until the slowest one is done.
+*/
+namespace Gcd
+{
+    inline int TrailingZeros(std::uint64_t x)
+    {
+        return std::countr_zero(x);
+    }
+
+    //
+    // Scalar
+    //
+
+    inline std::uint64_t BinaryGcd(std::uint64_t a, std::uint64_t b)
+    {
+        if (a == 0)
+            return b;
+        if (b == 0)
+            return a;
+
+        // The common power of two.
+        int shift = TrailingZeros(a | b);
+
+        // b is kept odd and a is made odd at the start of each step. The trailing zeros of the difference
+        // are counted at the same time as the minimum and the absolute difference are computed (-x has
+        // the same trailing zeros as x), and those are conditional moves: a data-dependent swap would be
+        // mispredicted about half the time.
+        int zeros = TrailingZeros(a);
+        b >>= TrailingZeros(b);
+        while (a != 0)
+        {
+            a >>= zeros;
+            auto difference = b - a; // wraps around if a > b
+            zeros = TrailingZeros(difference | (std::uint64_t{ 1 } << 63)); // the top bit keeps the argument nonzero
+            auto smaller = a < b ? a : b;
+            a = a < b ? b - a : a - b;
+            b = smaller;
+        }
+
+        return b << shift;
+    }
+
+    inline std::uint32_t BinaryGcd(std::uint32_t a, std::uint32_t b)
+    {
+        return static_cast<std::uint32_t>(BinaryGcd(static_cast<std::uint64_t>(a), static_cast<std::uint64_t>(b)));
+    }
+
+    // The gcd of signed numbers is the gcd of their absolute values. The negation is done in unsigned
+    // arithmetic, so it works for the most negative number too.
+    inline std::uint64_t BinaryGcd(std::int64_t a, std::int64_t b)
+    {
+        auto ua = a < 0 ? 0 - static_cast<std::uint64_t>(a) : static_cast<std::uint64_t>(a);
+        auto ub = b < 0 ? 0 - static_cast<std::uint64_t>(b) : static_cast<std::uint64_t>(b);
+        return BinaryGcd(ua, ub);
+    }
+
+    // UInt128 is just enough of a 128-bit unsigned integer for the binary GCD. Compilers have no portable
+    // 128-bit type (MSVC doesn't have one at all).
+    struct UInt128
+    {
+        std::uint64_t High;
+        std::uint64_t Low;
+
+        UInt128(std::uint64_t low = 0) : High{ 0 }, Low{ low } {}
+        UInt128(std::uint64_t high, std::uint64_t low) : High{ high }, Low{ low } {}
+
+        bool IsZero() const { return (High | Low) == 0; }
+
+        friend bool operator==(UInt128 a, UInt128 b) { return a.High == b.High && a.Low == b.Low; }
+        friend bool operator!=(UInt128 a, UInt128 b) { return !(a == b); }
+        friend bool operator<(UInt128 a, UInt128 b) { return a.High < b.High || (a.High == b.High && a.Low < b.Low); }
+        friend bool operator>(UInt128 a, UInt128 b) { return b < a; }
+
+        friend UInt128 operator|(UInt128 a, UInt128 b) { return UInt128(a.High | b.High, a.Low | b.Low); }
+
+        friend UInt128 operator-(UInt128 a, UInt128 b)
+        {
+            auto low = a.Low - b.Low;
+            auto borrow = a.Low < b.Low ? 1 : 0;
+            return UInt128(a.High - b.High - borrow, low);
+        }
+
+        // Shifts by 0..127 bits.
+        friend UInt128 operator>>(UInt128 a, int n)
+        {
+            if (n == 0)
+                return a;
+            if (n >= 64)
+                return UInt128(0, a.High >> (n - 64));
+            return UInt128(a.High >> n, (a.Low >> n) | (a.High << (64 - n)));
+        }
+
+        friend UInt128 operator<<(UInt128 a, int n)
+        {
+            if (n == 0)
+                return a;
+            if (n >= 64)
+                return UInt128(a.Low << (n - 64), 0);
+            return UInt128((a.High << n) | (a.Low >> (64 - n)), a.Low << n);
+        }
+    };
+
+    // x must not be zero.
+    inline int TrailingZeros(UInt128 x)
+    {
+        return x.Low != 0 ? TrailingZeros(x.Low) : 64 + TrailingZeros(x.High);
+    }
+
+    inline UInt128 BinaryGcd(UInt128 a, UInt128 b)
+    {
+        if (a.IsZero())
+            return b;
+        if (b.IsZero())
+            return a;
+
+        int shift = TrailingZeros(a | b);
+
+        a = a >> TrailingZeros(a);
+        do
+        {
+            b = b >> TrailingZeros(b);
+            if (a > b)
+                std::swap(a, b);
+            b = b - a;
+
+            // Once both fit in 64 bits the rest is cheaper with 64-bit arithmetic.
+            if (a.High == 0 && b.High == 0)
+                return UInt128(BinaryGcd(a.Low, b.Low)) << shift;
+        } while (!b.IsZero());
+
+        return a << shift;
+    }
+
+    // Lcm returns the least common multiple. Dividing by the gcd before multiplying keeps the
+    // intermediate result from overflowing; it throws std::overflow_error if the result itself
+    // does not fit in 64 bits.
+    inline std::uint64_t Lcm(std::uint64_t a, std::uint64_t b)
+    {
+        if (a == 0 || b == 0)
+            return 0;
+
+        auto q = a / BinaryGcd(a, b);
+        if (q > std::numeric_limits<std::uint64_t>::max() / b)
+            throw std::overflow_error("lcm does not fit in 64 bits");
+        return q * b;
+    }
+
+    //
+    // Arrays
+    //
+
+    // Gcd returns the gcd of count numbers (0 for an empty array).
+    inline std::uint64_t Gcd(std::uint64_t const * values, std::size_t count)
+    {
+        std::uint64_t result = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            result = BinaryGcd(result, values[i]);
+
+            // Random numbers quickly become coprime; nothing changes the result after that.
+            if (result == 1)
+                break;
+        }
+        return result;
+    }
+
+    // Lcm returns the lcm of count numbers (1 for an empty array).
+    inline std::uint64_t Lcm(std::uint64_t const * values, std::size_t count)
+    {
+        std::uint64_t result = 1;
+        for (std::size_t i = 0; i < count; ++i)
+            result = Lcm(result, values[i]);
+        return result;
+    }
+
+    inline void GcdPairsScalar(std::uint32_t const * a, std::uint32_t const * b, std::uint32_t * result, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            result[i] = BinaryGcd(a[i], b[i]);
+    }
+
+#if defined(BYTESEARCH_X86)
+    // TrailingZeros8 counts the trailing zeros of 8 lanes. The lowest set bit (x & -x) is a power of two,
+    // which converts to a float exactly; its exponent is the bit index. 0x80000000 converts to -2^31, whose
+    // exponent is still right once the sign is masked. Zero lanes give a negative count, which the variable
+    // shifts treat as a shift by 32 or more, producing 0.
+    BYTESEARCH_AVX2 inline __m256i TrailingZeros8(__m256i x)
+    {
+        auto lowest = _mm256_and_si256(x, _mm256_sub_epi32(_mm256_setzero_si256(), x));
+        auto bits = _mm256_castps_si256(_mm256_cvtepi32_ps(lowest));
+        auto exponent = _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xFF));
+        return _mm256_sub_epi32(exponent, _mm256_set1_epi32(127));
+    }
+
+    BYTESEARCH_AVX2 inline void GcdPairsAVX2(std::uint32_t const * a, std::uint32_t const * b, std::uint32_t * result, std::size_t count)
+    {
+        const auto zero = _mm256_setzero_si256();
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            auto x = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i));
+            auto y = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i));
+
+            // gcd(0, y) = y: swap those lanes so that x is the nonzero one (unless both are zero).
+            auto xZero = _mm256_cmpeq_epi32(x, zero);
+            auto swapped = _mm256_blendv_epi8(x, y, xZero);
+            y = _mm256_blendv_epi8(y, x, xZero);
+            x = swapped;
+
+            auto shift = TrailingZeros8(_mm256_or_si256(x, y));
+            x = _mm256_srlv_epi32(x, TrailingZeros8(x));
+
+            for (;;)
+            {
+                auto done = _mm256_cmpeq_epi32(y, zero);
+                if (_mm256_movemask_epi8(done) == -1)
+                    break;
+
+                y = _mm256_srlv_epi32(y, TrailingZeros8(y));
+                auto low = _mm256_min_epu32(x, y);
+                auto high = _mm256_max_epu32(x, y);
+
+                // The finished lanes keep their x and a zero y.
+                x = _mm256_blendv_epi8(low, x, done);
+                y = _mm256_andnot_si256(done, _mm256_sub_epi32(high, low));
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), _mm256_sllv_epi32(x, shift));
+        }
+
+        GcdPairsScalar(a + i, b + i, result + i, count - i);
+    }
+#endif
+
+    // GcdPairs sets result[i] to gcd(a[i], b[i]). AVX2 has no unsigned 64-bit min/max or conversion to float,
+    // so only the 32-bit version is vectorized.
+    inline void GcdPairs(std::uint32_t const * a, std::uint32_t const * b, std::uint32_t * result, std::size_t count, ByteSearch::Isa isa)
+    {
+#if defined(BYTESEARCH_X86)
+        if (isa == ByteSearch::Isa::AVX2)
+            return GcdPairsAVX2(a, b, result, count);
+#endif
+        GcdPairsScalar(a, b, result, count);
+    }
+
+    inline void GcdPairs(std::uint32_t const * a, std::uint32_t const * b, std::uint32_t * result, std::size_t count)
+    {
+        GcdPairs(a, b, result, count, ByteSearch::ActiveIsa());
+    }
+
+    // ReduceFractions divides each numerator[i] / denominator[i] by the gcd of the two.
+    // divisors is scratch space for count numbers. 0/0 is left as it is.
+    inline void ReduceFractions(std::uint32_t * numerators, std::uint32_t * denominators, std::uint32_t * divisors, std::size_t count)
+    {
+        GcdPairs(numerators, denominators, divisors, count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (divisors[i] > 1)
+            {
+                numerators[i] /= divisors[i];
+                denominators[i] /= divisors[i];
+            }
+        }
+    }
+}
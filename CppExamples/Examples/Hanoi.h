@@ -0,0 +1,158 @@
+#pragma once
+
+#include <iterator>  // forward_iterator_tag
+#include <stdexcept> // out_of_range
+#include <cstdint>   // uint64_t
+#include <cstddef>   // size_t, ptrdiff_t
+#include "Gcd.h"     // TrailingZeros
+
+/*
+    Tower of Hanoi moves without recursion, allocation or I/O.
+
+    The moves of the n-disk puzzle follow a binary counter. Numbering the moves m = 1 .. 2^n - 1:
+    - move m moves disk d = (the number of trailing zeros of m) + 1, where disk 1 is the smallest,
+    - from peg (m & (m - 1)) mod 3 to peg ((m | (m - 1)) + 1) mod 3, numbering the pegs 0, 1, 2.
+    That puts the tower on peg 2 when n is odd and on peg 1 when n is even, which is fixed by swapping
+    the labels of those two pegs. Any move can be computed directly from its number, so the moves can be
+    produced lazily, started anywhere, or split into chunks.
+
+    - Moves(n) is a range of Move values generated on the fly: for (auto move : Moves(20)) { ... }
+    - GenerateMoves(n, first, buffer, capacity) writes the moves first, first + 1, ... into a buffer
+      the caller owns and returns how many it wrote.
+    - MovesRecursive produces the same moves with the textbook recursion, for comparison.
+
+    With 63 disks there are 2^63 - 1 moves, the most a 64-bit counter can number.
+*/
+namespace Hanoi
+{
+    const int MaxDisks = 63;
+
+    struct Move
+    {
+        int Disk; // 1 is the smallest disk
+        int From;
+        int To;
+    };
+
+    inline bool operator==(Move const & a, Move const & b) { return a.Disk == b.Disk && a.From == b.From && a.To == b.To; }
+    inline bool operator!=(Move const & a, Move const & b) { return !(a == b); }
+
+    // MoveCount returns the number of moves needed for n disks: 2^n - 1.
+    inline std::uint64_t MoveCount(int disks)
+    {
+        if (disks < 0 || disks > MaxDisks)
+            throw std::out_of_range("the number of disks must be between 0 and 63");
+        return (std::uint64_t{ 1 } << disks) - 1;
+    }
+
+    // Pegs maps the peg numbers 0, 1, 2 of the formula to the caller's labels.
+    struct Pegs
+    {
+        int Labels[3];
+
+        Pegs(int disks, int source, int dest, int temp)
+            : Labels{ source, disks % 2 == 0 ? dest : temp, disks % 2 == 0 ? temp : dest }
+        {
+        }
+    };
+
+    // MoveNumber returns move m (1-based) of a puzzle.
+    inline Move MoveNumber(std::uint64_t m, Pegs const & pegs)
+    {
+        Move move;
+        move.Disk = Gcd::TrailingZeros(m) + 1;
+        move.From = pegs.Labels[(m & (m - 1)) % 3];
+        move.To = pegs.Labels[((m | (m - 1)) + 1) % 3];
+        return move;
+    }
+
+    // MoveRange is a lazy range of the moves of a puzzle. It and its iterators hold a few numbers only.
+    class MoveRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Move;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Move const *;
+            using reference = Move;
+
+            iterator() : m_number{ 0 }, m_pegs{ 0, 0, 0, 0 } {}
+            iterator(std::uint64_t number, Pegs const & pegs) : m_number{ number }, m_pegs{ pegs } {}
+
+            Move operator*() const { return MoveNumber(m_number, m_pegs); }
+
+            iterator& operator++()
+            {
+                ++m_number;
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto old = *this;
+                ++m_number;
+                return old;
+            }
+
+            friend bool operator==(iterator const & a, iterator const & b) { return a.m_number == b.m_number; }
+            friend bool operator!=(iterator const & a, iterator const & b) { return a.m_number != b.m_number; }
+
+        private:
+            std::uint64_t m_number;
+            Pegs m_pegs;
+        };
+
+        MoveRange(int disks, int source, int dest, int temp)
+            : m_count{ MoveCount(disks) }, m_pegs{ disks, source, dest, temp }
+        {
+        }
+
+        iterator begin() const { return iterator(1, m_pegs); }
+        iterator end() const { return iterator(m_count + 1, m_pegs); }
+
+        std::uint64_t size() const { return m_count; }
+
+    private:
+        std::uint64_t m_count;
+        Pegs m_pegs;
+    };
+
+    // Moves returns the moves that take a tower of disks from source to dest.
+    // The default labels are the ones used by towerOfHanoi: 1 -> 3 using 2.
+    inline MoveRange Moves(int disks, int source = 1, int dest = 3, int temp = 2)
+    {
+        return MoveRange(disks, source, dest, temp);
+    }
+
+    // GenerateMoves writes up to capacity moves, starting from move number first (0-based), into buffer.
+    // It returns the number of moves written, which is 0 once all the moves have been generated.
+    inline std::size_t GenerateMoves(int disks, std::uint64_t first, Move* buffer, std::size_t capacity, int source = 1, int dest = 3, int temp = 2)
+    {
+        auto count = MoveCount(disks);
+        if (first >= count)
+            return 0;
+
+        auto remaining = count - first;
+        auto n = remaining < capacity ? static_cast<std::size_t>(remaining) : capacity;
+
+        Pegs pegs(disks, source, dest, temp);
+        for (std::size_t i = 0; i < n; ++i)
+            buffer[i] = MoveNumber(first + i + 1, pegs);
+        return n;
+    }
+
+    // MovesRecursive calls visit(move) for each move, in the same order as towerOfHanoi.
+    template <typename Visit>
+    void MovesRecursive(int disks, int source, int dest, int temp, Visit&& visit)
+    {
+        if (disks > 0)
+        {
+            MovesRecursive(disks - 1, source, temp, dest, visit);
+            visit(Move{ disks, source, dest });
+            MovesRecursive(disks - 1, temp, dest, source, visit);
+        }
+    }
+}
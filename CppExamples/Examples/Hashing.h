@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint> // uint64_t
+#include <cstring> // memcpy
+#include <cstddef> // size_t
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h> // _umul128
+#endif
+
+/*
+    Hashing building blocks.
+
+    Combining hashes with exclusive-or (h1 ^ h2) is common but weak:
+    - it is symmetric: {a, b} and {b, a} get the same hash
+    - equal parts cancel out: h ^ h == 0
+    - the bits of the parts are not mixed, so keys whose hashes differ only in the low bits
+      (e.g. small integers with an identity std::hash<int>) land in neighbouring buckets
+
+    The functions below are based on the "mum" (multiply and mix) step used by wyhash:
+    the 128-bit product of two 64-bit values is folded by xoring its high and low halves.
+    Every bit of the result depends on every bit of both inputs, and a multiplication is much
+    cheaper than the byte-at-a-time loop of FNV-1a or the polynomial hashes of most std::hash<string>
+    implementations.
+
+    The hashes are not cryptographic and not stable across versions; don't persist them.
+*/
+namespace Hashing
+{
+    // Arbitrary odd constants with roughly half of the bits set (the wyhash secrets).
+    const std::uint64_t Secret0 = 0xa0761d6478bd642full;
+    const std::uint64_t Secret1 = 0xe7037ed1a0b428dbull;
+    const std::uint64_t Secret2 = 0x8ebc6af09c88c6e3ull;
+
+    // Mum multiplies two 64-bit values and folds the 128-bit product.
+    inline std::uint64_t Mum(std::uint64_t a, std::uint64_t b)
+    {
+#if defined(_MSC_VER) && defined(_M_X64)
+        std::uint64_t hi;
+        std::uint64_t lo = _umul128(a, b, &hi);
+        return lo ^ hi;
+#elif defined(__SIZEOF_INT128__)
+        unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+        return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+#else
+        // Schoolbook multiplication of 32-bit halves.
+        std::uint64_t ha = a >> 32, hb = b >> 32, la = a & 0xFFFFFFFF, lb = b & 0xFFFFFFFF;
+        std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+        std::uint64_t t = rl + (rm0 << 32);
+        std::uint64_t carry = t < rl;
+        std::uint64_t lo = t + (rm1 << 32);
+        carry += lo < t;
+        std::uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+        return lo ^ hi;
+#endif
+    }
+
+    inline std::uint64_t Read64(unsigned char const * p)
+    {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline std::uint64_t Read32(unsigned char const * p)
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    // HashBytes hashes a buffer 16 bytes at a time. Short buffers (up to 16 bytes), the common case
+    // for keys, are read with at most four overlapping loads and no loop.
+    inline std::uint64_t HashBytes(void const * data, std::size_t size, std::uint64_t seed = 0)
+    {
+        auto p = static_cast<unsigned char const *>(data);
+        seed ^= Mum(seed ^ Secret0, Secret1);
+
+        std::uint64_t a, b;
+        if (size <= 16)
+        {
+            if (size >= 4)
+            {
+                // Two loads from the front and two from the back cover all the bytes.
+                std::size_t mid = (size >> 3) << 2;
+                a = (Read32(p) << 32) | Read32(p + mid);
+                b = (Read32(p + size - 4) << 32) | Read32(p + size - 4 - mid);
+            }
+            else if (size > 0)
+            {
+                a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+                b = 0;
+            }
+            else
+            {
+                a = b = 0;
+            }
+        }
+        else
+        {
+            std::size_t i = size;
+            while (i > 16)
+            {
+                seed = Mum(Read64(p) ^ Secret1, Read64(p + 8) ^ seed);
+                p += 16;
+                i -= 16;
+            }
+
+            // The last 16 bytes; they may overlap the ones already hashed.
+            a = Read64(p + i - 16);
+            b = Read64(p + i - 8);
+        }
+
+        a ^= Secret1;
+        b ^= seed;
+        return Mum(Secret1 ^ size, Mum(a, b) ^ Secret2);
+    }
+
+    inline std::uint64_t HashString(std::string_view s, std::uint64_t seed = 0)
+    {
+        return HashBytes(s.data(), s.size(), seed);
+    }
+
+    // HashInt mixes an integer. Unlike the identity std::hash<int> of some standard libraries,
+    // all the bits of the result depend on all the bits of the value.
+    inline std::uint64_t HashInt(std::uint64_t value)
+    {
+        return Mum(value ^ Secret0, Secret1);
+    }
+
+    // HashCombine mixes the hash of another part of a key into a seed. The order of the parts matters.
+    inline std::uint64_t HashCombine(std::uint64_t seed, std::uint64_t hash)
+    {
+        return Mum(seed ^ Secret0, hash ^ Secret2);
+    }
+}
@@ -1,8 +1,19 @@
+#pragma once
+
 #include "Containers.h"
+#include "HistogramEngine.h"
+#include "StreamingTopK.h"
+#include "Pipeline.h" // Streaming::Pipeline
+#include "Chrono.h" // TimeNow, TimeElapsed
+#include "InputReader.h" // InputExamples::InputReader
+#include "Benchmark.h" // Benchmark::Register
 
 #include <iostream>
 #include <string>
+#include <sstream> // ostringstream, istringstream
 #include <iterator> // std::back_inserter, std::istream_iterator
+#include <random> // mt19937, discrete_distribution
+#include <cmath> // pow
 #include <conio.h> // getch()
 
 using std::cout;
@@ -17,18 +28,12 @@ namespace Applications
         cout << r.first << ' ' << r.second << endl;
     }
 
-    // Read words from input and record the frequency of their occurrence. 
-    void Histogram()
+    // MapHistogram reads words from a stream and records the frequency of their occurrence. 
+    // This is the reference implementation for HistogramEngine.
+    map<string, int> MapHistogram(std::istream& in)
     {
         using std::istream_iterator;
 
-        cout << endl << "Do you want to run histogram? (y/n)" << endl;
-        char answer = _getch();
-        if (answer == 'n' || answer == 'N')
-            return;
-
-        cout << "Enter words and mark the end with CTRL-Z." << endl;
-
         // The histogram stores the words and their frequency.
         map<string, int> histogram;
 
@@ -39,13 +44,302 @@ namespace Applications
         // Create a stream iterator using a constructor that accepts a stream.
         // The stream iterator created this way stops processing when the special value 
         // is encountered.
-        istream_iterator<string> ii(std::cin);
+        istream_iterator<string> ii(in);
 
         // Register the frequency of an input string s starting from the current position 
         // in the stream (which is the beginning) to the special value (which indicates the end).
         for_each(ii, eos, [&histogram](string s) { histogram[s]++; });
 
+        return histogram;
+    }
+
+    // MapHistogram with the words read by an InputReader: the same map, without a stream per word.
+    map<string, int> MapHistogram(InputExamples::InputReader& in)
+    {
+        map<string, int> histogram;
+        std::string_view word;
+        while (in.NextToken(word))
+            histogram[string(word)]++;
+        return histogram;
+    }
+
+    // Read words from input and record the frequency of their occurrence. 
+    void Histogram()
+    {
+        cout << endl << "Do you want to run histogram? (y/n)" << endl;
+        char answer = _getch();
+        if (answer == 'n' || answer == 'N')
+            return;
+
+        cout << "Enter words and mark the end with CTRL-Z." << endl;
+
+        InputExamples::InputReader in(InputExamples::InputReader::StandardInput);
+        auto histogram = MapHistogram(in);
+
         // Print each element of the histogram.
         for_each(histogram.begin(), histogram.end(), PrintHistogram);
     }
-}
\ No newline at end of file
+
+    // StreamingHistogram reads words from a stream of any length and returns the approximately k most
+    // frequent ones in a fixed amount of memory. Each count may exceed the true count by up to
+    // epsilon * (the number of words), with a probability of at least 1 - delta.
+    vector<StreamingTopK::WordCount> StreamingHistogram(std::istream& in, std::size_t k, double epsilon = 1e-4, double delta = 1e-3)
+    {
+        StreamingTopK topK(k, epsilon, delta);
+        topK.CountWords(in);
+        return topK.TopK();
+    }
+
+    // HistogramTopKAccuracy compares StreamingTopK with the exact map on a Zipf-distributed text:
+    // how many of the exact top k it reports and how far its counts are from the exact ones.
+    void HistogramTopKAccuracy(std::size_t k = 20, double epsilon = 1e-4, double delta = 1e-3,
+        std::size_t wordCount = 4'000'000, std::size_t vocabulary = 200'000)
+    {
+        cout << "*** Streaming top-" << k << " accuracy ***" << endl;
+
+        // Generate the text: the frequency of the word of rank r is proportional to 1/r, as in natural text.
+        std::vector<double> weights(vocabulary);
+        for (std::size_t r = 0; r < vocabulary; ++r)
+            weights[r] = 1.0 / static_cast<double>(r + 1);
+        std::discrete_distribution<std::size_t> rank(begin(weights), end(weights));
+        std::mt19937 gen(1);
+
+        std::ostringstream os;
+        for (std::size_t i = 0; i < wordCount; ++i)
+            os << 'w' << rank(gen) << ((i % 16 == 15) ? '\n' : ' ');
+        auto const text = os.str();
+        auto const megabytes = text.size() / (1024.0f * 1024.0f);
+
+        std::istringstream in1(text);
+        auto start = ChronoExamples::TimeNow();
+        auto exact = MapHistogram(in1);
+        auto seconds = ChronoExamples::TimeElapsed(start);
+        cout << "map<string,int>: " << megabytes / seconds << " MB/s, " << exact.size() << " words" << endl;
+
+        std::istringstream in2(text);
+        StreamingTopK topK(k, epsilon, delta);
+        start = ChronoExamples::TimeNow();
+        topK.CountWords(in2);
+        seconds = ChronoExamples::TimeElapsed(start);
+        cout << "StreamingTopK: " << megabytes / seconds << " MB/s, " << topK.Sketch().Depth() << " x " << topK.Sketch().Width()
+             << " counters (" << topK.Sketch().MemoryBytes() / 1024 << " KB)" << endl;
+
+        // The exact top k.
+        vector<std::pair<string, int>> reference(begin(exact), end(exact));
+        k = std::min(k, reference.size());
+        std::partial_sort(begin(reference), begin(reference) + k, end(reference),
+            [](std::pair<string, int> const & a, std::pair<string, int> const & b)
+            {
+                return a.second != b.second ? a.second > b.second : a.first < b.first;
+            });
+        reference.resize(k);
+
+        std::size_t found = 0;
+        std::uint64_t maxError = 0;
+        for (auto const & w : topK.TopK())
+        {
+            auto trueCount = static_cast<std::uint64_t>(exact[w.first]);
+            maxError = std::max(maxError, w.second - trueCount);
+            found += std::any_of(begin(reference), end(reference), [&w](std::pair<string, int> const & r) { return r.first == w.first; });
+        }
+
+        // The error of the sketch for all the words, most of which have small counts.
+        std::uint64_t maxSketchError = 0;
+        double sumSketchError = 0;
+        for (auto const & r : exact)
+        {
+            auto error = topK.Estimate(r.first) - static_cast<std::uint64_t>(r.second);
+            maxSketchError = std::max(maxSketchError, error);
+            sumSketchError += static_cast<double>(error);
+        }
+
+        cout << "Found " << found << " of the exact top " << k << ", largest overestimate " << maxError
+             << " (bound " << topK.ErrorBound() << ")" << endl;
+        cout << "All words: largest overestimate " << maxSketchError << ", mean " << sumSketchError / exact.size() << endl;
+        cout << endl;
+    }
+
+    // MakeHistogramText generates a text of pseudo-random words drawn from a fixed vocabulary.
+    string MakeHistogramText(std::size_t wordCount, std::size_t vocabulary)
+    {
+        std::ostringstream os;
+        unsigned x = 1;
+        for (std::size_t i = 0; i < wordCount; ++i)
+        {
+            x = x * 1103515245 + 12345;
+            os << 'w' << (x >> 8) % vocabulary << ((i % 16 == 15) ? '\n' : ' ');
+        }
+        return os.str();
+    }
+
+    // PipelineHistogram counts the words of a stream with the streaming pipeline: a stage reads 1MB
+    // chunks while a stage tokenizes the previous ones and each of the aggregating stages counts the
+    // words of the batches into its own table. The tables are merged into the first one.
+    WordTable PipelineHistogram(std::istream& in, unsigned aggregators)
+    {
+        Streaming::Pipeline pipeline;
+        auto& chunks = pipeline.MakeChannel<string>(4);
+        auto& batches = pipeline.MakeChannel<Streaming::WordBatch>(4);
+        vector<WordTable> tables(std::max(1u, aggregators));
+
+        pipeline.Run(Streaming::From(Streaming::ReadChunks(in, 1 << 20), chunks));
+        pipeline.Run(Streaming::Tokenize(chunks, batches, IsWordDelimiter));
+        for (auto& table : tables)
+        {
+            pipeline.Run(Streaming::Aggregate(batches, table, [](WordTable& t, Streaming::WordBatch batch)
+            {
+                for (auto word : batch.Words)
+                    t.Add(word);
+            }));
+        }
+        pipeline.Wait();
+        for (std::size_t i = 1; i < tables.size(); ++i)
+            tables[0].Merge(tables[i]);
+        return std::move(tables[0]);
+    }
+
+    // HistogramThroughput (examples --histograms) compares the map-based reference implementation with
+    // HistogramEngine and the streaming pipeline on a generated text and checks that they all produce
+    // the same histogram.
+    void HistogramThroughput(std::size_t wordCount = 4'000'000, std::size_t vocabulary = 50'000)
+    {
+        cout << "*** Histogram throughput ***" << endl;
+
+        auto const text = MakeHistogramText(wordCount, vocabulary);
+        auto const megabytes = text.size() / (1024.0f * 1024.0f);
+
+        // The reference implementation.
+        std::istringstream in1(text);
+        auto start = ChronoExamples::TimeNow();
+        auto reference = MapHistogram(in1);
+        auto seconds = ChronoExamples::TimeElapsed(start);
+        cout << "map<string,int>: " << megabytes / seconds << " MB/s" << endl;
+
+        // The same map with the words read by an InputReader.
+        {
+            std::istringstream in(text);
+            InputExamples::InputReader reader(in);
+            start = ChronoExamples::TimeNow();
+            auto result = MapHistogram(reader);
+            seconds = ChronoExamples::TimeElapsed(start);
+            cout << "map<string,int> with InputReader: " << megabytes / seconds << " MB/s"
+                 << (result == reference ? "" : " ERROR: results differ") << endl;
+        }
+
+        // The engine with 1 thread and with all hardware threads, if there are more.
+        vector<unsigned> engineThreads{ 1 };
+        if (std::thread::hardware_concurrency() > 1)
+            engineThreads.push_back(std::thread::hardware_concurrency());
+
+        for (unsigned threads : engineThreads)
+        {
+            std::istringstream in2(text);
+            HistogramEngine engine(threads);
+            start = ChronoExamples::TimeNow();
+            engine.CountWords(in2);
+            seconds = ChronoExamples::TimeElapsed(start);
+
+            // Sorting is not part of the measurement; it is done only to compare the results.
+            auto result = engine.Sorted();
+            auto same = result.size() == reference.size() &&
+                std::equal(begin(result), end(result), begin(reference),
+                    [](HistogramEngine::WordCount const & a, std::pair<const string, int> const & b)
+                    {
+                        return a.first == b.first && a.second == static_cast<std::uint64_t>(b.second);
+                    });
+
+            cout << "HistogramEngine(" << threads << (threads == 1 ? " thread): " : " threads): ") << megabytes / seconds << " MB/s"
+                 << (same ? "" : " ERROR: results differ") << endl;
+        }
+
+        // The streaming pipeline, with an aggregating stage per hardware thread.
+        {
+            std::istringstream in3(text);
+            start = ChronoExamples::TimeNow();
+            auto table = PipelineHistogram(in3, std::thread::hardware_concurrency());
+            seconds = ChronoExamples::TimeElapsed(start);
+
+            auto same = table.Size() == reference.size() &&
+                std::all_of(begin(reference), end(reference), [&table](std::pair<const string, int> const & r)
+                {
+                    return table.Find(r.first) == static_cast<std::uint64_t>(r.second);
+                });
+
+            cout << "Streaming pipeline: " << megabytes / seconds << " MB/s"
+                 << (same ? "" : " ERROR: results differ") << endl;
+        }
+
+        cout << endl;
+    }
+
+    // The histograms of a text of 1M words of a 50k-word vocabulary (~7 MB): the reference map, the
+    // same map with an InputReader, HistogramEngine, the streaming pipeline and the streaming top-k.
+    // On one hardware thread, in M words/s: map ~2.5, with InputReader ~2.8, HistogramEngine ~24,
+    // pipeline ~20, StreamingTopK ~6.
+    void RegisterBenchmarks()
+    {
+        const std::size_t wordCount = 1'000'000;
+        auto text = std::make_shared<string const>(MakeHistogramText(wordCount, 50'000));
+        auto const threads = std::max(1u, std::thread::hardware_concurrency());
+
+        Benchmark::Register("Histogram", "map<string,int> istream_iterator", [text, wordCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(static_cast<double>(wordCount));
+            while (state.KeepRunning())
+            {
+                std::istringstream in(*text);
+                Benchmark::DoNotOptimize(MapHistogram(in).size());
+            }
+        });
+
+        Benchmark::Register("Histogram", "map<string,int> InputReader", [text, wordCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(static_cast<double>(wordCount));
+            while (state.KeepRunning())
+            {
+                std::istringstream in(*text);
+                InputExamples::InputReader reader(in);
+                Benchmark::DoNotOptimize(MapHistogram(reader).size());
+            }
+        });
+
+        vector<unsigned> engineThreads{ 1 };
+        if (threads > 1)
+            engineThreads.push_back(threads);
+
+        for (unsigned n : engineThreads)
+        {
+            Benchmark::Register("Histogram", "HistogramEngine " + std::to_string(n) + (n == 1 ? " thread" : " threads"), [text, wordCount, n](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(static_cast<double>(wordCount));
+                while (state.KeepRunning())
+                {
+                    std::istringstream in(*text);
+                    HistogramEngine engine(n);
+                    engine.CountWords(in);
+                    Benchmark::DoNotOptimize(engine.Size());
+                }
+            });
+        }
+
+        Benchmark::Register("Histogram", "pipeline " + std::to_string(threads) + " aggregators", [text, wordCount, threads](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(static_cast<double>(wordCount));
+            while (state.KeepRunning())
+            {
+                std::istringstream in(*text);
+                Benchmark::DoNotOptimize(PipelineHistogram(in, threads).Size());
+            }
+        });
+
+        Benchmark::Register("Histogram", "StreamingTopK top 20", [text, wordCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(static_cast<double>(wordCount));
+            while (state.KeepRunning())
+            {
+                std::istringstream in(*text);
+                Benchmark::DoNotOptimize(StreamingHistogram(in, 20).size());
+            }
+        });
+    }
+}
@@ -0,0 +1,433 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <memory> // unique_ptr
+#include <utility> // pair, move
+#include <algorithm> // sort, partial_sort, max
+#include <cstdint> // uint32_t, uint64_t
+#include <cstring> // memcpy
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/*
+    HistogramEngine counts the frequency of words in large inputs.
+
+    The reference implementation (Applications::Histogram) pushes every token through
+    istream_iterator<string> into a map<string,int>:
+    - each token is a new std::string (a heap allocation for longer words)
+    - each lookup is O(log n) and chases pointers through the red-black tree
+    - everything runs on a single thread
+
+    HistogramEngine does the following instead:
+    - reads the input in large chunks (1MB by default); a word split by a chunk boundary is carried over to the next chunk
+    - tokenizes a chunk into string_views, so no string is created per token
+    - counts words in per-thread open-addressing hash tables (shards), so workers never take a lock in the hot loop
+    - merges the shards once at the end of input
+    - sorts the results only when asked (Sorted or TopK)
+*/
+namespace Applications
+{
+    // IsWordDelimiter is a lookup table equivalent of isspace in the "C" locale,
+    // i.e. the delimiters used by operator>> for strings.
+    inline bool IsWordDelimiter(char c)
+    {
+        static const struct Table
+        {
+            bool Values[256] = {};
+
+            Table()
+            {
+                for (unsigned char c : { ' ', '\t', '\n', '\v', '\f', '\r' })
+                    Values[c] = true;
+            }
+        } table;
+
+        return table.Values[static_cast<unsigned char>(c)];
+    }
+
+    // HashWord calculates the 64-bit FNV-1a hash of a word.
+    inline std::uint64_t HashWord(std::string_view word)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (char c : word)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // WordTable is an open-addressing hash table with linear probing that maps words to counts.
+    // The table owns a copy of each distinct word (stored in an arena of large blocks), so the
+    // keys do not depend on the lifetime of the buffer the words were read from.
+    class WordTable
+    {
+    public:
+        WordTable(std::size_t capacity = 1024)
+        {
+            // The capacity is always a power of 2 so we can use a mask instead of the modulo operator.
+            std::size_t n = 16;
+            while (n < capacity)
+                n *= 2;
+            m_slots.resize(n);
+        }
+
+        // Add increments the count of a word by a given value.
+        void Add(std::string_view word, std::uint64_t count = 1)
+        {
+            Add(word, HashWord(word), count);
+        }
+
+        // Add with a precomputed hash. Used when merging tables so that the hashes are not calculated again.
+        void Add(std::string_view word, std::uint64_t hash, std::uint64_t count)
+        {
+            // Keep the load factor below 0.5 to keep the probe sequences short.
+            if ((m_size + 1) * 2 > m_slots.size())
+                Grow();
+
+            auto mask = m_slots.size() - 1;
+            for (auto i = static_cast<std::size_t>(hash) & mask; ; i = (i + 1) & mask)
+            {
+                auto& slot = m_slots[i];
+
+                // An empty slot: the word is not in the table yet.
+                if (slot.Word == nullptr)
+                {
+                    slot.Hash = hash;
+                    slot.Word = Store(word);
+                    slot.Length = static_cast<std::uint32_t>(word.size());
+                    slot.Count = count;
+                    ++m_size;
+                    break;
+                }
+
+                // Compare the full hashes first; the words are compared only if the hashes are equal.
+                if (slot.Hash == hash && Key(slot) == word)
+                {
+                    slot.Count += count;
+                    break;
+                }
+            }
+
+            m_total += count;
+        }
+
+        // CountWords tokenizes text and adds each word to the table.
+        void CountWords(std::string_view text)
+        {
+            auto p = text.data();
+            auto end = p + text.size();
+
+            while (p != end)
+            {
+                // Skip the delimiters.
+                while (p != end && IsWordDelimiter(*p))
+                    ++p;
+
+                // Find the end of the word.
+                auto first = p;
+                while (p != end && !IsWordDelimiter(*p))
+                    ++p;
+
+                if (p != first)
+                    Add(std::string_view(first, p - first));
+            }
+        }
+
+        // Merge adds all the counts from another table to this table.
+        void Merge(WordTable const & other)
+        {
+            for (auto const & slot : other.m_slots)
+            {
+                if (slot.Word != nullptr)
+                    Add(Key(slot), slot.Hash, slot.Count);
+            }
+        }
+
+        // Find returns the count of a word or 0 if the word is not in the table.
+        std::uint64_t Find(std::string_view word) const
+        {
+            auto hash = HashWord(word);
+            auto mask = m_slots.size() - 1;
+            for (auto i = static_cast<std::size_t>(hash) & mask; m_slots[i].Word != nullptr; i = (i + 1) & mask)
+            {
+                if (m_slots[i].Hash == hash && Key(m_slots[i]) == word)
+                    return m_slots[i].Count;
+            }
+            return 0;
+        }
+
+        // Size returns the number of distinct words.
+        std::size_t Size() const { return m_size; }
+
+        // Total returns the number of words counted.
+        std::uint64_t Total() const { return m_total; }
+
+        // ForEach calls f(word, count) for each distinct word in an unspecified order.
+        template <typename Func>
+        void ForEach(Func f) const
+        {
+            for (auto const & slot : m_slots)
+            {
+                if (slot.Word != nullptr)
+                    f(Key(slot), slot.Count);
+            }
+        }
+
+    private:
+        struct Slot
+        {
+            std::uint64_t Hash = 0;
+            char const * Word = nullptr; // nullptr marks an empty slot
+            std::uint32_t Length = 0;
+            std::uint64_t Count = 0;
+        };
+
+        static constexpr std::size_t BlockSize = 64 * 1024;
+
+        std::vector<Slot> m_slots;
+        std::size_t m_size = 0;
+        std::uint64_t m_total = 0;
+
+        // The arena: blocks of memory holding the distinct words.
+        std::vector<std::unique_ptr<char[]>> m_blocks;
+        char* m_blockPos = nullptr;
+        std::size_t m_blockLeft = 0;
+
+        static std::string_view Key(Slot const & slot)
+        {
+            return std::string_view(slot.Word, slot.Length);
+        }
+
+        // Store copies a word into the arena and returns a pointer to the copy.
+        char const * Store(std::string_view word)
+        {
+            // Words longer than a block get a block of their own. An empty word still needs 
+            // a non-null address because nullptr marks an empty slot.
+            if (m_blockPos == nullptr || word.size() > m_blockLeft)
+            {
+                auto size = std::max(BlockSize, word.size());
+                m_blocks.push_back(std::make_unique<char[]>(size));
+                m_blockPos = m_blocks.back().get();
+                m_blockLeft = size;
+            }
+
+            auto p = m_blockPos;
+            std::memcpy(p, word.data(), word.size());
+            m_blockPos += word.size();
+            m_blockLeft -= word.size();
+            return p;
+        }
+
+        // Grow doubles the number of slots and reinserts the existing slots using their stored hashes.
+        // The words stay in the arena so only the slots are moved.
+        void Grow()
+        {
+            std::vector<Slot> slots(m_slots.size() * 2);
+            auto mask = slots.size() - 1;
+
+            for (auto const & slot : m_slots)
+            {
+                if (slot.Word == nullptr)
+                    continue;
+
+                auto i = static_cast<std::size_t>(slot.Hash) & mask;
+                while (slots[i].Word != nullptr)
+                    i = (i + 1) & mask;
+                slots[i] = slot;
+            }
+
+            m_slots.swap(slots);
+        }
+    };
+
+    // HistogramEngine reads an input stream in chunks and counts its words on multiple threads.
+    class HistogramEngine
+    {
+    public:
+        typedef std::pair<std::string_view, std::uint64_t> WordCount;
+
+        // threads    - the number of worker threads; 0 means std::thread::hardware_concurrency
+        // chunkSize  - the number of bytes read from the input at once
+        explicit HistogramEngine(unsigned threads = 0, std::size_t chunkSize = 1 << 20) :
+            m_threads{ threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency()) },
+            m_chunkSize{ std::max<std::size_t>(chunkSize, 64) }
+        {
+        }
+
+        // CountWords counts all the words in a stream. It can be called multiple times; the counts accumulate.
+        void CountWords(std::istream& in)
+        {
+            // One shard per worker. The shards are merged into m_table after all the workers finish.
+            std::vector<WordTable> shards(m_threads);
+            ChunkQueue queue(m_threads * 2); // a bounded queue so the reader does not run ahead of the workers
+
+            std::vector<std::thread> workers;
+            for (unsigned i = 0; i < m_threads; ++i)
+            {
+                workers.emplace_back([&queue, &shard = shards[i]]()
+                {
+                    std::vector<char> chunk;
+                    while (queue.Pop(chunk))
+                        shard.CountWords(std::string_view(chunk.data(), chunk.size()));
+                });
+            }
+
+            ReadChunks(in, queue);
+
+            for (auto& w : workers)
+                w.join();
+
+            for (auto const & shard : shards)
+                m_table.Merge(shard);
+        }
+
+        // CountWords counts all the words in a buffer on the calling thread.
+        void CountWords(std::string_view text)
+        {
+            m_table.CountWords(text);
+        }
+
+        // Size returns the number of distinct words.
+        std::size_t Size() const { return m_table.Size(); }
+
+        // Total returns the number of words counted.
+        std::uint64_t Total() const { return m_table.Total(); }
+
+        // Count returns the frequency of a single word.
+        std::uint64_t Count(std::string_view word) const
+        {
+            return m_table.Find(word);
+        }
+
+        // Sorted returns all the words sorted alphabetically - the same order as map<string,int>.
+        // The string_views point to the engine's storage and are valid as long as the engine exists.
+        std::vector<WordCount> Sorted() const
+        {
+            auto result = Collect();
+            std::sort(begin(result), end(result),
+                [](WordCount const & a, WordCount const & b) { return a.first < b.first; });
+            return result;
+        }
+
+        // TopK returns the k most frequent words sorted by frequency (descending).
+        // Words with the same frequency are sorted alphabetically.
+        std::vector<WordCount> TopK(std::size_t k) const
+        {
+            auto result = Collect();
+            k = std::min(k, result.size());
+
+            // partial_sort sorts only the first k elements: O(n log k) rather than O(n log n).
+            std::partial_sort(begin(result), begin(result) + k, end(result),
+                [](WordCount const & a, WordCount const & b)
+                {
+                    return a.second != b.second ? a.second > b.second : a.first < b.first;
+                });
+
+            result.resize(k);
+            return result;
+        }
+
+    private:
+        // ChunkQueue passes chunks from the reader to the workers.
+        class ChunkQueue
+        {
+        public:
+            explicit ChunkQueue(std::size_t capacity) : m_capacity{ capacity } {}
+
+            void Push(std::vector<char>&& chunk)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_notFull.wait(lock, [this] { return m_chunks.size() < m_capacity; });
+                m_chunks.push_back(std::move(chunk));
+                m_notEmpty.notify_one();
+            }
+
+            // Close tells the workers that there are no more chunks.
+            void Close()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_closed = true;
+                m_notEmpty.notify_all();
+            }
+
+            // Pop returns false if the queue is closed and empty.
+            bool Pop(std::vector<char>& chunk)
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_notEmpty.wait(lock, [this] { return !m_chunks.empty() || m_closed; });
+                if (m_chunks.empty())
+                    return false;
+
+                chunk = std::move(m_chunks.front());
+                m_chunks.pop_front();
+                m_notFull.notify_one();
+                return true;
+            }
+
+        private:
+            std::size_t m_capacity;
+            std::deque<std::vector<char>> m_chunks;
+            bool m_closed = false;
+            std::mutex m_mutex;
+            std::condition_variable m_notEmpty;
+            std::condition_variable m_notFull;
+        };
+
+        unsigned m_threads;
+        std::size_t m_chunkSize;
+        WordTable m_table;
+
+        // ReadChunks splits the input into chunks that end on a word delimiter.
+        void ReadChunks(std::istream& in, ChunkQueue& queue)
+        {
+            std::vector<char> carry; // the beginning of a word split by the chunk boundary
+
+            for (;;)
+            {
+                std::vector<char> chunk(std::move(carry));
+                auto offset = chunk.size();
+                chunk.resize(offset + m_chunkSize);
+
+                in.read(chunk.data() + offset, m_chunkSize);
+                auto size = offset + static_cast<std::size_t>(in.gcount());
+                chunk.resize(size);
+
+                if (!in)
+                {
+                    // The end of input: the last word is complete.
+                    if (!chunk.empty())
+                        queue.Push(std::move(chunk));
+                    break;
+                }
+
+                // Find the last delimiter. Everything after it is carried over to the next chunk.
+                auto last = size;
+                while (last != 0 && !IsWordDelimiter(chunk[last - 1]))
+                    --last;
+
+                carry.assign(begin(chunk) + last, end(chunk));
+                chunk.resize(last);
+
+                // If the chunk is one long word, keep reading.
+                if (!chunk.empty())
+                    queue.Push(std::move(chunk));
+            }
+
+            queue.Close();
+        }
+
+        std::vector<WordCount> Collect() const
+        {
+            std::vector<WordCount> result;
+            result.reserve(m_table.Size());
+            m_table.ForEach([&result](std::string_view w, std::uint64_t n) { result.emplace_back(w, n); });
+            return result;
+        }
+    };
+}
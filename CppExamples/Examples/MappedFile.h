@@ -0,0 +1,464 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <memory> // unique_ptr
+#include <utility> // move, swap
+#include <iterator> // input_iterator_tag
+#include <cstddef> // size_t, ptrdiff_t
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // keep std::min and std::max usable
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#include <sys/mman.h> // mmap, munmap
+#include <sys/stat.h> // fstat
+#endif
+
+/*
+    MappedFile maps a whole file into the address space of the process and exposes its contents
+    as a string_view. Reading through the mapping does not copy the file into a user-mode buffer;
+    the OS virtual memory manager pages the file in on demand from the file system cache.
+
+    The lines and the words of the file are exposed as lazy ranges of string_views pointing into
+    the mapping, so iterating over a file does not allocate memory per line or per word. The
+    string_views are valid as long as the MappedFile exists.
+
+    The resource management follows the unique_handle and map_view_deleter pattern from
+    WindowsExamples/SmartClasses.h (FileMappingDemo):
+    - the file object is held in a unique_handle
+    - the file mapping object (Windows only) is held in a unique_handle
+    - the mapped view is held in a unique_ptr with a custom deleter
+
+    Backends:
+    - Windows: CreateFile, CreateFileMapping, MapViewOfFile, UnmapViewOfFile
+    - POSIX: open, fstat, mmap, munmap
+*/
+namespace FileAndStreamExamples
+{
+    // A minimal version of SmartClassesExamples::unique_handle: a move-only owner of a handle described by a Traits class.
+    template <typename Traits>
+    class unique_handle
+    {
+        typedef typename Traits::pointer pointer;
+
+    public:
+        explicit unique_handle(pointer value = Traits::invalid()) noexcept
+            : m_value{ value }
+        {
+        }
+
+        unique_handle(unique_handle&& other) noexcept
+            : m_value{ other.release() }
+        {
+        }
+
+        unique_handle& operator=(unique_handle&& other) noexcept
+        {
+            if (this != &other)
+                reset(other.release());
+
+            return *this;
+        }
+
+        ~unique_handle() noexcept
+        {
+            close();
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return m_value != Traits::invalid();
+        }
+
+        pointer get() const noexcept
+        {
+            return m_value;
+        }
+
+        pointer release() noexcept
+        {
+            auto value = m_value;
+            m_value = Traits::invalid();
+            return value;
+        }
+
+        bool reset(pointer value = Traits::invalid()) noexcept
+        {
+            if (m_value != value)
+            {
+                close();
+                m_value = value;
+            }
+
+            return static_cast<bool>(*this);
+        }
+
+        unique_handle(unique_handle const &) = delete;
+        unique_handle& operator=(unique_handle const &) = delete;
+
+    private:
+        pointer m_value;
+
+        void close() noexcept
+        {
+            if (*this)
+                Traits::close(m_value);
+        }
+    };
+
+#ifdef _WIN32
+    // CreateFile reports failure with INVALID_HANDLE_VALUE.
+    struct invalid_handle_traits
+    {
+        typedef HANDLE pointer;
+
+        static pointer invalid() noexcept
+        {
+            return INVALID_HANDLE_VALUE;
+        }
+
+        static void close(pointer value) noexcept
+        {
+            CloseHandle(value);
+        }
+    };
+
+    // CreateFileMapping reports failure with a null pointer.
+    struct null_handle_traits
+    {
+        typedef HANDLE pointer;
+
+        static constexpr pointer invalid() noexcept
+        {
+            return nullptr;
+        }
+
+        static void close(pointer value) noexcept
+        {
+            CloseHandle(value);
+        }
+    };
+
+    typedef unique_handle<invalid_handle_traits> file_handle;
+
+    // A deleter used with unique_ptr to unmap a view of a file.
+    struct map_view_deleter
+    {
+        typedef char const * pointer;
+
+        void operator()(pointer value) const noexcept
+        {
+            UnmapViewOfFile(value);
+        }
+    };
+#else
+    // open reports failure with -1.
+    struct file_descriptor_traits
+    {
+        typedef int pointer;
+
+        static constexpr pointer invalid() noexcept
+        {
+            return -1;
+        }
+
+        static void close(pointer value) noexcept
+        {
+            ::close(value);
+        }
+    };
+
+    typedef unique_handle<file_descriptor_traits> file_handle;
+
+    // A deleter used with unique_ptr to unmap a view of a file. Unlike UnmapViewOfFile,
+    // munmap needs the size of the mapping so the deleter keeps it.
+    struct map_view_deleter
+    {
+        typedef char const * pointer;
+
+        std::size_t size = 0;
+
+        void operator()(pointer value) const noexcept
+        {
+            munmap(const_cast<char*>(value), size);
+        }
+    };
+#endif
+
+    // LineRange is a lazy range of lines in a buffer. Lines are separated by '\n'; a trailing '\r' is removed.
+    // Like std::getline, a newline at the end of the buffer does not produce an extra empty line.
+    class LineRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef std::string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::string_view const * pointer;
+            typedef std::string_view const & reference;
+
+            iterator() = default;
+
+            iterator(char const * p, char const * end) : m_next{ p }, m_end{ end }
+            {
+                ++*this;
+            }
+
+            reference operator*() const { return m_line; }
+            pointer operator->() const { return &m_line; }
+
+            iterator& operator++()
+            {
+                if (m_next == m_end)
+                {
+                    m_next = nullptr; // becomes the end iterator
+                    return *this;
+                }
+
+                auto first = m_next;
+                while (m_next != m_end && *m_next != '\n')
+                    ++m_next;
+
+                auto last = m_next;
+                if (last != first && *(last - 1) == '\r')
+                    --last;
+
+                m_line = std::string_view(first, last - first);
+
+                // Skip the '\n'.
+                if (m_next != m_end)
+                    ++m_next;
+
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(iterator const & a, iterator const & b) { return a.m_next == b.m_next; }
+            friend bool operator!=(iterator const & a, iterator const & b) { return a.m_next != b.m_next; }
+
+        private:
+            // The position after the current line; nullptr for the end iterator.
+            char const * m_next = nullptr;
+            char const * m_end = nullptr;
+            std::string_view m_line;
+        };
+
+        explicit LineRange(std::string_view text) : m_text{ text } {}
+
+        iterator begin() const { return iterator(m_text.data(), m_text.data() + m_text.size()); }
+        iterator end() const { return iterator(); }
+
+    private:
+        std::string_view m_text;
+    };
+
+    // WordRange is a lazy range of words in a buffer. Words are separated by whitespaces, as with operator>>.
+    class WordRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef std::string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::string_view const * pointer;
+            typedef std::string_view const & reference;
+
+            iterator() = default;
+
+            iterator(char const * p, char const * end) : m_next{ p }, m_end{ end }
+            {
+                ++*this;
+            }
+
+            reference operator*() const { return m_word; }
+            pointer operator->() const { return &m_word; }
+
+            iterator& operator++()
+            {
+                while (m_next != m_end && IsSpace(*m_next))
+                    ++m_next;
+
+                if (m_next == m_end)
+                {
+                    m_next = nullptr; // becomes the end iterator
+                    return *this;
+                }
+
+                auto first = m_next;
+                while (m_next != m_end && !IsSpace(*m_next))
+                    ++m_next;
+
+                m_word = std::string_view(first, m_next - first);
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(iterator const & a, iterator const & b) { return a.m_next == b.m_next; }
+            friend bool operator!=(iterator const & a, iterator const & b) { return a.m_next != b.m_next; }
+
+        private:
+            // The position after the current word; nullptr for the end iterator.
+            char const * m_next = nullptr;
+            char const * m_end = nullptr;
+            std::string_view m_word;
+
+            // isspace in the "C" locale.
+            static bool IsSpace(char c)
+            {
+                return c == ' ' || (c >= '\t' && c <= '\r');
+            }
+        };
+
+        explicit WordRange(std::string_view text) : m_text{ text } {}
+
+        iterator begin() const { return iterator(m_text.data(), m_text.data() + m_text.size()); }
+        iterator end() const { return iterator(); }
+
+    private:
+        std::string_view m_text;
+    };
+
+    // MappedFile is a read-only memory-mapped file. It is move-only, like the handles it owns.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+
+        // The ctor maps the whole file. Use the explicit Boolean conversion operator to check for failure,
+        // the same way as with ifstream. An empty file is valid and has an empty view.
+        explicit MappedFile(std::string const & filename)
+        {
+            Open(filename);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return m_open;
+        }
+
+        // View returns the contents of the file.
+        std::string_view View() const noexcept
+        {
+            return std::string_view(m_view.get(), m_size);
+        }
+
+        std::size_t Size() const noexcept
+        {
+            return m_size;
+        }
+
+        // Lines returns a lazy range of the lines of the file.
+        LineRange Lines() const noexcept
+        {
+            return LineRange(View());
+        }
+
+        // Words returns a lazy range of the words of the file.
+        WordRange Words() const noexcept
+        {
+            return WordRange(View());
+        }
+
+    private:
+        std::unique_ptr<char const, map_view_deleter> m_view;
+        std::size_t m_size = 0;
+        bool m_open = false;
+
+#ifdef _WIN32
+        void Open(std::string const & filename)
+        {
+            auto file = file_handle
+            {
+                CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr)
+            };
+
+            if (!file)
+                return;
+
+            auto size = LARGE_INTEGER{};
+            if (!GetFileSizeEx(file.get(), &size))
+                return;
+
+            // An empty file cannot be mapped by CreateFileMapping.
+            if (size.QuadPart == 0)
+            {
+                m_open = true;
+                return;
+            }
+
+            auto map = unique_handle<null_handle_traits>
+            {
+                CreateFileMapping(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr)
+            };
+
+            if (!map)
+                return;
+
+            // The view keeps a reference to the file mapping object which keeps a reference
+            // to the file object, so both handles can be closed once the view is mapped.
+            m_view.reset(static_cast<char const *>(MapViewOfFile(map.get(), FILE_MAP_READ, 0, 0, 0)));
+            if (!m_view)
+                return;
+
+            m_size = static_cast<std::size_t>(size.QuadPart);
+            m_open = true;
+        }
+#else
+        void Open(std::string const & filename)
+        {
+            auto file = file_handle{ ::open(filename.c_str(), O_RDONLY) };
+            if (!file)
+                return;
+
+            struct stat st = {};
+            if (fstat(file.get(), &st) != 0)
+                return;
+
+            // mmap fails with EINVAL for a zero-length mapping.
+            if (st.st_size == 0)
+            {
+                m_open = true;
+                return;
+            }
+
+            auto size = static_cast<std::size_t>(st.st_size);
+            auto p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.get(), 0);
+            if (p == MAP_FAILED)
+                return;
+
+            // Tell the kernel that we are going to read the file sequentially so it can read ahead.
+            madvise(p, size, MADV_SEQUENTIAL);
+
+            // The mapping stays valid after the file descriptor is closed.
+            m_view = std::unique_ptr<char const, map_view_deleter>(static_cast<char const *>(p), map_view_deleter{ size });
+            m_size = size;
+            m_open = true;
+        }
+#endif
+    };
+}
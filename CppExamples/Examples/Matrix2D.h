@@ -0,0 +1,262 @@
+#pragma once
+
+#include <vector>
+#include <algorithm> // min, swap
+#include <utility> // move
+#include <cstddef> // size_t
+#include <initializer_list>
+
+/*
+    Matrix2D<T> is a contiguous row-major matrix: all the elements are kept in a single allocation
+    and an element (r,c) is at data[r * cols + c].
+
+    vector<vector<T>> allocates each row separately, so walking down a column chases one pointer
+    per row and the rows end up scattered over the heap. With Matrix2D the rows are adjacent,
+    the address of an element is a multiply-add, and the hardware prefetcher can follow the accesses.
+
+    Matrix2DView<T> is a non-owning view of a rectangular part of a matrix. It has a stride
+    (the distance between the starts of two consecutive rows) so a sub-matrix can be viewed
+    without copying it.
+
+    Rotation and transposition are cache-blocked (tiled): the matrix is processed in Tile x Tile
+    blocks so the rows and columns touched by a block stay in the L1 cache while the block is processed.
+*/
+namespace ContainerExamples
+{
+    // The default tile size. 32x32 ints is 4KB per block; a rotation touches four blocks at a time.
+    const std::size_t MatrixTile = 32;
+
+    template <typename T>
+    class Matrix2DView
+    {
+    public:
+        Matrix2DView(T* data, std::size_t rows, std::size_t cols, std::size_t stride) :
+            m_data{ data }, m_rows{ rows }, m_cols{ cols }, m_stride{ stride }
+        {
+        }
+
+        std::size_t Rows() const { return m_rows; }
+        std::size_t Cols() const { return m_cols; }
+        std::size_t Stride() const { return m_stride; }
+
+        T& operator()(std::size_t r, std::size_t c) const
+        {
+            return m_data[r * m_stride + c];
+        }
+
+        // Row returns a pointer to the first element of a row. The row has Cols() contiguous elements.
+        T* Row(std::size_t r) const
+        {
+            return m_data + r * m_stride;
+        }
+
+        // Sub returns a view of a rectangular part of this view.
+        Matrix2DView Sub(std::size_t row, std::size_t col, std::size_t rows, std::size_t cols) const
+        {
+            return Matrix2DView(m_data + row * m_stride + col, rows, cols, m_stride);
+        }
+
+    private:
+        T* m_data;
+        std::size_t m_rows;
+        std::size_t m_cols;
+        std::size_t m_stride;
+    };
+
+    template <typename T>
+    class Matrix2D
+    {
+    public:
+        Matrix2D() = default;
+
+        Matrix2D(std::size_t rows, std::size_t cols, T const & value = T{}) :
+            m_rows{ rows }, m_cols{ cols }, m_data(rows * cols, value)
+        {
+        }
+
+        // Construct a matrix from nested initializer lists: Matrix2D<int>{ {1,2}, {3,4} }.
+        // All the rows need to have the same length.
+        Matrix2D(std::initializer_list<std::initializer_list<T>> rows) :
+            m_rows{ rows.size() }, m_cols{ rows.size() != 0 ? rows.begin()->size() : 0 }
+        {
+            m_data.reserve(m_rows * m_cols);
+            for (auto const & row : rows)
+            {
+                m_data.insert(m_data.end(), row.begin(), row.end());
+            }
+        }
+
+        std::size_t Rows() const { return m_rows; }
+        std::size_t Cols() const { return m_cols; }
+        std::size_t Size() const { return m_data.size(); }
+
+        T& operator()(std::size_t r, std::size_t c)
+        {
+            return m_data[r * m_cols + c];
+        }
+
+        T const & operator()(std::size_t r, std::size_t c) const
+        {
+            return m_data[r * m_cols + c];
+        }
+
+        T* Data() { return m_data.data(); }
+        T const * Data() const { return m_data.data(); }
+
+        // The whole matrix viewed as Matrix2DView; the stride is the number of columns.
+        Matrix2DView<T> View() { return Matrix2DView<T>(m_data.data(), m_rows, m_cols, m_cols); }
+        Matrix2DView<T const> View() const { return Matrix2DView<T const>(m_data.data(), m_rows, m_cols, m_cols); }
+
+        auto begin() { return m_data.begin(); }
+        auto end() { return m_data.end(); }
+        auto begin() const { return m_data.begin(); }
+        auto end() const { return m_data.end(); }
+
+        friend bool operator==(Matrix2D const & a, Matrix2D const & b)
+        {
+            return a.m_rows == b.m_rows && a.m_cols == b.m_cols && a.m_data == b.m_data;
+        }
+
+        friend bool operator!=(Matrix2D const & a, Matrix2D const & b)
+        {
+            return !(a == b);
+        }
+
+    private:
+        std::size_t m_rows = 0;
+        std::size_t m_cols = 0;
+        std::vector<T> m_data;
+    };
+
+    // TransposeInPlace transposes a square view in a single pass over the blocks on and above the diagonal.
+    // Each block above the diagonal is swapped with its mirror block below the diagonal.
+    template <typename T>
+    void TransposeInPlace(Matrix2DView<T> m, std::size_t tile = MatrixTile)
+    {
+        auto n = m.Rows();
+
+        for (std::size_t ib = 0; ib < n; ib += tile)
+        {
+            for (std::size_t jb = ib; jb < n; jb += tile)
+            {
+                auto iEnd = std::min(ib + tile, n);
+                auto jEnd = std::min(jb + tile, n);
+
+                for (auto i = ib; i < iEnd; ++i)
+                {
+                    // On a diagonal block, swap only the elements above the diagonal.
+                    for (auto j = (ib == jb ? i + 1 : jb); j < jEnd; ++j)
+                        std::swap(m(i, j), m(j, i));
+                }
+            }
+        }
+    }
+
+    // Transpose copies a transposed view into another view of the transposed dimensions.
+    template <typename T, typename U>
+    void Transpose(Matrix2DView<T> src, Matrix2DView<U> dst, std::size_t tile = MatrixTile)
+    {
+        for (std::size_t ib = 0; ib < src.Rows(); ib += tile)
+        {
+            for (std::size_t jb = 0; jb < src.Cols(); jb += tile)
+            {
+                auto iEnd = std::min(ib + tile, src.Rows());
+                auto jEnd = std::min(jb + tile, src.Cols());
+
+                for (auto i = ib; i < iEnd; ++i)
+                    for (auto j = jb; j < jEnd; ++j)
+                        dst(j, i) = src(i, j);
+            }
+        }
+    }
+
+    // RotateClockwiseInPlace rotates a square view by 90 degrees clockwise in a single pass.
+    // Rather than a transpose followed by a reflection (two passes over the whole matrix),
+    // each element of the top-left quadrant is rotated together with its three images (a 4-cycle):
+    // (i,j) <- (n-1-j,i) <- (n-1-i,n-1-j) <- (j,n-1-i) <- (i,j)
+    //
+    // The quadrant is processed in tiles. A tile and its three images are first copied into small
+    // buffers and then written back rotated. The loops are ordered so that every read and write
+    // of the matrix walks along a row; only the buffers, which stay in the L1 cache, are accessed
+    // by columns. Walking the matrix by columns directly is slow, especially when the row size is 
+    // a power of 2 and all the rows of a tile map to the same cache set.
+    template <typename T>
+    void RotateClockwiseInPlace(Matrix2DView<T> m, std::size_t tile = MatrixTile)
+    {
+        auto n = m.Rows();
+        auto rowsEnd = n / 2;         // the quadrant's rows
+        auto colsEnd = (n + 1) / 2;   // the quadrant's columns; for an odd n, the middle column is included and the centre stays put
+
+        // The tile and its images in the tile's coordinates: a[i][j] = m(i,j), b[i][j] = m(n-1-j,i), etc.
+        std::vector<T> a(tile * tile), b(tile * tile), c(tile * tile), d(tile * tile);
+
+        for (std::size_t ib = 0; ib < rowsEnd; ib += tile)
+        {
+            for (std::size_t jb = 0; jb < colsEnd; jb += tile)
+            {
+                auto iEnd = std::min(ib + tile, rowsEnd);
+                auto jEnd = std::min(jb + tile, colsEnd);
+                auto at = [tile, ib, jb](std::size_t i, std::size_t j) { return (i - ib) * tile + (j - jb); };
+
+                // Load.
+                for (auto i = ib; i < iEnd; ++i)
+                    for (auto j = jb; j < jEnd; ++j)
+                        a[at(i, j)] = std::move(m(i, j));
+
+                for (auto j = jb; j < jEnd; ++j)
+                    for (auto i = ib; i < iEnd; ++i)
+                        b[at(i, j)] = std::move(m(n - 1 - j, i));
+
+                for (auto i = ib; i < iEnd; ++i)
+                    for (auto j = jb; j < jEnd; ++j)
+                        c[at(i, j)] = std::move(m(n - 1 - i, n - 1 - j));
+
+                for (auto j = jb; j < jEnd; ++j)
+                    for (auto i = ib; i < iEnd; ++i)
+                        d[at(i, j)] = std::move(m(j, n - 1 - i));
+
+                // Store rotated.
+                for (auto i = ib; i < iEnd; ++i)
+                    for (auto j = jb; j < jEnd; ++j)
+                        m(i, j) = std::move(b[at(i, j)]);
+
+                for (auto j = jb; j < jEnd; ++j)
+                    for (auto i = ib; i < iEnd; ++i)
+                        m(n - 1 - j, i) = std::move(c[at(i, j)]);
+
+                for (auto i = ib; i < iEnd; ++i)
+                    for (auto j = jb; j < jEnd; ++j)
+                        m(n - 1 - i, n - 1 - j) = std::move(d[at(i, j)]);
+
+                for (auto j = jb; j < jEnd; ++j)
+                    for (auto i = ib; i < iEnd; ++i)
+                        m(j, n - 1 - i) = std::move(a[at(i, j)]);
+            }
+        }
+    }
+
+    // RotateClockwise rotates a matrix of any shape by 90 degrees clockwise into a new matrix.
+    // A rows x cols matrix becomes cols x rows. Square matrices can be rotated in place instead.
+    template <typename T>
+    Matrix2D<T> RotateClockwise(Matrix2D<T> const & m, std::size_t tile = MatrixTile)
+    {
+        Matrix2D<T> result(m.Cols(), m.Rows());
+        auto rows = m.Rows();
+
+        // result(j, rows-1-i) = m(i, j)
+        for (std::size_t ib = 0; ib < m.Rows(); ib += tile)
+        {
+            for (std::size_t jb = 0; jb < m.Cols(); jb += tile)
+            {
+                auto iEnd = std::min(ib + tile, m.Rows());
+                auto jEnd = std::min(jb + tile, m.Cols());
+
+                for (auto i = ib; i < iEnd; ++i)
+                    for (auto j = jb; j < jEnd; ++j)
+                        result(j, rows - 1 - i) = m(i, j);
+            }
+        }
+
+        return result;
+    }
+}
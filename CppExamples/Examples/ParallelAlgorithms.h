@@ -0,0 +1,285 @@
+#pragma once
+
+#include <algorithm> // sort, count, remove_if, unique, merge, move
+#include <numeric> // accumulate, reduce
+#include <iterator> // iterator_traits, distance
+#include <functional> // less, plus
+#include <vector>
+#include <cstddef> // size_t
+#include "ThreadPool.h" // Tasks::ThreadPool
+
+// The C++17 parallel algorithms live in <execution>. MSVC implements them with its own thread pool;
+// libstdc++ implements them with Intel TBB (link with -ltbb) and runs them sequentially without it.
+// Define PARALLEL_NO_STD_EXECUTION to use the thread pool backend only.
+#if !defined(PARALLEL_NO_STD_EXECUTION) && defined(__has_include)
+#if __has_include(<execution>)
+#include <execution>
+#endif
+#endif
+
+#if defined(__cpp_lib_execution) && !defined(PARALLEL_NO_STD_EXECUTION)
+#define PARALLEL_STD_EXECUTION 1
+#else
+#define PARALLEL_STD_EXECUTION 0
+#endif
+
+/*
+    Parallel versions of the algorithms used in ContainerAlgorithms: sort, count, reduce, remove_if
+    and unique.
+
+    Each function takes a Backend:
+    - Sequential: the std algorithm.
+    - Par, ParUnseq: the std algorithm with std::execution::par or par_unseq (par_unseq also allows
+      vectorizing the loops). Without <execution> these fall back to Pool.
+    - Pool: the implementations below on a Tasks::ThreadPool (the default pool unless one is given).
+
+    The Pool implementations split the range into chunks, one task each:
+    - Sort sorts the chunks in parallel and then merges pairs of neighbouring chunks, in parallel,
+      until one is left (a merge sort). Each round moves the elements between the range and a buffer.
+    - Count and Reduce compute a result per chunk and combine the chunk results in order, so Reduce
+      gives the same result for the same number of chunks even for non-associative operations such
+      as floating-point addition.
+    - RemoveIf and Unique run the sequential algorithm on each chunk in parallel, then move the kept
+      elements of the chunks together. Unique also drops the first element of a chunk if it equals the
+      last element kept before it.
+*/
+namespace Parallel
+{
+    enum class Backend
+    {
+        Sequential,
+        Par,
+        ParUnseq,
+        Pool
+    };
+
+    inline char const * BackendName(Backend backend)
+    {
+        switch (backend)
+        {
+        case Backend::Par: return PARALLEL_STD_EXECUTION ? "std::execution::par" : "par (pool)";
+        case Backend::ParUnseq: return PARALLEL_STD_EXECUTION ? "std::execution::par_unseq" : "par_unseq (pool)";
+        case Backend::Pool: return "thread pool";
+        default: return "sequential";
+        }
+    }
+
+    // Chunks describes the split of n elements into chunks for a pool.
+    struct Chunks
+    {
+        std::size_t Count;
+        std::size_t Size;
+
+        // At least 64K elements per chunk, so that the tasks are worth scheduling;
+        // up to 4 per thread, so that the work can be balanced by stealing.
+        // A pool of 1 thread gets a single chunk: the sequential algorithm.
+        Chunks(std::size_t n, Tasks::ThreadPool const & pool)
+        {
+            const std::size_t minSize = 64 * 1024;
+            auto threads = pool.ThreadCount();
+            Count = threads == 1 ? 1 : std::max<std::size_t>(1, std::min<std::size_t>(4 * threads, n / minSize));
+            Size = (n + Count - 1) / Count;
+        }
+
+        std::size_t Begin(std::size_t chunk, std::size_t n) const { return std::min(n, chunk * Size); }
+        std::size_t End(std::size_t chunk, std::size_t n) const { return std::min(n, (chunk + 1) * Size); }
+    };
+
+    //
+    // Thread pool implementations
+    //
+
+    template <typename RandomIt, typename Compare>
+    void PoolSort(Tasks::ThreadPool& pool, RandomIt first, RandomIt last, Compare comp)
+    {
+        typedef typename std::iterator_traits<RandomIt>::value_type T;
+
+        auto n = static_cast<std::size_t>(last - first);
+        Chunks chunks(n, pool);
+        if (chunks.Count == 1)
+        {
+            std::sort(first, last, comp);
+            return;
+        }
+
+        pool.ParallelFor(chunks.Count, 1, [&](std::size_t begin, std::size_t end)
+        {
+            for (auto c = begin; c < end; ++c)
+                std::sort(first + chunks.Begin(c, n), first + chunks.End(c, n), comp);
+        });
+
+        // Merge runs of width chunks, doubling the width each round. The data alternates between
+        // the range and the buffer; a run without a partner is moved across as it is.
+        std::vector<T> buffer(n);
+        bool inBuffer = false;
+        for (std::size_t width = 1; width < chunks.Count; width *= 2)
+        {
+            auto pairs = (chunks.Count + 2 * width - 1) / (2 * width);
+            pool.ParallelFor(pairs, 1, [&](std::size_t begin, std::size_t end)
+            {
+                for (auto p = begin; p < end; ++p)
+                {
+                    auto lo = chunks.Begin(2 * p * width, n);
+                    auto mid = chunks.Begin((2 * p + 1) * width, n);
+                    auto hi = chunks.Begin((2 * p + 2) * width, n);
+                    if (inBuffer)
+                        std::merge(std::make_move_iterator(buffer.begin() + lo), std::make_move_iterator(buffer.begin() + mid),
+                            std::make_move_iterator(buffer.begin() + mid), std::make_move_iterator(buffer.begin() + hi), first + lo, comp);
+                    else
+                        std::merge(std::make_move_iterator(first + lo), std::make_move_iterator(first + mid),
+                            std::make_move_iterator(first + mid), std::make_move_iterator(first + hi), buffer.begin() + lo, comp);
+                }
+            });
+            inBuffer = !inBuffer;
+        }
+
+        if (inBuffer)
+        {
+            pool.ParallelFor(n, chunks.Size, [&](std::size_t begin, std::size_t end)
+            {
+                std::move(buffer.begin() + begin, buffer.begin() + end, first + begin);
+            });
+        }
+    }
+
+    // PoolTransformReduce reduces the chunks with chunkResult(begin, end) in parallel and combines
+    // the chunk results from left to right with op.
+    template <typename T, typename ChunkResult, typename Op>
+    T PoolTransformReduce(Tasks::ThreadPool& pool, std::size_t n, T init, ChunkResult chunkResult, Op op)
+    {
+        Chunks chunks(n, pool);
+        std::vector<T> partial(chunks.Count, init);
+        pool.ParallelFor(chunks.Count, 1, [&](std::size_t begin, std::size_t end)
+        {
+            for (auto c = begin; c < end; ++c)
+                partial[c] = chunkResult(chunks.Begin(c, n), chunks.End(c, n));
+        });
+
+        auto result = init;
+        for (auto const & p : partial)
+            result = op(result, p);
+        return result;
+    }
+
+    // PoolCompact runs keep(begin, end) on each chunk in parallel; keep moves the elements to keep to
+    // the front of its chunk and returns how many there are. Then the kept elements are moved together.
+    // If dropFirst(previous, first) is true for the last element kept so far and the first element kept
+    // in a chunk, that element is dropped too.
+    template <typename RandomIt, typename Keep, typename DropFirst>
+    RandomIt PoolCompact(Tasks::ThreadPool& pool, RandomIt first, RandomIt last, Keep keep, DropFirst dropFirst)
+    {
+        auto n = static_cast<std::size_t>(last - first);
+        Chunks chunks(n, pool);
+        std::vector<std::size_t> kept(chunks.Count);
+        pool.ParallelFor(chunks.Count, 1, [&](std::size_t begin, std::size_t end)
+        {
+            for (auto c = begin; c < end; ++c)
+                kept[c] = keep(first + chunks.Begin(c, n), first + chunks.End(c, n));
+        });
+
+        // The kept elements only move towards the front, so moving the chunks in order is safe.
+        auto out = first;
+        for (std::size_t c = 0; c < chunks.Count; ++c)
+        {
+            auto begin = first + chunks.Begin(c, n);
+            auto end = begin + kept[c];
+            if (begin != end && out != first && dropFirst(*(out - 1), *begin))
+                ++begin;
+            out = begin == out ? end : std::move(begin, end, out);
+        }
+        return out;
+    }
+
+    //
+    // Algorithms
+    //
+
+    template <typename RandomIt, typename Compare = std::less<>>
+    void Sort(Backend backend, RandomIt first, RandomIt last, Compare comp = Compare(), Tasks::ThreadPool& pool = Tasks::ThreadPool::Default())
+    {
+        switch (backend)
+        {
+        case Backend::Sequential: std::sort(first, last, comp); return;
+#if PARALLEL_STD_EXECUTION
+        case Backend::Par: std::sort(std::execution::par, first, last, comp); return;
+        case Backend::ParUnseq: std::sort(std::execution::par_unseq, first, last, comp); return;
+#endif
+        default: PoolSort(pool, first, last, comp); return;
+        }
+    }
+
+    template <typename RandomIt, typename T>
+    std::size_t Count(Backend backend, RandomIt first, RandomIt last, T const & value, Tasks::ThreadPool& pool = Tasks::ThreadPool::Default())
+    {
+        switch (backend)
+        {
+        case Backend::Sequential: return std::count(first, last, value);
+#if PARALLEL_STD_EXECUTION
+        case Backend::Par: return std::count(std::execution::par, first, last, value);
+        case Backend::ParUnseq: return std::count(std::execution::par_unseq, first, last, value);
+#endif
+        default:
+            return PoolTransformReduce(pool, static_cast<std::size_t>(last - first), std::size_t{ 0 },
+                [&](std::size_t begin, std::size_t end) { return static_cast<std::size_t>(std::count(first + begin, first + end, value)); },
+                std::plus<std::size_t>());
+        }
+    }
+
+    // Reduce adds up the elements like std::accumulate, in an unspecified order for the std backends.
+    template <typename RandomIt, typename T, typename Op = std::plus<>>
+    T Reduce(Backend backend, RandomIt first, RandomIt last, T init, Op op = Op(), Tasks::ThreadPool& pool = Tasks::ThreadPool::Default())
+    {
+        switch (backend)
+        {
+        case Backend::Sequential: return std::accumulate(first, last, init, op);
+#if PARALLEL_STD_EXECUTION
+        case Backend::Par: return std::reduce(std::execution::par, first, last, init, op);
+        case Backend::ParUnseq: return std::reduce(std::execution::par_unseq, first, last, init, op);
+#endif
+        default:
+            if (first == last)
+                return init;
+
+            // Each chunk starts from the first of its elements, so init is added exactly once.
+            return PoolTransformReduce(pool, static_cast<std::size_t>(last - first), init,
+                [&](std::size_t begin, std::size_t end) { return std::accumulate(first + begin + 1, first + end, T(first[begin]), op); },
+                op);
+        }
+    }
+
+    // RemoveIf is std::remove_if: it returns the new end of the range.
+    template <typename RandomIt, typename Predicate>
+    RandomIt RemoveIf(Backend backend, RandomIt first, RandomIt last, Predicate pred, Tasks::ThreadPool& pool = Tasks::ThreadPool::Default())
+    {
+        switch (backend)
+        {
+        case Backend::Sequential: return std::remove_if(first, last, pred);
+#if PARALLEL_STD_EXECUTION
+        case Backend::Par: return std::remove_if(std::execution::par, first, last, pred);
+        case Backend::ParUnseq: return std::remove_if(std::execution::par_unseq, first, last, pred);
+#endif
+        default:
+            return PoolCompact(pool, first, last,
+                [&](RandomIt begin, RandomIt end) { return static_cast<std::size_t>(std::remove_if(begin, end, pred) - begin); },
+                [](auto const &, auto const &) { return false; });
+        }
+    }
+
+    // Unique is std::unique: it removes consecutive equal elements and returns the new end of the range.
+    template <typename RandomIt>
+    RandomIt Unique(Backend backend, RandomIt first, RandomIt last, Tasks::ThreadPool& pool = Tasks::ThreadPool::Default())
+    {
+        switch (backend)
+        {
+        case Backend::Sequential: return std::unique(first, last);
+#if PARALLEL_STD_EXECUTION
+        case Backend::Par: return std::unique(std::execution::par, first, last);
+        case Backend::ParUnseq: return std::unique(std::execution::par_unseq, first, last);
+#endif
+        default:
+            return PoolCompact(pool, first, last,
+                [](RandomIt begin, RandomIt end) { return static_cast<std::size_t>(std::unique(begin, end) - begin); },
+                [](auto const & previous, auto const & value) { return previous == value; });
+        }
+    }
+}
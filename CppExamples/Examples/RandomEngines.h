@@ -0,0 +1,373 @@
+#pragma once
+
+#include <cstdint> // uint32_t, uint64_t
+#include <cstddef> // size_t
+#include <limits>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/*
+    Random number engines for Monte-Carlo simulations.
+
+    rand() has a few problems:
+    - RAND_MAX is only 32767 with MSVC
+    - rand() % n is biased unless n divides RAND_MAX + 1: small values come up more often
+    - the CRT keeps the state per thread or behind a lock, and the sequence can't be split between threads
+
+    std::mt19937 is a good generator but its state is 2.5KB, it's slow to seed properly, and
+    it has no cheap way to create independent streams for threads.
+
+    The engines below:
+    - SplitMix64 - a tiny generator used to expand a single 64-bit seed into the state of the other engines
+    - Xoshiro256StarStar - a fast general-purpose generator with 256 bits of state (Blackman and Vigna).
+      Jump() advances it by 2^128 steps, so thread k can use the engine jumped k times: the streams
+      never overlap.
+    - Philox4x32 - a counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3").
+      The output is a function of (key, counter): number i of stream s is available directly without
+      generating the numbers before it. That makes parallel results reproducible regardless of
+      how the work is divided between threads.
+    - FloatFiller - eight xoshiro128+ generators run side by side in arrays (structure of arrays),
+      so the compiler can vectorize the loop that fills a buffer with floats.
+
+    All the engines satisfy the UniformRandomBitGenerator requirements, so they work with
+    the <random> distributions too.
+
+    UniformBelow generates an unbiased integer in [0, range) with Lemire's method: a 32x32->64-bit
+    multiplication maps the random number to the range and a rejection, which is rarely needed,
+    removes the bias. There is no division in the common case.
+*/
+namespace RandExamples
+{
+    inline std::uint64_t RotateLeft(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    inline std::uint32_t RotateLeft32(std::uint32_t x, int k)
+    {
+        return (x << k) | (x >> (32 - k));
+    }
+
+    class SplitMix64
+    {
+    public:
+        typedef std::uint64_t result_type;
+
+        explicit SplitMix64(std::uint64_t seed) : m_state{ seed } {}
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()()
+        {
+            std::uint64_t z = (m_state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+    private:
+        std::uint64_t m_state;
+    };
+
+    class Xoshiro256StarStar
+    {
+    public:
+        typedef std::uint64_t result_type;
+
+        explicit Xoshiro256StarStar(std::uint64_t seed = 0)
+        {
+            SplitMix64 sm(seed);
+            for (auto& s : m_state)
+                s = sm();
+        }
+
+        // ForStream returns the engine for stream 'index' of a seed. The streams are 2^128 numbers apart.
+        static Xoshiro256StarStar ForStream(std::uint64_t seed, unsigned index)
+        {
+            Xoshiro256StarStar g(seed);
+            for (unsigned i = 0; i < index; ++i)
+                g.Jump();
+            return g;
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        result_type operator()()
+        {
+            auto& s = m_state;
+            auto result = RotateLeft(s[1] * 5, 7) * 9;
+            auto t = s[1] << 17;
+
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = RotateLeft(s[3], 45);
+
+            return result;
+        }
+
+        // Next32 returns the upper 32 bits, which are the better ones.
+        std::uint32_t Next32()
+        {
+            return static_cast<std::uint32_t>((*this)() >> 32);
+        }
+
+        // Jump advances the engine by 2^128 steps.
+        void Jump()
+        {
+            static const std::uint64_t jump[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+            std::uint64_t s[4] = {};
+            for (auto j : jump)
+            {
+                for (int b = 0; b < 64; ++b)
+                {
+                    if (j & (1ull << b))
+                    {
+                        for (int k = 0; k < 4; ++k)
+                            s[k] ^= m_state[k];
+                    }
+                    (*this)();
+                }
+            }
+
+            for (int k = 0; k < 4; ++k)
+                m_state[k] = s[k];
+        }
+
+    private:
+        std::uint64_t m_state[4];
+    };
+
+    class Philox4x32
+    {
+    public:
+        typedef std::uint32_t result_type;
+
+        // The key is the seed. The stream selects one of 2^64 independent sequences of 2^66 numbers.
+        explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0) :
+            m_key{ static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32) },
+            m_stream{ stream }
+        {
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        // Block computes the four numbers at a given position of the engine's stream.
+        // It does not depend on the state of the engine.
+        void Block(std::uint64_t position, std::uint32_t out[4]) const
+        {
+            std::uint32_t c[4] = {
+                static_cast<std::uint32_t>(position), static_cast<std::uint32_t>(position >> 32),
+                static_cast<std::uint32_t>(m_stream), static_cast<std::uint32_t>(m_stream >> 32) };
+            std::uint32_t k0 = m_key[0], k1 = m_key[1];
+
+            // Philox4x32-10: ten rounds of multiplications whose high and low halves are mixed with the key.
+            for (int round = 0; round < 10; ++round)
+            {
+                auto p0 = static_cast<std::uint64_t>(0xD2511F53u) * c[0];
+                auto p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c[2];
+
+                std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c[1] ^ k0;
+                std::uint32_t n1 = static_cast<std::uint32_t>(p1);
+                std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c[3] ^ k1;
+                std::uint32_t n3 = static_cast<std::uint32_t>(p0);
+                c[0] = n0; c[1] = n1; c[2] = n2; c[3] = n3;
+
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+
+            for (int i = 0; i < 4; ++i)
+                out[i] = c[i];
+        }
+
+        result_type operator()()
+        {
+            if (m_index == 4)
+            {
+                Block(m_position++, m_buffer);
+                m_index = 0;
+            }
+            return m_buffer[m_index++];
+        }
+
+        std::uint32_t Next32()
+        {
+            return (*this)();
+        }
+
+        // Seek moves the engine to number n of its stream in constant time.
+        void Seek(std::uint64_t n)
+        {
+            m_position = n / 4;
+            Block(m_position++, m_buffer);
+            m_index = static_cast<int>(n % 4);
+        }
+
+    private:
+        std::uint32_t m_key[2];
+        std::uint64_t m_stream;
+        std::uint64_t m_position = 0;   // the next block
+        std::uint32_t m_buffer[4] = {};
+        int m_index = 4;                // the next number in the buffer; 4 means the buffer is used up
+    };
+
+    // UniformBelow returns an unbiased random integer in [0, range). The range must not be 0.
+    // The generator needs a Next32 method.
+    template <typename Generator>
+    std::uint32_t UniformBelow(Generator& g, std::uint32_t range)
+    {
+        auto m = static_cast<std::uint64_t>(g.Next32()) * range;
+        auto low = static_cast<std::uint32_t>(m);
+
+        // The products whose low half is below 2^32 mod range would make some results more likely.
+        if (low < range)
+        {
+            auto threshold = static_cast<std::uint32_t>(-range) % range;
+            while (low < threshold)
+            {
+                m = static_cast<std::uint64_t>(g.Next32()) * range;
+                low = static_cast<std::uint32_t>(m);
+            }
+        }
+
+        return static_cast<std::uint32_t>(m >> 32);
+    }
+
+    // UniformInt returns an unbiased random integer in [a, b].
+    template <typename Generator>
+    int UniformInt(Generator& g, int a, int b)
+    {
+        auto range = static_cast<std::uint32_t>(static_cast<std::int64_t>(b) - a + 1);
+        if (range == 0) // [INT_MIN, INT_MAX]
+            return static_cast<int>(g.Next32());
+        return static_cast<int>(a + static_cast<std::int64_t>(UniformBelow(g, range)));
+    }
+
+    // ToUnitFloat maps the upper 24 bits of a random number to a float in [0, 1).
+    // 24 bits is the precision of a float, so all the results are equally likely.
+    inline float ToUnitFloat(std::uint32_t x)
+    {
+        return static_cast<float>(static_cast<std::int32_t>(x >> 8)) * (1.0f / 16777216.0f);
+    }
+
+    // UniformFloat returns a random float in [lo, hi).
+    template <typename Generator>
+    float UniformFloat(Generator& g, float lo, float hi)
+    {
+        return lo + ToUnitFloat(g.Next32()) * (hi - lo);
+    }
+
+    // FloatFiller fills buffers with uniformly distributed floats. It runs eight xoshiro128+ generators
+    // whose states are kept in arrays, one array per state word. The generators don't depend on each other,
+    // so the compiler turns each step of the loop over them into a few SIMD instructions.
+    // xoshiro128+ is meant for floating-point numbers: only its low bits are weak and ToUnitFloat drops them.
+    class FloatFiller
+    {
+    public:
+        static const int Lanes = 8;
+
+        // Each lane is seeded from SplitMix64. Nothing guarantees the lanes are far apart in xoshiro128+'s sequence,
+        // but with a period of 2^128 an overlap is unlikely enough to be ignored.
+        explicit FloatFiller(std::uint64_t seed = 0)
+        {
+            SplitMix64 sm(seed);
+            for (int j = 0; j < Lanes; ++j)
+            {
+                auto a = sm(), b = sm();
+                m_s0[j] = static_cast<std::uint32_t>(a);
+                m_s1[j] = static_cast<std::uint32_t>(a >> 32);
+                m_s2[j] = static_cast<std::uint32_t>(b);
+                m_s3[j] = static_cast<std::uint32_t>(b >> 32);
+            }
+        }
+
+        // Fill writes count floats in [lo, hi).
+        void Fill(float* data, std::size_t count, float lo, float hi)
+        {
+            auto scale = (hi - lo) * (1.0f / 16777216.0f);
+            std::size_t i = 0;
+
+            for (; i + Lanes <= count; i += Lanes)
+            {
+                Step(data + i, lo, scale);
+            }
+
+            if (i < count)
+            {
+                float tail[Lanes];
+                Step(tail, lo, scale);
+                for (std::size_t j = 0; i < count; ++i, ++j)
+                    data[i] = tail[j];
+            }
+        }
+
+    private:
+        std::uint32_t m_s0[Lanes];
+        std::uint32_t m_s1[Lanes];
+        std::uint32_t m_s2[Lanes];
+        std::uint32_t m_s3[Lanes];
+
+        void Step(float* out, float lo, float scale)
+        {
+            for (int j = 0; j < Lanes; ++j)
+            {
+                auto result = m_s0[j] + m_s3[j];
+                auto t = m_s1[j] << 9;
+
+                m_s2[j] ^= m_s0[j];
+                m_s3[j] ^= m_s1[j];
+                m_s1[j] ^= m_s2[j];
+                m_s0[j] ^= m_s3[j];
+                m_s2[j] ^= t;
+                m_s3[j] = RotateLeft32(m_s3[j], 11);
+
+                out[j] = lo + static_cast<float>(static_cast<std::int32_t>(result >> 8)) * scale;
+            }
+        }
+    };
+
+    // ParallelFill fills a buffer with floats in [lo, hi) on multiple threads.
+    // The buffer is divided into fixed blocks and block b is always filled by a FloatFiller seeded
+    // with (seed, b), so the result is the same for any number of threads.
+    inline void ParallelFill(std::uint64_t seed, float* data, std::size_t count, float lo, float hi, unsigned threads = 0)
+    {
+        const std::size_t blockSize = 1 << 16;
+        auto blocks = (count + blockSize - 1) / blockSize;
+
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+        if (threads == 0)
+            threads = 1;
+        if (threads > blocks)
+            threads = static_cast<unsigned>(blocks);
+
+        std::atomic<std::size_t> next{ 0 };
+        auto worker = [&]()
+        {
+            for (auto b = next++; b < blocks; b = next++)
+            {
+                // Mix the block index into the seed so neighbouring blocks get unrelated states.
+                FloatFiller filler(SplitMix64(seed ^ (b * 0x9e3779b97f4a7c15ull))());
+                auto first = b * blockSize;
+                auto n = count - first < blockSize ? count - first : blockSize;
+                filler.Fill(data + first, n, lo, hi);
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned t = 1; t < threads; ++t)
+            pool.emplace_back(worker);
+        worker();
+
+        for (auto& t : pool)
+            t.join();
+    }
+}
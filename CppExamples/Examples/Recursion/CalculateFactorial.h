@@ -1,11 +1,14 @@
 #pragma once
 
 #include <iostream>
+#include "../Sequences.h" // Sequences::FactorialBig
 
 using std::cout;
 using std::endl;
 
-int factorial(int n)
+// 20! is the largest factorial that fits in 64 bits (an int overflows at 13!).
+// Sequences::FactorialBig computes larger ones.
+unsigned long long factorial(unsigned n)
 {
     if (n == 0)
         return 1;
@@ -20,6 +23,8 @@ void CalculateFactorial()
     cout << "7! = " << factorial(7) << endl;
     cout << "10! = " << factorial(10) << endl;
     cout << "13! = " << factorial(13) << endl;
+    cout << "20! = " << factorial(20) << endl;
+    cout << "30! = " << Sequences::FactorialBig(30).ToString() << endl;
 
     cout << endl;
 }
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <iostream>
+#include "../Gcd.h" // Gcd::BinaryGcd
 
 using std::cout;
 using std::endl;
 
+// Each step divides, which is slow. Gcd::BinaryGcd replaces the divisions with shifts and subtractions.
 int gcd(int a, int b)
 {
     if (a % b == 0)
@@ -31,6 +33,8 @@ void CalculateGreatestCommonDivisor()
 
     cout << "GCD(60,45) = " << gcd(60, 45) << endl;
 
+    cout << "Binary GCD(48,18) = " << Gcd::BinaryGcd(48u, 18u) << endl;
+
     cout << endl;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include "../Hanoi.h" // Hanoi::Moves
 
 using std::cout;
 using std::endl;
@@ -22,6 +23,9 @@ using std::endl;
     2 -> 1
     2 -> 3
     1 -> 3
+
+    Each move is printed, so a large tower is bound by the output (and the recursion by the
+    stack depth). Hanoi::Moves generates the same moves iteratively without printing them.
 */
 
 void towerOfHanoi(int num, int source, int dest, int temp)
@@ -47,5 +51,9 @@ void TowerOfHanoi()
 
     towerOfHanoi(num, source, dest, temp);
 
+    // The same moves generated iteratively.
+    for (auto move : Hanoi::Moves(num, source, dest, temp))
+        cout << "disk " << move.Disk << ": " << move.From << " -> " << move.To << endl;
+
     cout << endl;
 }
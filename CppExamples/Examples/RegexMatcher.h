@@ -0,0 +1,432 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <regex>
+#include <memory> // shared_ptr
+#include <unordered_map>
+#include <mutex>
+#include <vector>
+#include <array>
+#include <iterator> // input_iterator_tag
+#include <cstring> // memchr
+#include <cstddef> // size_t, ptrdiff_t
+
+/*
+    A reusable regular expression matcher.
+
+    Constructing a std::regex parses the pattern and builds a state machine. This is expensive,
+    yet it's easy to do it again and again, e.g. in a function that is called for each line of a log.
+    std::smatch::str() then copies every match into a new string.
+
+    The matcher does the following instead:
+    - Compiled patterns are kept in a cache (RegexCache) keyed by the pattern string and the flags,
+      so a pattern is compiled once per process no matter how many times it is requested.
+    - The matches are exposed as string_views into the searched text. Nothing is copied, so the text
+      can be a memory-mapped file (see FileAndStreamExamples::MappedFile).
+    - Simple fixed-length patterns made of digit classes and literal characters, such as a phone
+      number (\d{3})-(\d{4}), are recognized when the matcher is created and are searched with
+      a hand-written scanner instead of std::regex. The scanner uses memchr to jump to the next
+      occurrence of the first literal character and then checks the characters around it.
+      It finds the same matches as std::regex_search.
+
+    Matcher::Search returns a range of matches; the matches don't overlap, as with std::regex_iterator.
+    A Match holds up to MaxGroups string_views: the whole match and the submatches.
+*/
+namespace RegularExpressions
+{
+    // RegexCache is a thread-safe cache of compiled regular expressions.
+    class RegexCache
+    {
+    public:
+        // Get returns the compiled regex for a pattern, compiling it on the first request.
+        // Throws std::regex_error if the pattern is invalid.
+        std::shared_ptr<std::regex const> Get(std::string_view pattern, std::regex::flag_type flags = std::regex::ECMAScript)
+        {
+            auto key = std::string(pattern);
+            key += '\0';
+            key += std::to_string(static_cast<unsigned>(flags));
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_cache.find(key);
+                if (it != m_cache.end())
+                    return it->second;
+            }
+
+            // Compile outside of the lock; if two threads compile the same pattern, the first one wins.
+            auto compiled = std::make_shared<std::regex const>(pattern.begin(), pattern.end(), flags);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_cache.emplace(std::move(key), std::move(compiled)).first->second;
+        }
+
+        std::size_t Size() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_cache.size();
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, std::shared_ptr<std::regex const>> m_cache;
+    };
+
+    // The process-wide cache used by Matcher.
+    inline RegexCache& DefaultRegexCache()
+    {
+        static RegexCache cache;
+        return cache;
+    }
+
+    // DigitPattern is a fixed-length pattern made of digits (\d or \d{n}), literal characters,
+    // and non-nested groups, e.g. (\d{3})-(\d{4}) or \d{4}/\d\d/\d\d.
+    class DigitPattern
+    {
+    public:
+        static const std::size_t MaxGroups = 10;
+
+        // Parse returns false if the pattern uses anything else.
+        bool Parse(std::string_view pattern)
+        {
+            m_elements.clear();
+            m_groups.clear();
+            bool inGroup = false;
+            std::size_t groupStart = 0;
+
+            for (std::size_t i = 0; i < pattern.size(); ++i)
+            {
+                char c = pattern[i];
+                if (c == '(')
+                {
+                    if (inGroup || m_groups.size() + 2 > MaxGroups)
+                        return false;
+                    inGroup = true;
+                    groupStart = m_elements.size();
+                }
+                else if (c == ')')
+                {
+                    if (!inGroup)
+                        return false;
+                    inGroup = false;
+                    m_groups.push_back({ groupStart, m_elements.size() });
+                }
+                else if (c == '\\')
+                {
+                    if (++i == pattern.size())
+                        return false;
+
+                    if (pattern[i] == 'd')
+                    {
+                        std::size_t count = 1;
+                        if (i + 1 < pattern.size() && pattern[i + 1] == '{')
+                        {
+                            auto close = pattern.find('}', i + 2);
+                            if (close == std::string_view::npos || close == i + 2)
+                                return false;
+
+                            count = 0;
+                            for (auto j = i + 2; j < close; ++j)
+                            {
+                                if (pattern[j] < '0' || pattern[j] > '9')
+                                    return false; // {n,m} is not fixed-length
+                                count = count * 10 + (pattern[j] - '0');
+                            }
+                            i = close;
+                        }
+                        m_elements.insert(m_elements.end(), count, Element{ true, 0 });
+                    }
+                    else if (IsMeta(pattern[i]))
+                    {
+                        m_elements.push_back(Element{ false, pattern[i] }); // an escaped metacharacter, e.g. \.
+                    }
+                    else
+                    {
+                        return false; // \w, \s, \b, ...
+                    }
+                }
+                else if (IsMeta(c))
+                {
+                    return false; // quantifiers, alternatives, character classes, anchors
+                }
+                else
+                {
+                    m_elements.push_back(Element{ false, c });
+                }
+
+                // A quantifier after a group would make the length variable.
+                if (c == ')' && i + 1 < pattern.size() && IsQuantifier(pattern[i + 1]))
+                    return false;
+            }
+
+            if (inGroup || m_elements.empty())
+                return false;
+
+            // The first literal character is the anchor the scanner searches for with memchr.
+            m_anchor = m_elements.size();
+            for (std::size_t i = 0; i < m_elements.size(); ++i)
+            {
+                if (!m_elements[i].Digit)
+                {
+                    m_anchor = i;
+                    break;
+                }
+            }
+            return true;
+        }
+
+        std::size_t Length() const { return m_elements.size(); }
+        std::size_t GroupCount() const { return m_groups.size(); }
+
+        // Find returns the position of the first match at or after pos, or npos.
+        std::size_t Find(std::string_view text, std::size_t pos) const
+        {
+            auto length = m_elements.size();
+            if (text.size() < length)
+                return std::string_view::npos;
+
+            auto lastStart = text.size() - length;
+
+            if (m_anchor == length)
+            {
+                // Digits only: try every position.
+                for (auto start = pos; start <= lastStart; ++start)
+                {
+                    if (MatchesAt(text.data() + start))
+                        return start;
+                }
+                return std::string_view::npos;
+            }
+
+            auto literal = m_elements[m_anchor].Literal;
+            for (auto start = pos; start <= lastStart; ++start)
+            {
+                // Jump to the next anchor character. Since the pattern has a fixed length,
+                // the anchors are found in the order of the match positions.
+                auto from = text.data() + start + m_anchor;
+                auto p = static_cast<char const *>(std::memchr(from, literal, lastStart - start + 1));
+                if (p == nullptr)
+                    return std::string_view::npos;
+
+                start = (p - text.data()) - m_anchor;
+                if (MatchesAt(text.data() + start))
+                    return start;
+            }
+            return std::string_view::npos;
+        }
+
+        // Group returns the position and length of a group relative to the start of a match.
+        std::pair<std::size_t, std::size_t> Group(std::size_t index) const
+        {
+            return { m_groups[index].first, m_groups[index].second - m_groups[index].first };
+        }
+
+    private:
+        struct Element
+        {
+            bool Digit;
+            char Literal;
+        };
+
+        std::vector<Element> m_elements;
+        std::vector<std::pair<std::size_t, std::size_t>> m_groups; // [first, last) element indexes
+        std::size_t m_anchor = 0;
+
+        static bool IsMeta(char c)
+        {
+            return std::string_view(R"(\^$.|?*+()[]{})").find(c) != std::string_view::npos;
+        }
+
+        static bool IsQuantifier(char c)
+        {
+            return c == '*' || c == '+' || c == '?' || c == '{';
+        }
+
+        bool MatchesAt(char const * p) const
+        {
+            for (auto const & e : m_elements)
+            {
+                auto c = *p++;
+                if (e.Digit ? (c < '0' || c > '9') : c != e.Literal)
+                    return false;
+            }
+            return true;
+        }
+    };
+
+    // Match is a single match: the whole match and its submatches as string_views into the searched text.
+    // A submatch that did not participate in the match is an empty string_view with a null data pointer.
+    class Match
+    {
+    public:
+        static const std::size_t MaxGroups = DigitPattern::MaxGroups;
+
+        // Size returns the number of submatches including the whole match (index 0).
+        std::size_t Size() const { return m_size; }
+
+        std::string_view operator[](std::size_t i) const { return m_groups[i]; }
+
+        // Position returns the offset of a submatch from the start of the searched text.
+        std::size_t Position(std::size_t i = 0) const { return m_groups[i].data() - m_text; }
+
+    private:
+        friend class Matcher;
+
+        std::array<std::string_view, MaxGroups> m_groups;
+        std::size_t m_size = 0;
+        char const * m_text = nullptr;
+    };
+
+    class Matcher
+    {
+    public:
+        // The ctor gets the compiled pattern from the cache. If the pattern is a DigitPattern,
+        // the matcher uses the scanner and std::regex is never run (but the pattern is still validated).
+        explicit Matcher(std::string_view pattern, bool allowScanner = true, RegexCache& cache = DefaultRegexCache()) :
+            m_regex{ cache.Get(pattern) }
+        {
+            m_useScanner = allowScanner && m_scanner.Parse(pattern);
+        }
+
+        bool UsesScanner() const { return m_useScanner; }
+
+        class iterator
+        {
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef Match value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef Match const * pointer;
+            typedef Match const & reference;
+
+            iterator() = default;
+
+            iterator(Matcher const * matcher, std::string_view text) : m_matcher{ matcher }, m_text{ text }
+            {
+                m_match.m_text = text.data();
+                if (!matcher->m_useScanner)
+                    m_it = std::cregex_iterator(text.data(), text.data() + text.size(), *matcher->m_regex);
+                Next();
+            }
+
+            reference operator*() const { return m_match; }
+            pointer operator->() const { return &m_match; }
+
+            iterator& operator++()
+            {
+                Next();
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            // Two iterators are equal if both are at the end or at the same match.
+            friend bool operator==(iterator const & a, iterator const & b)
+            {
+                return a.m_matcher == b.m_matcher && (a.m_matcher == nullptr || a.m_match[0].data() == b.m_match[0].data());
+            }
+
+            friend bool operator!=(iterator const & a, iterator const & b) { return !(a == b); }
+
+        private:
+            Matcher const * m_matcher = nullptr; // nullptr for the end iterator
+            std::string_view m_text;
+            std::size_t m_next = 0;
+            std::cregex_iterator m_it;
+            bool m_started = false;
+            Match m_match;
+
+            void Next()
+            {
+                if (m_matcher->m_useScanner)
+                    NextScan();
+                else
+                    NextRegex();
+            }
+
+            void NextScan()
+            {
+                auto const & scanner = m_matcher->m_scanner;
+                auto start = scanner.Find(m_text, m_next);
+                if (start == std::string_view::npos)
+                {
+                    m_matcher = nullptr;
+                    return;
+                }
+
+                m_match.m_groups[0] = m_text.substr(start, scanner.Length());
+                m_match.m_size = scanner.GroupCount() + 1;
+                for (std::size_t g = 0; g < scanner.GroupCount(); ++g)
+                {
+                    auto group = scanner.Group(g);
+                    m_match.m_groups[g + 1] = m_text.substr(start + group.first, group.second);
+                }
+                m_next = start + scanner.Length();
+            }
+
+            void NextRegex()
+            {
+                if (m_started)
+                    ++m_it;
+                m_started = true;
+
+                if (m_it == std::cregex_iterator())
+                {
+                    m_matcher = nullptr;
+                    return;
+                }
+
+                auto const & m = *m_it;
+                m_match.m_size = m.size() < Match::MaxGroups ? m.size() : Match::MaxGroups;
+                for (std::size_t g = 0; g < m_match.m_size; ++g)
+                {
+                    m_match.m_groups[g] = m[g].matched
+                        ? std::string_view(m[g].first, m[g].second - m[g].first)
+                        : std::string_view();
+                }
+            }
+        };
+
+        class MatchRange
+        {
+        public:
+            MatchRange(Matcher const * matcher, std::string_view text) : m_matcher{ matcher }, m_text{ text } {}
+
+            iterator begin() const { return iterator(m_matcher, m_text); }
+            iterator end() const { return iterator(); }
+
+        private:
+            Matcher const * m_matcher;
+            std::string_view m_text;
+        };
+
+        // Search returns a lazy range of the non-overlapping matches in a text.
+        // The matcher and the text have to outlive the range.
+        MatchRange Search(std::string_view text) const
+        {
+            return MatchRange(this, text);
+        }
+
+        // Count returns the number of matches in a text.
+        std::size_t Count(std::string_view text) const
+        {
+            std::size_t count = 0;
+            for (auto const & match : Search(text))
+            {
+                (void)match;
+                ++count;
+            }
+            return count;
+        }
+
+    private:
+        std::shared_ptr<std::regex const> m_regex;
+        DigitPattern m_scanner;
+        bool m_useScanner = false;
+    };
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <array>
+#include <algorithm> // reverse, max
+#include <stdexcept> // out_of_range
+#include <cstdint> // uint32_t, uint64_t
+#include <cstddef> // size_t
+
+/*
+    Fibonacci numbers and factorials computed in different ways.
+
+    The algorithm matters much more than micro-optimizations:
+    - FibonacciRecursive follows the definition F(n) = F(n-1) + F(n-2). It calls itself F(n) times, so it's
+      exponential: F(40) takes about a billion calls.
+    - FibonacciMemoized remembers the numbers it has already computed, so each one is computed once: O(n).
+    - FibonacciIterative keeps only the last two numbers: O(n) time and O(1) space.
+    - FibonacciFastDoubling uses the identities
+          F(2k)   = F(k) * (2F(k+1) - F(k))
+          F(2k+1) = F(k+1)^2 + F(k)^2
+      and walks the bits of n from the top, halving the problem at each step: O(log n) multiplications.
+    - FibonacciTable and FactorialTable are computed by the compiler (constexpr), so looking a number up
+      at run time is a single load.
+
+    F(93) and 20! are the largest that fit in 64 bits. The 64-bit functions throw std::out_of_range
+    beyond that instead of overflowing silently. BigUnsigned, a simple arbitrary-precision integer,
+    gives the exact results for any n.
+*/
+namespace Sequences
+{
+    const unsigned MaxFibonacci64 = 93;  // F(93) = 12200160415121876738
+    const unsigned MaxFactorial64 = 20;  // 20! = 2432902008176640000
+
+    //
+    // 64-bit results
+    //
+
+    inline std::uint64_t FibonacciRecursive(unsigned n)
+    {
+        return n < 2 ? n : FibonacciRecursive(n - 1) + FibonacciRecursive(n - 2);
+    }
+
+    // FibonacciMemo caches the numbers computed so far. Reusing the object makes later calls cheap.
+    class FibonacciMemo
+    {
+    public:
+        FibonacciMemo() : m_values{ 0, 1 } {}
+
+        std::uint64_t operator()(unsigned n)
+        {
+            if (n > MaxFibonacci64)
+                throw std::out_of_range("F(n) does not fit in 64 bits for n > 93");
+
+            while (m_values.size() <= n)
+                m_values.push_back(m_values[m_values.size() - 1] + m_values[m_values.size() - 2]);
+            return m_values[n];
+        }
+
+    private:
+        std::vector<std::uint64_t> m_values;
+    };
+
+    inline std::uint64_t FibonacciMemoized(unsigned n)
+    {
+        FibonacciMemo memo;
+        return memo(n);
+    }
+
+    inline std::uint64_t FibonacciIterative(unsigned n)
+    {
+        if (n > MaxFibonacci64)
+            throw std::out_of_range("F(n) does not fit in 64 bits for n > 93");
+
+        std::uint64_t a = 0, b = 1; // F(i), F(i+1)
+        for (unsigned i = 0; i < n; ++i)
+        {
+            auto next = a + b;
+            a = b;
+            b = next;
+        }
+        return a;
+    }
+
+    // HighestBit returns the index of the highest set bit of n, or -1 for 0.
+    inline int HighestBit(unsigned n)
+    {
+        int bit = -1;
+        while (n != 0)
+        {
+            n >>= 1;
+            ++bit;
+        }
+        return bit;
+    }
+
+    inline std::uint64_t FibonacciFastDoubling(unsigned n)
+    {
+        if (n > MaxFibonacci64)
+            throw std::out_of_range("F(n) does not fit in 64 bits for n > 93");
+
+        // (a, b) = (F(k), F(k+1)) where k is the prefix of n's bits processed so far.
+        std::uint64_t a = 0, b = 1;
+        for (int bit = HighestBit(n); bit >= 0; --bit)
+        {
+            // Unsigned arithmetic wraps, so F(k+1) can be computed for k = 93 even though it does not fit:
+            // the final result is still exact.
+            auto c = a * (2 * b - a);   // F(2k)
+            auto d = a * a + b * b;     // F(2k+1)
+
+            if ((n >> bit) & 1)
+            {
+                a = d;
+                b = c + d;
+            }
+            else
+            {
+                a = c;
+                b = d;
+            }
+        }
+        return a;
+    }
+
+    inline std::uint64_t FactorialIterative(unsigned n)
+    {
+        if (n > MaxFactorial64)
+            throw std::out_of_range("n! does not fit in 64 bits for n > 20");
+
+        std::uint64_t result = 1;
+        for (unsigned i = 2; i <= n; ++i)
+            result *= i;
+        return result;
+    }
+
+    //
+    // Compile-time tables
+    //
+
+    constexpr std::array<std::uint64_t, MaxFibonacci64 + 1> MakeFibonacciTable()
+    {
+        std::array<std::uint64_t, MaxFibonacci64 + 1> table{};
+        table[1] = 1;
+        for (std::size_t i = 2; i < table.size(); ++i)
+            table[i] = table[i - 1] + table[i - 2];
+        return table;
+    }
+
+    constexpr std::array<std::uint64_t, MaxFactorial64 + 1> MakeFactorialTable()
+    {
+        std::array<std::uint64_t, MaxFactorial64 + 1> table{};
+        table[0] = 1;
+        for (std::size_t i = 1; i < table.size(); ++i)
+            table[i] = table[i - 1] * i;
+        return table;
+    }
+
+    constexpr auto FibonacciTable = MakeFibonacciTable();
+    constexpr auto FactorialTable = MakeFactorialTable();
+
+    static_assert(FibonacciTable[MaxFibonacci64] == 12200160415121876738ull, "F(93)");
+    static_assert(FactorialTable[MaxFactorial64] == 2432902008176640000ull, "20!");
+
+    //
+    // Arbitrary precision
+    //
+
+    // BigUnsigned is a non-negative integer of any size stored as 32-bit limbs, least significant first.
+    // It has just the operations the sequences need.
+    class BigUnsigned
+    {
+    public:
+        BigUnsigned(std::uint64_t value = 0)
+        {
+            while (value != 0)
+            {
+                m_limbs.push_back(static_cast<std::uint32_t>(value));
+                value >>= 32;
+            }
+        }
+
+        bool IsZero() const { return m_limbs.empty(); }
+
+        friend bool operator==(BigUnsigned const & a, BigUnsigned const & b) { return a.m_limbs == b.m_limbs; }
+        friend bool operator!=(BigUnsigned const & a, BigUnsigned const & b) { return a.m_limbs != b.m_limbs; }
+
+        friend BigUnsigned operator+(BigUnsigned const & a, BigUnsigned const & b)
+        {
+            auto const & longer = a.m_limbs.size() >= b.m_limbs.size() ? a : b;
+            auto const & shorter = a.m_limbs.size() >= b.m_limbs.size() ? b : a;
+
+            BigUnsigned result;
+            result.m_limbs.resize(longer.m_limbs.size() + 1);
+
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i < longer.m_limbs.size(); ++i)
+            {
+                carry += longer.m_limbs[i];
+                if (i < shorter.m_limbs.size())
+                    carry += shorter.m_limbs[i];
+                result.m_limbs[i] = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            result.m_limbs.back() = static_cast<std::uint32_t>(carry);
+            result.Trim();
+            return result;
+        }
+
+        // a - b; a must not be less than b.
+        friend BigUnsigned operator-(BigUnsigned const & a, BigUnsigned const & b)
+        {
+            BigUnsigned result = a;
+            std::int64_t borrow = 0;
+            for (std::size_t i = 0; i < result.m_limbs.size(); ++i)
+            {
+                std::int64_t diff = static_cast<std::int64_t>(result.m_limbs[i]) - borrow - (i < b.m_limbs.size() ? b.m_limbs[i] : 0);
+                borrow = diff < 0 ? 1 : 0;
+                result.m_limbs[i] = static_cast<std::uint32_t>(diff + (borrow << 32));
+            }
+            result.Trim();
+            return result;
+        }
+
+        // Schoolbook multiplication: O(n*m) limb products.
+        friend BigUnsigned operator*(BigUnsigned const & a, BigUnsigned const & b)
+        {
+            if (a.IsZero() || b.IsZero())
+                return BigUnsigned();
+
+            BigUnsigned result;
+            result.m_limbs.assign(a.m_limbs.size() + b.m_limbs.size(), 0);
+
+            for (std::size_t i = 0; i < a.m_limbs.size(); ++i)
+            {
+                std::uint64_t carry = 0;
+                for (std::size_t j = 0; j < b.m_limbs.size(); ++j)
+                {
+                    carry += static_cast<std::uint64_t>(a.m_limbs[i]) * b.m_limbs[j] + result.m_limbs[i + j];
+                    result.m_limbs[i + j] = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+                result.m_limbs[i + b.m_limbs.size()] = static_cast<std::uint32_t>(carry);
+            }
+
+            result.Trim();
+            return result;
+        }
+
+        BigUnsigned& operator*=(std::uint32_t factor)
+        {
+            std::uint64_t carry = 0;
+            for (auto& limb : m_limbs)
+            {
+                carry += static_cast<std::uint64_t>(limb) * factor;
+                limb = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            if (carry != 0)
+                m_limbs.push_back(static_cast<std::uint32_t>(carry));
+            Trim();
+            return *this;
+        }
+
+        // ToString converts to decimal, nine digits at a time (by repeated division by 10^9).
+        std::string ToString() const
+        {
+            if (IsZero())
+                return "0";
+
+            auto limbs = m_limbs;
+            std::string digits;
+            while (!limbs.empty())
+            {
+                std::uint64_t remainder = 0;
+                for (auto i = limbs.size(); i-- > 0;)
+                {
+                    auto current = (remainder << 32) | limbs[i];
+                    limbs[i] = static_cast<std::uint32_t>(current / 1'000'000'000);
+                    remainder = current % 1'000'000'000;
+                }
+                while (!limbs.empty() && limbs.back() == 0)
+                    limbs.pop_back();
+
+                for (int k = 0; k < 9 && (remainder != 0 || !limbs.empty()); ++k)
+                {
+                    digits += static_cast<char>('0' + remainder % 10);
+                    remainder /= 10;
+                }
+            }
+
+            std::reverse(begin(digits), end(digits));
+            return digits;
+        }
+
+    private:
+        std::vector<std::uint32_t> m_limbs;
+
+        void Trim()
+        {
+            while (!m_limbs.empty() && m_limbs.back() == 0)
+                m_limbs.pop_back();
+        }
+    };
+
+    inline BigUnsigned FibonacciBigIterative(unsigned n)
+    {
+        BigUnsigned a = 0, b = 1;
+        for (unsigned i = 0; i < n; ++i)
+        {
+            auto next = a + b;
+            a = std::move(b);
+            b = std::move(next);
+        }
+        return a;
+    }
+
+    inline BigUnsigned FibonacciBig(unsigned n)
+    {
+        BigUnsigned a = 0, b = 1; // F(k), F(k+1)
+        for (int bit = HighestBit(n); bit >= 0; --bit)
+        {
+            auto c = a * (b + b - a);
+            auto d = a * a + b * b;
+
+            if ((n >> bit) & 1)
+            {
+                b = c + d;
+                a = std::move(d);
+            }
+            else
+            {
+                a = std::move(c);
+                b = std::move(d);
+            }
+        }
+        return a;
+    }
+
+    inline BigUnsigned FactorialBig(unsigned n)
+    {
+        BigUnsigned result = 1;
+        for (unsigned i = 2; i <= n; ++i)
+            result *= i;
+        return result;
+    }
+}
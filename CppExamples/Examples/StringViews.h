@@ -0,0 +1,231 @@
+#pragma once
+
+#include <string_view>
+#include <iterator> // forward_iterator_tag
+#include <cstring> // memchr
+#include <cstddef> // size_t, ptrdiff_t
+
+/*
+    Non-allocating string utilities built on std::string_view.
+
+    A string_view is a pointer and a length; trimming or splitting a view only moves the pointer
+    and shrinks the length. Nothing is copied and nothing is allocated, so the utilities can be
+    called for every field of every line of a CSV or config file.
+
+    - IsSpace classifies whitespace with a 256-entry lookup table. isspace is a function call that
+      consults the current locale, and passing it a negative char (e.g. a UTF-8 byte) is undefined behaviour.
+    - TrimView, TrimLeftView and TrimRightView return the part of a view without the leading and/or
+      trailing whitespace.
+    - Split returns a lazy range of the fields separated by a delimiter. Fields are found one at a time
+      while iterating; there is no vector of results. The single-character delimiter is found with memchr,
+      which the C runtime vectorizes, so long fields are scanned many bytes at a time.
+    - SplitWords returns a lazy range of the whitespace-separated words, like repeated operator>>
+      on a stringstream.
+
+    The views point into the original string: they are valid only as long as the string is alive
+    and not modified.
+*/
+namespace StringsExamples
+{
+    // The whitespace characters of the "C" locale.
+    struct SpaceTable
+    {
+        bool Values[256] = {};
+
+        SpaceTable()
+        {
+            for (unsigned char c : { ' ', '\t', '\n', '\v', '\f', '\r' })
+                Values[c] = true;
+        }
+    };
+
+    inline bool IsSpace(char c)
+    {
+        static const SpaceTable table;
+        return table.Values[static_cast<unsigned char>(c)];
+    }
+
+    inline std::string_view TrimLeftView(std::string_view s)
+    {
+        std::size_t i = 0;
+        while (i < s.size() && IsSpace(s[i]))
+            ++i;
+        return s.substr(i);
+    }
+
+    inline std::string_view TrimRightView(std::string_view s)
+    {
+        auto n = s.size();
+        while (n > 0 && IsSpace(s[n - 1]))
+            --n;
+        return s.substr(0, n);
+    }
+
+    // TrimView removes whitespaces from either end of a view. Only the ends are visited;
+    // the characters in the middle are not read.
+    inline std::string_view TrimView(std::string_view s)
+    {
+        return TrimRightView(TrimLeftView(s));
+    }
+
+    // SplitRange is a lazy range of the fields of a string separated by a delimiter character.
+    // "a,,b," gives four fields: "a", "", "b" and "". An empty string gives a single empty field,
+    // like most CSV readers.
+    class SplitRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef std::string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::string_view const * pointer;
+            typedef std::string_view const & reference;
+
+            iterator() = default;
+
+            iterator(char const * p, char const * end, char delimiter) : m_next{ p }, m_end{ end }, m_delimiter{ delimiter }, m_more{ true }
+            {
+                ++*this;
+            }
+
+            reference operator*() const { return m_field; }
+            pointer operator->() const { return &m_field; }
+
+            iterator& operator++()
+            {
+                if (!m_more)
+                {
+                    m_valid = false; // becomes the end iterator
+                    return *this;
+                }
+
+                auto first = m_next;
+                auto found = first != m_end ? static_cast<char const *>(std::memchr(first, m_delimiter, m_end - first)) : nullptr;
+                auto last = found != nullptr ? found : m_end;
+
+                m_field = std::string_view(first, last - first);
+                m_valid = true;
+
+                // A delimiter is always followed by another field, possibly empty.
+                m_more = found != nullptr;
+                if (m_more)
+                    m_next = found + 1;
+
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            // Every field starts at a different position, even an empty one.
+            friend bool operator==(iterator const & a, iterator const & b)
+            {
+                return a.m_valid == b.m_valid && (!a.m_valid || a.m_field.data() == b.m_field.data());
+            }
+
+            friend bool operator!=(iterator const & a, iterator const & b) { return !(a == b); }
+
+        private:
+            char const * m_next = nullptr;  // the start of the next field
+            char const * m_end = nullptr;
+            char m_delimiter = 0;
+            bool m_more = false;            // is there a field after the current one
+            bool m_valid = false;           // false for the end iterator
+            std::string_view m_field;
+        };
+
+        SplitRange(std::string_view s, char delimiter) : m_text{ s }, m_delimiter{ delimiter } {}
+
+        iterator begin() const { return iterator(m_text.data(), m_text.data() + m_text.size(), m_delimiter); }
+        iterator end() const { return iterator(); }
+
+    private:
+        std::string_view m_text;
+        char m_delimiter;
+    };
+
+    inline SplitRange Split(std::string_view s, char delimiter)
+    {
+        return SplitRange(s, delimiter);
+    }
+
+    // WordRange is a lazy range of the whitespace-separated words of a string.
+    // Runs of whitespace count as a single separator and there are no empty words.
+    class WordRange
+    {
+    public:
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef std::string_view value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef std::string_view const * pointer;
+            typedef std::string_view const & reference;
+
+            iterator() = default;
+
+            iterator(char const * p, char const * end) : m_next{ p }, m_end{ end }
+            {
+                ++*this;
+            }
+
+            reference operator*() const { return m_word; }
+            pointer operator->() const { return &m_word; }
+
+            iterator& operator++()
+            {
+                while (m_next != m_end && IsSpace(*m_next))
+                    ++m_next;
+
+                if (m_next == m_end)
+                {
+                    m_next = nullptr; // becomes the end iterator
+                    return *this;
+                }
+
+                auto first = m_next;
+                while (m_next != m_end && !IsSpace(*m_next))
+                    ++m_next;
+
+                m_word = std::string_view(first, m_next - first);
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                auto tmp = *this;
+                ++*this;
+                return tmp;
+            }
+
+            friend bool operator==(iterator const & a, iterator const & b) { return a.m_next == b.m_next; }
+            friend bool operator!=(iterator const & a, iterator const & b) { return a.m_next != b.m_next; }
+
+        private:
+            // The position after the current word; nullptr for the end iterator.
+            char const * m_next = nullptr;
+            char const * m_end = nullptr;
+            std::string_view m_word;
+        };
+
+        explicit WordRange(std::string_view s) : m_text{ s } {}
+
+        iterator begin() const { return iterator(m_text.data(), m_text.data() + m_text.size()); }
+        iterator end() const { return iterator(); }
+
+    private:
+        std::string_view m_text;
+    };
+
+    inline WordRange SplitWords(std::string_view s)
+    {
+        return WordRange(s);
+    }
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <charconv> // to_chars
+#include <type_traits>
+#include <utility> // move
+#include <cstring> // memcpy
+#include <cstddef> // size_t
+
+/*
+    TextBuilder builds a string from pieces without std::ostringstream.
+
+    An ostringstream is convenient, but each insertion goes through the stream's virtual buffer
+    interface, consults the locale (e.g. for the decimal point and the digit grouping), and checks
+    the formatting state set by manipulators such as setprecision. For log formatting that easily
+    costs more than producing the digits.
+
+    TextBuilder:
+    - works in an inline buffer of InlineCapacity characters, so short strings don't allocate at all
+    - when the inline buffer is full, it moves the text into a std::string and doubles its size
+      whenever it runs out of room
+    - converts numbers with std::to_chars, which is locale-independent and does not allocate
+    - formats with small value objects (Fixed, Scientific, Hex) instead of stream state, so formatting
+      one value does not leak into the next one, as std::hex does with cout
+    - can give its heap buffer away: ToString() on an rvalue moves the std::string out instead of copying it
+
+    Usage:
+        TextBuilder<> b;
+        b << "a:" << 1 << ",b:" << Fixed(2.25, 1) << ",c:" << Hex(255);
+        std::string s = std::move(b).ToString(); // a:1,b:2.2,c:ff
+*/
+namespace StringsExamples
+{
+    // Fixed formats a floating-point value with a given number of digits after the decimal point,
+    // like std::fixed with std::setprecision. A non-zero width right-justifies the value with spaces, like std::setw.
+    struct Fixed
+    {
+        double Value;
+        int Precision;
+        int Width;
+
+        Fixed(double value, int precision = 6, int width = 0) : Value{ value }, Precision{ precision }, Width{ width } {}
+    };
+
+    // Scientific formats a floating-point value as d.ddde+xx, like std::scientific with std::setprecision.
+    struct Scientific
+    {
+        double Value;
+        int Precision;
+
+        Scientific(double value, int precision = 6) : Value{ value }, Precision{ precision } {}
+    };
+
+    // Hex formats an unsigned integer in base 16. A non-zero width pads it with leading zeros.
+    struct Hex
+    {
+        unsigned long long Value;
+        int Width;
+        bool Uppercase;
+
+        Hex(unsigned long long value, int width = 0, bool uppercase = false) : Value{ value }, Width{ width }, Uppercase{ uppercase } {}
+    };
+
+    template <std::size_t InlineCapacity = 128>
+    class TextBuilder
+    {
+    public:
+        TextBuilder() = default;
+
+        // TextBuilder holds pointers into its own buffer, so copying would need care. It's not needed.
+        TextBuilder(TextBuilder const &) = delete;
+        TextBuilder& operator=(TextBuilder const &) = delete;
+
+        std::size_t Size() const { return m_size; }
+        bool Empty() const { return m_size == 0; }
+        char const * Data() const { return m_data; }
+
+        std::string_view View() const { return std::string_view(m_data, m_size); }
+
+        void Clear() { m_size = 0; }
+
+        // Reserve makes room for at least count characters.
+        void Reserve(std::size_t count)
+        {
+            if (count > m_capacity)
+                Grow(count);
+        }
+
+        TextBuilder& Append(std::string_view s)
+        {
+            std::memcpy(Extend(s.size()), s.data(), s.size());
+            return *this;
+        }
+
+        TextBuilder& Append(char c)
+        {
+            *Extend(1) = c;
+            return *this;
+        }
+
+        TextBuilder& Append(char c, std::size_t count)
+        {
+            std::memset(Extend(count), c, count);
+            return *this;
+        }
+
+        // Append an integer in base 10.
+        template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value && !std::is_same<T, char>::value, int>::type = 0>
+        TextBuilder& Append(T value)
+        {
+            // 20 digits and a sign is enough for any 64-bit integer.
+            AppendChars(24, [value](char* first, char* last) { return std::to_chars(first, last, value); });
+            return *this;
+        }
+
+        TextBuilder& Append(bool value)
+        {
+            return Append(value ? std::string_view("true") : std::string_view("false"));
+        }
+
+        // Append a floating-point value in the shortest form that converts back to the same value.
+        // Unlike operator<< for streams, there is no default precision of 6 digits: 2.2 is "2.2" and 0.1 + 0.2
+        // is "0.30000000000000004".
+        TextBuilder& Append(double value)
+        {
+            AppendChars(32, [value](char* first, char* last) { return std::to_chars(first, last, value); });
+            return *this;
+        }
+
+        TextBuilder& Append(Fixed f)
+        {
+            // The number of integer digits is not bounded (1e300 has 301), so try a small buffer first.
+            auto start = m_size;
+            AppendChars(static_cast<std::size_t>(f.Precision) + 24, [f](char* first, char* last)
+            {
+                return std::to_chars(first, last, f.Value, std::chars_format::fixed, f.Precision);
+            }, static_cast<std::size_t>(f.Precision) + 330);
+            Justify(start, f.Width);
+            return *this;
+        }
+
+        TextBuilder& Append(Scientific s)
+        {
+            AppendChars(static_cast<std::size_t>(s.Precision) + 16, [s](char* first, char* last)
+            {
+                return std::to_chars(first, last, s.Value, std::chars_format::scientific, s.Precision);
+            });
+            return *this;
+        }
+
+        TextBuilder& Append(Hex h)
+        {
+            char digits[16];
+            auto result = std::to_chars(digits, digits + sizeof(digits), h.Value, 16);
+            auto count = static_cast<std::size_t>(result.ptr - digits);
+
+            if (h.Width > 0 && count < static_cast<std::size_t>(h.Width))
+                Append('0', h.Width - count);
+
+            auto p = Extend(count);
+            for (std::size_t i = 0; i < count; ++i)
+                p[i] = h.Uppercase && digits[i] >= 'a' ? digits[i] - 'a' + 'A' : digits[i];
+            return *this;
+        }
+
+        template <typename T>
+        TextBuilder& operator<<(T const & value)
+        {
+            return Append(value);
+        }
+
+        TextBuilder& operator<<(char const * s)
+        {
+            return Append(std::string_view(s));
+        }
+
+        // ToString copies the text into a new string.
+        std::string ToString() const &
+        {
+            return std::string(m_data, m_size);
+        }
+
+        // ToString on an rvalue (std::move(builder).ToString()) hands the heap buffer over to the string.
+        // The builder is left empty.
+        std::string ToString() &&
+        {
+            if (m_data != m_inline)
+            {
+                m_heap.resize(m_size); // shrinks; does not reallocate
+                auto result = std::move(m_heap);
+                Reset();
+                return result;
+            }
+
+            auto result = std::string(m_data, m_size);
+            m_size = 0;
+            return result;
+        }
+
+    private:
+        char m_inline[InlineCapacity];
+        std::string m_heap;             // the storage once the text does not fit in m_inline
+        char* m_data = m_inline;
+        std::size_t m_size = 0;
+        std::size_t m_capacity = InlineCapacity;
+
+        void Reset()
+        {
+            m_heap = std::string{};
+            m_data = m_inline;
+            m_size = 0;
+            m_capacity = InlineCapacity;
+        }
+
+        void Grow(std::size_t required)
+        {
+            auto capacity = m_capacity * 2;
+            if (capacity < required)
+                capacity = required;
+
+            if (m_data == m_inline)
+            {
+                m_heap.resize(capacity);
+                std::memcpy(&m_heap[0], m_inline, m_size);
+            }
+            else
+            {
+                m_heap.resize(capacity);
+            }
+
+            m_data = &m_heap[0];
+            m_capacity = capacity;
+        }
+
+        // Extend adds count characters at the end and returns a pointer to the first of them.
+        char* Extend(std::size_t count)
+        {
+            if (m_size + count > m_capacity)
+                Grow(m_size + count);
+
+            auto p = m_data + m_size;
+            m_size += count;
+            return p;
+        }
+
+        // AppendChars makes room for reserve characters and calls convert(first, last) which returns a to_chars_result.
+        // If the conversion does not fit, it is retried with room for maxReserve characters.
+        template <typename Convert>
+        void AppendChars(std::size_t reserve, Convert convert, std::size_t maxReserve = 0)
+        {
+            for (;;)
+            {
+                Reserve(m_size + reserve);
+                auto result = convert(m_data + m_size, m_data + m_capacity);
+                if (result.ec == std::errc{})
+                {
+                    m_size = static_cast<std::size_t>(result.ptr - m_data);
+                    return;
+                }
+
+                if (reserve >= maxReserve)
+                    return;
+                reserve = maxReserve;
+            }
+        }
+
+        // Justify right-justifies the text from start to the end in a field of width characters.
+        void Justify(std::size_t start, int width)
+        {
+            auto length = m_size - start;
+            if (width <= 0 || length >= static_cast<std::size_t>(width))
+                return;
+
+            auto padding = static_cast<std::size_t>(width) - length;
+            Extend(padding);
+            std::memmove(m_data + start + padding, m_data + start, length);
+            std::memset(m_data + start, ' ', padding);
+        }
+    };
+}
@@ -14,6 +14,7 @@ namespace Patterns
         Account(int v);
         ~Account();
         int MyMethod();
+        int Value() const;
 
         // moving is ok, copying is not (unless you implement deep copy)
         Account(Account&& otherAccount);
@@ -32,4 +33,7 @@ namespace Patterns
     };
 
     void pImplTest();
+
+    // Compares Account, FastAccount and PooledAccount.
+    void RegisterBenchmarks();
 }
@@ -0,0 +1,89 @@
+#include "FastAccount.h"
+
+#include <iostream>
+#include <new> // placement new, launder
+#include <utility> // move
+
+using std::cout;
+
+using namespace Patterns;
+
+// AccountImpl interface. The same as in Account.cpp.
+class FastAccount::AccountImpl
+{
+public:
+    AccountImpl(int v);
+    int MyMethod();
+    int Value() const;
+
+private:
+    // ... implementation details
+    int m_v;
+};
+
+// AccountImpl implementation.
+FastAccount::AccountImpl::AccountImpl(int v)
+{
+    m_v = v;
+}
+
+int FastAccount::AccountImpl::MyMethod()
+{
+    cout << m_v;
+    return m_v;
+}
+
+int FastAccount::AccountImpl::Value() const
+{
+    return m_v;
+}
+
+// The storage holds an AccountImpl from the constructor to the destructor. std::launder tells
+// the compiler that the bytes of m_storage are now that object.
+FastAccount::AccountImpl& FastAccount::Impl()
+{
+    return *std::launder(reinterpret_cast<AccountImpl*>(m_storage));
+}
+
+FastAccount::AccountImpl const & FastAccount::Impl() const
+{
+    return *std::launder(reinterpret_cast<AccountImpl const *>(m_storage));
+}
+
+// Construct AccountImpl in place: no allocation.
+FastAccount::FastAccount(int v)
+{
+    // If AccountImpl grows, these fail to compile instead of overflowing m_storage.
+    // They are in a member function because AccountImpl and ImplSize are private.
+    static_assert(sizeof(AccountImpl) <= ImplSize, "increase FastAccount::ImplSize");
+    static_assert(alignof(AccountImpl) <= ImplAlignment, "increase FastAccount::ImplAlignment");
+
+    new (m_storage) AccountImpl(v);
+}
+
+FastAccount::~FastAccount()
+{
+    Impl().~AccountImpl();
+}
+
+// Unlike with unique_ptr, the moved-from account still holds an AccountImpl (a moved-from one).
+FastAccount::FastAccount(FastAccount&& otherAccount)
+{
+    new (m_storage) AccountImpl(std::move(otherAccount.Impl()));
+}
+
+FastAccount& FastAccount::operator=(FastAccount&& otherAccount)
+{
+    Impl() = std::move(otherAccount.Impl());
+    return *this;
+}
+
+int FastAccount::MyMethod()
+{
+    return Impl().MyMethod();
+}
+
+int FastAccount::Value() const
+{
+    return Impl().Value();
+}
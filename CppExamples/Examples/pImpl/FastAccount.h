@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef> // size_t
+
+// FastAccount keeps the compilation firewall of Account but stores AccountImpl inside the object
+// instead of on the heap ("fast pImpl"). The header only knows how many bytes the implementation
+// needs; FastAccount.cpp checks that number against the real AccountImpl at compile time.
+//
+// A vector<FastAccount> is one contiguous block, and a call is no longer a dependent pointer load.
+// The price: changing the size of AccountImpl beyond ImplSize means changing this header
+// (and recompiling its users), which is what pImpl set out to avoid.
+
+namespace Patterns
+{
+    class FastAccount
+    {
+    public:
+        FastAccount(int v);
+        ~FastAccount();
+        int MyMethod();
+        int Value() const;
+
+        // moving is ok, copying is not (AccountImpl is moved into the other object's storage)
+        FastAccount(FastAccount&& otherAccount);
+        FastAccount& operator=(FastAccount&& otherAccount);
+
+        FastAccount(FastAccount const &) = delete;
+        FastAccount& operator=(FastAccount const &) = delete;
+
+    private:
+        class AccountImpl;
+
+        AccountImpl& Impl();
+        AccountImpl const & Impl() const;
+
+        // The size and alignment reserved for AccountImpl. Leaving a little room spare means
+        // AccountImpl can grow a bit without touching this header.
+        static const std::size_t ImplSize = 8;
+        static const std::size_t ImplAlignment = 8;
+
+        alignas(ImplAlignment) unsigned char m_storage[ImplSize];
+    };
+}
@@ -0,0 +1,163 @@
+#include "PooledAccount.h"
+
+#include <iostream>
+#include <vector>
+#include <new> // operator new, operator delete
+#include <cstddef> // size_t, max_align_t
+
+using std::cout;
+
+using namespace Patterns;
+
+namespace
+{
+    // SlabPool hands out blocks of one size. It allocates them a slab (many blocks) at a time
+    // and keeps the freed blocks on a free list threaded through the blocks themselves.
+    // The slabs are released with the pool. It is not thread-safe.
+    class SlabPool
+    {
+    public:
+        SlabPool(std::size_t blockSize, std::size_t blocksPerSlab)
+            : m_blockSize{ RoundUp(blockSize < sizeof(void*) ? sizeof(void*) : blockSize) },
+            m_blocksPerSlab{ blocksPerSlab }, m_free{ nullptr }, m_next{ nullptr }, m_end{ nullptr }
+        {
+        }
+
+        SlabPool(SlabPool const &) = delete;
+        SlabPool& operator=(SlabPool const &) = delete;
+
+        void* Allocate()
+        {
+            // Reuse a freed block first.
+            if (m_free != nullptr)
+            {
+                auto block = m_free;
+                m_free = *static_cast<void**>(block);
+                return block;
+            }
+
+            // Then carve the next block off the current slab.
+            if (m_next == m_end)
+            {
+                m_slabs.emplace_back(new unsigned char[m_blockSize * m_blocksPerSlab]);
+                m_next = m_slabs.back().get();
+                m_end = m_next + m_blockSize * m_blocksPerSlab;
+            }
+
+            auto block = m_next;
+            m_next += m_blockSize;
+            return block;
+        }
+
+        void Deallocate(void* block)
+        {
+            *static_cast<void**>(block) = m_free;
+            m_free = block;
+        }
+
+    private:
+        // new[] returns memory aligned for any fundamental type, so blocks of a multiple of that alignment are too.
+        static std::size_t RoundUp(std::size_t size)
+        {
+            const auto alignment = alignof(std::max_align_t);
+            return (size + alignment - 1) / alignment * alignment;
+        }
+
+        std::size_t m_blockSize;
+        std::size_t m_blocksPerSlab;
+        void* m_free;
+        unsigned char* m_next;
+        unsigned char* m_end;
+        std::vector<std::unique_ptr<unsigned char[]>> m_slabs;
+    };
+}
+
+// AccountImpl interface. The same as in Account.cpp plus the class-specific operator new and delete.
+class PooledAccount::AccountImpl
+{
+public:
+    AccountImpl(int v);
+    int MyMethod();
+    int Value() const;
+
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size);
+
+private:
+    // ... implementation details
+    int m_v;
+
+    static SlabPool& Pool();
+};
+
+// AccountImpl implementation.
+PooledAccount::AccountImpl::AccountImpl(int v)
+{
+    m_v = v;
+}
+
+int PooledAccount::AccountImpl::MyMethod()
+{
+    cout << m_v;
+    return m_v;
+}
+
+int PooledAccount::AccountImpl::Value() const
+{
+    return m_v;
+}
+
+SlabPool& PooledAccount::AccountImpl::Pool()
+{
+    // 4096 impls per slab.
+    static SlabPool pool(sizeof(AccountImpl), 4096);
+    return pool;
+}
+
+void* PooledAccount::AccountImpl::operator new(std::size_t size)
+{
+    // A derived class would be bigger than the blocks.
+    if (size != sizeof(AccountImpl))
+        return ::operator new(size);
+    return Pool().Allocate();
+}
+
+void PooledAccount::AccountImpl::operator delete(void* p, std::size_t size)
+{
+    if (p == nullptr)
+        return;
+    if (size != sizeof(AccountImpl))
+        ::operator delete(p);
+    else
+        Pool().Deallocate(p);
+}
+
+// new goes to AccountImpl::operator new.
+PooledAccount::PooledAccount(int v) : pImpl(new PooledAccount::AccountImpl(v))
+{
+}
+
+// The destructor has to be here, where AccountImpl is complete, as in Account.cpp.
+PooledAccount::~PooledAccount()
+{
+}
+
+PooledAccount::PooledAccount(PooledAccount&& otherAccount) : pImpl(std::move(otherAccount.pImpl))
+{
+}
+
+PooledAccount& PooledAccount::operator=(PooledAccount&& otherAccount)
+{
+    pImpl = std::move(otherAccount.pImpl);
+    return *this;
+}
+
+int PooledAccount::MyMethod()
+{
+    return pImpl->MyMethod();
+}
+
+int PooledAccount::Value() const
+{
+    return pImpl->Value();
+}
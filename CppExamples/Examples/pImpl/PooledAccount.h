@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+
+// PooledAccount is Account with the "fast pImpl" of the pImpl notes: AccountImpl overloads
+// operator new and delete to take its objects from a slab pool (see PooledAccount.cpp). The header
+// and the size of PooledAccount are the same as Account's; only the allocation changes.
+//
+// The impls of accounts created one after another sit next to each other in a slab, without
+// the per-allocation overhead of the general heap, and freeing one is pushing it on a free list.
+
+namespace Patterns
+{
+    class PooledAccount
+    {
+    public:
+        PooledAccount(int v);
+        ~PooledAccount();
+        int MyMethod();
+        int Value() const;
+
+        // moving is ok, copying is not (unless you implement deep copy)
+        PooledAccount(PooledAccount&& otherAccount);
+        PooledAccount& operator=(PooledAccount&& otherAccount);
+
+    private:
+        class AccountImpl;
+
+        std::unique_ptr<AccountImpl> pImpl;
+    };
+}
@@ -3,6 +3,15 @@
 #include <iostream>
 #include <stdexcept> // exception classes: exception, invalid_argument, out_of_range, etc.
 #include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <random> // mt19937
+#include <algorithm> // min
+#include <cstdint> // int64_t
+#include "Examples/Expected.h" // Expected, Unexpected, At, Find
+#include "Examples/NumberConversion.h" // StringToInt64, ParseInteger
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -27,12 +36,97 @@ using std::vector;
     - enables faster code, for example a function std::move_if_noexcept() may use it
     - a rule of thumb: mark code as noexcept and remove it when it's not true
     - when code is marked as noexcept but throws an exception, the application is aborted
+
+    Exceptions are for errors that are rare. A throw costs microseconds (see the benchmarks), so an
+    input that is often bad is better reported with a return value: an error code, or an Expected<T, E>
+    that holds the value or the error (Examples/Expected.h).
 */
 
 namespace ExceptionsExamples
 {
     class Book { };
 
+    using ErrorHandling::Expected;
+    using ErrorHandling::Unexpected;
+
+    //
+    // The same parser of a record "count,price" with an exception and with an Expected. The
+    // errors go up two functions to the caller of ParseRecord.
+    //
+    inline std::int64_t ParseNumberOrThrow(std::string_view text)
+    {
+        std::int64_t n = 0;
+        if (ConversionExamples::StringToInt64(text, n) != std::errc())
+            throw std::invalid_argument("not a number");
+        return n;
+    }
+
+    inline std::int64_t ParseFieldOrThrow(std::string_view record, std::size_t& start)
+    {
+        auto end = std::min(record.find(',', start), record.size());
+        auto n = ParseNumberOrThrow(record.substr(start, end - start));
+        start = end + 1;
+        return n;
+    }
+
+    // ParseRecordOrThrow returns count * price.
+    inline std::int64_t ParseRecordOrThrow(std::string_view record)
+    {
+        std::size_t start = 0;
+        auto count = ParseFieldOrThrow(record, start);
+        auto price = ParseFieldOrThrow(record, start);
+        return count * price;
+    }
+
+    inline Expected<std::int64_t, std::errc> ParseField(std::string_view record, std::size_t& start)
+    {
+        auto end = std::min(record.find(',', start), record.size());
+        auto n = ConversionExamples::ParseInteger(record.substr(start, end - start));
+        start = end + 1;
+        return n;
+    }
+
+    // ParseRecord returns count * price, or the error of the first field that isn't a number.
+    inline Expected<std::int64_t, std::errc> ParseRecord(std::string_view record)
+    {
+        std::size_t start = 0;
+        auto count = ParseField(record, start);
+        if (!count)
+            return count;
+        auto price = ParseField(record, start);
+        if (!price)
+            return price;
+        return *count * *price;
+    }
+
+    // Report errors without exceptions.
+    void ExpectedErrors()
+    {
+        auto total = ParseRecord("3,25");
+        auto bad = ParseRecord("3,2x");
+        cout << *total << " " << (bad.Error() == std::errc::invalid_argument) << " "; // 75 1
+
+        // Value() throws for the callers that want an exception.
+        try
+        {
+            cout << bad.Value();
+        }
+        catch (ErrorHandling::BadExpectedAccess& exc)
+        {
+            cout << exc.what() << " "; // Expected has no value
+        }
+
+        // The lookups return an ErrorCode where at() throws.
+        vector<int> v{ 1 };
+        auto missing = ErrorHandling::At(v, 10);
+        cout << (missing.Error() == ErrorHandling::ErrorCode::OutOfRange) << " "; // 1
+
+        std::map<std::string, int> prices{ { "pen", 3 } };
+        if (auto price = ErrorHandling::Find(prices, "pen"))
+            cout << **price << " "; // 3
+        cout << ErrorHandling::Find(prices, "ink").HasValue() << " "; // 0
+    }
+
     void Test()
     {
         // Throw and catch an exception.
@@ -74,5 +168,60 @@ namespace ExceptionsExamples
         {
             cout << "deallocation ";
         }
+
+        ExpectedErrors();
+    }
+
+    // Registers the benchmarks of parsing 100k records with exceptions and with Expected, for 0%, 1%, 10%
+    // and 50% of bad records.
+    void RegisterBenchmarks()
+    {
+        const std::size_t count = 100'000;
+
+        for (int percent : { 0, 1, 10, 50 })
+        {
+            std::mt19937 gen(1);
+            std::vector<std::string> records(count);
+            for (auto& record : records)
+                record = std::to_string(gen() % 100) + "," + std::to_string(gen() % 1000) + (static_cast<int>(gen() % 100) < percent ? "x" : "");
+
+            auto suffix = " 100k records " + std::to_string(percent) + "% bad";
+
+            Benchmark::Register("Exceptions", "throw" + suffix, [records, count](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(count);
+                while (state.KeepRunning())
+                {
+                    std::int64_t sum = 0;
+                    for (auto const & record : records)
+                    {
+                        try
+                        {
+                            sum += ParseRecordOrThrow(record);
+                        }
+                        catch (std::invalid_argument&)
+                        {
+                            --sum;
+                        }
+                    }
+                    Benchmark::DoNotOptimize(sum);
+                }
+            });
+
+            Benchmark::Register("Exceptions", "Expected" + suffix, [records, count](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(count);
+                while (state.KeepRunning())
+                {
+                    std::int64_t sum = 0;
+                    for (auto const & record : records)
+                    {
+                        auto r = ParseRecord(record);
+                        sum += r ? *r : -1;
+                    }
+                    Benchmark::DoNotOptimize(sum);
+                }
+            });
+        }
     }
 }
\ No newline at end of file
@@ -7,6 +7,13 @@
 #include <iomanip> // setprecision
 #include <fstream> // ofstream, ifstream
 #include <sstream> // ostringstream
+#include <map>
+#include "Examples/MappedFile.h" // MappedFile
+#include "Examples/InputReader.h" // InputExamples::InputReader
+#include "Examples/Pipeline.h" // Streaming::Pipeline, Channel, Generator
+#include "Examples/FlatRecords.h" // Records::Write, Records::File
+#include "Containers.h" // ContainerExamples::Book, ContainerExamples::Person
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -25,6 +32,80 @@ namespace FileAndStreamExamples
 {
     const string FILENAME = "test.dat";
 
+    // A generator of the integers in [first, last).
+    Streaming::Generator<int> Integers(int first, int last)
+    {
+        for (int i = first; i < last; ++i)
+            co_yield i;
+    }
+
+    // A pipeline of coroutines: the stages run on the default thread pool, connected by channels
+    // that hold a few items each.
+    void StreamingPipeline()
+    {
+        // The sum of the squares of the even numbers in [1, 10].
+        {
+            Streaming::Pipeline pipeline;
+            auto& numbers = pipeline.MakeChannel<int>(4);
+            auto& evens = pipeline.MakeChannel<int>(4);
+            auto& squares = pipeline.MakeChannel<int>(4);
+            int sum = 0;
+
+            pipeline.Run(Streaming::From(Integers(1, 11), numbers));
+            pipeline.Run(Streaming::Filter(numbers, evens, [](int n) { return n % 2 == 0; }));
+            pipeline.Run(Streaming::Map(evens, squares, [](int n) { return n * n; }));
+            pipeline.Run(Streaming::Aggregate(squares, sum, [](int& s, int n) { s += n; }));
+            pipeline.Wait();
+            cout << sum << " "; // 220
+        }
+
+        // Count the words of the file, read in chunks of 4 bytes: the words split between chunks are
+        // put together again by Tokenize.
+        {
+            ifstream f(FILENAME);
+            Streaming::Pipeline pipeline;
+            auto& chunks = pipeline.MakeChannel<string>(2);
+            auto& batches = pipeline.MakeChannel<Streaming::WordBatch>(2);
+            std::map<string, int> counts;
+
+            pipeline.Run(Streaming::From(Streaming::ReadChunks(f, 4), chunks));
+            pipeline.Run(Streaming::Tokenize(chunks, batches, [](char c) { return c == ' ' || c == '\n'; }));
+            pipeline.Run(Streaming::Aggregate(batches, counts, [](std::map<string, int>& m, Streaming::WordBatch batch)
+            {
+                for (auto word : batch.Words)
+                    ++m[string(word)];
+            }));
+            pipeline.Wait();
+
+            for (auto const & [word, count] : counts)
+                cout << word << ":" << count << ","; // 7.118200:1,A:1,B:2,C:1,D:1,
+            cout << " ";
+        }
+    }
+
+    // Write Books as flat binary records and read them in place from a mapped file: there is no parsing
+    // and no deserialization, and the strings are string_views into the mapping.
+    void BinaryRecords()
+    {
+        using ContainerExamples::Book;
+        using ContainerExamples::Person;
+
+        const string filename = "books.rec";
+        vector<Book> books{ { 10, "X", "A" }, { 20, "Y", "B" }, { 30, "Z", "C" } };
+        {
+            ofstream f(filename, std::ios::binary);
+            Records::Write<Book>(f, books);
+        }
+
+        Records::File<Book> file(filename);
+        for (auto book : file.Records())
+            cout << book.Get<0>() << book.Get<1>() << book.Get<2>() << ","; // 10XA,20YB,30ZC,
+        cout << file.Records()[1].Load().Title << " "; // Y
+
+        // The file records the types of the fields: it can't be read as Persons (a string and an int).
+        cout << static_cast<bool>(Records::File<Person>(filename)) << " "; // 0
+    }
+
     void Test()
     {
         // Create a file and write strings to it.
@@ -79,6 +160,32 @@ namespace FileAndStreamExamples
             cout << " ";
         }
 
+        // Read lines and words from a memory-mapped file. The lines and words are string_views 
+        // pointing into the mapping; no string is allocated per line or per word.
+        {
+            auto f = MappedFile{ FILENAME };
+            if (f)
+            {
+                for (auto line : f.Lines())
+                    cout << line;
+                cout << " ";
+
+                for (auto word : f.Words())
+                    cout << word;
+                cout << " ";
+            }
+        }
+
+        // Read words from a file in blocks with an InputReader. The words are string_views into its buffer.
+        {
+            auto f = ifstream{ FILENAME, std::ios::binary };
+            auto reader = InputExamples::InputReader{ f };
+            std::string_view word;
+            while (reader.NextToken(word))
+                cout << word;
+            cout << " ";
+        }
+
         // Append a float value.
         {
             ofstream f;
@@ -88,5 +195,243 @@ namespace FileAndStreamExamples
 
             f << endl;
         }
+
+        StreamingPipeline();
+        BinaryRecords();
+    }
+
+    // Registers the cases that write and read 10M Books: as text with operator<< and operator>>, and as
+    // flat records. The Books are made before the measurement; each case needs ~1 GB of memory.
+    void RegisterRecordBenchmarks()
+    {
+        using ContainerExamples::Book;
+
+        const std::size_t bookCount = 10'000'000;
+        const string textFile = "books.txt";
+        const string recordFile = "books.rec";
+
+        // The titles and authors have no spaces, so operator>> reads them back.
+        auto makeBooks = [bookCount]()
+        {
+            vector<Book> books(bookCount);
+            for (std::size_t i = 0; i < bookCount; ++i)
+                books[i] = Book{ static_cast<int>(i), "Title" + std::to_string(i), "Author" + std::to_string(i % 1000) };
+            return books;
+        };
+
+        auto writeText = [textFile](vector<Book> const & books)
+        {
+            ofstream f(textFile);
+            for (auto const & b : books)
+                f << b.Id << ' ' << b.Title << ' ' << b.Author << '\n';
+        };
+
+        auto writeRecords = [recordFile](vector<Book> const & books)
+        {
+            ofstream f(recordFile, std::ios::binary);
+            Records::Write<Book>(f, books);
+        };
+
+        Benchmark::Register("FilesAndStreams", "text write 10M books", [=](Benchmark::State& state)
+        {
+            auto books = makeBooks();
+            state.SetItemsPerIteration(bookCount);
+            while (state.KeepRunning())
+                writeText(books);
+        });
+
+        Benchmark::Register("FilesAndStreams", "Records::Write 10M books", [=](Benchmark::State& state)
+        {
+            auto books = makeBooks();
+            state.SetItemsPerIteration(bookCount);
+            while (state.KeepRunning())
+                writeRecords(books);
+        });
+
+        Benchmark::Register("FilesAndStreams", "text read 10M books", [=](Benchmark::State& state)
+        {
+            writeText(makeBooks());
+            state.SetItemsPerIteration(bookCount);
+            while (state.KeepRunning())
+            {
+                ifstream f(textFile);
+                vector<Book> books;
+                books.reserve(bookCount);
+                Book b;
+                while (f >> b.Id >> b.Title >> b.Author)
+                    books.push_back(b);
+                Benchmark::DoNotOptimize(books.data());
+            }
+        });
+
+        Benchmark::Register("FilesAndStreams", "InputReader read 10M books", [=](Benchmark::State& state)
+        {
+            writeText(makeBooks());
+            state.SetItemsPerIteration(bookCount);
+            while (state.KeepRunning())
+            {
+                auto f = ifstream{ textFile, std::ios::binary };
+                auto reader = InputExamples::InputReader{ f };
+                vector<Book> books;
+                books.reserve(bookCount);
+                std::int64_t id;
+                std::string_view title, author;
+                while (reader.NextInt(id) && reader.NextToken(title) && reader.NextToken(author))
+                    books.push_back(Book{ static_cast<int>(id), string(title), string(author) });
+                Benchmark::DoNotOptimize(books.data());
+            }
+        });
+
+        // Reading in place: the sum of the title sizes touches every record and its title.
+        Benchmark::Register("FilesAndStreams", "Records::File read 10M books", [=](Benchmark::State& state)
+        {
+            writeRecords(makeBooks());
+            state.SetItemsPerIteration(bookCount);
+            while (state.KeepRunning())
+            {
+                Records::File<Book> file(recordFile);
+                std::size_t size = 0;
+                for (auto book : file.Records())
+                    size += book.Get<1>().size();
+                Benchmark::DoNotOptimize(size);
+            }
+        });
+
+        Benchmark::Register("FilesAndStreams", "Records::File load 10M books", [=](Benchmark::State& state)
+        {
+            writeRecords(makeBooks());
+            state.SetItemsPerIteration(bookCount);
+            while (state.KeepRunning())
+            {
+                Records::File<Book> file(recordFile);
+                vector<Book> books;
+                books.reserve(bookCount);
+                for (auto book : file.Records())
+                    books.push_back(book.Load());
+                Benchmark::DoNotOptimize(books.data());
+            }
+        });
+    }
+
+    // Registers the benchmark cases of the file examples: counting the lines of a 100k-line file
+    // with getline, MappedFile and InputReader, and its words with operator>>, InputReader and a Streaming pipeline;
+    // writing and reading 10M Books as text and as flat binary records.
+    void RegisterBenchmarks()
+    {
+        const string benchFile = "bench.dat";
+        const int lineCount = 100'000;
+
+        auto writeFile = [benchFile, lineCount]()
+        {
+            ofstream f(benchFile);
+            for (int i = 0; i < lineCount; ++i)
+                f << "line " << i << " of the benchmark file\n";
+        };
+
+        Benchmark::Register("FilesAndStreams", "getline 100k lines", [=](Benchmark::State& state)
+        {
+            writeFile();
+            state.SetItemsPerIteration(lineCount);
+            while (state.KeepRunning())
+            {
+                auto f = ifstream{ benchFile };
+                auto w = string{};
+                int n = 0;
+                while (std::getline(f, w))
+                    ++n;
+                Benchmark::DoNotOptimize(n);
+            }
+        });
+
+        Benchmark::Register("FilesAndStreams", "MappedFile::Lines 100k lines", [=](Benchmark::State& state)
+        {
+            writeFile();
+            state.SetItemsPerIteration(lineCount);
+            while (state.KeepRunning())
+            {
+                auto f = MappedFile{ benchFile };
+                int n = 0;
+                for (auto line : f.Lines())
+                {
+                    Benchmark::DoNotOptimize(line);
+                    ++n;
+                }
+                Benchmark::DoNotOptimize(n);
+            }
+        });
+
+        Benchmark::Register("FilesAndStreams", "InputReader::NextLine 100k lines", [=](Benchmark::State& state)
+        {
+            writeFile();
+            state.SetItemsPerIteration(lineCount);
+            while (state.KeepRunning())
+            {
+                auto f = ifstream{ benchFile, std::ios::binary };
+                auto reader = InputExamples::InputReader{ f };
+                int n = 0;
+                for (auto line : reader.Lines())
+                {
+                    Benchmark::DoNotOptimize(line);
+                    ++n;
+                }
+                Benchmark::DoNotOptimize(n);
+            }
+        });
+
+        const int wordCount = 6 * lineCount;
+
+        Benchmark::Register("FilesAndStreams", "operator>> words 100k lines", [=](Benchmark::State& state)
+        {
+            writeFile();
+            state.SetItemsPerIteration(wordCount);
+            while (state.KeepRunning())
+            {
+                auto f = ifstream{ benchFile };
+                auto w = string{};
+                int n = 0;
+                while (f >> w)
+                    ++n;
+                Benchmark::DoNotOptimize(n);
+            }
+        });
+
+        Benchmark::Register("FilesAndStreams", "InputReader::NextToken words 100k lines", [=](Benchmark::State& state)
+        {
+            writeFile();
+            state.SetItemsPerIteration(wordCount);
+            while (state.KeepRunning())
+            {
+                auto f = ifstream{ benchFile, std::ios::binary };
+                auto reader = InputExamples::InputReader{ f };
+                std::string_view w;
+                int n = 0;
+                while (reader.NextToken(w))
+                    ++n;
+                Benchmark::DoNotOptimize(n);
+            }
+        });
+
+        // The reading and the tokenizing run on the default pool; the words are string_views into 64 KB batches.
+        Benchmark::Register("FilesAndStreams", "Streaming pipeline words 100k lines", [=](Benchmark::State& state)
+        {
+            writeFile();
+            state.SetItemsPerIteration(wordCount);
+            while (state.KeepRunning())
+            {
+                auto f = ifstream{ benchFile, std::ios::binary };
+                Streaming::Pipeline pipeline;
+                auto& chunks = pipeline.MakeChannel<string>(4);
+                auto& batches = pipeline.MakeChannel<Streaming::WordBatch>(4);
+                std::size_t n = 0;
+
+                pipeline.Run(Streaming::From(Streaming::ReadChunks(f, 64 * 1024), chunks));
+                pipeline.Run(Streaming::Tokenize(chunks, batches, [](char c) { return c == ' ' || c == '\n'; }));
+                pipeline.Run(Streaming::Aggregate(batches, n, [](std::size_t& count, Streaming::WordBatch batch) { count += batch.Words.size(); }));
+                pipeline.Wait();
+                Benchmark::DoNotOptimize(n);
+            }
+        });
+
+        RegisterRecordBenchmarks();
     }
 }
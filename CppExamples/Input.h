@@ -2,7 +2,9 @@
 
 #include <iostream>
 #include <string> // getline, strlen
+#include <sstream> // istringstream
 #include <conio.h> // getch()
+#include "Examples/InputReader.h" // InputReader
 
 using std::cout;
 using std::endl;
@@ -55,6 +57,26 @@ namespace InputExamples
         cout << "You entered: " << a << ", " << b << ", " << c << endl;
     }
 
+    // Read numbers, tokens and lines in blocks. InputReader(InputReader::StandardInput) reads stdin;
+    // here it reads a string stream. For std::cin itself, turning off the synchronization with
+    // C stdio gives it a buffer: std::ios::sync_with_stdio(false) before the first input.
+    void ReadInBlocks()
+    {
+        std::istringstream in("3 1.5 abc\nsecond line\r\nthird");
+        InputReader reader(in, 4); // blocks of 4 bytes to show the refills
+
+        std::int64_t n = 0;
+        double d = 0;
+        std::string_view token;
+        if (reader.NextInt(n) && reader.NextDouble(d) && reader.NextToken(token))
+            cout << n << " " << d << " " << token << " "; // 3 1.5 abc
+
+        // The rest of the first line is empty.
+        for (auto line : reader.Lines())
+            cout << "[" << line << "]"; // [][second line][third]
+        cout << " " << reader.Eof() << endl; // 1
+    }
+
     void WaitForKey()
     {
         cout << "Press any key...";
@@ -64,6 +86,7 @@ namespace InputExamples
 
     void Test()
     {
+        ReadInBlocks();
         GetLine();
         GetValues();
         WaitForKey();
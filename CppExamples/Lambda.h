@@ -4,6 +4,11 @@
 #include <string>
 #include <vector>
 #include <functional> // std::function
+#include <memory> // unique_ptr
+#include <stdexcept> // runtime_error
+#include "Examples/Callable.h" // FunctionRef, InplaceFunction
+#include "Examples/ThreadPool.h" // Tasks::ThreadPool, Tasks::TaskGroup
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -148,6 +153,41 @@ namespace LambdaExamples
         SetLambda([](double d) { return d > 0.0; });
     }
 
+    // The same as ReturnLambda, but the lambda is stored inside the returned object.
+    InplaceFunction<int(void)> ReturnInplaceLambda(int x)
+    {
+        return [x]() { return 2 * x; };
+    }
+
+    // A FunctionRef parameter refers to the caller's lambda: nothing is copied or allocated.
+    // The lambda lives until the call returns, which is all SetLambda needs.
+    bool SetLambdaRef(FunctionRef<bool(double)> lambda)
+    {
+        return lambda(1.0);
+    }
+
+    void CallableWrappers()
+    {
+        auto multiplier = ReturnInplaceLambda(3);
+        cout << multiplier() << " "; // 6
+
+        int threshold = 2;
+        cout << SetLambdaRef([threshold](double d) { return d > threshold; }) << " "; // 0
+
+        // A lambda with a move-only capture (see CaptureByMove). std::function needs a copyable callable,
+        // so it can't hold this one.
+        auto p = std::make_unique<string>("c");
+        InplaceFunction<void()> printLine = [item = std::move(p)]() { cout << *item << " "; };
+        auto moved = std::move(printLine); // the unique_ptr moves with the lambda
+        moved(); // c
+        cout << static_cast<bool>(printLine) << " "; // 0
+
+        // 32 bytes of captures: more than std::function stores inline, so it allocates; InplaceFunction doesn't.
+        double a = 1, b = 2, c = 3, d = 4;
+        InplaceFunction<double(), 32> sum = [a, b, c, d]() { return a + b + c + d; };
+        cout << sum() << " "; // 10
+    }
+
     // If the lambda expression is marked as mutable, the copies of captured 
     // variables are not const and the lambda body can modify the local variables.
     void MakeLambdaMutable()
@@ -317,6 +357,151 @@ namespace LambdaExamples
         printLineWithMove();
     }
 
+    // A lambda is a task: ThreadPool::Submit runs it on another thread and returns a future for its
+    // result, and a move-only capture (see CaptureByMove) moves into the task with the lambda.
+    void LambdasAsTasks()
+    {
+        Tasks::ThreadPool pool(2);
+
+        auto p = std::make_unique<string>("task");
+        auto length = pool.Submit([item = std::move(p)]() { return item->size(); });
+        auto doubled = pool.Submit(ReturnLambda(3)); // a std::function is a task too
+        cout << length.get() << " " << doubled.get() << " "; // 4 6
+
+        // An exception thrown by the task is rethrown by get().
+        auto failed = pool.Submit([]() -> int { throw std::runtime_error("failed"); });
+        try
+        {
+            failed.get();
+        }
+        catch (std::runtime_error const & e)
+        {
+            cout << e.what() << " "; // failed
+        }
+
+        // A task group waits for the tasks it ran. The tasks capture by reference, so they must be
+        // done before the variables go out of scope: Wait (or the group's destructor) makes sure.
+        vector<int> results(4);
+        Tasks::TaskGroup group(pool);
+        for (int i = 0; i < 4; ++i)
+            group.Run([&results, i]() { results[i] = i * i; });
+        group.Wait();
+        for (auto n : results)
+            cout << n << ","; // 0,1,4,9,
+        cout << " ";
+    }
+
+    // Registers the benchmarks of the callable wrappers: the cost of a call through std::function,
+    // FunctionRef and InplaceFunction compared with a direct call, and the cost of constructing each
+    // from a lambda with 8 and with 48 bytes of captures.
+    void RegisterBenchmarks()
+    {
+        const int callCount = 1000;
+
+        // The wrapper's address is passed to DoNotOptimize, so the compiler can't see which lambda it calls.
+        Benchmark::Register("Lambda", "call lambda directly", [callCount](Benchmark::State& state)
+        {
+            int k = 3;
+            auto f = [k](int x) { return x * k; };
+            state.SetItemsPerIteration(callCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (int i = 0; i < callCount; ++i)
+                    sum += f(i);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Lambda", "call std::function", [callCount](Benchmark::State& state)
+        {
+            int k = 3;
+            std::function<int(int)> f = [k](int x) { return x * k; };
+            Benchmark::DoNotOptimize(&f);
+            state.SetItemsPerIteration(callCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (int i = 0; i < callCount; ++i)
+                    sum += f(i);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Lambda", "call FunctionRef", [callCount](Benchmark::State& state)
+        {
+            int k = 3;
+            auto lambda = [k](int x) { return x * k; };
+            FunctionRef<int(int)> f = lambda;
+            Benchmark::DoNotOptimize(&f);
+            state.SetItemsPerIteration(callCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (int i = 0; i < callCount; ++i)
+                    sum += f(i);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Lambda", "call InplaceFunction", [callCount](Benchmark::State& state)
+        {
+            int k = 3;
+            InplaceFunction<int(int)> f = [k](int x) { return x * k; };
+            Benchmark::DoNotOptimize(&f);
+            state.SetItemsPerIteration(callCount);
+            while (state.KeepRunning())
+            {
+                int sum = 0;
+                for (int i = 0; i < callCount; ++i)
+                    sum += f(i);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        // Construct a wrapper and call it once. 6 doubles are more than std::function's small buffer.
+        Benchmark::Register("Lambda", "construct std::function 8 bytes", [](Benchmark::State& state)
+        {
+            double a = 1;
+            while (state.KeepRunning())
+            {
+                std::function<double()> f = [a]() { return a; };
+                Benchmark::DoNotOptimize(f());
+            }
+        });
+
+        Benchmark::Register("Lambda", "construct std::function 48 bytes", [](Benchmark::State& state)
+        {
+            double a = 1, b = 2, c = 3, d = 4, e = 5, g = 6;
+            while (state.KeepRunning())
+            {
+                std::function<double()> f = [a, b, c, d, e, g]() { return a + b + c + d + e + g; };
+                Benchmark::DoNotOptimize(f());
+            }
+        });
+
+        Benchmark::Register("Lambda", "construct InplaceFunction 48 bytes", [](Benchmark::State& state)
+        {
+            double a = 1, b = 2, c = 3, d = 4, e = 5, g = 6;
+            while (state.KeepRunning())
+            {
+                InplaceFunction<double(), 48> f = [a, b, c, d, e, g]() { return a + b + c + d + e + g; };
+                Benchmark::DoNotOptimize(f());
+            }
+        });
+
+        Benchmark::Register("Lambda", "construct FunctionRef 48 bytes", [](Benchmark::State& state)
+        {
+            double a = 1, b = 2, c = 3, d = 4, e = 5, g = 6;
+            while (state.KeepRunning())
+            {
+                auto lambda = [a, b, c, d, e, g]() { return a + b + c + d + e + g; };
+                FunctionRef<double()> f = lambda;
+                Benchmark::DoNotOptimize(f());
+            }
+        });
+    }
+
     void Test()
     {
         BasicLambda();
@@ -324,6 +509,7 @@ namespace LambdaExamples
         CaptureVariables();
         SpecifyReturnType();
         ReturnAndSetLambda();
+        CallableWrappers();
         MakeLambdaMutable();
         AccessNonLocalVariables()(); // AccessNonLocalVariables returns a lambda; the second parentheses cause the lambda to execute immediately
         ExecuteImmediately();
@@ -332,5 +518,6 @@ namespace LambdaExamples
         EmulateRecursion();
         UndefinedBehaviour();
         CaptureByMove();
+        LambdasAsTasks();
     }
 }
\ No newline at end of file
@@ -22,107 +22,319 @@
 #include "SmartPointers.h"
 #include "Strings.h"
 #include "Templates.h"
+#include "Examples/pImpl/Account.h"
+#include "Examples/Histogram.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "Sections.h"
+
+#include <cstring> // strcmp, strncmp, strlen
+#include <cstdlib> // atoi
+#include <sstream> // istringstream
+#include <algorithm> // max
+
+// Registers the benchmark cases of all the examples.
+void RegisterBenchmarks()
+{
+    ArraysExamples::RegisterBenchmarks();
+    ChronoExamples::RegisterBenchmarks();
+    ContainerExamples::RegisterBenchmarks();
+    ConversionExamples::RegisterBenchmarks();
+    EnumExamples::RegisterBenchmarks();
+    ExceptionsExamples::RegisterBenchmarks();
+    FileAndStreamExamples::RegisterBenchmarks();
+    Applications::RegisterBenchmarks();
+    LambdaExamples::RegisterBenchmarks();
+    NumbersExamples::RegisterBenchmarks();
+    OperatorOverloadingExamples::RegisterBenchmarks();
+    Patterns::RegisterBenchmarks();
+    RandExamples::RegisterBenchmarks();
+    RegularExpressions::RegisterBenchmarks();
+    SmartPointersExamples::RegisterBenchmarks();
+    StringsExamples::RegisterBenchmarks();
+    TemplatesExamples::RegisterBenchmarks();
+}
+
+// RunBenchmarks runs the registered benchmark cases and prints the results.
+// Command-line options:
+//   --bench                   run the benchmarks instead of the examples
+//   --format=table|csv|json   the output format (table by default)
+//   --filter=text             run only the cases whose "Group/Name" contains the text
+//   --counters                read the hardware counters of each case (PerfCounters.h)
+int RunBenchmarks(int argc, char* argv[])
+{
+    string format = "table";
+    string filter;
+    Benchmark::Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "--format=", 9) == 0)
+            format = argv[i] + 9;
+        else if (strncmp(argv[i], "--filter=", 9) == 0)
+            filter = argv[i] + 9;
+        else if (strcmp(argv[i], "--counters") == 0)
+            options.Counters = true;
+    }
+
+    RegisterBenchmarks();
+    auto results = Benchmark::RunAll(filter, options);
+
+    if (format == "csv")
+        Benchmark::PrintCsv(cout, results);
+    else if (format == "json")
+        Benchmark::PrintJson(cout, results);
+    else
+        Benchmark::PrintTable(cout, results);
+
+    return 0;
+}
+
+// RunHistogramReports prints the reports of the histograms of Examples/Histogram.h, which take a few
+// seconds each: the throughput of each histogram, checked against the reference map, and the accuracy
+// of the streaming top-k against the exact histogram, with the two configurations of StreamingTopK.h.
+int RunHistogramReports()
+{
+    Applications::HistogramThroughput();
+    Applications::HistogramTopKAccuracy(20, 1e-4, 1e-3);
+    Applications::HistogramTopKAccuracy(10, 1e-3, 1e-2);
+    return 0;
+}
+
+// Registers the sections of the examples in the order they are printed. A section that changes the
+// formatting of cout, prints with printf or from other threads, or writes the shared files is not
+// independent (false).
+void RegisterSections()
+{
+    Sections::Register("Arrays", "Arrays", []()
+    {
+        PROFILE_SCOPE("Arrays");
+        ArraysExamples::Test();
+    });
+
+    Sections::Register("AutoDecltypeTypedef", "Auto, Decltype, Typedef (type inference)", []()
+    {
+        PROFILE_SCOPE("Auto, Decltype, Typedef (type inference)");
+        AutoDecltypeExamples::Test();
+        TypedefExamples::Test();
+    });
+
+    Sections::Register("Casting", "Casting", []()
+    {
+        PROFILE_SCOPE("Casting");
+        CastingExamples::StaticCast();
+        CastingExamples::DynamicCast();
+        CastingExamples::ConstCast();
+        CastingExamples::ReinterpretCast();
+    });
+
+    Sections::Register("Chrono", "Chrono", []()
+    {
+        PROFILE_SCOPE("Chrono");
+        ChronoExamples::Test();
+    }, false);
+
+    Sections::Register("Classes", "Classes", []()
+    {
+        PROFILE_SCOPE("Classes");
+        ClassesExamples::Test();
+    }, false);
+
+    Sections::Register("Containers", "Containers", []()
+    {
+        PROFILE_SCOPE("Containers");
+        ContainerExamples::Test();
+    }, false);
+
+    Sections::Register("Conversion", "Conversion", []()
+    {
+        PROFILE_SCOPE("Conversion");
+        ConversionExamples::Test();
+    }, false);
+
+    Sections::Register("Enums", "Enums", []()
+    {
+        PROFILE_SCOPE("Enums");
+        EnumExamples::Test();
+    });
+
+    Sections::Register("Exceptions", "Exceptions", []()
+    {
+        PROFILE_SCOPE("Exceptions");
+        ExceptionsExamples::Test();
+    });
+
+    Sections::Register("FilesAndStreams", "Files & Streams", []()
+    {
+        PROFILE_SCOPE("Files & Streams");
+        FileAndStreamExamples::Test();
+    }, false);
+
+    Sections::Register("Formatting", "Formatting", []()
+    {
+        PROFILE_SCOPE("Formatting");
+        FormattingExamples::Test();
+    }, false);
+
+    Sections::Register("Initialization", "Initialization", []()
+    {
+        PROFILE_SCOPE("Initialization");
+        InitializationExamples::Initialization();
+    });
+
+    //Sections::Register("Input", "Input", []() { InputExamples::Test(); }, false); // interactive
+
+    Sections::Register("Lambda", "Lambda", []()
+    {
+        PROFILE_SCOPE("Lambda");
+        LambdaExamples::Test();
+    }, false);
+
+    Sections::Register("MoveSemantics", "Move semantics", []()
+    {
+        PROFILE_SCOPE("Move semantics");
+        MoveSemanticsExamples::Test();
+    });
+
+    Sections::Register("OperatorOverloading", "Operator overloading", []()
+    {
+        PROFILE_SCOPE("Operator overloading");
+        OperatorOverloadingExamples::Test();
+    });
+
+    Sections::Register("Numbers", "Numbers", []()
+    {
+        PROFILE_SCOPE("Numbers");
+        NumbersExamples::Test();
+    }, false);
+
+    Sections::Register("PointersAndReferences", "Pointers & References", []()
+    {
+        PROFILE_SCOPE("Pointers & References");
+        PointerAndReferenceExamples::Test();
+    });
+
+    Sections::Register("Rand", "Rand", []()
+    {
+        PROFILE_SCOPE("Rand");
+        RandExamples::Test();
+    }, false);
+
+    Sections::Register("RegularExpressions", "Regular expressions", []()
+    {
+        PROFILE_SCOPE("Regular expressions");
+        RegularExpressions::Test();
+    }, false);
+
+    Sections::Register("SmartPointers", "Smart pointers", []()
+    {
+        PROFILE_SCOPE("Smart pointers");
+        SmartPointersExamples::Test();
+    });
+
+    Sections::Register("Strings", "Strings", []()
+    {
+        PROFILE_SCOPE("Strings");
+        StringsExamples::Test();
+    }, false);
+
+    Sections::Register("Templates", "Templates", []()
+    {
+        PROFILE_SCOPE("Templates");
+        TemplatesExamples::Test();
+    }, false);
+}
+
+// SplitNames splits a comma-separated list of section names.
+vector<string> SplitNames(string const & list)
+{
+    vector<string> names;
+    std::istringstream in(list);
+    for (string name; std::getline(in, name, ','); )
+    {
+        if (!name.empty())
+            names.push_back(name);
+    }
+    return names;
+}
 
 //
 // The purpose of this application is to provide examples of C++ and STL features.
+// Run with --bench to measure the examples' benchmark cases instead (see RunBenchmarks), or with
+// --histograms to print the reports of the histograms (see RunHistogramReports).
+// Command-line options of the examples:
+//   --only=Containers,Strings  run only the sections with these names (the names of the headers)
+//   --repeat=N                 run each section N times; prints the times
+//   --parallel                 run the independent sections on a thread each; the outputs are printed in order
+//   --time                     print the time taken by each section
+//   --profile                  print the profile of the sections and write a Chrome trace to profile.json
+// --only and --repeat also take their value as the next argument.
 //
-int main()
+int main(int argc, char* argv[])
 {
-    cout << "*** Arrays ***" << endl;
-    ArraysExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Auto, Decltype, Typedef (type inference) ***" << endl;
-    AutoDecltypeExamples::Test();
-    TypedefExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Casting ***" << endl;
-    CastingExamples::StaticCast();
-    CastingExamples::DynamicCast();
-    CastingExamples::ConstCast();
-    CastingExamples::ReinterpretCast();
-    cout << endl << endl;
-
-    cout << "*** Chrono ***" << endl;
-    ChronoExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Classes ***" << endl;
-    ClassesExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Containers ***" << endl;
-    ContainerExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Conversion ***" << endl;
-    ConversionExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Enums ***" << endl;
-    EnumExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Exceptions ***" << endl;
-    ExceptionsExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Files & Streams ***" << endl;
-    FileAndStreamExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Formatting ***" << endl;
-    FormattingExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Initialization ***" << endl;
-    InitializationExamples::Initialization();
-    cout << endl << endl;
-
-    //cout << "*** Input ***" << endl;
-    //InputExamples::Test();
-    //cout << endl << endl;
-
-    cout << "*** Lambda ***" << endl;
-    LambdaExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Move semantics ***" << endl;
-    MoveSemanticsExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Operator overloading ***" << endl;
-    OperatorOverloadingExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Numbers ***" << endl;
-    NumbersExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Pointers & References ***" << endl;
-    PointerAndReferenceExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Rand ***" << endl;
-    RandExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Regular expressions ***" << endl;
-    RegularExpressions::Test();
-    cout << endl << endl;
-
-    cout << "*** Smart pointers ***" << endl;
-    SmartPointersExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Strings ***" << endl;
-    StringsExamples::Test();
-    cout << endl << endl;
-
-    cout << "*** Templates ***" << endl;
-    TemplatesExamples::Test();
-    cout << endl << endl;
+    bool profile = false;
+    bool times = false;
+    Sections::Options options;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        // The value of --name=value or --name value.
+        auto value = [&](char const * name) -> char const *
+        {
+            auto length = strlen(name);
+            if (strncmp(argv[i], name, length) != 0)
+                return nullptr;
+            if (argv[i][length] == '=')
+                return argv[i] + length + 1;
+            if (argv[i][length] == '\0' && i + 1 < argc)
+                return argv[++i];
+            return nullptr;
+        };
+
+        if (strcmp(argv[i], "--bench") == 0)
+            return RunBenchmarks(argc, argv);
+        if (strcmp(argv[i], "--histograms") == 0)
+            return RunHistogramReports();
+        if (strcmp(argv[i], "--profile") == 0)
+            profile = true;
+        else if (strcmp(argv[i], "--parallel") == 0)
+            options.Parallel = true;
+        else if (strcmp(argv[i], "--time") == 0)
+            times = true;
+        else if (auto only = value("--only"))
+            options.Only = SplitNames(only);
+        else if (auto repeat = value("--repeat"))
+        {
+            options.Repeat = static_cast<unsigned>(std::max(1, atoi(repeat)));
+            times = true;
+        }
+    }
+
+    RegisterSections();
+
+    for (auto const & name : options.Only)
+    {
+        if (Sections::Find(name) == nullptr)
+        {
+            std::cerr << "Unknown section " << name << "; the sections are:";
+            for (auto const & section : Sections::Registry())
+                std::cerr << " " << section.Name;
+            std::cerr << endl;
+            return 1;
+        }
+    }
+
+    auto results = Sections::RunAll(options);
+
+    if (times)
+        Sections::PrintTimes(cout, results);
+
+    // With --profile, print where the time went and save a Chrome trace of the sections.
+    if (profile)
+    {
+        Profiling::PrintReport(cout);
+        Profiling::WriteChromeTrace("profile.json");
+    }
 
     return 0;
 }
@@ -6,6 +6,14 @@
 #include <iomanip>  // setiosflags, setprecision
 #include <limits>   // numeric_limits
 #include <cmath>    // M_PI, M_E, etc.
+#include <numeric>  // gcd
+#include <random>   // mt19937
+#include <vector>
+#include <string>
+#include "Examples/Gcd.h"
+#include "Examples/Sequences.h" // FibonacciTable
+#include "Examples/Recursion/GreatestCommonDivisor.h" // the recursive gcd
+#include "Benchmark.h"
 
 using std::cout;
 using std::endl;
@@ -154,6 +162,28 @@ namespace NumbersExamples
         int n2 = 1'00'0'00'0; // the same as above; the digit separators are ignored
     }
 
+    void GreatestCommonDivisor()
+    {
+        cout << "gcd(48,18)=" << Gcd::BinaryGcd(48u, 18u) << " "; // 6
+        cout << "gcd(-12,18)=" << Gcd::BinaryGcd(std::int64_t{ -12 }, std::int64_t{ 18 }) << " "; // 6
+        cout << "lcm(4,6)=" << Gcd::Lcm(4, 6) << " "; // 12
+
+        // gcd(3 * 2^100, 9 * 2^90) = 3 * 2^90, which is 3 * 2^26 in the high 64 bits.
+        auto g = Gcd::BinaryGcd(Gcd::UInt128(3) << 100, Gcd::UInt128(9) << 90);
+        cout << "gcd(3*2^100,9*2^90)=0x" << std::hex << g.High << std::setfill('0') << setw(16) << g.Low << std::setfill(' ') << std::dec << " "; // 0xc0000000000000000000000
+
+        std::uint64_t values[] = { 84, 126, 210 };
+        cout << "gcd(84,126,210)=" << Gcd::Gcd(values, 3) << " "; // 42
+
+        // 6/8, 10/15, 7/21 -> 3/4, 2/3, 1/3
+        std::uint32_t numerators[] = { 6, 10, 7 };
+        std::uint32_t denominators[] = { 8, 15, 21 };
+        std::uint32_t divisors[3];
+        Gcd::ReduceFractions(numerators, denominators, divisors, 3);
+        for (int i = 0; i < 3; ++i)
+            cout << numerators[i] << "/" << denominators[i] << " "; // 3/4 2/3 1/3
+    }
+
     void Test()
     {
         Size();
@@ -162,5 +192,97 @@ namespace NumbersExamples
         ShowDecimalDigits();
         SwapNumbers();
         UserDefinedLiterals();
+        GreatestCommonDivisor();
+    }
+
+    // GcdInputs returns count pairs of positive numbers below 2^31, so that the recursive int gcd handles them too.
+    // - "random": uniform numbers; most pairs have a small gcd.
+    // - "fractions": both numbers share a random factor, as fractions that need reducing do.
+    // - "fibonacci": consecutive Fibonacci numbers, the worst case for Euclid's algorithm.
+    void GcdInputs(std::string const & distribution, std::vector<std::uint32_t>& a, std::vector<std::uint32_t>& b, std::size_t count)
+    {
+        std::mt19937 gen(1);
+        a.resize(count);
+        b.resize(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (distribution == "fractions")
+            {
+                auto factor = gen() % 1000 + 1;
+                a[i] = (gen() % 1'000'000 + 1) * factor;
+                b[i] = (gen() % 1'000'000 + 1) * factor;
+            }
+            else if (distribution == "fibonacci")
+            {
+                auto n = gen() % 40 + 5;
+                a[i] = static_cast<std::uint32_t>(Sequences::FibonacciTable[n + 1]);
+                b[i] = static_cast<std::uint32_t>(Sequences::FibonacciTable[n]);
+            }
+            else
+            {
+                a[i] = (gen() >> 1) + 1;
+                b[i] = (gen() >> 1) + 1;
+            }
+        }
+    }
+
+    void RegisterBenchmarks()
+    {
+        const std::size_t count = 4096;
+
+        for (std::string distribution : { "random", "fractions", "fibonacci" })
+        {
+            std::vector<std::uint32_t> a, b;
+            GcdInputs(distribution, a, b, count);
+
+            Benchmark::Register("Numbers", "gcd recursive " + distribution, [a, b](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(static_cast<double>(a.size()));
+                while (state.KeepRunning())
+                {
+                    std::uint32_t sum = 0;
+                    for (std::size_t i = 0; i < a.size(); ++i)
+                        sum += gcd(static_cast<int>(a[i]), static_cast<int>(b[i]));
+                    Benchmark::DoNotOptimize(sum);
+                }
+            });
+
+            Benchmark::Register("Numbers", "std::gcd " + distribution, [a, b](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(static_cast<double>(a.size()));
+                while (state.KeepRunning())
+                {
+                    std::uint32_t sum = 0;
+                    for (std::size_t i = 0; i < a.size(); ++i)
+                        sum += std::gcd(a[i], b[i]);
+                    Benchmark::DoNotOptimize(sum);
+                }
+            });
+
+            Benchmark::Register("Numbers", "binary gcd " + distribution, [a, b](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(static_cast<double>(a.size()));
+                while (state.KeepRunning())
+                {
+                    std::uint32_t sum = 0;
+                    for (std::size_t i = 0; i < a.size(); ++i)
+                        sum += Gcd::BinaryGcd(a[i], b[i]);
+                    Benchmark::DoNotOptimize(sum);
+                }
+            });
+
+            auto isa = ByteSearch::ActiveIsa();
+            Benchmark::Register("Numbers", std::string("GcdPairs ") + ByteSearch::IsaName(isa) + " " + distribution, [a, b, isa](Benchmark::State& state)
+            {
+                std::vector<std::uint32_t> result(a.size());
+                state.SetItemsPerIteration(static_cast<double>(a.size()));
+                while (state.KeepRunning())
+                {
+                    Gcd::GcdPairs(a.data(), b.data(), result.data(), a.size(), isa);
+                    Benchmark::DoNotOptimize(result.data());
+                    Benchmark::ClobberMemory();
+                }
+            });
+        }
     }
 }
@@ -2,6 +2,10 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
+#include <random>   // mt19937
+#include "Examples/Vector2DArray.h" // Vector2DArray, Dot, Length, Normalize
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -95,14 +99,14 @@ namespace OperatorOverloadingExamples
         // param ctor 
         Vector2D(float x, float y) : X(x), Y(y) {}
 
-        // copy ctor
-        Vector2D(const Vector2D& v) : X(v.X), Y(v.Y) {}
-
-        // destr    
-        ~Vector2D(void) {}
+        // copy ctor and destr
+        // Defaulted rather than written out, so that Vector2D stays trivially copyable: a vector of
+        // Vector2D can then be copied with memcpy, and the compiler can vectorize loops over it.
+        Vector2D(const Vector2D& v) = default;
+        ~Vector2D(void) = default;
 
         // adding two vectors
-        Vector2D operator+(const Vector2D &v)
+        Vector2D operator+(const Vector2D &v) const
         {
             return Vector2D(X + v.X, Y + v.Y);
         }
@@ -156,9 +160,139 @@ namespace OperatorOverloadingExamples
         cout << "v3=" << v3 << " ";
     }
 
+    // A structure of arrays: the xs of all the vectors in one aligned array and the ys in another.
+    // The operators build an expression that is evaluated in a single loop when it is assigned.
+    void VectorArrayTest()
+    {
+        Vector2DArray a = { { 1.f, 2.f }, { 3.f, 4.f }, { 0.f, 0.f } };
+        Vector2DArray b = { { 1.f, 1.f }, { 2.f, 2.f }, { 5.f, 0.f } };
+
+        // One pass over a and b, no temporary arrays.
+        Vector2DArray r = a + b * 2.f;
+        for (std::size_t i = 0; i < r.size(); ++i)
+            cout << "r" << i << "=" << Vector2D(r.X(i), r.Y(i)) << " "; // r0=(3, 4) r1=(7, 8) r2=(10, 0)
+
+        r += a;
+        r -= 0.5f * b;
+        cout << "r0=" << Vector2D(r.X(0), r.Y(0)) << " "; // r0=(3.5, 5.5)
+
+        std::vector<float> dots(a.size());
+        Dot(a, b, dots.data());
+        cout << "dots=" << dots[0] << "," << dots[1] << "," << dots[2] << " "; // dots=3,14,0
+
+        std::vector<float> lengths(a.size());
+        Length(a, lengths.data());
+        cout << "|a1|=" << lengths[1] << " "; // |a1|=5
+
+        Normalize(a);
+        cout << "a1/|a1|=" << Vector2D(a.X(1), a.Y(1)) << " "; // (0.6, 0.8)
+        cout << "a2/|a2|=" << Vector2D(a.X(2), a.Y(2)) << " "; // (0, 0), zero vectors stay zero
+    }
+
     void Test()
     {
         BookTest();
         VectorTest();
+        VectorArrayTest();
+    }
+
+    void RegisterBenchmarks()
+    {
+        const std::size_t count = 1'000'000;
+
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<float> dist(-100.f, 100.f);
+        std::vector<Vector2D> aos1(count), aos2(count);
+        Vector2DArray soa1(count), soa2(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            aos1[i] = Vector2D(dist(gen), dist(gen));
+            aos2[i] = Vector2D(dist(gen), dist(gen));
+            soa1.Set(i, aos1[i].X, aos1[i].Y);
+            soa2.Set(i, aos2[i].X, aos2[i].Y);
+        }
+
+        Benchmark::Register("OperatorOverloading", "AoS r = a + b * s 1M", [aos1, aos2](Benchmark::State& state)
+        {
+            std::vector<Vector2D> r(aos1.size());
+            state.SetItemsPerIteration(aos1.size());
+            while (state.KeepRunning())
+            {
+                for (std::size_t i = 0; i < r.size(); ++i)
+                    r[i] = aos1[i] + aos2[i] * 1.5f;
+                Benchmark::DoNotOptimize(r.data());
+            }
+        });
+
+        // The same expression evaluated one operator at a time, into a temporary array per operator.
+        Benchmark::Register("OperatorOverloading", "SoA temporaries r = a + b * s 1M", [soa1, soa2](Benchmark::State& state)
+        {
+            Vector2DArray r(soa1.size()), scaled(soa1.size());
+            state.SetItemsPerIteration(soa1.size());
+            while (state.KeepRunning())
+            {
+                scaled = soa2 * 1.5f;
+                r = soa1 + scaled;
+                Benchmark::DoNotOptimize(r.Xs());
+            }
+        });
+
+        const ByteSearch::Isa isas[] = { ByteSearch::Isa::Scalar, ByteSearch::Isa::AVX2 };
+        for (auto isa : isas)
+        {
+            if (isa == ByteSearch::Isa::AVX2 && ByteSearch::ActiveIsa() != ByteSearch::Isa::AVX2)
+                continue;
+            std::string suffix = isa == ByteSearch::Isa::AVX2 ? " AVX2" : " scalar";
+
+            Benchmark::Register("OperatorOverloading", "SoA r = a + b * s 1M" + suffix, [soa1, soa2, isa](Benchmark::State& state)
+            {
+                Vector2DArray r(soa1.size());
+                state.SetItemsPerIteration(soa1.size());
+                while (state.KeepRunning())
+                {
+                    r.Assign(soa1 + soa2 * 1.5f, isa);
+                    Benchmark::DoNotOptimize(r.Xs());
+                }
+            });
+
+            Benchmark::Register("OperatorOverloading", "SoA Dot 1M" + suffix, [soa1, soa2, isa](Benchmark::State& state)
+            {
+                std::vector<float> dots(soa1.size());
+                state.SetItemsPerIteration(soa1.size());
+                while (state.KeepRunning())
+                {
+                    Dot(soa1, soa2, dots.data(), isa);
+                    Benchmark::DoNotOptimize(dots.data());
+                }
+            });
+
+            Benchmark::Register("OperatorOverloading", "SoA Normalize 1M" + suffix, [soa1, isa](Benchmark::State& state)
+            {
+                Vector2DArray v(soa1);
+                state.SetItemsPerIteration(v.size());
+                while (state.KeepRunning())
+                {
+                    // Normalizing unit vectors again costs the same, so v isn't reset.
+                    Normalize(v, isa);
+                    Benchmark::DoNotOptimize(v.Xs());
+                }
+            });
+        }
+
+        Benchmark::Register("OperatorOverloading", "AoS Normalize 1M", [aos1](Benchmark::State& state)
+        {
+            std::vector<Vector2D> v(aos1);
+            state.SetItemsPerIteration(v.size());
+            while (state.KeepRunning())
+            {
+                for (auto& p : v)
+                {
+                    auto length = std::sqrt(p.X * p.X + p.Y * p.Y);
+                    auto inverse = length > 0.0f ? 1.0f / length : 0.0f;
+                    p = p * inverse;
+                }
+                Benchmark::DoNotOptimize(v.data());
+            }
+        });
     }
 }
\ No newline at end of file
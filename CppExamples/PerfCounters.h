@@ -0,0 +1,268 @@
+#pragma once
+
+#include <string>
+#include <sstream> // ostringstream
+#include <iomanip> // setprecision
+#include <utility> // forward
+#include <cstdint> // uint64_t
+#include <cstddef> // size_t
+
+#if defined(__linux__)
+#include <linux/perf_event.h> // perf_event_attr, PERF_*
+#include <sys/ioctl.h> // ioctl
+#include <sys/syscall.h> // SYS_perf_event_open
+#include <unistd.h> // syscall, read, close
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX // keep std::min and std::max usable
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h> // QueryThreadCycleTime
+#endif
+
+/*
+    Hardware performance counters of a region of code.
+
+    The time a loop takes says that it is slow, not why. The CPU counts the events that explain it:
+    the cycles and the instructions retired (instructions per cycle, IPC, is ~3-4 for a loop that
+    runs from L1 and below 0.5 for one that waits for memory), the L1 data cache and last-level cache
+    misses, the data TLB misses (a page walk per access when the accesses are a page apart) and the
+    branch mispredictions (~15-20 cycles each).
+
+    - CounterGroup opens the counters of the calling thread; Start and Stop enable and disable them,
+      Read returns the counts since the last Start. A counter that the system doesn't provide is
+      reported as not available (Counts::Available) instead of failing.
+    - Measure(f) runs f between Start and Stop; a CounterScope reads the counters at the end of a scope.
+    - The Benchmark harness counts the iterations of each case with Options::Counters (--counters) and
+      reports the counts per iteration next to the time.
+
+    On Linux the counters are perf_event_open events of the calling thread in user mode. The CPU has
+    only a few counters (4 to 8 on x86); when more events are open, the kernel rotates them and the
+    counts are scaled by the time each was counted, like perf stat does. With perf_event_paranoid above 2
+    or in a virtual machine without a virtual PMU, no counter is available. On Windows the hardware
+    counters are read only by an ETW kernel session with administrator rights (TracePmcCounterListInfo),
+    which is out of scope here: only the cycles are available, from QueryThreadCycleTime.
+
+    The counters count the calling thread only; the worker threads of a parallel case aren't included.
+
+    Summing 4096 x 4096 ints (64 MB) (Arrays and Containers benchmarks): by rows ~10 ms, by columns
+    ~165 ms; by columns in a vector<vector<int>> ~130 ms and in a Matrix2D<int> ~175 ms. The contiguous
+    matrix is the slower one there because its rows are exactly 16 KB apart, so a column falls into a
+    few sets of the L1 and L2 caches; the heap puts a header between the rows of a vector<vector<int>>.
+    The times are from a virtual machine without a PMU, where no counter could be read.
+*/
+namespace PerfCounters
+{
+    enum class Event
+    {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        DTLBMisses,
+        BranchMisses
+    };
+
+    const std::size_t EventCount = 6;
+
+    // EventName returns a short name of an event for the reports.
+    inline char const * EventName(Event event)
+    {
+        static char const * const names[EventCount] = { "cycles", "instructions", "L1d misses", "LLC misses", "dTLB misses", "branch misses" };
+        return names[static_cast<std::size_t>(event)];
+    }
+
+    // Counts holds a count per event and whether it was counted.
+    struct Counts
+    {
+        double Values[EventCount] = {};
+        bool Available[EventCount] = {};
+
+        double operator[](Event event) const { return Values[static_cast<std::size_t>(event)]; }
+        bool Has(Event event) const { return Available[static_cast<std::size_t>(event)]; }
+
+        bool Any() const
+        {
+            for (auto available : Available)
+            {
+                if (available)
+                    return true;
+            }
+            return false;
+        }
+
+        // Per divides the counts by a number of iterations (or items).
+        Counts Per(double n) const
+        {
+            Counts result = *this;
+            for (auto& value : result.Values)
+                value = n > 0 ? value / n : 0;
+            return result;
+        }
+    };
+
+    // CounterGroup is the set of counters of the calling thread. It is not copyable: it owns the counters.
+    class CounterGroup
+    {
+    public:
+        CounterGroup()
+        {
+#if defined(__linux__)
+            struct Config { std::uint32_t Type; std::uint64_t Value; };
+            const Config configs[EventCount] =
+            {
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+                { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+                { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+            };
+
+            for (std::size_t i = 0; i < EventCount; ++i)
+            {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = configs[i].Type;
+                attr.config = configs[i].Value;
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                // pid 0 and cpu -1: the calling thread on any CPU.
+                m_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        CounterGroup(CounterGroup const &) = delete;
+        CounterGroup& operator=(CounterGroup const &) = delete;
+
+        ~CounterGroup()
+        {
+#if defined(__linux__)
+            for (auto fd : m_fds)
+            {
+                if (fd >= 0)
+                    close(fd);
+            }
+#endif
+        }
+
+        // Start resets the counters and starts counting.
+        void Start()
+        {
+#if defined(__linux__)
+            for (auto fd : m_fds)
+            {
+                if (fd >= 0)
+                {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#elif defined(_WIN32)
+            QueryThreadCycleTime(GetCurrentThread(), &m_startCycles);
+#endif
+        }
+
+        // Stop stops counting; the counts are kept for Read.
+        void Stop()
+        {
+#if defined(__linux__)
+            for (auto fd : m_fds)
+            {
+                if (fd >= 0)
+                    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+#elif defined(_WIN32)
+            QueryThreadCycleTime(GetCurrentThread(), &m_stopCycles);
+#endif
+        }
+
+        // Read returns the counts between Start and Stop.
+        Counts Read() const
+        {
+            Counts counts;
+#if defined(__linux__)
+            for (std::size_t i = 0; i < EventCount; ++i)
+            {
+                // The value, the time the event was enabled and the time it was on a counter.
+                std::uint64_t data[3] = {};
+                if (m_fds[i] < 0 || read(m_fds[i], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)) || data[2] == 0)
+                    continue;
+
+                counts.Values[i] = static_cast<double>(data[0]) * (static_cast<double>(data[1]) / static_cast<double>(data[2]));
+                counts.Available[i] = true;
+            }
+#elif defined(_WIN32)
+            counts.Values[static_cast<std::size_t>(Event::Cycles)] = static_cast<double>(m_stopCycles - m_startCycles);
+            counts.Available[static_cast<std::size_t>(Event::Cycles)] = true;
+#endif
+            return counts;
+        }
+
+    private:
+#if defined(__linux__)
+        int m_fds[EventCount] = { -1, -1, -1, -1, -1, -1 };
+#elif defined(_WIN32)
+        ULONG64 m_startCycles = 0;
+        ULONG64 m_stopCycles = 0;
+#endif
+    };
+
+    // Measure returns the counts of running f once.
+    template <typename F>
+    Counts Measure(F&& f)
+    {
+        CounterGroup counters;
+        counters.Start();
+        std::forward<F>(f)();
+        counters.Stop();
+        return counters.Read();
+    }
+
+    // CounterScope counts the events from its construction to the end of its scope into counts.
+    class CounterScope
+    {
+    public:
+        explicit CounterScope(Counts& counts) : m_counts{ counts }
+        {
+            m_counters.Start();
+        }
+
+        CounterScope(CounterScope const &) = delete;
+        CounterScope& operator=(CounterScope const &) = delete;
+
+        ~CounterScope()
+        {
+            m_counters.Stop();
+            m_counts = m_counters.Read();
+        }
+
+    private:
+        Counts& m_counts;
+        CounterGroup m_counters;
+    };
+
+    // Format writes the available counts, and the IPC if the cycles and instructions are available.
+    inline std::string Format(Counts const & counts)
+    {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(2);
+        for (std::size_t i = 0; i < EventCount; ++i)
+        {
+            if (counts.Available[i])
+                os << (os.tellp() > 0 ? ", " : "") << counts.Values[i] << " " << EventName(static_cast<Event>(i));
+        }
+
+        if (counts.Has(Event::Cycles) && counts.Has(Event::Instructions) && counts[Event::Cycles] > 0)
+            os << ", IPC " << counts[Event::Instructions] / counts[Event::Cycles];
+
+        auto text = os.str();
+        return text.empty() ? "no counters available" : text;
+    }
+}
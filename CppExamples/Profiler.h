@@ -0,0 +1,362 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <iomanip> // setw, setprecision
+#include <string>
+#include <vector>
+#include <memory> // shared_ptr
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm> // sort
+#include <cstdint> // uint64_t
+#include "Benchmark.h" // Benchmark::EscapeJson
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h> // __rdtsc
+#define PROFILE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#define PROFILE_RDTSC
+#endif
+
+/*
+    Scoped profiling zones.
+
+    TimeElapsed (Chrono.h) measures one piece of code once and the Benchmark harness measures
+    a piece of code in isolation. To find out where the time goes in a running program, the program
+    is instrumented instead:
+
+        void Parse()
+        {
+            PROFILE_SCOPE("Parse");
+            ...
+        }
+
+    PROFILE_SCOPE creates an RAII object that reads the clock when the scope is entered and again
+    when it's left. The duration is recorded in the calling thread's profile:
+    - per-zone statistics: count, total, min, max and a histogram of the durations with power-of-2 buckets,
+      from which the median and the 99th percentile are estimated
+    - a list of events (start and duration), written as a Chrome trace (chrome://tracing or ui.perfetto.dev
+      show the zones of each thread on a timeline)
+
+    Each thread records into its own profile, so recording takes no lock. A zone's static description
+    (its name, file and line) is registered once, the first time the scope runs.
+
+    The clock is the time-stamp counter (rdtsc) on x86 and steady_clock elsewhere. Reading rdtsc takes
+    a few nanoseconds; its ticks are converted to nanoseconds by comparing it with steady_clock over
+    the run of the program.
+
+    PrintReport and WriteChromeTrace are called at the end of the program, when the threads have finished.
+*/
+namespace Profiling
+{
+    // Ticks reads the profiler's clock.
+    inline std::uint64_t Ticks()
+    {
+#if defined(PROFILE_RDTSC)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Clock relates the profiler's ticks to nanoseconds.
+    struct Clock
+    {
+        std::uint64_t StartTicks = Ticks();
+        std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+        // NanosecondsPerTick calibrates the ticks against steady_clock since the start.
+        double NanosecondsPerTick() const
+        {
+#if defined(PROFILE_RDTSC)
+            auto ticks = Ticks() - StartTicks;
+            auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - StartTime).count();
+            return ticks != 0 ? ns / static_cast<double>(ticks) : 1.0;
+#else
+            return 1e9 * std::chrono::steady_clock::period::num / std::chrono::steady_clock::period::den;
+#endif
+        }
+    };
+
+    inline Clock& ProgramClock()
+    {
+        static Clock clock;
+        return clock;
+    }
+
+    // ZoneInfo is the static description of a zone. PROFILE_SCOPE creates one per scope.
+    struct ZoneInfo
+    {
+        char const * Name;
+        char const * File;
+        int Line;
+        std::size_t Id;
+
+        ZoneInfo(char const * name, char const * file, int line);
+    };
+
+    struct ZoneStats
+    {
+        static const int Buckets = 64;
+
+        std::uint64_t Count = 0;
+        std::uint64_t Total = 0;
+        std::uint64_t Min = ~0ull;
+        std::uint64_t Max = 0;
+        std::uint64_t Histogram[Buckets] = {}; // bucket k counts the durations in [2^k, 2^(k+1)) ticks
+
+        void Add(std::uint64_t ticks)
+        {
+            ++Count;
+            Total += ticks;
+            if (ticks < Min) Min = ticks;
+            if (ticks > Max) Max = ticks;
+            ++Histogram[Log2(ticks)];
+        }
+
+        void Merge(ZoneStats const & other)
+        {
+            Count += other.Count;
+            Total += other.Total;
+            if (other.Min < Min) Min = other.Min;
+            if (other.Max > Max) Max = other.Max;
+            for (int k = 0; k < Buckets; ++k)
+                Histogram[k] += other.Histogram[k];
+        }
+
+        // Percentile estimates the duration below which p of the durations fall: the upper bound of its bucket.
+        std::uint64_t Percentile(double p) const
+        {
+            auto target = static_cast<std::uint64_t>(p * static_cast<double>(Count));
+            std::uint64_t seen = 0;
+            for (int k = 0; k < Buckets; ++k)
+            {
+                seen += Histogram[k];
+                if (seen > target)
+                {
+                    auto bound = k < 63 ? (2ull << k) - 1 : ~0ull;
+                    return bound < Max ? bound : Max;
+                }
+            }
+            return Max;
+        }
+
+        static int Log2(std::uint64_t x)
+        {
+            int k = 0;
+            while (x >>= 1)
+                ++k;
+            return k;
+        }
+    };
+
+    struct Event
+    {
+        std::size_t Zone;
+        std::uint64_t Start;
+        std::uint64_t Duration;
+    };
+
+    // ThreadProfile is the record of one thread. Only the owning thread writes to it.
+    struct ThreadProfile
+    {
+        // The events beyond the limit are not kept (the statistics still are), so a zone in a hot loop
+        // does not use up the memory.
+        static const std::size_t MaxEvents = 1 << 20;
+
+        unsigned ThreadIndex = 0;
+        std::vector<ZoneStats> Stats; // indexed by ZoneInfo::Id
+        std::vector<Event> Events;
+
+        void Record(std::size_t zone, std::uint64_t start, std::uint64_t duration)
+        {
+            if (zone >= Stats.size())
+                Stats.resize(zone + 1);
+            Stats[zone].Add(duration);
+
+            if (Events.size() < MaxEvents)
+                Events.push_back(Event{ zone, start, duration });
+        }
+    };
+
+    // Registry holds the zones and the profiles of all the threads.
+    struct Registry
+    {
+        std::mutex Mutex;
+        std::vector<ZoneInfo const *> Zones;
+        std::vector<std::shared_ptr<ThreadProfile>> Threads;
+    };
+
+    inline Registry& GlobalRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    inline ZoneInfo::ZoneInfo(char const * name, char const * file, int line) :
+        Name{ name }, File{ file }, Line{ line }
+    {
+        ProgramClock(); // start the clock no later than the first zone
+        auto& registry = GlobalRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+        Id = registry.Zones.size();
+        registry.Zones.push_back(this);
+    }
+
+    // CurrentThreadProfile returns the calling thread's profile, registering it on the first call.
+    // The registry shares the ownership, so the profile outlives the thread.
+    inline ThreadProfile& CurrentThreadProfile()
+    {
+        thread_local std::shared_ptr<ThreadProfile> profile;
+        if (!profile)
+        {
+            profile = std::make_shared<ThreadProfile>();
+            auto& registry = GlobalRegistry();
+            std::lock_guard<std::mutex> lock(registry.Mutex);
+            profile->ThreadIndex = static_cast<unsigned>(registry.Threads.size());
+            registry.Threads.push_back(profile);
+        }
+        return *profile;
+    }
+
+    // ScopedZone measures the lifetime of the object.
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(ZoneInfo const & zone) : m_zone{ zone.Id }, m_start{ Ticks() } {}
+
+        ~ScopedZone()
+        {
+            auto end = Ticks();
+            CurrentThreadProfile().Record(m_zone, m_start, end - m_start);
+        }
+
+        ScopedZone(ScopedZone const &) = delete;
+        ScopedZone& operator=(ScopedZone const &) = delete;
+
+    private:
+        std::size_t m_zone;
+        std::uint64_t m_start;
+    };
+
+    struct ZoneSummary
+    {
+        ZoneInfo const * Zone;
+        ZoneStats Stats;
+    };
+
+    // Summarize merges the statistics of all the threads, sorted by the total time.
+    inline std::vector<ZoneSummary> Summarize()
+    {
+        auto& registry = GlobalRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+
+        std::vector<ZoneSummary> summary(registry.Zones.size());
+        for (std::size_t z = 0; z < registry.Zones.size(); ++z)
+            summary[z].Zone = registry.Zones[z];
+
+        for (auto const & thread : registry.Threads)
+        {
+            for (std::size_t z = 0; z < thread->Stats.size(); ++z)
+                summary[z].Stats.Merge(thread->Stats[z]);
+        }
+
+        std::sort(begin(summary), end(summary), [](ZoneSummary const & a, ZoneSummary const & b) { return a.Stats.Total > b.Stats.Total; });
+        return summary;
+    }
+
+    // PrintReport prints a table of the zones, the most expensive first. The times are in milliseconds
+    // except for the mean, median and p99, which are per call in microseconds.
+    inline void PrintReport(std::ostream& os)
+    {
+        auto nsPerTick = ProgramClock().NanosecondsPerTick();
+        auto ms = [nsPerTick](double ticks) { return ticks * nsPerTick / 1e6; };
+        auto us = [nsPerTick](double ticks) { return ticks * nsPerTick / 1e3; };
+
+        auto flags = os.flags();
+        auto precision = os.precision();
+        os << std::fixed << std::setprecision(3);
+
+        os << std::left << std::setw(32) << "zone" << std::right
+           << std::setw(10) << "count" << std::setw(14) << "total[ms]" << std::setw(12) << "mean[us]"
+           << std::setw(12) << "min[us]" << std::setw(12) << "p50[us]" << std::setw(12) << "p99[us]"
+           << std::setw(14) << "max[us]" << endl;
+
+        for (auto const & z : Summarize())
+        {
+            auto const & s = z.Stats;
+            if (s.Count == 0)
+                continue;
+
+            os << std::left << std::setw(32) << z.Zone->Name << std::right
+               << std::setw(10) << s.Count
+               << std::setw(14) << ms(static_cast<double>(s.Total))
+               << std::setw(12) << us(static_cast<double>(s.Total) / static_cast<double>(s.Count))
+               << std::setw(12) << us(static_cast<double>(s.Min))
+               << std::setw(12) << us(static_cast<double>(s.Percentile(0.5)))
+               << std::setw(12) << us(static_cast<double>(s.Percentile(0.99)))
+               << std::setw(14) << us(static_cast<double>(s.Max)) << endl;
+        }
+
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    // WriteChromeTrace writes the events in the Chrome trace-event format: complete ("X") events
+    // with the start and the duration in microseconds.
+    inline void WriteChromeTrace(std::ostream& os)
+    {
+        auto nsPerTick = ProgramClock().NanosecondsPerTick();
+        auto start = ProgramClock().StartTicks;
+
+        auto& registry = GlobalRegistry();
+        std::lock_guard<std::mutex> lock(registry.Mutex);
+
+        auto flags = os.flags();
+        os << std::fixed << std::setprecision(3);
+        os << "{ \"traceEvents\": [" << endl;
+
+        bool first = true;
+        for (auto const & thread : registry.Threads)
+        {
+            for (auto const & e : thread->Events)
+            {
+                auto const & zone = *registry.Zones[e.Zone];
+                os << (first ? "  " : ", ")
+                   << "{ \"name\": \"" << Benchmark::EscapeJson(zone.Name) << "\", \"ph\": \"X\""
+                   << ", \"ts\": " << static_cast<double>(e.Start - start) * nsPerTick / 1e3
+                   << ", \"dur\": " << static_cast<double>(e.Duration) * nsPerTick / 1e3
+                   << ", \"pid\": 0, \"tid\": " << thread->ThreadIndex << " }" << endl;
+                first = false;
+            }
+        }
+
+        os << "] }" << endl;
+        os.flags(flags);
+    }
+
+    inline bool WriteChromeTrace(std::string const & path)
+    {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+        WriteChromeTrace(file);
+        return static_cast<bool>(file);
+    }
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// PROFILE_SCOPE measures the rest of the enclosing scope as a zone with the given name.
+// The name needs to be a string literal. Define PROFILE_DISABLE to compile the zones out.
+#if !defined(PROFILE_DISABLE)
+#define PROFILE_SCOPE(name) \
+    static const Profiling::ZoneInfo PROFILE_CONCAT(profileZone, __LINE__)(name, __FILE__, __LINE__); \
+    Profiling::ScopedZone PROFILE_CONCAT(profileScope, __LINE__)(PROFILE_CONCAT(profileZone, __LINE__))
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
@@ -4,6 +4,9 @@
 #include <string>
 #include <chrono>
 #include <random> // mt19937, normal_distribution
+#include <vector>
+#include "Examples/RandomEngines.h" // Xoshiro256StarStar, Philox4x32, FloatFiller
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -110,6 +113,150 @@ namespace RandExamples
             cout << std::setprecision(2) << nd(gen) << ",";
     }
 
+    // The engines from RandomEngines.h. With a fixed seed the results are the same on every run
+    // and with any number of threads.
+    void ReproducibleRandomization()
+    {
+        const std::uint64_t seed = 2024;
+
+        // Unbiased dice rolls; rand() % 6 is biased because 6 does not divide RAND_MAX + 1.
+        Xoshiro256StarStar gen(seed);
+        cout << "xoshiro256**: ";
+        for (int i = 0; i < 10; ++i)
+            cout << UniformInt(gen, 1, 6);
+        cout << " ";
+
+        // Independent streams for threads: stream k is the engine jumped k times.
+        auto stream1 = Xoshiro256StarStar::ForStream(seed, 1);
+        cout << UniformInt(stream1, 1, 6) << " ";
+
+        // A counter-based engine can jump to any position of any stream directly.
+        Philox4x32 philox(seed, 7);
+        std::uint32_t block[4];
+        philox.Block(1000, block);  // numbers 4000..4003 of stream 7
+        philox.Seek(4000);
+        cout << "philox: " << (philox() == block[0]) << " "; // 1
+
+        // The engines work with the <random> distributions.
+        std::normal_distribution<float> nd;
+        cout << std::setprecision(2) << nd(gen) << " ";
+
+        // Fill a buffer with floats on all the threads. The sum is the same for any number of threads.
+        std::vector<float> samples(1'000'000);
+        ParallelFill(seed, samples.data(), samples.size(), -1.0f, 1.0f);
+        double sum = 0;
+        for (auto x : samples)
+            sum += x;
+        cout << "mean=" << std::setprecision(3) << sum / samples.size() << " "; // close to 0
+    }
+
+    void RegisterBenchmarks()
+    {
+        const int count = 1 << 16;
+
+        Benchmark::Register("Rand", "rand() % 100", [](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                unsigned sum = 0;
+                for (int i = 0; i < count; ++i)
+                    sum += rand() % 100;
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Rand", "mt19937 uniform_int_distribution", [](Benchmark::State& state)
+        {
+            std::mt19937 gen(1);
+            std::uniform_int_distribution<int> dist(0, 99);
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                unsigned sum = 0;
+                for (int i = 0; i < count; ++i)
+                    sum += dist(gen);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Rand", "xoshiro256** UniformBelow", [](Benchmark::State& state)
+        {
+            Xoshiro256StarStar gen(1);
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                unsigned sum = 0;
+                for (int i = 0; i < count; ++i)
+                    sum += UniformBelow(gen, 100);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Rand", "Philox4x32 UniformBelow", [](Benchmark::State& state)
+        {
+            Philox4x32 gen(1);
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                unsigned sum = 0;
+                for (int i = 0; i < count; ++i)
+                    sum += UniformBelow(gen, 100);
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Rand", "fill floats mt19937", [](Benchmark::State& state)
+        {
+            std::mt19937 gen(1);
+            std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+            std::vector<float> data(count);
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                for (auto& x : data)
+                    x = dist(gen);
+                Benchmark::DoNotOptimize(data[0]);
+            }
+        });
+
+        Benchmark::Register("Rand", "fill floats xoshiro256**", [](Benchmark::State& state)
+        {
+            Xoshiro256StarStar gen(1);
+            std::vector<float> data(count);
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                for (auto& x : data)
+                    x = UniformFloat(gen, -1.0f, 1.0f);
+                Benchmark::DoNotOptimize(data[0]);
+            }
+        });
+
+        Benchmark::Register("Rand", "fill floats FloatFiller", [](Benchmark::State& state)
+        {
+            FloatFiller filler(1);
+            std::vector<float> data(count);
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                filler.Fill(data.data(), data.size(), -1.0f, 1.0f);
+                Benchmark::DoNotOptimize(data[0]);
+            }
+        });
+
+        Benchmark::Register("Rand", "fill floats ParallelFill 16M", [](Benchmark::State& state)
+        {
+            std::vector<float> data(16 << 20);
+            state.SetItemsPerIteration(static_cast<double>(data.size()));
+            while (state.KeepRunning())
+            {
+                ParallelFill(1, data.data(), data.size(), -1.0f, 1.0f);
+                Benchmark::DoNotOptimize(data[0]);
+            }
+        });
+    }
+
     void Test()
     {
         // Start the random generator. It needs to be done once per program run.
@@ -118,5 +265,6 @@ namespace RandExamples
         RandomNumbers();
         TestRandFloat();
         StrongRandomization();
+        ReproducibleRandomization();
     }
 }
\ No newline at end of file
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <iostream>
+#include <fstream>
+#include <string>
 #include <regex>
+#include "Examples/RegexMatcher.h" // Matcher, RegexCache
+#include "Examples/MappedFile.h" // MappedFile
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
 using std::regex;
+using std::string;
 
 namespace RegularExpressions
 {
@@ -101,9 +107,120 @@ namespace RegularExpressions
         }
     }
 
+    void RegexMatcherExamples()
+    {
+        // Matchers get the compiled regex from a cache, so constructing a matcher for the same pattern 
+        // again (e.g. in a function called for each line) does not compile the pattern again.
+        auto pattern = R"((\d{3})-(\d{4}))";
+        auto m1 = Matcher{ pattern };
+        auto m2 = Matcher{ pattern };
+        assert(DefaultRegexCache().Get(pattern) == DefaultRegexCache().Get(pattern));
+
+        // (\d{3})-(\d{4}) is simple enough for the scanner.
+        assert(m1.UsesScanner());
+
+        // The matches are string_views into the string being searched. There are no copies.
+        // Output: 808-2321:808,2321 555-0199:555,0199
+        auto s = std::string_view{ "AAA 808-2321 BBB 555-0199 12-3456" };
+        for (auto const & m : m2.Search(s))
+            cout << m[0] << ":" << m[1] << "," << m[2] << " ";
+
+        // Patterns that are not fixed-length digit patterns use std::regex.
+        // Output: 8:<abc.cc>@7
+        auto files = Matcher{ R"(<\w+\.\w{2,3}>)" };
+        assert(!files.UsesScanner());
+        for (auto const & m : files.Search("a.h qq <abc.cc> abc"))
+            cout << m[0].length() << ":" << m[0] << "@" << m.Position() << " ";
+
+        // Search a memory-mapped file. The text is read directly from the mapping.
+        {
+            std::ofstream log("phones.log");
+            for (int i = 0; i < 1000; ++i)
+                log << "line " << i << ": call " << 100 + i % 900 << "-" << 1000 + i << " now" << endl;
+        }
+
+        auto file = FileAndStreamExamples::MappedFile{ "phones.log" };
+        if (file)
+            cout << m1.Count(file.View()) << " "; // 1000
+    }
+
+    // MakePhoneLog creates a log of lines, a quarter of which contain a phone number.
+    string MakePhoneLog(std::size_t lines)
+    {
+        string log;
+        for (std::size_t i = 0; i < lines; ++i)
+        {
+            log += "2024-01-01 12:00:00 INFO request " + std::to_string(i * 7919 % 100000) + " processed";
+            if (i % 4 == 0)
+                log += ", callback " + std::to_string(100 + i % 900) + "-" + std::to_string(1000 + i % 9000);
+            log += '\n';
+        }
+        return log;
+    }
+
+    void RegisterBenchmarks()
+    {
+        const std::size_t lines = 20'000;
+        auto pattern = R"((\d{3})-(\d{4}))";
+
+        // The anti-pattern: a regex constructed for each line.
+        Benchmark::Register("RegularExpressions", "regex constructed per line", [=](Benchmark::State& state)
+        {
+            auto log = MakePhoneLog(lines / 10);
+            state.SetItemsPerIteration(static_cast<double>(lines / 10));
+            while (state.KeepRunning())
+            {
+                std::size_t count = 0;
+                for (auto line : FileAndStreamExamples::LineRange(log))
+                {
+                    auto r = regex{ pattern };
+                    auto m = std::cmatch{};
+                    count += std::regex_search(line.data(), line.data() + line.size(), m, r);
+                }
+                Benchmark::DoNotOptimize(count);
+            }
+        });
+
+        Benchmark::Register("RegularExpressions", "regex_search per line", [=](Benchmark::State& state)
+        {
+            auto log = MakePhoneLog(lines);
+            auto r = regex{ pattern };
+            state.SetItemsPerIteration(lines);
+            while (state.KeepRunning())
+            {
+                std::size_t count = 0;
+                for (auto line : FileAndStreamExamples::LineRange(log))
+                {
+                    auto m = std::cmatch{};
+                    count += std::regex_search(line.data(), line.data() + line.size(), m, r);
+                }
+                Benchmark::DoNotOptimize(count);
+            }
+        });
+
+        Benchmark::Register("RegularExpressions", "Matcher with std::regex", [=](Benchmark::State& state)
+        {
+            auto log = MakePhoneLog(lines);
+            auto matcher = Matcher{ pattern, false };
+            state.SetItemsPerIteration(lines);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(matcher.Count(log));
+        });
+
+        Benchmark::Register("RegularExpressions", "Matcher with scanner", [=](Benchmark::State& state)
+        {
+            auto log = MakePhoneLog(lines);
+            auto matcher = Matcher{ pattern };
+            state.SetItemsPerIteration(lines);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(matcher.Count(log));
+        });
+    }
+
     void Test()
     {
         RegexSearch();
         RegexIterators();
+        RegexMatcherExamples();
     }
 }
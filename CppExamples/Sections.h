@@ -0,0 +1,314 @@
+#pragma once
+
+#include <iostream>
+#include <sstream> // ostringstream, stringbuf
+#include <iomanip> // setw, setprecision
+#include <string>
+#include <vector>
+#include <functional> // std::function
+#include <algorithm> // sort, min, max
+#include <thread>
+#include <chrono>
+#include <cctype> // tolower
+#include <cstdio> // fflush, stdout
+#include <fcntl.h> // open, O_WRONLY
+
+#ifdef _WIN32
+#include <io.h> // _dup, _dup2, _open, _close, _fileno
+#else
+#include <unistd.h> // dup, dup2, close
+#endif
+
+using std::cout;
+using std::endl;
+using std::string;
+using std::vector;
+
+/*
+    The sections of the examples program: a registry of the *Examples::Test functions, run in order,
+    all or some of them, once or several times, one after the other or in parallel.
+
+    Each section writes to cout as before, but cout is redirected while the sections run: a
+    SectionOutput stream buffer forwards the characters to the buffer of the section running on the
+    calling thread (a thread_local pointer), so the sections can run on separate threads and their
+    outputs are still printed whole and in the order of the registry. endl, which flushes, is then
+    only a '\n' in a string buffer until the section ends. The sections that run on the main thread
+    write to the console directly, so what they print with printf comes in order.
+
+    - Register adds a section: a name for --only (the name of its header), a title, the function, and
+      whether it is independent. A section that changes the formatting state of cout (precision,
+      flags), prints with printf or from other threads, or writes files other sections read is not
+      independent.
+    - RunAll runs the selected sections Repeat times and prints the output of the first run; the
+      output of the other runs is dropped (QuietStdout for printf), their times kept. With Parallel,
+      the independent sections run on a thread each, then the other sections one after the other.
+    - Some examples print with the formatting state (fixed, precision, boolalpha) that an earlier
+      section left in cout, and their comments show those outputs. A run of all the sections one
+      after the other leaves the state as it is; with Parallel or Only, the state is restored after
+      each section that isn't independent, so a section's output doesn't depend on which sections ran
+      before it: then Numbers prints 2.5 instead of 2.5000, Lambda and Enums 1 instead of true, etc.
+    - PrintTimes prints the min, median and max time of each section: the examples are also a smoke
+      performance test.
+
+    A full run takes ~0.5 s: Containers ~470 ms, Templates ~57 ms, Chrono and Rand ~4 ms each, and each
+    of the other sections less than 1 ms. The independent sections are among the short ones, so
+    --parallel gains little on the examples as they are (the outputs are the same, but for the times
+    and the seeds from random_device that the examples print).
+*/
+namespace Sections
+{
+    struct Section
+    {
+        string Name;
+        string Title;
+        std::function<void()> Run;
+        bool Independent;
+    };
+
+    struct Options
+    {
+        vector<string> Only; // the names of the sections to run; all if empty
+        unsigned Repeat = 1;
+        bool Parallel = false;
+    };
+
+    struct Result
+    {
+        string Name;
+        string Title;
+        string Output; // the output of the first run of a section that ran on a thread
+        vector<double> Milliseconds; // per run
+    };
+
+    // Registry returns the sections in the order of registration.
+    inline vector<Section>& Registry()
+    {
+        static vector<Section> registry;
+        return registry;
+    }
+
+    inline void Register(string name, string title, std::function<void()> run, bool independent = true)
+    {
+        Registry().push_back(Section{ std::move(name), std::move(title), std::move(run), independent });
+    }
+
+    // SectionOutput is a stream buffer without a buffer of its own: it passes the characters to the
+    // buffer of the calling thread's section, or to the original buffer of the stream.
+    class SectionOutput : public std::streambuf
+    {
+    public:
+        explicit SectionOutput(std::streambuf* original) : m_original{ original } {}
+
+        // Target sets the buffer of the calling thread; nullptr restores the original buffer.
+        static void Target(std::streambuf* buffer) { t_target = buffer; }
+
+    protected:
+        int_type overflow(int_type c) override
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof()))
+                return traits_type::not_eof(c);
+            return Current()->sputc(traits_type::to_char_type(c));
+        }
+
+        std::streamsize xsputn(char const * s, std::streamsize n) override
+        {
+            return Current()->sputn(s, n);
+        }
+
+        int sync() override
+        {
+            return Current()->pubsync();
+        }
+
+    private:
+        std::streambuf* m_original;
+        static inline thread_local std::streambuf* t_target = nullptr;
+
+        std::streambuf* Current() const { return t_target != nullptr ? t_target : m_original; }
+    };
+
+    // EqualNoCase compares two names ignoring the case.
+    inline bool EqualNoCase(string const & a, string const & b)
+    {
+        return a.size() == b.size() && std::equal(begin(a), end(a), begin(b), [](char x, char y)
+        {
+            return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+
+    // Find returns the section with the name, or nullptr.
+    inline Section const * Find(string const & name)
+    {
+        for (auto const & section : Registry())
+        {
+            if (EqualNoCase(section.Name, name))
+                return &section;
+        }
+        return nullptr;
+    }
+
+    // QuietStdout sends what is printed to the C standard output (printf) to the null device, from its
+    // construction to its destruction.
+    class QuietStdout
+    {
+    public:
+        QuietStdout()
+        {
+            std::fflush(stdout);
+#ifdef _WIN32
+            m_saved = _dup(_fileno(stdout));
+            int null = _open("NUL", _O_WRONLY);
+            if (null >= 0)
+            {
+                _dup2(null, _fileno(stdout));
+                _close(null);
+            }
+#else
+            m_saved = dup(fileno(stdout));
+            int null = open("/dev/null", O_WRONLY);
+            if (null >= 0)
+            {
+                dup2(null, fileno(stdout));
+                close(null);
+            }
+#endif
+        }
+
+        QuietStdout(QuietStdout const &) = delete;
+        QuietStdout& operator=(QuietStdout const &) = delete;
+
+        ~QuietStdout()
+        {
+            std::fflush(stdout);
+            if (m_saved < 0)
+                return;
+#ifdef _WIN32
+            _dup2(m_saved, _fileno(stdout));
+            _close(m_saved);
+#else
+            dup2(m_saved, fileno(stdout));
+            close(m_saved);
+#endif
+        }
+
+    private:
+        int m_saved;
+    };
+
+    // RunSection runs a section Repeat times. With direct, the first run writes to the console;
+    // otherwise its output is kept in the result. The output of the other runs is dropped.
+    // With restoreFormat, the formatting state of cout is restored after a section that isn't
+    // independent; an independent section doesn't change it, and may run beside other ones, which
+    // would race on cout.
+    inline void RunSection(Section const & section, unsigned repeat, bool direct, bool restoreFormat, Result& result)
+    {
+        bool restore = restoreFormat && !section.Independent;
+        for (unsigned i = 0; i < std::max(repeat, 1u); ++i)
+        {
+            std::stringbuf buffer;
+            if (!direct || i > 0)
+                SectionOutput::Target(&buffer);
+
+            std::ios state(nullptr);
+            if (restore)
+                state.copyfmt(cout);
+
+            auto start = std::chrono::steady_clock::now();
+            if (direct && i > 0)
+            {
+                QuietStdout quiet;
+                section.Run();
+            }
+            else
+                section.Run();
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            if (restore)
+                cout.copyfmt(state);
+            SectionOutput::Target(nullptr);
+
+            result.Milliseconds.push_back(std::chrono::duration<double, std::milli>(elapsed).count());
+            if (!direct && i == 0)
+                result.Output = buffer.str();
+        }
+    }
+
+    // RunAll runs the sections selected by the options and prints their outputs in the order of the
+    // registry. The names in Only must be names of sections (main checks them with Find).
+    inline vector<Result> RunAll(Options const & options)
+    {
+        vector<Section const *> selected;
+        for (auto const & section : Registry())
+        {
+            if (options.Only.empty() || std::any_of(begin(options.Only), end(options.Only), [&section](string const & name) { return EqualNoCase(section.Name, name); }))
+                selected.push_back(&section);
+        }
+
+        vector<Result> results(selected.size());
+        for (std::size_t i = 0; i < selected.size(); ++i)
+        {
+            results[i].Name = selected[i]->Name;
+            results[i].Title = selected[i]->Title;
+        }
+
+        SectionOutput output(cout.rdbuf());
+        auto original = cout.rdbuf(&output);
+        std::ostream out(original); // the console, while cout goes to the sections
+
+        // A run of all the sections keeps the formatting state that each leaves to the next one.
+        bool restoreFormat = options.Parallel || !options.Only.empty();
+
+        // The independent sections first, on a thread each, while the main thread waits; then the
+        // others one after the other, so that nothing runs beside a section that isn't independent.
+        if (options.Parallel)
+        {
+            vector<std::thread> threads;
+            for (std::size_t i = 0; i < selected.size(); ++i)
+            {
+                if (selected[i]->Independent)
+                    threads.emplace_back([&, i]() { RunSection(*selected[i], options.Repeat, false, restoreFormat, results[i]); });
+            }
+            for (auto& t : threads)
+                t.join();
+        }
+
+        // The sections that run on the main thread write to the console after their title, like
+        // what they print with printf.
+        for (std::size_t i = 0; i < selected.size(); ++i)
+        {
+            out << "*** " << results[i].Title << " ***\n" << std::flush;
+            if (!options.Parallel || !selected[i]->Independent)
+                RunSection(*selected[i], options.Repeat, true, restoreFormat, results[i]);
+            out << results[i].Output << "\n\n" << std::flush;
+        }
+
+        cout.rdbuf(original);
+
+        return results;
+    }
+
+    // PrintTimes prints the time of each section: min, median and max of the runs, in milliseconds.
+    inline void PrintTimes(std::ostream& os, vector<Result> const & results)
+    {
+        std::size_t width = 0;
+        for (auto const & r : results)
+            width = std::max(width, r.Name.size());
+
+        os << "*** Times (ms: min, median, max) ***" << endl;
+        double total = 0;
+        for (auto const & r : results)
+        {
+            auto times = r.Milliseconds;
+            std::sort(begin(times), end(times));
+            if (times.empty())
+                continue;
+
+            total += times[times.size() / 2]; // the sum of the medians
+            os << std::left << std::setw(static_cast<int>(width) + 2) << r.Name << std::right << std::fixed << std::setprecision(3)
+               << std::setw(10) << times.front() << std::setw(10) << times[times.size() / 2] << std::setw(10) << times.back() << endl;
+        }
+        os << std::left << std::setw(static_cast<int>(width) + 2) << "Sum" << std::right << std::setw(20) << total << endl;
+        os.unsetf(std::ios::floatfield | std::ios::adjustfield);
+        os << std::setprecision(6);
+    }
+}
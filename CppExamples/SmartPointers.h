@@ -3,6 +3,13 @@
 #include <iostream>
 #include <string>
 #include <memory> // unique_ptr, shared_ptr, weak_ptr
+#include <vector>
+#include "Examples/RefCounted.h" // IntrusivePtr, IntrusiveWeakPtr, LocalSharedPtr
+#include "Examples/ObjectPool.h" // ObjectPool
+#include "Examples/WeakCache.h" // WeakCache
+#include <cmath>    // sqrt
+#include <random>   // mt19937
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -202,6 +209,29 @@ namespace SmartPointersExamples
 
         } // Book destr called twice: ~F ~F
 
+        // An object pool hands out unique_ptrs whose deleter returns the object to the pool
+        // instead of deleting it.
+        void PooledObjects()
+        {
+            ObjectPool<Book> pool([](Book& book) { book.SetTitle("returned"); }); // reset on return
+
+            Book* first;
+            {
+                auto b1 = pool.Acquire("P"); // a new Book("P")
+                first = b1.get();
+                b1->SetTitle("Q");
+            } // the book goes back to the pool: no destr
+
+            // The same object again, as the reset function left it. The ctor arguments are
+            // only used when the pool has no object to reuse.
+            auto b2 = pool.Acquire("R");
+            if (b2.get() == first) cout << "reused ";
+
+            // Moving the unique_ptr moves the deleter with it.
+            auto b3 = std::move(b2);
+            cout << "size=" << pool.Size() << " "; // 1
+        } // destr: ~returned when the pool is destroyed
+
         void Test()
         {
             ConstructUniquePtr();
@@ -209,6 +239,7 @@ namespace SmartPointersExamples
             TransferOwnership();
             CopyObjectContainingUniquePtr();
             UniquePtrMethods();
+            PooledObjects();
         }
     }
 
@@ -381,11 +412,159 @@ namespace SmartPointersExamples
             }
         }
 
+        // A decoded asset, expensive to make.
+        struct Texture
+        {
+            int Id;
+            std::vector<float> Pixels;
+        };
+
+        std::shared_ptr<Texture> DecodeTexture(int id)
+        {
+            auto texture = std::make_shared<Texture>();
+            texture->Id = id;
+            texture->Pixels.resize(4096);
+            for (std::size_t i = 0; i < texture->Pixels.size(); ++i)
+                texture->Pixels[i] = std::sqrt(static_cast<float>(i * id));
+            return texture;
+        }
+
+        // WeakCache keeps the most recently used objects alive (the LRU tier) and finds any
+        // object that is still used elsewhere (the weak_ptr tier).
+        void WeakPtrCache()
+        {
+            WeakCache<int, Texture> cache(2, 1); // 2 objects in the LRU tier, 1 shard
+
+            auto t1 = cache.GetOrLoad(1, []() { return DecodeTexture(1); }); // miss: decoded
+            cache.GetOrLoad(2, []() { return DecodeTexture(2); });           // miss: decoded
+            cache.GetOrLoad(3, []() { return DecodeTexture(3); });           // miss: decoded, evicts 1 from the LRU tier
+
+            // Texture 1 is no longer in the LRU tier, but t1 keeps it alive: a weak hit.
+            auto again = cache.Find(1);
+            assert(again == t1);
+
+            // Texture 2 was evicted by 1 and nobody else holds it, so it has been reclaimed.
+            assert(cache.Find(2) == nullptr);
+
+            auto stats = cache.GetStats();
+            cout << "hits=" << stats.StrongHits + stats.WeakHits << " misses=" << stats.Misses << " "; // hits=1 misses=4
+
+            // A load that fails (an empty pointer) isn't cached: the next request loads again.
+            WeakCache<int, Texture> unsharded(2, 0); // 0 shards are taken as 1
+            assert(unsharded.GetOrLoad(4, []() { return std::shared_ptr<Texture>(); }) == nullptr);
+            assert(unsharded.GetOrLoad(4, []() { return DecodeTexture(4); }) != nullptr);
+        }
+
         void Test()
         {
             AssignSharedPtr();
             InitWeakPtr();
             WeakPtrMembers();
+            WeakPtrCache();
+        }
+    }
+
+    //
+    // Single-threaded reference counting
+    //
+    namespace IntrusivePtrExamples
+    {
+        // The book holds its own reference count.
+        class Book : public RefCounted<Book>
+        {
+        public:
+            Book(const string& title) : m_title(title) { }
+            string GetTitle() const { return m_title; }
+        private:
+            string m_title;
+        };
+
+        class Library
+        {
+        public:
+            Library() : m_book{ MakeIntrusive<Book>("AAA") } { }
+            IntrusivePtr<Book> GetBook() const { return m_book; } // a non-atomic increment
+        private:
+            IntrusivePtr<Book> m_book;
+        };
+
+        void IntrusivePtrTest()
+        {
+            IntrusivePtr<Book> b;
+            {
+                Library lib;
+                b = lib.GetBook();
+                cout << "cnt=" << b->RefCount() << " "; // 2
+            }
+            cout << "cnt=" << b->RefCount() << " "; // 1
+
+            // The count is in the object, so a raw pointer can be turned into another owner.
+            Book* raw = b.get();
+            IntrusivePtr<Book> b2(raw);
+            cout << "cnt=" << b->RefCount() << " "; // 2
+        }
+
+        void IntrusiveWeakPtrTest()
+        {
+            auto b = MakeIntrusive<Book>("BBB");
+            IntrusiveWeakPtr<Book> wp = b;
+
+            if (auto locked = wp.lock())
+                cout << "locked:" << locked->GetTitle() << " "; // BBB
+
+            // The weak block outlives the book, so the weak pointer knows the book is gone.
+            b.reset();
+            assert(wp.expired());
+            assert(!wp.lock());
+        }
+
+        // A node whose child holds a weak pointer to it, and locks it when it is destroyed.
+        class Node : public RefCounted<Node>
+        {
+        public:
+            struct Child
+            {
+                IntrusiveWeakPtr<Node> Parent;
+                ~Child() { assert(!Parent.lock()); } // the parent is being deleted
+            };
+
+            virtual ~Node() { }
+            Child m_child;
+        };
+
+        class DerivedNode : public Node
+        {
+        public:
+            ~DerivedNode() override
+            {
+                // The last owner has released the node: the weak pointers are already expired.
+                cout << (m_child.Parent.expired() ? "expired " : "alive "); // expired
+            }
+        };
+
+        void IntrusiveWeakPtrInDestructorTest()
+        {
+            IntrusivePtr<Node> node = MakeIntrusive<DerivedNode>();
+            node->m_child.Parent = node;
+            node.reset(); // deleted once
+        }
+
+        void LocalSharedPtrTest()
+        {
+            // For types that don't derive from RefCounted; the count is allocated with the object.
+            auto p = MakeLocalShared<string>("CCC");
+            auto pc = p;
+            cout << "cnt=" << p.use_count() << " "; // 2
+            pc.reset();
+            cout << "cnt=" << p.use_count() << " " << *p << " "; // 1 CCC
+        }
+
+        void Test()
+        {
+            IntrusivePtrTest();
+            IntrusiveWeakPtrTest();
+            IntrusiveWeakPtrInDestructorTest();
+            LocalSharedPtrTest();
         }
     }
 
@@ -394,5 +573,159 @@ namespace SmartPointersExamples
         UniquePtrExamples::Test();
         SharedPtrExamples::Test();
         WeakPtrExamples::Test();
+        IntrusivePtrExamples::Test();
+    }
+
+    // A library of books handing out owning pointers, which are copied to a list and
+    // destroyed again: one increment and one decrement per book.
+    template <typename BookPtr>
+    void RegisterLibraryBenchmark(const string& name, std::vector<BookPtr> const & books)
+    {
+        const std::size_t copies = 1024;
+
+        Benchmark::Register("SmartPointers", name + " copy/destroy 1024", [books, copies](Benchmark::State& state)
+        {
+            std::vector<BookPtr> borrowed;
+            borrowed.reserve(copies);
+            state.SetItemsPerIteration(copies);
+            while (state.KeepRunning())
+            {
+                for (std::size_t i = 0; i < copies; ++i)
+                    borrowed.push_back(books[i % books.size()]);
+                Benchmark::DoNotOptimize(borrowed.data());
+                borrowed.clear();
+            }
+        });
+    }
+
+    // A message that allocates: the body's and the fields' buffers.
+    struct Message
+    {
+        string Body;
+        std::vector<int> Fields;
+    };
+
+    // Fills a message as a pipeline stage would.
+    inline void FillMessage(Message& m, std::size_t i)
+    {
+        m.Body.assign(40, static_cast<char>('a' + i % 26));
+        for (int k = 0; k < 16; ++k)
+            m.Fields.push_back(k);
+    }
+
+    void RegisterPoolBenchmarks()
+    {
+        const std::size_t live = 64;
+        const std::size_t messages = 1024;
+
+        Benchmark::Register("SmartPointers", "make_unique message churn", [live, messages](Benchmark::State& state)
+        {
+            std::vector<std::unique_ptr<Message>> window(live);
+            state.SetItemsPerIteration(messages);
+            while (state.KeepRunning())
+            {
+                for (std::size_t i = 0; i < messages; ++i)
+                {
+                    auto m = std::make_unique<Message>();
+                    FillMessage(*m, i);
+                    window[i % live] = std::move(m);
+                }
+                Benchmark::DoNotOptimize(window.data());
+            }
+        });
+
+        Benchmark::Register("SmartPointers", "ObjectPool message churn", [live, messages](Benchmark::State& state)
+        {
+            ObjectPool<Message> pool([](Message& m) { m.Body.clear(); m.Fields.clear(); });
+            std::vector<ObjectPool<Message>::Pointer> window(live);
+            state.SetItemsPerIteration(messages);
+            while (state.KeepRunning())
+            {
+                for (std::size_t i = 0; i < messages; ++i)
+                {
+                    auto m = pool.Acquire();
+                    FillMessage(*m, i);
+                    window[i % live] = std::move(m);
+                }
+                Benchmark::DoNotOptimize(window.data());
+            }
+        });
+    }
+
+    // Requests for textures: 80% for 32 hot ones, the rest spread over 4096.
+    void RegisterCacheBenchmarks()
+    {
+        const std::size_t requests = 1024;
+
+        std::mt19937 gen(1);
+        std::vector<int> ids(requests);
+        for (auto& id : ids)
+            id = gen() % 5 < 4 ? static_cast<int>(gen() % 32) : static_cast<int>(32 + gen() % 4096);
+
+        Benchmark::Register("SmartPointers", "decode every request", [ids](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(ids.size());
+            while (state.KeepRunning())
+            {
+                for (auto id : ids)
+                {
+                    auto texture = WeakPtrExamples::DecodeTexture(id);
+                    Benchmark::DoNotOptimize(texture->Pixels.data());
+                }
+            }
+        });
+
+        Benchmark::Register("SmartPointers", "WeakCache GetOrLoad (64 in LRU)", [ids](Benchmark::State& state)
+        {
+            WeakCache<int, WeakPtrExamples::Texture> cache(64);
+            state.SetItemsPerIteration(ids.size());
+            while (state.KeepRunning())
+            {
+                for (auto id : ids)
+                {
+                    auto texture = cache.GetOrLoad(id, [id]() { return WeakPtrExamples::DecodeTexture(id); });
+                    Benchmark::DoNotOptimize(texture->Pixels.data());
+                }
+            }
+        });
+
+        Benchmark::Register("SmartPointers", "WeakCache Find hit", [requests](Benchmark::State& state)
+        {
+            WeakCache<int, WeakPtrExamples::Texture> cache(64);
+            for (int id = 0; id < 32; ++id)
+                cache.Insert(id, WeakPtrExamples::DecodeTexture(id));
+            state.SetItemsPerIteration(requests);
+            while (state.KeepRunning())
+            {
+                for (std::size_t i = 0; i < requests; ++i)
+                {
+                    auto texture = cache.Find(static_cast<int>(i % 32));
+                    Benchmark::DoNotOptimize(texture.get());
+                }
+            }
+        });
+    }
+
+    void RegisterBenchmarks()
+    {
+        RegisterPoolBenchmarks();
+        RegisterCacheBenchmarks();
+
+        const std::size_t count = 64;
+
+        std::vector<std::shared_ptr<string>> shared;
+        std::vector<LocalSharedPtr<string>> local;
+        std::vector<IntrusivePtr<IntrusivePtrExamples::Book>> intrusive;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            auto title = "Book " + std::to_string(i);
+            shared.push_back(std::make_shared<string>(title));
+            local.push_back(MakeLocalShared<string>(title));
+            intrusive.push_back(MakeIntrusive<IntrusivePtrExamples::Book>(title));
+        }
+
+        RegisterLibraryBenchmark("shared_ptr", shared);
+        RegisterLibraryBenchmark("LocalSharedPtr", local);
+        RegisterLibraryBenchmark("IntrusivePtr", intrusive);
     }
 }
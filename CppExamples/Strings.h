@@ -4,6 +4,11 @@
 #include <string>
 #include <sstream> // ostringstream
 #include <algorithm> // find_if_not
+#include <iomanip> // setprecision
+#include "Examples/TextBuilder.h" // TextBuilder
+#include "Examples/StringViews.h" // TrimView, Split, SplitWords
+#include "Examples/ByteSearch.h" // CountByte, FindFirstOf, Find
+#include "Benchmark.h" // Benchmark::Register
 
 using std::cout;
 using std::endl;
@@ -28,19 +33,10 @@ using std::basic_string;
 namespace StringsExamples
 {
     // Trim removes whitespaces from either end of a string.
+    // It returns a new string; TrimView does the same without copying.
     string Trim(string const & s)
     {
-        // Find the first non-whitespace character - the front of the substring.
-        // Use the isspace() function as a predicate.
-        auto front = std::find_if_not(begin(s), end(s), isspace);
-
-        // Find the last whitespace character - to the back of the substring.
-        auto back = std::find_if_not(rbegin(s), rend(s), isspace);
-
-        // The front and back define the half-open range. 'back' is a reverse iterator 
-        // pointing to the last whitespace character. We turn it into a regular iterator 
-        // using the base() method that returns the iterator's underlying base iterator. 
-        return string{ front, back.base() };
+        return string{ TrimView(s) };
     }
 
     void assert(bool condition)
@@ -170,6 +166,12 @@ namespace StringsExamples
         if (ci != s.end()) // check if there are any Cs
             cout << *ci << " "; // 'c'
 
+        // The same with the vectorized kernels. They pay off on long strings.
+        s = "abcdec abcd ef gi";
+        cout << "cnt=" << ByteSearch::CountByte(s, 'c') << " ";  // 3
+        cout << ByteSearch::FindFirstOf(s, " \t") << " ";        // 6
+        cout << ByteSearch::Find(s, "ef") << " ";                // 12
+
         // Replace a substring.
         s = "Hello there!";
         cout << s.substr(6, 5) << " "; // substr(index,length) - "there"
@@ -205,6 +207,32 @@ namespace StringsExamples
         cout << text << " "; // a:1,b:2.2
     }
 
+    // TextBuilder produces the same text as ConcatenateValues and StringBuilder without a stream.
+    // The formatting is given for each value rather than set on the stream.
+    void TextBuilderExamples()
+    {
+        TextBuilder<> b;
+        b << 5 << " " << Fixed(3.56789, 4) << " ";
+        cout << b.View(); // 5 3.5679
+
+        b.Clear();
+        b << "a:" << 1 << ",";
+        b << "b:" << 2.2;
+        cout << b.View() << " "; // a:1,b:2.2
+
+        b.Clear();
+        b << Hex(0xBEEF, 8, true) << " " << Hex(255) << " " << Fixed(2.5, 2, 6) << " " << Scientific(12345.678, 2);
+        cout << b.View() << " "; // 0000BEEF ff   2.50 1.23e+04
+
+        // Once the text does not fit in the inline buffer, the builder allocates.
+        // Moving it into a string hands over the allocation instead of copying the text.
+        TextBuilder<16> small;
+        for (int i = 0; i < 10; ++i)
+            small << i << ",";
+        string text = std::move(small).ToString();
+        cout << text << " "; // 0,1,2,3,4,5,6,7,8,9,
+    }
+
     // Split space-separated substrings into variables.
     // Useful when reading command-line parameters.
     void ReadValues()
@@ -220,6 +248,26 @@ namespace StringsExamples
         cout << va << vb << " ";
     }
 
+    // Split strings into string_views without a stringstream and without allocating.
+    void SplitValues()
+    {
+        // Fields separated by a delimiter. Empty fields are kept.
+        string csv = " id , name ,, price ";
+        for (auto field : Split(csv, ','))
+            cout << "[" << TrimView(field) << "]"; // [id][name][][price]
+        cout << " ";
+
+        // Whitespace-separated words, the same as ReadValues.
+        string commandLine = " a \t b\n";
+        for (auto word : SplitWords(commandLine))
+            cout << word; // ab
+        cout << " ";
+
+        // The views point into the original string.
+        auto trimmed = TrimView(csv);
+        assert(trimmed.data() == csv.data() + 1);
+    }
+
     void CharType()
     {
         // Signed and unsigned char.
@@ -287,13 +335,221 @@ namespace StringsExamples
         size_t len = strlen(src); // len=5 
     }
 
+    // Compares the owning Trim and stringstream splitting with the string_view utilities.
+    void RegisterViewBenchmarks()
+    {
+        Benchmark::Register("Strings", "Trim", [](Benchmark::State& state)
+        {
+            string s = " \t  field value  \r\n";
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Trim(s));
+        });
+
+        Benchmark::Register("Strings", "TrimView", [](Benchmark::State& state)
+        {
+            string s = " \t  field value  \r\n";
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(TrimView(s));
+        });
+
+        // A CSV line of 32 fields.
+        string line;
+        for (int i = 0; i < 32; ++i)
+            line += " field" + std::to_string(i) + " ,";
+        line.pop_back();
+
+        Benchmark::Register("Strings", "getline split + Trim", [line](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(32);
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                std::istringstream ss(line);
+                string field;
+                while (std::getline(ss, field, ','))
+                    length += Trim(field).size();
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+
+        Benchmark::Register("Strings", "Split + TrimView", [line](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(32);
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                for (auto field : Split(line, ','))
+                    length += TrimView(field).size();
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+
+        Benchmark::Register("Strings", "stringstream words", [line](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(32);
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                std::istringstream ss(line);
+                string word;
+                while (ss >> word)
+                    length += word.size();
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+
+        Benchmark::Register("Strings", "SplitWords", [line](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(32);
+            while (state.KeepRunning())
+            {
+                std::size_t length = 0;
+                for (auto word : SplitWords(line))
+                    length += word.size();
+                Benchmark::DoNotOptimize(length);
+            }
+        });
+    }
+
+    // Compares std::count, string::find_first_of and string::find with the ByteSearch kernels
+    // for each instruction set on a 1MB buffer.
+    void RegisterSearchBenchmarks()
+    {
+        // Words of lower-case letters separated by spaces, without tabs or digits.
+        string text;
+        unsigned seed = 1;
+        while (text.size() < 1'000'000)
+        {
+            seed = seed * 1103515245 + 12345;
+            text += static_cast<char>('a' + (seed >> 16) % 26);
+            if ((seed >> 8) % 6 == 0)
+                text += ' ';
+        }
+        text += "\t42 needle";
+        const auto size = static_cast<double>(text.size());
+
+        Benchmark::Register("Strings", "std::count", [text, size](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(size);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(std::count(begin(text), end(text), ' '));
+        });
+
+        Benchmark::Register("Strings", "string::find_first_of", [text, size](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(size);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(text.find_first_of("\t0123456789"));
+        });
+
+        Benchmark::Register("Strings", "string::find", [text, size](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(size);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(text.find("needle"));
+        });
+
+        for (auto isa : { ByteSearch::Isa::Scalar, ByteSearch::Isa::SSE2, ByteSearch::Isa::AVX2 })
+        {
+            // Don't register the kernels this CPU does not support.
+            if (isa > ByteSearch::ActiveIsa())
+                continue;
+
+            auto suffix = string(" ") + ByteSearch::IsaName(isa);
+
+            Benchmark::Register("Strings", "CountByte" + suffix, [text, size, isa](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(size);
+                while (state.KeepRunning())
+                    Benchmark::DoNotOptimize(ByteSearch::CountByte(text, ' ', isa));
+            });
+
+            Benchmark::Register("Strings", "FindFirstOf" + suffix, [text, size, isa](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(size);
+                while (state.KeepRunning())
+                    Benchmark::DoNotOptimize(ByteSearch::FindFirstOf(text, "\t0123456789", isa));
+            });
+
+            Benchmark::Register("Strings", "Find" + suffix, [text, size, isa](Benchmark::State& state)
+            {
+                state.SetItemsPerIteration(size);
+                while (state.KeepRunning())
+                    Benchmark::DoNotOptimize(ByteSearch::Find(text, "needle", isa));
+            });
+        }
+    }
+
+    // Compares ostringstream with TextBuilder on the text of ConcatenateValues and StringBuilder.
+    void RegisterBenchmarks()
+    {
+        Benchmark::Register("Strings", "ostringstream fixed", [](Benchmark::State& state)
+        {
+            double value = 3.56789;
+            while (state.KeepRunning())
+            {
+                std::ostringstream buffer;
+                buffer << 5 << " "
+                    << std::setiosflags(std::ios::fixed | std::ios::showpoint) << std::setprecision(4)
+                    << value << " ";
+                auto text = buffer.str();
+                Benchmark::DoNotOptimize(text);
+            }
+        });
+
+        Benchmark::Register("Strings", "TextBuilder fixed", [](Benchmark::State& state)
+        {
+            double value = 3.56789;
+            while (state.KeepRunning())
+            {
+                TextBuilder<> b;
+                b << 5 << " " << Fixed(value, 4) << " ";
+                auto text = std::move(b).ToString();
+                Benchmark::DoNotOptimize(text);
+            }
+        });
+
+        Benchmark::Register("Strings", "ostringstream key-values", [](Benchmark::State& state)
+        {
+            const int count = 100;
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                std::ostringstream buffer;
+                for (int i = 0; i < count; ++i)
+                    buffer << "a:" << i << ",b:" << i * 0.5 << ",";
+                auto text = buffer.str();
+                Benchmark::DoNotOptimize(text);
+            }
+        });
+
+        Benchmark::Register("Strings", "TextBuilder key-values", [](Benchmark::State& state)
+        {
+            const int count = 100;
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                TextBuilder<> b;
+                for (int i = 0; i < count; ++i)
+                    b << "a:" << i << ",b:" << i * 0.5 << ",";
+                auto text = std::move(b).ToString();
+                Benchmark::DoNotOptimize(text);
+            }
+        });
+
+        RegisterViewBenchmarks();
+        RegisterSearchBenchmarks();
+    }
+
     void Test()
     {
         StringBasics();
         StringOperations();
         ConcatenateValues();
         StringBuilder();
+        TextBuilderExamples();
         ReadValues();
+        SplitValues();
         CharType();
         CStyleStrings();
     }
@@ -6,6 +6,10 @@
 #include <string>
 #include <complex>
 #include <vector>
+#include <cmath> // sin
+#include "Examples/LookupTables.h"
+#include "Examples/Reductions.h"
+#include "Benchmark.h"
 
 using std::cout;
 using std::endl;
@@ -144,7 +148,7 @@ namespace TemplatesExamples
         public:
             Accumulator(T start) : m_total(start) { };
             T operator+=(const T& t) { return m_total += t; };
-            T GetTotal() { return m_total; }
+            T GetTotal() const { return m_total; }
         private:
             T m_total;
         };
@@ -172,6 +176,21 @@ namespace TemplatesExamples
             accum2 += "Hello";
             accum2 += "World";
             cout << accum2.GetTotal() << " ";
+
+            //
+            // Reductions: ten million times 0.1f
+            //
+            vector<float> tenths(10'000'000, 0.1f);
+            Accumulator<float> naive(0.0f);
+            for (auto x : tenths)
+                naive += x;
+            cout << std::fixed << std::setprecision(0)
+                << naive.GetTotal() << " "                                                             // 1087937
+                << Reductions::LaneSum(tenths.data(), tenths.size()) << " "                            // 1010792
+                << Reductions::PairwiseSum(tenths.data(), tenths.size()) << " "                        // 1000000
+                << Reductions::Accumulate(Reductions::KahanSum<float>(), tenths.begin(), tenths.end()).GetTotal() << " "; // 1000000
+            cout.unsetf(std::ios_base::floatfield);
+            cout << std::setprecision(6);
         }
     }
 
@@ -299,7 +318,7 @@ namespace TemplatesExamples
         public:
             Accumulator(T start) : m_total(start) { };
             T operator+=(const T& t) { return m_total += t; };
-            T GetTotal() { return m_total; }
+            T GetTotal() const { return m_total; }
         private:
             T m_total;
         };
@@ -317,7 +336,10 @@ namespace TemplatesExamples
         public:
             Accumulator(float start) : m_total(start) { };
             float operator+=(const Book& b) { return m_total += b.Price; };
-            float GetTotal() { return m_total; }
+            float GetTotal() const { return m_total; }
+
+            // Merge adds the total of another accumulator (Reductions::Merge can't add it as a Book).
+            void Merge(const Accumulator& other) { m_total += other.m_total; }
         private:
             float m_total;
         };
@@ -340,6 +362,13 @@ namespace TemplatesExamples
             accum += b1;
             accum += b2;
             cout << std::setprecision(1) << accum.GetTotal() << " ";
+
+            // The accumulator on a thread pool: each chunk of the books gets its own accumulator and the
+            // accumulators are merged in order.
+            vector<Book> books(1000, Book{ "C", 0.5f });
+            Tasks::ThreadPool pool(2);
+            auto total = Reductions::Reduce(pool, books.begin(), books.end(), []() { return Accumulator<Book>(0.0f); });
+            cout << std::setprecision(4) << total.GetTotal() << " "; // 500
         }
     }
 
@@ -607,11 +636,34 @@ namespace TemplatesExamples
             enum { value = 1 };
         };
 
+        // The same with a constexpr function: one table from one call instead of one type per value.
+        // See Examples/LookupTables.h for the compile-time and object-size comparison.
+        void ConstexprTables()
+        {
+            using namespace LookupTables;
+
+            // Factorials and Factorial<n>::value are both compile-time constants.
+            static_assert(Factorials[4] == Factorial<4>::value, "4!");
+
+            cout << "10!=" << Factorials[10] << " "; // 3628800
+            cout << "2^40=" << PowerTable<2, 64>[40] << " "; // 1099511627776
+            cout << "C(52,5)=" << Binomials[52][5] << " "; // 2598960 poker hands
+
+            cout << std::setprecision(6);
+            cout << "sin(45)=" << FastSin(32) << ",std::sin:" << std::sin(LookupTables::Pi / 4) << " "; // 0.707107,std::sin:0.707107
+            cout << "cos(180)=" << FastCos(128) << " "; // -1.000000 (fixed is still set)
+
+            string text = "The quick brown fox jumps over the lazy dog";
+            cout << "crc32=" << std::hex << Crc32(text.data(), text.size()) << std::dec << " "; // 414fa339
+        }
+
         void Test()
         {
             // Pre-calculate factorials in *compile time*.
             int x = Factorial<4>::value; // 24
             int y = Factorial<0>::value; // 1
+
+            ConstexprTables();
         }
     }
 
@@ -620,5 +672,111 @@ namespace TemplatesExamples
         ConsumingTemplates::Test();
         TemplateClasses::Test();
         TemplateFunctions::Test();
+        TemplateMetaprogramming::Test();
+    }
+
+    void RegisterBenchmarks()
+    {
+        using namespace LookupTables;
+
+        const int count = 1 << 16;
+
+        Benchmark::Register("Templates", "std::sin", [](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                float sum = 0;
+                for (int i = 0; i < count; ++i)
+                    sum += static_cast<float>(std::sin(2 * Pi * (i & 255) / 256));
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        Benchmark::Register("Templates", "constexpr sin table", [](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(count);
+            while (state.KeepRunning())
+            {
+                float sum = 0;
+                for (int i = 0; i < count; ++i)
+                    sum += FastSin(static_cast<unsigned char>(i));
+                Benchmark::DoNotOptimize(sum);
+            }
+        });
+
+        // Summing 4M floats one at a time, with the reductions, and on the default pool.
+        vector<float> floats(1 << 22);
+        std::uint32_t x = 1;
+        for (auto& f : floats)
+        {
+            x = x * 1664525 + 1013904223;
+            f = static_cast<float>(x >> 8) / (1 << 24);
+        }
+        const auto floatCount = static_cast<double>(floats.size());
+
+        Benchmark::Register("Reductions", "Accumulator<float>", [floats, floatCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(floatCount);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Reductions::Accumulate(TemplateClasses::Accumulator<float>(0.0f), floats.begin(), floats.end()).GetTotal());
+        });
+
+        Benchmark::Register("Reductions", "LaneSum", [floats, floatCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(floatCount);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Reductions::LaneSum(floats.data(), floats.size()));
+        });
+
+        Benchmark::Register("Reductions", "PairwiseSum", [floats, floatCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(floatCount);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Reductions::PairwiseSum(floats.data(), floats.size()));
+        });
+
+        Benchmark::Register("Reductions", "KahanSum", [floats, floatCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(floatCount);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Reductions::Accumulate(Reductions::KahanSum<float>(), floats.begin(), floats.end()).GetTotal());
+        });
+
+        Benchmark::Register("Reductions", "NeumaierSum", [floats, floatCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(floatCount);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Reductions::Accumulate(Reductions::NeumaierSum<float>(), floats.begin(), floats.end()).GetTotal());
+        });
+
+        Benchmark::Register("Reductions", "Reduce NeumaierSum (default pool)", [floats, floatCount](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(floatCount);
+            while (state.KeepRunning())
+            {
+                auto sum = Reductions::Reduce(Tasks::ThreadPool::Default(), floats.begin(), floats.end(), []() { return Reductions::NeumaierSum<float>(); });
+                Benchmark::DoNotOptimize(sum.GetTotal());
+            }
+        });
+
+        vector<unsigned char> data(1 << 16);
+        for (std::size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<unsigned char>(i * 31);
+        const auto size = static_cast<double>(data.size());
+
+        Benchmark::Register("Templates", "crc32 bitwise", [data, size](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(size);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Crc32Bitwise(data.data(), data.size()));
+        });
+
+        Benchmark::Register("Templates", "crc32 constexpr table", [data, size](Benchmark::State& state)
+        {
+            state.SetItemsPerIteration(size);
+            while (state.KeepRunning())
+                Benchmark::DoNotOptimize(Crc32(data.data(), data.size()));
+        });
     }
 }
\ No newline at end of file
@@ -0,0 +1,548 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <random>
+#include <algorithm> // min, max, copy
+#include <cmath>
+#include <cstdint> // int32_t, uint32_t
+#include <cstring> // memcpy
+#include <cfloat> // FLT_MIN
+
+#include "BatchMath.h"
+#include "Timing.h"
+
+#if defined(__AVX512F__) || defined(_XM_AVX2_INTRINSICS_)
+#include <immintrin.h> // __m512, __m256
+#endif
+
+using namespace DirectX;
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+    // The operations the kernels are written with, on a register of Width floats (F) or 32-bit integers (I).
+
+    // One float at a time, for the builds without SSE2 or AVX (ARM, _XM_NO_INTRINSICS_).
+    struct ScalarOps
+    {
+        typedef float F;
+        typedef std::int32_t I;
+        static const std::size_t Width = 1;
+
+        static F Load(const float* p) { return *p; }
+        static void Store(float* p, F a) { *p = a; }
+        static F Set(float a) { return a; }
+        static I SetInt(std::int32_t a) { return a; }
+
+        static F Add(F a, F b) { return a + b; }
+        static F Subtract(F a, F b) { return a - b; }
+        static F Multiply(F a, F b) { return a * b; }
+        static F MultiplyAdd(F a, F b, F c) { return a * b + c; }
+        static F Divide(F a, F b) { return a / b; }
+        static F Min(F a, F b) { return a < b ? a : b; }
+        static F Max(F a, F b) { return a > b ? a : b; }
+        static F Sqrt(F a) { return std::sqrt(a); }
+        static F ReciprocalSqrtEst(F a) { return 1.f / std::sqrt(a); }
+
+        // KeepIfGreater returns a where x > limit, and 0 elsewhere.
+        static F KeepIfGreater(F a, F x, F limit) { return x > limit ? a : 0.f; }
+
+        static I Round(F a) { return static_cast<I>(std::lrint(a)); }
+        static F ToFloat(I a) { return static_cast<F>(a); }
+        static I AsInt(F a) { I i; std::memcpy(&i, &a, sizeof(i)); return i; }
+        static F AsFloat(I a) { F f; std::memcpy(&f, &a, sizeof(f)); return f; }
+
+        static I AddInt(I a, I b) { return static_cast<I>(static_cast<std::uint32_t>(a) + static_cast<std::uint32_t>(b)); }
+        static I SubtractInt(I a, I b) { return static_cast<I>(static_cast<std::uint32_t>(a) - static_cast<std::uint32_t>(b)); }
+        static I XorInt(I a, I b) { return a ^ b; }
+        template <int N> static I ShiftLeft(I a) { return static_cast<I>(static_cast<std::uint32_t>(a) << N); }
+        template <int N> static I ShiftRightArithmetic(I a) { return a >> N; }
+    };
+
+#if defined(_XM_SSE_INTRINSICS_)
+    struct SseOps
+    {
+        typedef __m128 F;
+        typedef __m128i I;
+        static const std::size_t Width = 4;
+
+        static F Load(const float* p) { return _mm_loadu_ps(p); }
+        static void Store(float* p, F a) { _mm_storeu_ps(p, a); }
+        static F Set(float a) { return _mm_set1_ps(a); }
+        static I SetInt(std::int32_t a) { return _mm_set1_epi32(a); }
+
+        static F Add(F a, F b) { return _mm_add_ps(a, b); }
+        static F Subtract(F a, F b) { return _mm_sub_ps(a, b); }
+        static F Multiply(F a, F b) { return _mm_mul_ps(a, b); }
+#if defined(_XM_FMA3_INTRINSICS_)
+        static F MultiplyAdd(F a, F b, F c) { return _mm_fmadd_ps(a, b, c); }
+#else
+        static F MultiplyAdd(F a, F b, F c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+#endif
+        static F Divide(F a, F b) { return _mm_div_ps(a, b); }
+        static F Min(F a, F b) { return _mm_min_ps(a, b); }
+        static F Max(F a, F b) { return _mm_max_ps(a, b); }
+        static F Sqrt(F a) { return _mm_sqrt_ps(a); }
+        static F ReciprocalSqrtEst(F a) { return _mm_rsqrt_ps(a); }
+        static F KeepIfGreater(F a, F x, F limit) { return _mm_and_ps(a, _mm_cmpgt_ps(x, limit)); }
+
+        static I Round(F a) { return _mm_cvtps_epi32(a); }
+        static F ToFloat(I a) { return _mm_cvtepi32_ps(a); }
+        static I AsInt(F a) { return _mm_castps_si128(a); }
+        static F AsFloat(I a) { return _mm_castsi128_ps(a); }
+
+        static I AddInt(I a, I b) { return _mm_add_epi32(a, b); }
+        static I SubtractInt(I a, I b) { return _mm_sub_epi32(a, b); }
+        static I XorInt(I a, I b) { return _mm_xor_si128(a, b); }
+        template <int N> static I ShiftLeft(I a) { return _mm_slli_epi32(a, N); }
+        template <int N> static I ShiftRightArithmetic(I a) { return _mm_srai_epi32(a, N); }
+    };
+#endif
+
+#if defined(_XM_AVX2_INTRINSICS_)
+    struct Avx2Ops
+    {
+        typedef __m256 F;
+        typedef __m256i I;
+        static const std::size_t Width = 8;
+
+        static F Load(const float* p) { return _mm256_loadu_ps(p); }
+        static void Store(float* p, F a) { _mm256_storeu_ps(p, a); }
+        static F Set(float a) { return _mm256_set1_ps(a); }
+        static I SetInt(std::int32_t a) { return _mm256_set1_epi32(a); }
+
+        static F Add(F a, F b) { return _mm256_add_ps(a, b); }
+        static F Subtract(F a, F b) { return _mm256_sub_ps(a, b); }
+        static F Multiply(F a, F b) { return _mm256_mul_ps(a, b); }
+        static F MultiplyAdd(F a, F b, F c) { return _mm256_fmadd_ps(a, b, c); }
+        static F Divide(F a, F b) { return _mm256_div_ps(a, b); }
+        static F Min(F a, F b) { return _mm256_min_ps(a, b); }
+        static F Max(F a, F b) { return _mm256_max_ps(a, b); }
+        static F Sqrt(F a) { return _mm256_sqrt_ps(a); }
+        static F ReciprocalSqrtEst(F a) { return _mm256_rsqrt_ps(a); }
+        static F KeepIfGreater(F a, F x, F limit) { return _mm256_and_ps(a, _mm256_cmp_ps(x, limit, _CMP_GT_OQ)); }
+
+        static I Round(F a) { return _mm256_cvtps_epi32(a); }
+        static F ToFloat(I a) { return _mm256_cvtepi32_ps(a); }
+        static I AsInt(F a) { return _mm256_castps_si256(a); }
+        static F AsFloat(I a) { return _mm256_castsi256_ps(a); }
+
+        static I AddInt(I a, I b) { return _mm256_add_epi32(a, b); }
+        static I SubtractInt(I a, I b) { return _mm256_sub_epi32(a, b); }
+        static I XorInt(I a, I b) { return _mm256_xor_si256(a, b); }
+        template <int N> static I ShiftLeft(I a) { return _mm256_slli_epi32(a, N); }
+        template <int N> static I ShiftRightArithmetic(I a) { return _mm256_srai_epi32(a, N); }
+    };
+#endif
+
+#if defined(__AVX512F__)
+    // DirectXMath has no AVX-512 code path; /arch:AVX512 defines __AVX512F__.
+    struct Avx512Ops
+    {
+        typedef __m512 F;
+        typedef __m512i I;
+        static const std::size_t Width = 16;
+
+        static F Load(const float* p) { return _mm512_loadu_ps(p); }
+        static void Store(float* p, F a) { _mm512_storeu_ps(p, a); }
+        static F Set(float a) { return _mm512_set1_ps(a); }
+        static I SetInt(std::int32_t a) { return _mm512_set1_epi32(a); }
+
+        static F Add(F a, F b) { return _mm512_add_ps(a, b); }
+        static F Subtract(F a, F b) { return _mm512_sub_ps(a, b); }
+        static F Multiply(F a, F b) { return _mm512_mul_ps(a, b); }
+        static F MultiplyAdd(F a, F b, F c) { return _mm512_fmadd_ps(a, b, c); }
+        static F Divide(F a, F b) { return _mm512_div_ps(a, b); }
+        static F Min(F a, F b) { return _mm512_min_ps(a, b); }
+        static F Max(F a, F b) { return _mm512_max_ps(a, b); }
+        static F Sqrt(F a) { return _mm512_sqrt_ps(a); }
+        static F ReciprocalSqrtEst(F a) { return _mm512_rsqrt14_ps(a); }
+        static F KeepIfGreater(F a, F x, F limit) { return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(x, limit, _CMP_GT_OQ), a); }
+
+        static I Round(F a) { return _mm512_cvtps_epi32(a); }
+        static F ToFloat(I a) { return _mm512_cvtepi32_ps(a); }
+        static I AsInt(F a) { return _mm512_castps_si512(a); }
+        static F AsFloat(I a) { return _mm512_castsi512_ps(a); }
+
+        static I AddInt(I a, I b) { return _mm512_add_epi32(a, b); }
+        static I SubtractInt(I a, I b) { return _mm512_sub_epi32(a, b); }
+        static I XorInt(I a, I b) { return _mm512_xor_si512(a, b); }
+        template <int N> static I ShiftLeft(I a) { return _mm512_slli_epi32(a, N); }
+        template <int N> static I ShiftRightArithmetic(I a) { return _mm512_srai_epi32(a, N); }
+    };
+
+    typedef Avx512Ops WideOps;
+#elif defined(_XM_AVX2_INTRINSICS_)
+    typedef Avx2Ops WideOps;
+#elif defined(_XM_SSE_INTRINSICS_)
+    typedef SseOps WideOps;
+#else
+    typedef ScalarOps WideOps;
+#endif
+
+    // The kernels. The coefficients are minimax fits on the reduced ranges given in BatchMath.h;
+    // the comments give the largest error on the range.
+
+    template <typename V>
+    typename V::F Exp2(typename V::F x, MathAccuracy accuracy)
+    {
+        typename V::F clamped = V::Min(V::Max(x, V::Set(-126.f)), V::Set(127.f));
+        typename V::I n = V::Round(clamped);
+        typename V::F f = V::Subtract(clamped, V::ToFloat(n));
+
+        typename V::F p;
+        if (accuracy == MathAccuracy::Fast)
+        {
+            // relative error 1.7e-3
+            p = V::MultiplyAdd(V::MultiplyAdd(V::Set(0.238428923f), f, V::Set(0.703448005f)), f, V::Set(1.000443144f));
+        }
+        else
+        {
+            // relative error 7.5e-5
+            p = V::MultiplyAdd(V::Set(0.055171667f), f, V::Set(0.242611122f));
+            p = V::MultiplyAdd(V::MultiplyAdd(p, f, V::Set(0.693260986f)), f, V::Set(0.999928074f));
+        }
+
+        typename V::F result = V::AsFloat(V::AddInt(V::AsInt(p), V::template ShiftLeft<23>(n)));
+        return V::KeepIfGreater(result, x, V::Set(-125.f));
+    }
+
+    template <typename V>
+    typename V::F Log2(typename V::F x, MathAccuracy accuracy)
+    {
+        // Subtracting the bits of sqrt(0.5) splits x into e and m in [sqrt(0.5), sqrt(2)).
+        typename V::I bits = V::AsInt(x);
+        typename V::I e = V::template ShiftRightArithmetic<23>(V::SubtractInt(bits, V::SetInt(0x3F3504F3)));
+        typename V::F m = V::AsFloat(V::SubtractInt(bits, V::template ShiftLeft<23>(e)));
+        typename V::F one = V::Set(1.f);
+
+        typename V::F p;
+        if (accuracy == MathAccuracy::Fast)
+        {
+            // absolute error 5.6e-3
+            typename V::F u = V::Subtract(m, one);
+            p = V::Multiply(V::MultiplyAdd(V::Set(-0.699150471f), u, V::Set(1.483122326f)), u);
+        }
+        else
+        {
+            // absolute error 5.6e-6
+            typename V::F t = V::Divide(V::Subtract(m, one), V::Add(m, one));
+            p = V::Multiply(V::MultiplyAdd(V::Set(0.983534509f), V::Multiply(t, t), V::Set(2.885228570f)), t);
+        }
+
+        return V::Add(p, V::ToFloat(e));
+    }
+
+    template <typename V>
+    typename V::F Cos(typename V::F x, MathAccuracy accuracy)
+    {
+        // y = x - k*pi, with pi = 3.140625 + 9.67653589793e-4; k*3.140625 is exact for |k| < 2^15.
+        typename V::I k = V::Round(V::Multiply(x, V::Set(0.318309886f)));
+        typename V::F kf = V::ToFloat(k);
+        typename V::F y = V::MultiplyAdd(kf, V::Set(-3.140625f), x);
+        y = V::MultiplyAdd(kf, V::Set(-9.67653589793e-4f), y);
+        typename V::F y2 = V::Multiply(y, y);
+
+        typename V::F p;
+        if (accuracy == MathAccuracy::Fast)
+        {
+            // absolute error 6.0e-4
+            p = V::MultiplyAdd(V::MultiplyAdd(V::Set(0.036791683f), y2, V::Set(-0.495580849f)), y2, V::Set(0.999403229f));
+        }
+        else
+        {
+            // absolute error 6.7e-6
+            p = V::MultiplyAdd(V::Set(-0.001271209f), y2, V::Set(0.041487748f));
+            p = V::MultiplyAdd(V::MultiplyAdd(p, y2, V::Set(-0.499912440f)), y2, V::Set(0.999993295f));
+        }
+
+        // Flip the sign for odd k.
+        return V::AsFloat(V::XorInt(V::AsInt(p), V::template ShiftLeft<31>(k)));
+    }
+
+    template <typename V>
+    typename V::F Sqrt(typename V::F x, MathAccuracy accuracy)
+    {
+        // rsqrt(0) is infinite; x is raised to FLT_MIN and the results for x <= 0 are set to 0.
+        typename V::F r = V::ReciprocalSqrtEst(V::Max(x, V::Set(FLT_MIN)));
+        if (accuracy == MathAccuracy::Estimate)
+        {
+            // One Newton step: r = r * (1.5 - 0.5 * x * r * r).
+            typename V::F halfX = V::Multiply(x, V::Set(0.5f));
+            r = V::Multiply(r, V::MultiplyAdd(V::Multiply(halfX, r), V::Subtract(V::Set(0.f), r), V::Set(1.5f)));
+        }
+        return V::KeepIfGreater(V::Multiply(x, r), x, V::Set(0.f));
+    }
+
+    // Map calls kernel(register) over the span, WideOps::Width floats at a time. The last, partial register is
+    // evaluated in a padded copy of the input. The padding is 1, a valid argument to every function.
+    template <typename Kernel>
+    void Map(float* output, const float* input, std::size_t count, Kernel kernel)
+    {
+        typedef WideOps V;
+
+        std::size_t i = 0;
+        for (; i + V::Width <= count; i += V::Width)
+            V::Store(output + i, kernel(V::Load(input + i)));
+
+        if (i < count)
+        {
+            float buffer[V::Width];
+            std::fill(buffer, buffer + V::Width, 1.f);
+            std::copy(input + i, input + count, buffer);
+            V::Store(buffer, kernel(V::Load(buffer)));
+            std::copy(buffer, buffer + (count - i), output + i);
+        }
+    }
+
+    template <typename Kernel>
+    void Map(float* output, const float* input1, const float* input2, std::size_t count, Kernel kernel)
+    {
+        typedef WideOps V;
+
+        std::size_t i = 0;
+        for (; i + V::Width <= count; i += V::Width)
+            V::Store(output + i, kernel(V::Load(input1 + i), V::Load(input2 + i)));
+
+        if (i < count)
+        {
+            float buffer1[V::Width], buffer2[V::Width];
+            std::fill(buffer1, buffer1 + V::Width, 1.f);
+            std::fill(buffer2, buffer2 + V::Width, 1.f);
+            std::copy(input1 + i, input1 + count, buffer1);
+            std::copy(input2 + i, input2 + count, buffer2);
+            V::Store(buffer1, kernel(V::Load(buffer1), V::Load(buffer2)));
+            std::copy(buffer1, buffer1 + (count - i), output + i);
+        }
+    }
+
+    // The full-accuracy functions: the DirectXMath function on XMVECTORs.
+    template <typename Function>
+    void MapXM(float* output, const float* input, std::size_t count, Function function)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(output + i), function(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(input + i))));
+
+        for (; i < count; ++i)
+            output[i] = XMVectorGetX(function(XMVectorReplicate(input[i])));
+    }
+}
+
+void BatchCos(float* output, const float* input, std::size_t count, MathAccuracy accuracy)
+{
+    if (accuracy == MathAccuracy::Full)
+        MapXM(output, input, count, [](FXMVECTOR v) { return XMVectorCos(v); });
+    else
+        Map(output, input, count, [accuracy](WideOps::F x) { return Cos<WideOps>(x, accuracy); });
+}
+
+void BatchLog2(float* output, const float* input, std::size_t count, MathAccuracy accuracy)
+{
+    if (accuracy == MathAccuracy::Full)
+        MapXM(output, input, count, [](FXMVECTOR v) { return XMVectorLog2(v); });
+    else
+        Map(output, input, count, [accuracy](WideOps::F x) { return Log2<WideOps>(x, accuracy); });
+}
+
+void BatchExp2(float* output, const float* input, std::size_t count, MathAccuracy accuracy)
+{
+    if (accuracy == MathAccuracy::Full)
+        MapXM(output, input, count, [](FXMVECTOR v) { return XMVectorExp2(v); });
+    else
+        Map(output, input, count, [accuracy](WideOps::F x) { return Exp2<WideOps>(x, accuracy); });
+}
+
+void BatchSqrt(float* output, const float* input, std::size_t count, MathAccuracy accuracy)
+{
+    if (accuracy == MathAccuracy::Full)
+        Map(output, input, count, [](WideOps::F x) { return WideOps::Sqrt(x); });
+    else
+        Map(output, input, count, [accuracy](WideOps::F x) { return Sqrt<WideOps>(x, accuracy); });
+}
+
+void BatchPow(float* output, const float* base, const float* exponent, std::size_t count, MathAccuracy accuracy)
+{
+    if (accuracy == MathAccuracy::Full)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            XMVECTOR v = XMVectorPow(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(base + i)), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(exponent + i)));
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(output + i), v);
+        }
+        for (; i < count; ++i)
+            output[i] = XMVectorGetX(XMVectorPow(XMVectorReplicate(base[i]), XMVectorReplicate(exponent[i])));
+        return;
+    }
+
+    Map(output, base, exponent, count, [accuracy](WideOps::F x, WideOps::F y)
+    {
+        return Exp2<WideOps>(WideOps::Multiply(y, Log2<WideOps>(x, accuracy)), accuracy);
+    });
+}
+
+void BatchMathExample()
+{
+    cout.precision(4);
+
+    const char* names[] = { "full", "estimate", "fast" };
+    const MathAccuracy accuracies[] = { MathAccuracy::Full, MathAccuracy::Estimate, MathAccuracy::Fast };
+
+    // The arguments of ArithmeticOperations.
+    const float angles[] = { 0.0f, XM_PIDIV4, XM_PIDIV2, XM_PI };
+    const float powers[] = { 1.0f, 2.0f, 4.0f, 8.0f };
+    const float exponents[] = { 2.0f, 3.0f, 4.0f, 5.0f };
+    const float bases[] = { 2.0f, 3.0f, 4.0f, 5.0f };
+    const float baseExponents[] = { 4.0f, 3.0f, 2.0f, 1.0f };
+    const float squares[] = { 121.0f, 256.0f, 4.0f, 27.0f };
+
+    auto print = [](const char* function, const char* accuracy, const float* v)
+    {
+        cout << std::setw(5) << function << " " << std::setw(8) << accuracy << ": (" << v[0] << ", " << v[1] << ", " << v[2] << ", " << v[3] << ")" << endl;
+    };
+
+    float result[4];
+    for (int a = 0; a < 3; ++a)
+    {
+        BatchCos(result, angles, 4, accuracies[a]);
+        print("cos", names[a], result); // full: (1, 0.7071, -1.192e-07, -1), fast: (0.9994, 0.7077, 0.0005967, -0.9994)
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        BatchLog2(result, powers, 4, accuracies[a]);
+        print("log2", names[a], result); // (0, 1, 2, 3) at every accuracy: the mantissa of a power of 2 is 1
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        BatchExp2(result, exponents, 4, accuracies[a]);
+        print("exp2", names[a], result); // full: (4, 8, 16, 32), fast: (4.002, 8.004, 16.01, 32.01)
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        BatchPow(result, bases, baseExponents, 4, accuracies[a]);
+        print("pow", names[a], result); // full: (16, 27, 16, 5), fast: (16.01, 26.99, 16.01, 5.024)
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        BatchSqrt(result, squares, 4, accuracies[a]);
+        print("sqrt", names[a], result); // (11, 16, 2, 5.196)
+    }
+
+    cout << endl;
+}
+
+namespace
+{
+    // The distance in ulps between two floats: the number of floats between them, plus one.
+    double UlpDistance(float a, float b)
+    {
+        auto ordered = [](float f)
+        {
+            std::int32_t i;
+            std::memcpy(&i, &f, sizeof(i));
+            return i < 0 ? -static_cast<double>(i & 0x7FFFFFFF) : static_cast<double>(i);
+        };
+        return std::fabs(ordered(a) - ordered(b));
+    }
+
+    struct ErrorStats
+    {
+        double MaxUlps = 0;
+        double MaxError = 0;
+    };
+
+    // The error is absolute for the functions that have zeros (cos, log2). Near a zero, an absolute error
+    // of 1e-6 is millions of ulps, so their ulps are only counted where |f(x)| >= 0.5.
+    ErrorStats MeasureError(const std::vector<float>& result, const std::vector<double>& reference, bool relative)
+    {
+        ErrorStats stats;
+        for (std::size_t i = 0; i < result.size(); ++i)
+        {
+            double error = std::fabs(result[i] - reference[i]);
+            if (relative && reference[i] != 0)
+                error /= std::fabs(reference[i]);
+            stats.MaxError = std::max(stats.MaxError, error);
+            if (relative || std::fabs(reference[i]) >= 0.5)
+                stats.MaxUlps = std::max(stats.MaxUlps, UlpDistance(result[i], static_cast<float>(reference[i])));
+        }
+        return stats;
+    }
+}
+
+void BatchMathBenchmark()
+{
+    const std::size_t count = 1'000'000;
+
+    cout << "Apply cos, log2, exp2, pow, and sqrt to " << count << " floats, " << WideOps::Width << " at a time." << endl;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> angle(-100.f, 100.f), octave(-20.f, 20.f), smallOctave(-6.f, 6.f), power(-2.f, 2.f);
+
+    // The arguments and the results in double precision.
+    std::vector<float> angles(count), positives(count), exponents(count), bases(count), powers(count);
+    std::vector<double> cosRef(count), log2Ref(count), exp2Ref(count), powRef(count), sqrtRef(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        angles[i] = angle(gen);
+        positives[i] = std::exp2(octave(gen));
+        exponents[i] = octave(gen);
+        bases[i] = std::exp2(smallOctave(gen));
+        powers[i] = power(gen);
+
+        cosRef[i] = std::cos(static_cast<double>(angles[i]));
+        log2Ref[i] = std::log2(static_cast<double>(positives[i]));
+        exp2Ref[i] = std::exp2(static_cast<double>(exponents[i]));
+        powRef[i] = std::pow(static_cast<double>(bases[i]), static_cast<double>(powers[i]));
+        sqrtRef[i] = std::sqrt(static_cast<double>(positives[i]));
+    }
+
+    std::vector<float> output(count);
+
+    cout << "function  accuracy   max ulps   max error   M floats/s" << endl;
+    auto report = [&](const char* function, const char* accuracy, const std::vector<double>& reference, bool relative, double seconds)
+    {
+        ErrorStats stats = MeasureError(output, reference, relative);
+        cout << std::setw(8) << std::left << function << "  " << std::setw(8) << accuracy << std::right
+            << std::setw(11) << std::setprecision(0) << std::fixed << stats.MaxUlps
+            << std::setw(12) << std::setprecision(2) << std::scientific << stats.MaxError
+            << std::setw(13) << std::setprecision(0) << std::fixed << count / seconds / 1e6 << endl;
+        cout.unsetf(std::ios_base::floatfield);
+        cout << std::setprecision(6);
+    };
+
+    // The std:: functions, one float at a time, for comparison.
+    double seconds = TimeBestOf(5, [&]() { for (std::size_t i = 0; i < count; ++i) output[i] = std::cos(angles[i]); });
+    report("cos", "std::", cosRef, false, seconds);
+
+    const char* names[] = { "full", "estimate", "fast" };
+    const MathAccuracy accuracies[] = { MathAccuracy::Full, MathAccuracy::Estimate, MathAccuracy::Fast };
+
+    for (int a = 0; a < 3; ++a)
+    {
+        seconds = TimeBestOf(5, [&]() { BatchCos(output.data(), angles.data(), count, accuracies[a]); });
+        report("cos", names[a], cosRef, false, seconds);
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        seconds = TimeBestOf(5, [&]() { BatchLog2(output.data(), positives.data(), count, accuracies[a]); });
+        report("log2", names[a], log2Ref, false, seconds);
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        seconds = TimeBestOf(5, [&]() { BatchExp2(output.data(), exponents.data(), count, accuracies[a]); });
+        report("exp2", names[a], exp2Ref, true, seconds);
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        seconds = TimeBestOf(5, [&]() { BatchPow(output.data(), bases.data(), powers.data(), count, accuracies[a]); });
+        report("pow", names[a], powRef, true, seconds);
+    }
+    for (int a = 0; a < 3; ++a)
+    {
+        seconds = TimeBestOf(5, [&]() { BatchSqrt(output.data(), positives.data(), count, accuracies[a]); });
+        report("sqrt", names[a], sqrtRef, true, seconds);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef> // size_t
+
+#include <DirectXMath.h>
+
+/*
+Batch transcendental functions with a choice of accuracy.
+
+ArithmeticOperations calls XMVectorCos, XMVectorLog2, XMVectorExp2, XMVectorPow, and XMVectorSqrt
+on single vectors. They are accurate to about a float's precision, which audio and lighting code
+that calls them per sample seldom needs. The batch functions apply a function to a whole span of
+floats, at one of three accuracies:
+- MathAccuracy::Full: the DirectXMath function, four floats at a time (sqrt: the sqrt instruction).
+- MathAccuracy::Estimate: a short polynomial, with an error of about 1e-5 (about 1e-4 for exp2 and pow).
+- MathAccuracy::Fast: a shorter polynomial, with an error of about 1e-3 (about 1e-2 for pow).
+
+The polynomials are minimax fits on a reduced range:
+- exp2(x) = 2^n * 2^f, with n = round(x) and f in [-0.5, 0.5]. 2^n is added to the exponent bits.
+- log2(x) = e + log2(m), with x = m * 2^e and m in [sqrt(0.5), sqrt(2)). e and m are taken from the
+  bits of x. Estimate evaluates log2(m) as an odd polynomial of t = (m - 1) / (m + 1), Fast as a
+  quadratic of m - 1.
+- cos(x) = (-1)^k * cos(x - k*pi), with k = round(x / pi): an even polynomial on [-pi/2, pi/2].
+  pi is subtracted in two parts (Cody-Waite), so the reduction stays accurate to |x| ~ 1e5.
+- pow(x, y) = exp2(y * log2(x)): the error of log2 is multiplied by |y|.
+- sqrt(x) = x * rsqrt(x), from the reciprocal square root estimate instruction: Estimate refines it
+  with a Newton step, Fast uses it as is.
+The functions are evaluated branch-free on whole registers: 16 floats with AVX-512 (/arch:AVX512),
+8 with AVX2 (_XM_AVX2_INTRINSICS_), 4 with SSE2, one at a time otherwise. The last, partial
+register is evaluated in a padded copy, so every element goes through the same code.
+
+The Estimate and Fast functions expect finite arguments: log2 and pow a normal positive x, exp2
+flushes results below 2^-125 to zero and saturates at 2^127.
+
+BatchMathBenchmark prints the error of each function and accuracy, in ulps and as an absolute
+(cos, log2) or relative (the others) error, and its throughput. A million floats, AVX2: std::cos one
+float at a time ~90 M floats/s; the estimates of cos, log2, and exp2 ~2900 M floats/s, about as fast
+as copying the array, and the fast versions no faster; pow ~1200 (estimate) and ~2000 (fast).
+The sqrt instruction of a recent CPU is as fast as the estimates; they pay off on older CPUs.
+*/
+
+enum class MathAccuracy
+{
+    Full,
+    Estimate,
+    Fast
+};
+
+// The functions write f(input[i]) to output[i]. The output may be the input.
+void BatchCos(float* output, const float* input, std::size_t count, MathAccuracy accuracy = MathAccuracy::Full);
+void BatchLog2(float* output, const float* input, std::size_t count, MathAccuracy accuracy = MathAccuracy::Full);
+void BatchExp2(float* output, const float* input, std::size_t count, MathAccuracy accuracy = MathAccuracy::Full);
+void BatchSqrt(float* output, const float* input, std::size_t count, MathAccuracy accuracy = MathAccuracy::Full);
+
+// BatchPow writes base[i] raised to exponent[i] to output[i].
+void BatchPow(float* output, const float* base, const float* exponent, std::size_t count, MathAccuracy accuracy = MathAccuracy::Full);
+
+void BatchMathExample();
+void BatchMathBenchmark();
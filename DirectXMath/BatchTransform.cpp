@@ -0,0 +1,287 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <cstdint> // uintptr_t
+#include <cmath> // fabs
+
+#include "BatchTransform.h"
+#include "Timing.h"
+
+using namespace DirectX;
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+    template <typename T>
+    inline T* Advance(T* p, std::size_t bytes)
+    {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(p) + bytes);
+    }
+
+    template <typename T>
+    inline const T* Advance(const T* p, std::size_t bytes)
+    {
+        return reinterpret_cast<const T*>(reinterpret_cast<const char*>(p) + bytes);
+    }
+
+    inline bool IsAligned16(const void* p)
+    {
+        return (reinterpret_cast<std::uintptr_t>(p) & 15) == 0;
+    }
+
+    // Transforms a single XMFLOAT3 with the matrix rows already in registers.
+    // W is 1 for points and 0 for vectors.
+    template <int W>
+    inline void XM_CALLCONV TransformOne(XMFLOAT3* output, const XMFLOAT3* input, FXMMATRIX m)
+    {
+        XMVECTOR v = XMLoadFloat3(input);
+        XMVECTOR r = W ? XMVector3Transform(v, m) : XMVector3TransformNormal(v, m);
+        XMStoreFloat3(output, r);
+    }
+
+    // The serial kernel for XMFLOAT3 arrays.
+    template <int W>
+    void TransformFloat3Range(XMFLOAT3* output, std::size_t outputStride, const XMFLOAT3* input, std::size_t inputStride,
+        std::size_t count, FXMMATRIX m, bool nonTemporal)
+    {
+        std::size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        if (inputStride == sizeof(XMFLOAT3) && outputStride == sizeof(XMFLOAT3))
+        {
+            // Streaming stores need 16-byte aligned addresses. Transform single vertices until 
+            // the output is aligned; a packed XMFLOAT3 array gets there after at most three vertices.
+            if (nonTemporal)
+            {
+                while (i < count && !IsAligned16(output + i))
+                {
+                    TransformOne<W>(output + i, input + i, m);
+                    ++i;
+                }
+                nonTemporal = IsAligned16(output + i);
+            }
+
+            // The matrix elements replicated into all four lanes.
+            const XMVECTOR m00 = XMVectorSplatX(m.r[0]), m01 = XMVectorSplatY(m.r[0]), m02 = XMVectorSplatZ(m.r[0]);
+            const XMVECTOR m10 = XMVectorSplatX(m.r[1]), m11 = XMVectorSplatY(m.r[1]), m12 = XMVectorSplatZ(m.r[1]);
+            const XMVECTOR m20 = XMVectorSplatX(m.r[2]), m21 = XMVectorSplatY(m.r[2]), m22 = XMVectorSplatZ(m.r[2]);
+            const XMVECTOR m30 = W ? XMVectorSplatX(m.r[3]) : XMVectorZero();
+            const XMVECTOR m31 = W ? XMVectorSplatY(m.r[3]) : XMVectorZero();
+            const XMVECTOR m32 = W ? XMVectorSplatZ(m.r[3]) : XMVectorZero();
+
+            for (; i + 4 <= count; i += 4)
+            {
+                const float* src = &input[i].x;
+
+                // a = (x0 y0 z0 x1), b = (y1 z1 x2 y2), c = (z2 x3 y3 z3)
+                __m128 a = _mm_loadu_ps(src);
+                __m128 b = _mm_loadu_ps(src + 4);
+                __m128 c = _mm_loadu_ps(src + 8);
+
+                // Deinterleave into x = (x0 x1 x2 x3), y = (y0 y1 y2 y3), z = (z0 z1 z2 z3).
+                __m128 t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2)); // x2 y2 x3 y3
+                __m128 u = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1)); // y0 z0 y1 z1
+                __m128 x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(2, 0, 3, 0));
+                __m128 y = _mm_shuffle_ps(u, t, _MM_SHUFFLE(3, 1, 2, 0));
+                __m128 z = _mm_shuffle_ps(u, c, _MM_SHUFFLE(3, 0, 3, 1));
+
+                // out.x = x*m00 + y*m10 + z*m20 + m30, etc.
+                __m128 ox = XMVectorMultiplyAdd(x, m00, XMVectorMultiplyAdd(y, m10, XMVectorMultiplyAdd(z, m20, m30)));
+                __m128 oy = XMVectorMultiplyAdd(x, m01, XMVectorMultiplyAdd(y, m11, XMVectorMultiplyAdd(z, m21, m31)));
+                __m128 oz = XMVectorMultiplyAdd(x, m02, XMVectorMultiplyAdd(y, m12, XMVectorMultiplyAdd(z, m22, m32)));
+
+                // Interleave back into (x0 y0 z0 x1), (y1 z1 x2 y2), (z2 x3 y3 z3).
+                __m128 xyLo = _mm_unpacklo_ps(ox, oy);                         // x0 y0 x1 y1
+                __m128 xyHi = _mm_unpackhi_ps(ox, oy);                         // x2 y2 x3 y3
+                __m128 zx = _mm_shuffle_ps(oz, ox, _MM_SHUFFLE(1, 1, 0, 0));   // z0 z0 x1 x1
+                __m128 yz = _mm_shuffle_ps(oy, oz, _MM_SHUFFLE(1, 1, 1, 1));   // y1 y1 z1 z1
+                __m128 zxy = _mm_shuffle_ps(oz, xyHi, _MM_SHUFFLE(3, 2, 3, 2));// z2 z3 x3 y3
+
+                __m128 ra = _mm_shuffle_ps(xyLo, zx, _MM_SHUFFLE(2, 0, 1, 0));
+                __m128 rb = _mm_shuffle_ps(yz, xyHi, _MM_SHUFFLE(1, 0, 2, 0));
+                __m128 rc = _mm_shuffle_ps(zxy, zxy, _MM_SHUFFLE(1, 3, 2, 0));
+
+                float* dst = &output[i].x;
+                if (nonTemporal)
+                {
+                    _mm_stream_ps(dst, ra);
+                    _mm_stream_ps(dst + 4, rb);
+                    _mm_stream_ps(dst + 8, rc);
+                }
+                else
+                {
+                    _mm_storeu_ps(dst, ra);
+                    _mm_storeu_ps(dst + 4, rb);
+                    _mm_storeu_ps(dst + 8, rc);
+                }
+            }
+
+            // Streaming stores are weakly ordered. The fence makes them visible before any later store,
+            // e.g. the one that tells another thread the buffer is ready.
+            if (nonTemporal)
+                _mm_sfence();
+        }
+#else
+        (void)nonTemporal;
+#endif
+
+        // Strided arrays and the last few vertices.
+        for (; i < count; ++i)
+            TransformOne<W>(Advance(output, i * outputStride), Advance(input, i * inputStride), m);
+    }
+
+    void TransformFloat4Range(XMFLOAT4* output, std::size_t outputStride, const XMFLOAT4* input, std::size_t inputStride,
+        std::size_t count, FXMMATRIX m, bool nonTemporal)
+    {
+        std::size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        // An XMFLOAT4 fills a whole register, so there is nothing to shuffle. Only the stores differ.
+        if (nonTemporal && IsAligned16(output) && outputStride % 16 == 0)
+        {
+            for (; i < count; ++i)
+            {
+                XMVECTOR v = XMLoadFloat4(Advance(input, i * inputStride));
+                _mm_stream_ps(&Advance(output, i * outputStride)->x, XMVector4Transform(v, m));
+            }
+            _mm_sfence();
+        }
+#else
+        (void)nonTemporal;
+#endif
+
+        for (; i < count; ++i)
+        {
+            XMVECTOR v = XMLoadFloat4(Advance(input, i * inputStride));
+            XMStoreFloat4(Advance(output, i * outputStride), XMVector4Transform(v, m));
+        }
+    }
+
+    // Splits [0, count) into chunks and calls range(first, count) for each chunk on its own thread.
+    // The chunks are multiples of 64 elements so the threads do not write to the same cache line 
+    // in a packed array.
+    template <typename Range>
+    void ForEachChunk(std::size_t count, unsigned threads, Range range)
+    {
+        if (threads == 0)
+            threads = std::thread::hardware_concurrency();
+
+        const std::size_t minChunk = 16 * 1024;
+        if (threads <= 1 || count < 2 * minChunk)
+        {
+            range(0, count);
+            return;
+        }
+
+        std::size_t chunk = ((count + threads - 1) / threads + 63) / 64 * 64;
+        if (chunk < minChunk)
+            chunk = minChunk;
+
+        std::vector<std::thread> workers;
+        for (std::size_t first = chunk; first < count; first += chunk)
+        {
+            std::size_t n = count - first < chunk ? count - first : chunk;
+            workers.emplace_back([=]() { range(first, n); });
+        }
+
+        // The calling thread takes the first chunk.
+        range(0, chunk < count ? chunk : count);
+
+        for (auto& worker : workers)
+            worker.join();
+    }
+}
+
+void TransformPositions(XMFLOAT3* output, std::size_t outputStride, const XMFLOAT3* input, std::size_t inputStride,
+    std::size_t count, FXMMATRIX m, const TransformOptions& options)
+{
+    XMMATRIX matrix = m;
+    ForEachChunk(count, options.Threads, [=](std::size_t first, std::size_t n)
+    {
+        TransformFloat3Range<1>(Advance(output, first * outputStride), outputStride,
+            Advance(input, first * inputStride), inputStride, n, matrix, options.NonTemporal);
+    });
+}
+
+void TransformNormals(XMFLOAT3* output, std::size_t outputStride, const XMFLOAT3* input, std::size_t inputStride,
+    std::size_t count, FXMMATRIX m, const TransformOptions& options)
+{
+    XMMATRIX matrix = m;
+    ForEachChunk(count, options.Threads, [=](std::size_t first, std::size_t n)
+    {
+        TransformFloat3Range<0>(Advance(output, first * outputStride), outputStride,
+            Advance(input, first * inputStride), inputStride, n, matrix, options.NonTemporal);
+    });
+}
+
+void TransformFloat4(XMFLOAT4* output, std::size_t outputStride, const XMFLOAT4* input, std::size_t inputStride,
+    std::size_t count, FXMMATRIX m, const TransformOptions& options)
+{
+    XMMATRIX matrix = m;
+    ForEachChunk(count, options.Threads, [=](std::size_t first, std::size_t n)
+    {
+        TransformFloat4Range(Advance(output, first * outputStride), outputStride,
+            Advance(input, first * inputStride), inputStride, n, matrix, options.NonTemporal);
+    });
+}
+
+namespace
+{
+    float MaxDifference(const std::vector<XMFLOAT3>& a, const std::vector<XMFLOAT3>& b)
+    {
+        float result = 0.f;
+        for (std::size_t i = 0; i < a.size(); ++i)
+        {
+            float d = std::fabs(a[i].x - b[i].x) + std::fabs(a[i].y - b[i].y) + std::fabs(a[i].z - b[i].z);
+            if (d > result)
+                result = d;
+        }
+        return result;
+    }
+}
+
+void BatchTransformBenchmark()
+{
+    const std::size_t count = 1'000'000;
+
+    cout << "Transform " << count << " vertices." << endl;
+
+    std::vector<XMFLOAT3> positions(count), reference(count), output(count);
+    for (std::size_t i = 0; i < count; ++i)
+        positions[i] = XMFLOAT3(static_cast<float>(i % 1000), static_cast<float>(i / 1000), static_cast<float>(i % 7));
+
+    XMMATRIX world = XMMatrixScaling(2.f, 2.f, 2.f) * XMMatrixRotationY(0.5f) * XMMatrixTranslation(10.f, 20.f, 30.f);
+
+    // The usual per-vertex loop.
+    double perElement = TimeBestOf(5, [&]()
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR v = XMLoadFloat3(&positions[i]);
+            XMStoreFloat3(&reference[i], XMVector3Transform(v, world));
+        }
+    });
+
+    TransformOptions cached;
+    double batch = TimeBestOf(5, [&]() { TransformPositions(output.data(), sizeof(XMFLOAT3), positions.data(), sizeof(XMFLOAT3), count, world, cached); });
+    float batchError = MaxDifference(reference, output);
+
+    TransformOptions streaming;
+    streaming.NonTemporal = true;
+    double nonTemporal = TimeBestOf(5, [&]() { TransformPositions(output.data(), sizeof(XMFLOAT3), positions.data(), sizeof(XMFLOAT3), count, world, streaming); });
+    float nonTemporalError = MaxDifference(reference, output);
+
+    TransformOptions threaded;
+    threaded.NonTemporal = true;
+    threaded.Threads = 0;
+    double multiThreaded = TimeBestOf(5, [&]() { TransformPositions(output.data(), sizeof(XMFLOAT3), positions.data(), sizeof(XMFLOAT3), count, world, threaded); });
+    float multiThreadedError = MaxDifference(reference, output);
+
+    cout << "Max difference from the per-vertex loop: " << batchError << ", " << nonTemporalError << ", " << multiThreadedError << endl;
+    cout << "Per-vertex load/transform/store: " << count / perElement / 1e6 << " M vertices/s" << endl;
+    cout << "Batch:                           " << count / batch / 1e6 << " M vertices/s" << endl;
+    cout << "Batch, streaming stores:         " << count / nonTemporal / 1e6 << " M vertices/s" << endl;
+    cout << "Batch, streaming, " << std::thread::hardware_concurrency() << " threads:      " << count / multiThreaded / 1e6 << " M vertices/s" << endl;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef> // size_t
+
+#include <DirectXMath.h>
+
+/*
+Batch transformation of vertex arrays.
+
+MatrixLoadingStoring shows a single XMLoadFloat4x4/XMStoreFloat4x4 round trip. Transforming 
+a vertex buffer one vertex at a time with XMLoadFloat3, XMVector3Transform, and XMStoreFloat3
+wastes most of the SIMD register: an XMFLOAT3 load and store each take several instructions and
+every vertex needs four splats of its components.
+
+The batch functions transform a whole array by one matrix:
+- The matrix is loaded once and kept in registers for the whole array.
+- Contiguous XMFLOAT3 arrays are processed four vertices at a time: three 16-byte loads fetch 
+  the twelve floats, shuffles turn them into x, y, and z registers (structure-of-arrays),
+  the transform is 9 multiply-adds for four vertices, and three 16-byte stores write the result.
+- Optionally, the results are written with non-temporal (streaming) stores. Such stores bypass
+  the cache, so a large output that won't be read again soon (e.g. a vertex buffer for the GPU)
+  does not evict useful data, and the cache line does not need to be read before being written.
+- Optionally, the array is split into chunks transformed by several threads.
+
+The arrays are described the same way as in the DirectXMath stream functions 
+(e.g. XMVector3TransformStream): a pointer, a stride in bytes, and a count. A stride larger than
+the element size means the elements are interleaved with other vertex attributes. Any stride
+works; the fast paths are used for packed arrays (sizeof(XMFLOAT3) or sizeof(XMFLOAT4)).
+The input and output arrays must not overlap, unless they are the same array with the same stride.
+*/
+
+struct TransformOptions
+{
+    bool NonTemporal = false;   // write the output with streaming stores
+    unsigned Threads = 1;       // the number of threads; 0 means std::thread::hardware_concurrency()
+};
+
+// TransformPositions transforms points (w = 1) by a matrix: out = (x, y, z, 1) * m. 
+// As with XMVector3Transform, the result is not divided by w.
+void TransformPositions(
+    DirectX::XMFLOAT3* output, std::size_t outputStride,
+    const DirectX::XMFLOAT3* input, std::size_t inputStride,
+    std::size_t count, DirectX::FXMMATRIX m, const TransformOptions& options = TransformOptions{});
+
+// TransformNormals transforms vectors (w = 0) by a matrix: the translation is ignored. For matrices
+// with a non-uniform scale, pass the inverse-transpose of the matrix (see PlaneTransformation).
+void TransformNormals(
+    DirectX::XMFLOAT3* output, std::size_t outputStride,
+    const DirectX::XMFLOAT3* input, std::size_t inputStride,
+    std::size_t count, DirectX::FXMMATRIX m, const TransformOptions& options = TransformOptions{});
+
+// TransformFloat4 transforms 4D vectors by a matrix: out = v * m.
+void TransformFloat4(
+    DirectX::XMFLOAT4* output, std::size_t outputStride,
+    const DirectX::XMFLOAT4* input, std::size_t inputStride,
+    std::size_t count, DirectX::FXMMATRIX m, const TransformOptions& options = TransformOptions{});
+
+void BatchTransformBenchmark();
@@ -0,0 +1,347 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath> // pow
+#include <cstdint> // uint8_t
+
+#include "OutputOperators.h"
+#include "BulkColors.h"
+#include "Timing.h"
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+using std::cout;
+using std::endl;
+
+float SRGBToLinear(float c)
+{
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float LinearToSRGB(float l)
+{
+    return l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.f / 2.4f) - 0.055f;
+}
+
+namespace
+{
+    const int SRGBIndexBits = 12;
+    const int SRGBIndexMax = (1 << SRGBIndexBits) - 1;
+
+    struct SRGBTables
+    {
+        float ToLinear[256];
+        std::uint8_t ToSRGB[SRGBIndexMax + 1];
+
+        SRGBTables()
+        {
+            for (int i = 0; i < 256; ++i)
+                ToLinear[i] = SRGBToLinear(i / 255.f);
+
+            for (int i = 0; i <= SRGBIndexMax; ++i)
+                ToSRGB[i] = static_cast<std::uint8_t>(LinearToSRGB(static_cast<float>(i) / SRGBIndexMax) * 255.f + 0.5f);
+        }
+    };
+
+    // The tables are built on first use. The initialization of a local static is thread-safe.
+    const SRGBTables& Tables()
+    {
+        static const SRGBTables tables;
+        return tables;
+    }
+
+    template <typename T>
+    inline T* AdvanceRow(T* p, std::size_t pitch, std::size_t row)
+    {
+        return reinterpret_cast<T*>(reinterpret_cast<char*>(p) + row * pitch);
+    }
+
+    template <typename T>
+    inline const T* AdvanceRow(const T* p, std::size_t pitch, std::size_t row)
+    {
+        return reinterpret_cast<const T*>(reinterpret_cast<const char*>(p) + row * pitch);
+    }
+
+    void LoadColorsLinear(XMFLOAT4* output, const XMCOLOR* input, std::size_t count)
+    {
+        std::size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128 scale = _mm_set1_ps(1.f / 255.f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            // b0 g0 r0 a0 b1 g1 r1 a1 b2 g2 r2 a2 b3 g3 r3 a3
+            __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+
+            // Widen the bytes to 16 bits and then to 32 bits.
+            __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+            __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+            __m128i p[4] = 
+            { 
+                _mm_unpacklo_epi16(lo, zero), _mm_unpackhi_epi16(lo, zero),
+                _mm_unpacklo_epi16(hi, zero), _mm_unpackhi_epi16(hi, zero) 
+            };
+
+            for (int j = 0; j < 4; ++j)
+            {
+                __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(p[j]), scale);
+                v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2)); // (b, g, r, a) -> (r, g, b, a)
+                _mm_storeu_ps(&output[i + j].x, v);
+            }
+        }
+#endif
+
+        for (; i < count; ++i)
+            XMStoreFloat4(&output[i], XMLoadColor(&input[i]));
+    }
+
+    void StoreColorsLinear(XMCOLOR* output, const XMFLOAT4* input, std::size_t count)
+    {
+        std::size_t i = 0;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_set1_ps(255.f);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i p[4];
+            for (int j = 0; j < 4; ++j)
+            {
+                __m128 v = _mm_loadu_ps(&input[i + j].x);
+                v = _mm_min_ps(_mm_max_ps(v, zero), one); // saturate; a NaN becomes 0
+                v = _mm_mul_ps(v, scale);
+                v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2)); // (r, g, b, a) -> (b, g, r, a)
+                p[j] = _mm_cvtps_epi32(v); // round to nearest
+            }
+
+            // Narrow 32 -> 16 -> 8 bits. The values are already in [0, 255] so the saturation does nothing.
+            __m128i lo = _mm_packs_epi32(p[0], p[1]);
+            __m128i hi = _mm_packs_epi32(p[2], p[3]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(lo, hi));
+        }
+#endif
+
+        for (; i < count; ++i)
+            XMStoreColor(&output[i], XMLoadFloat4(&input[i]));
+    }
+
+    void LoadColorsSRGB(XMFLOAT4* output, const XMCOLOR* input, std::size_t count)
+    {
+        const float* toLinear = Tables().ToLinear;
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            XMCOLOR c = input[i];
+            output[i] = XMFLOAT4(toLinear[c.r], toLinear[c.g], toLinear[c.b], c.a * (1.f / 255.f));
+        }
+    }
+
+    void StoreColorsSRGB(XMCOLOR* output, const XMFLOAT4* input, std::size_t count)
+    {
+        const std::uint8_t* toSRGB = Tables().ToSRGB;
+
+#if defined(_XM_SSE_INTRINSICS_)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 scale = _mm_setr_ps(SRGBIndexMax, SRGBIndexMax, SRGBIndexMax, 255.f);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            // Compute the table indices of r, g, b and the alpha byte in one go.
+            __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&input[i].x), zero), one);
+            alignas(16) std::int32_t index[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_cvtps_epi32(_mm_mul_ps(v, scale)));
+
+            XMCOLOR& c = output[i];
+            c.r = toSRGB[index[0]];
+            c.g = toSRGB[index[1]];
+            c.b = toSRGB[index[2]];
+            c.a = static_cast<std::uint8_t>(index[3]);
+        }
+#else
+        auto quantize = [](float x, float scale)
+        {
+            x = x > 0.f ? (x < 1.f ? x : 1.f) : 0.f;
+            return static_cast<int>(x * scale + 0.5f);
+        };
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            XMCOLOR& c = output[i];
+            c.r = toSRGB[quantize(input[i].x, SRGBIndexMax)];
+            c.g = toSRGB[quantize(input[i].y, SRGBIndexMax)];
+            c.b = toSRGB[quantize(input[i].z, SRGBIndexMax)];
+            c.a = static_cast<std::uint8_t>(quantize(input[i].w, 255.f));
+        }
+#endif
+    }
+
+    // Calls convertRows(firstRow, rowCount) for tiles of rows on several threads.
+    // The threads take the next tile from a shared counter, so a thread that is slowed down
+    // (e.g. preempted by the OS) does not hold up the others.
+    template <typename ConvertRows>
+    void ForEachTile(std::size_t height, const ImageOptions& options, ConvertRows convertRows)
+    {
+        unsigned threads = options.Threads != 0 ? options.Threads : std::thread::hardware_concurrency();
+        std::size_t tileRows = options.TileRows != 0 ? options.TileRows : 1;
+        std::size_t tiles = (height + tileRows - 1) / tileRows;
+
+        if (threads > tiles)
+            threads = static_cast<unsigned>(tiles);
+
+        std::atomic<std::size_t> nextTile{ 0 };
+        auto worker = [&]()
+        {
+            for (std::size_t tile = nextTile++; tile < tiles; tile = nextTile++)
+            {
+                std::size_t first = tile * tileRows;
+                convertRows(first, height - first < tileRows ? height - first : tileRows);
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t)
+            workers.emplace_back(worker);
+
+        worker();
+
+        for (auto& w : workers)
+            w.join();
+    }
+}
+
+void LoadColors(XMFLOAT4* output, const XMCOLOR* input, std::size_t count, ColorEncoding encoding)
+{
+    if (encoding == ColorEncoding::SRGB)
+        LoadColorsSRGB(output, input, count);
+    else
+        LoadColorsLinear(output, input, count);
+}
+
+void StoreColors(XMCOLOR* output, const XMFLOAT4* input, std::size_t count, ColorEncoding encoding)
+{
+    if (encoding == ColorEncoding::SRGB)
+        StoreColorsSRGB(output, input, count);
+    else
+        StoreColorsLinear(output, input, count);
+}
+
+void LoadColorImage(XMFLOAT4* output, std::size_t outputPitch, const XMCOLOR* input, std::size_t inputPitch,
+    std::size_t width, std::size_t height, ColorEncoding encoding, const ImageOptions& options)
+{
+    ForEachTile(height, options, [=](std::size_t first, std::size_t rows)
+    {
+        for (std::size_t y = first; y < first + rows; ++y)
+            LoadColors(AdvanceRow(output, outputPitch, y), AdvanceRow(input, inputPitch, y), width, encoding);
+    });
+}
+
+void StoreColorImage(XMCOLOR* output, std::size_t outputPitch, const XMFLOAT4* input, std::size_t inputPitch,
+    std::size_t width, std::size_t height, ColorEncoding encoding, const ImageOptions& options)
+{
+    ForEachTile(height, options, [=](std::size_t first, std::size_t rows)
+    {
+        for (std::size_t y = first; y < first + rows; ++y)
+            StoreColors(AdvanceRow(output, outputPitch, y), AdvanceRow(input, inputPitch, y), width, encoding);
+    });
+}
+
+void BulkColorConversion()
+{
+    cout << "Convert a span of colors." << endl;
+
+    // The same colors as in ColorConversion.
+    XMCOLOR colors[3] = { XMCOLOR(.5f, .25f, .3f, .1f), XMCOLOR(.2f, .3f, .1f, .5f), XMCOLOR(0x80804080) };
+    XMFLOAT4 values[3];
+
+    LoadColors(values, colors, 3);
+    for (const auto& v : values)
+        cout << "v = " << v << endl;
+
+    // A mid-grey in sRGB is much darker in linear space.
+    LoadColors(values, colors, 3, ColorEncoding::SRGB);
+    cout << "linear v = " << values[2] << endl; // (0.215861, 0.0512695, 0.215861, 0.501961)
+
+    XMCOLOR roundTrip[3];
+    StoreColors(roundTrip, values, 3, ColorEncoding::SRGB);
+    cout << "color (hex) = " << std::hex << roundTrip[2] << std::dec << endl; // 80804080
+}
+
+void BulkColorBenchmark()
+{
+    const std::size_t width = 3840;
+    const std::size_t height = 2160;
+    const std::size_t count = width * height;
+    const double megapixels = count / 1e6;
+
+    cout << "Convert a " << width << "x" << height << " frame." << endl;
+
+    std::vector<XMCOLOR> frame(count), packed(count);
+    std::vector<XMFLOAT4> pixels(count), reference(count);
+    for (std::size_t i = 0; i < count; ++i)
+        frame[i] = XMCOLOR(static_cast<std::uint32_t>(i * 2654435761u));
+
+    ImageOptions options;
+    std::size_t colorPitch = width * sizeof(XMCOLOR);
+    std::size_t floatPitch = width * sizeof(XMFLOAT4);
+
+    double perPixelLoad = TimeBestOf(3, [&]()
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            XMStoreFloat4(&reference[i], XMLoadColor(&frame[i]));
+    });
+    double bulkLoad = TimeBestOf(3, [&]() { LoadColors(pixels.data(), frame.data(), count); });
+    double imageLoad = TimeBestOf(3, [&]() { LoadColorImage(pixels.data(), floatPitch, frame.data(), colorPitch, width, height, ColorEncoding::Linear, options); });
+
+    float maxDifference = 0.f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        float d = std::fabs(pixels[i].x - reference[i].x) + std::fabs(pixels[i].y - reference[i].y) +
+                  std::fabs(pixels[i].z - reference[i].z) + std::fabs(pixels[i].w - reference[i].w);
+        if (d > maxDifference)
+            maxDifference = d;
+    }
+
+    double perPixelStore = TimeBestOf(3, [&]()
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            XMStoreColor(&packed[i], XMLoadFloat4(&pixels[i]));
+    });
+    double bulkStore = TimeBestOf(3, [&]() { StoreColors(packed.data(), pixels.data(), count); });
+    double imageStore = TimeBestOf(3, [&]() { StoreColorImage(packed.data(), colorPitch, pixels.data(), floatPitch, width, height, ColorEncoding::Linear, options); });
+
+    bool roundTrip = true;
+    for (std::size_t i = 0; i < count; ++i)
+        roundTrip = roundTrip && packed[i] == frame[i];
+
+    double srgbLoad = TimeBestOf(3, [&]() { LoadColorImage(pixels.data(), floatPitch, frame.data(), colorPitch, width, height, ColorEncoding::SRGB, options); });
+    double srgbStore = TimeBestOf(3, [&]() { StoreColorImage(packed.data(), colorPitch, pixels.data(), floatPitch, width, height, ColorEncoding::SRGB, options); });
+
+    // Compare the table with the exact curve.
+    int maxStep = 0;
+    for (std::size_t i = 0; i < count; i += 97)
+    {
+        int exact = static_cast<int>(LinearToSRGB(pixels[i].x) * 255.f + 0.5f);
+        int step = std::abs(exact - static_cast<int>(packed[i].r));
+        if (step > maxStep)
+            maxStep = step;
+    }
+
+    cout << "Max difference from XMLoadColor: " << maxDifference << endl;
+    cout << "Linear round trip is " << (roundTrip ? "exact" : "NOT exact") << endl;
+    cout << "sRGB round trip, max difference from the exact curve: " << maxStep << " step(s)" << endl;
+    cout << "XMLoadColor per pixel:  " << megapixels / perPixelLoad << " MPix/s" << endl;
+    cout << "LoadColors:             " << megapixels / bulkLoad << " MPix/s" << endl;
+    cout << "LoadColorImage:         " << megapixels / imageLoad << " MPix/s" << endl;
+    cout << "XMStoreColor per pixel: " << megapixels / perPixelStore << " MPix/s" << endl;
+    cout << "StoreColors:            " << megapixels / bulkStore << " MPix/s" << endl;
+    cout << "StoreColorImage:        " << megapixels / imageStore << " MPix/s" << endl;
+    cout << "LoadColorImage, sRGB:   " << megapixels / srgbLoad << " MPix/s" << endl;
+    cout << "StoreColorImage, sRGB:  " << megapixels / srgbStore << " MPix/s" << endl;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef> // size_t
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h> // XMCOLOR
+
+/*
+Bulk conversion between 32-bit colors (XMCOLOR) and 128-bit colors (XMFLOAT4).
+
+ColorConversion converts single colors with XMLoadColor and XMStoreColor. Converting a whole
+framebuffer that way costs a function call, a few shuffles, and a partial-register store per pixel.
+The bulk functions convert spans of pixels:
+- Linear encoding: four pixels at a time with SSE2. A 16-byte load fetches four XMCOLORs; the
+  bytes are widened to 32-bit integers with unpack instructions, converted to floats, scaled by 
+  1/255, and swizzled from the B, G, R, A byte order of XMCOLOR to (r, g, b, a). Storing is the
+  reverse: clamp to [0, 1], scale by 255, round, and narrow with saturating packs.
+- sRGB encoding: the 8-bit r, g, b components are sRGB-encoded and the floats are linear.
+  The sRGB curve needs pow, so it is replaced by lookup tables:
+  - sRGB -> linear: a 256-entry float table, one entry per byte value; this is exact.
+  - linear -> sRGB: a 4096-entry byte table indexed by the linear value quantized to 12 bits;
+    the result differs from the exact curve by at most one step.
+  Alpha is always linear.
+
+The image functions convert a width x height rectangle with row pitches in bytes (like the
+RowPitch of a mapped Direct3D texture). The image is split into tiles of rows which are 
+handed out to threads, so a 4K frame is converted by all cores.
+*/
+
+enum class ColorEncoding
+{
+    Linear,
+    SRGB
+};
+
+// LoadColors converts XMCOLORs to (r, g, b, a) floats in [0, 1]. With ColorEncoding::Linear the result 
+// is the same as XMLoadColor.
+void LoadColors(DirectX::XMFLOAT4* output, const DirectX::PackedVector::XMCOLOR* input, std::size_t count,
+    ColorEncoding encoding = ColorEncoding::Linear);
+
+// StoreColors converts (r, g, b, a) floats to XMCOLORs. The values are clamped to [0, 1].
+// With ColorEncoding::Linear the result is the same as XMStoreColor.
+void StoreColors(DirectX::PackedVector::XMCOLOR* output, const DirectX::XMFLOAT4* input, std::size_t count,
+    ColorEncoding encoding = ColorEncoding::Linear);
+
+struct ImageOptions
+{
+    unsigned Threads = 0;           // 0 means std::thread::hardware_concurrency()
+    std::size_t TileRows = 32;      // the number of rows a thread converts at a time
+};
+
+void LoadColorImage(DirectX::XMFLOAT4* output, std::size_t outputPitch,
+    const DirectX::PackedVector::XMCOLOR* input, std::size_t inputPitch,
+    std::size_t width, std::size_t height, ColorEncoding encoding = ColorEncoding::Linear,
+    const ImageOptions& options = ImageOptions{});
+
+void StoreColorImage(DirectX::PackedVector::XMCOLOR* output, std::size_t outputPitch,
+    const DirectX::XMFLOAT4* input, std::size_t inputPitch,
+    std::size_t width, std::size_t height, ColorEncoding encoding = ColorEncoding::Linear,
+    const ImageOptions& options = ImageOptions{});
+
+// The exact sRGB curve.
+float SRGBToLinear(float c);
+float LinearToSRGB(float l);
+
+void BulkColorConversion();
+void BulkColorBenchmark();
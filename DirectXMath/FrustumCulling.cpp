@@ -0,0 +1,416 @@
+#include <iostream>
+#include <random>
+
+#include "OutputOperators.h"
+#include "PlaneClassification.h" // MaskWords, TestMaskBit
+#include "FrustumCulling.h"
+#include "Timing.h"
+
+using namespace DirectX;
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+    // The frustum planes with their coefficients replicated into all four lanes, so that
+    // four volumes stored in SoA form can be tested against a plane with a few multiply-adds.
+    struct SplatPlanes
+    {
+        XMVECTOR A[Frustum::PlaneCount];
+        XMVECTOR B[Frustum::PlaneCount];
+        XMVECTOR C[Frustum::PlaneCount];
+        XMVECTOR D[Frustum::PlaneCount];
+
+        explicit SplatPlanes(const Frustum& frustum)
+        {
+            for (int k = 0; k < Frustum::PlaneCount; ++k)
+            {
+                A[k] = XMVectorReplicate(frustum.Planes[k].x);
+                B[k] = XMVectorReplicate(frustum.Planes[k].y);
+                C[k] = XMVectorReplicate(frustum.Planes[k].z);
+                D[k] = XMVectorReplicate(frustum.Planes[k].w);
+            }
+        }
+    };
+
+    // Loads four consecutive floats starting at p[i]. Past the end of the array the lanes are zero.
+    inline XMVECTOR XM_CALLCONV Load4(const float* p, std::size_t i, std::size_t count)
+    {
+        if (i + 4 <= count)
+            return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(p + i));
+
+        float tail[4] = {};
+        for (std::size_t j = 0; i + j < count; ++j)
+            tail[j] = p[i + j];
+        return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(tail));
+    }
+
+    // Packs the comparison results of the four lanes of a mask (each lane is all ones or all zeros) into 4 bits.
+    inline unsigned XM_CALLCONV MoveMask(FXMVECTOR mask)
+    {
+#if defined(_XM_SSE_INTRINSICS_)
+        return static_cast<unsigned>(_mm_movemask_ps(mask));
+#else
+        XMUINT4 m;
+        XMStoreUInt4(&m, mask);
+        return (m.x & 1) | ((m.y & 1) << 1) | ((m.z & 1) << 2) | ((m.w & 1) << 3);
+#endif
+    }
+
+    // The bits of the valid lanes of a group of four volumes starting at i.
+    inline unsigned LaneBits(std::size_t i, std::size_t count)
+    {
+        return count - i >= 4 ? 0xFu : (1u << (count - i)) - 1;
+    }
+
+    void ClearMask(std::uint64_t* mask, std::size_t count)
+    {
+        if (mask)
+        {
+            for (std::size_t w = 0; w < MaskWords(count); ++w)
+                mask[w] = 0;
+        }
+    }
+
+    // Stores the results of a group of four volumes starting at i. The volume is visible unless
+    // it is outside at least one plane.
+    inline void StoreGroup(std::size_t i, std::size_t count, unsigned outside, unsigned inside,
+        std::uint64_t* visible, std::uint64_t* insideMask)
+    {
+        unsigned lanes = LaneBits(i, count);
+        std::uint64_t shift = i % 64;
+
+        visible[i / 64] |= static_cast<std::uint64_t>(~outside & lanes) << shift;
+        if (insideMask)
+            insideMask[i / 64] |= static_cast<std::uint64_t>(inside & lanes) << shift;
+    }
+
+    void CullNode(const XMVECTOR* planes, const XMVECTOR* absPlanes, const std::vector<BoundingBoxNode>& nodes,
+        std::uint32_t index, unsigned planeMask, std::vector<std::uint32_t>& visibleLeaves, CullStats& stats)
+    {
+        const BoundingBoxNode& node = nodes[index];
+        ++stats.NodesVisited;
+
+        // Test the box against the planes that the ancestors have not been completely inside of.
+        if (planeMask != 0)
+        {
+            XMVECTOR center = XMLoadFloat3(&node.Center);
+            XMVECTOR extents = XMLoadFloat3(&node.Extents);
+
+            for (int k = 0; k < Frustum::PlaneCount; ++k)
+            {
+                if ((planeMask & (1u << k)) == 0)
+                    continue;
+
+                ++stats.PlaneTests;
+
+                // The signed distance of the centre, and the "radius" of the box: the projection
+                // of the extents onto the plane normal.
+                float distance = XMVectorGetX(XMPlaneDotCoord(planes[k], center));
+                float radius = XMVectorGetX(XMVector3Dot(absPlanes[k], extents));
+
+                if (distance < -radius)
+                    return; // outside the plane: the whole subtree is culled
+
+                if (distance >= radius)
+                    planeMask &= ~(1u << k); // inside the plane: the children do not need to test it
+            }
+        }
+
+        if (node.ChildCount == 0)
+        {
+            visibleLeaves.push_back(index);
+            return;
+        }
+
+        for (std::uint32_t c = node.FirstChild; c < node.FirstChild + node.ChildCount; ++c)
+            CullNode(planes, absPlanes, nodes, c, planeMask, visibleLeaves, stats);
+    }
+}
+
+Frustum ExtractFrustum(FXMMATRIX viewProjection)
+{
+    // The rows of the transposed matrix are the columns of the original one.
+    XMMATRIX m = XMMatrixTranspose(viewProjection);
+
+    XMVECTOR planes[Frustum::PlaneCount];
+    planes[Frustum::Left] = XMVectorAdd(m.r[3], m.r[0]);
+    planes[Frustum::Right] = XMVectorSubtract(m.r[3], m.r[0]);
+    planes[Frustum::Bottom] = XMVectorAdd(m.r[3], m.r[1]);
+    planes[Frustum::Top] = XMVectorSubtract(m.r[3], m.r[1]);
+    planes[Frustum::Near] = m.r[2];
+    planes[Frustum::Far] = XMVectorSubtract(m.r[3], m.r[2]);
+
+    Frustum frustum;
+    for (int k = 0; k < Frustum::PlaneCount; ++k)
+        XMStoreFloat4(&frustum.Planes[k], XMPlaneNormalize(planes[k]));
+
+    return frustum;
+}
+
+void CullSpheres(const Frustum& frustum, const SpheresSoA& spheres, std::uint64_t* visible, std::uint64_t* inside)
+{
+    SplatPlanes planes(frustum);
+
+    ClearMask(visible, spheres.Count);
+    ClearMask(inside, spheres.Count);
+
+    for (std::size_t i = 0; i < spheres.Count; i += 4)
+    {
+        XMVECTOR x = Load4(spheres.X, i, spheres.Count);
+        XMVECTOR y = Load4(spheres.Y, i, spheres.Count);
+        XMVECTOR z = Load4(spheres.Z, i, spheres.Count);
+        XMVECTOR r = Load4(spheres.Radius, i, spheres.Count);
+        XMVECTOR negR = XMVectorNegate(r);
+
+        // No branches: all six planes are tested and the results are accumulated in masks.
+        XMVECTOR outsideAny = XMVectorFalseInt();
+        XMVECTOR insideAll = XMVectorTrueInt();
+
+        for (int k = 0; k < Frustum::PlaneCount; ++k)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(planes.A[k], x,
+                                XMVectorMultiplyAdd(planes.B[k], y,
+                                XMVectorMultiplyAdd(planes.C[k], z, planes.D[k])));
+
+            outsideAny = XMVectorOrInt(outsideAny, XMVectorLess(distance, negR));
+            insideAll = XMVectorAndInt(insideAll, XMVectorGreaterOrEqual(distance, r));
+        }
+
+        StoreGroup(i, spheres.Count, MoveMask(outsideAny), MoveMask(insideAll), visible, inside);
+    }
+}
+
+void CullSpheresScalar(const Frustum& frustum, const SpheresSoA& spheres, std::uint64_t* visible)
+{
+    XMVECTOR planes[Frustum::PlaneCount];
+    for (int k = 0; k < Frustum::PlaneCount; ++k)
+        planes[k] = XMLoadFloat4(&frustum.Planes[k]);
+
+    ClearMask(visible, spheres.Count);
+
+    for (std::size_t i = 0; i < spheres.Count; ++i)
+    {
+        XMVECTOR center = XMVectorSet(spheres.X[i], spheres.Y[i], spheres.Z[i], 1.f);
+        bool isVisible = true;
+
+        for (int k = 0; k < Frustum::PlaneCount; ++k)
+        {
+            if (XMVectorGetX(XMPlaneDotCoord(planes[k], center)) < -spheres.Radius[i])
+            {
+                isVisible = false;
+                break;
+            }
+        }
+
+        if (isVisible)
+            visible[i / 64] |= 1ull << (i % 64);
+    }
+}
+
+void CullBoxes(const Frustum& frustum, const BoxesSoA& boxes, std::uint64_t* visible, std::uint64_t* inside)
+{
+    SplatPlanes planes(frustum);
+
+    // The radius of a box relative to a plane is |A|ex + |B|ey + |C|ez.
+    XMVECTOR absA[Frustum::PlaneCount], absB[Frustum::PlaneCount], absC[Frustum::PlaneCount];
+    for (int k = 0; k < Frustum::PlaneCount; ++k)
+    {
+        absA[k] = XMVectorAbs(planes.A[k]);
+        absB[k] = XMVectorAbs(planes.B[k]);
+        absC[k] = XMVectorAbs(planes.C[k]);
+    }
+
+    ClearMask(visible, boxes.Count);
+    ClearMask(inside, boxes.Count);
+
+    for (std::size_t i = 0; i < boxes.Count; i += 4)
+    {
+        XMVECTOR cx = Load4(boxes.CenterX, i, boxes.Count);
+        XMVECTOR cy = Load4(boxes.CenterY, i, boxes.Count);
+        XMVECTOR cz = Load4(boxes.CenterZ, i, boxes.Count);
+        XMVECTOR ex = Load4(boxes.ExtentX, i, boxes.Count);
+        XMVECTOR ey = Load4(boxes.ExtentY, i, boxes.Count);
+        XMVECTOR ez = Load4(boxes.ExtentZ, i, boxes.Count);
+
+        XMVECTOR outsideAny = XMVectorFalseInt();
+        XMVECTOR insideAll = XMVectorTrueInt();
+
+        for (int k = 0; k < Frustum::PlaneCount; ++k)
+        {
+            XMVECTOR distance = XMVectorMultiplyAdd(planes.A[k], cx,
+                                XMVectorMultiplyAdd(planes.B[k], cy,
+                                XMVectorMultiplyAdd(planes.C[k], cz, planes.D[k])));
+
+            XMVECTOR radius = XMVectorMultiplyAdd(absA[k], ex,
+                              XMVectorMultiplyAdd(absB[k], ey,
+                              XMVectorMultiply(absC[k], ez)));
+
+            outsideAny = XMVectorOrInt(outsideAny, XMVectorLess(distance, XMVectorNegate(radius)));
+            insideAll = XMVectorAndInt(insideAll, XMVectorGreaterOrEqual(distance, radius));
+        }
+
+        StoreGroup(i, boxes.Count, MoveMask(outsideAny), MoveMask(insideAll), visible, inside);
+    }
+}
+
+void CullHierarchy(const Frustum& frustum, const std::vector<BoundingBoxNode>& nodes, std::uint32_t root,
+    std::vector<std::uint32_t>& visibleLeaves, CullStats* stats)
+{
+    XMVECTOR planes[Frustum::PlaneCount], absPlanes[Frustum::PlaneCount];
+    for (int k = 0; k < Frustum::PlaneCount; ++k)
+    {
+        planes[k] = XMLoadFloat4(&frustum.Planes[k]);
+        absPlanes[k] = XMVectorAbs(planes[k]);
+    }
+
+    CullStats local;
+    const unsigned allPlanes = (1u << Frustum::PlaneCount) - 1;
+    CullNode(planes, absPlanes, nodes, root, allPlanes, visibleLeaves, stats ? *stats : local);
+}
+
+void FrustumPlaneExtraction()
+{
+    cout << "Extract the frustum planes from a projection matrix." << endl;
+
+    // A 90-degree field of view and a square viewport: the side planes are at 45 degrees.
+    XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.f, 1.f, 100.f);
+    Frustum frustum = ExtractFrustum(projection);
+
+    const char* names[] = { "left", "right", "bottom", "top", "near", "far" };
+    for (int k = 0; k < Frustum::PlaneCount; ++k)
+        cout << names[k] << ": " << frustum.Planes[k] << endl;
+
+    // For the view-projection matrix, the planes are in the world space.
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.f, 0.f, -10.f, 1.f), XMVectorZero(), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+    frustum = ExtractFrustum(view * projection);
+    cout << "near in world space: " << frustum.Planes[Frustum::Near] << endl; // z = -9
+}
+
+void FrustumCullingBenchmark()
+{
+    const std::size_t count = 1'000'000;
+
+    cout << "Cull " << count << " spheres and boxes." << endl;
+
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorZero(), XMVectorSet(0.f, 0.f, 1.f, 1.f), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+    XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.f / 9.f, 1.f, 100.f);
+    Frustum frustum = ExtractFrustum(view * projection);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> coordinate(-100.f, 100.f);
+    std::uniform_real_distribution<float> size(0.1f, 2.f);
+
+    std::vector<float> x(count), y(count), z(count), r(count), ex(count), ey(count), ez(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        x[i] = coordinate(gen);
+        y[i] = coordinate(gen);
+        z[i] = coordinate(gen);
+        r[i] = size(gen);
+        ex[i] = size(gen);
+        ey[i] = size(gen);
+        ez[i] = size(gen);
+    }
+
+    SpheresSoA spheres = { x.data(), y.data(), z.data(), r.data(), count };
+    BoxesSoA boxes = { x.data(), y.data(), z.data(), ex.data(), ey.data(), ez.data(), count };
+
+    std::vector<std::uint64_t> visible(MaskWords(count)), visibleRef(MaskWords(count)), inside(MaskWords(count));
+
+    double scalar = TimeBestOf(5, [&]() { CullSpheresScalar(frustum, spheres, visibleRef.data()); });
+    double batch = TimeBestOf(5, [&]() { CullSpheres(frustum, spheres, visible.data(), inside.data()); });
+    double batchBoxes = TimeBestOf(5, [&]() { CullBoxes(frustum, boxes, visible.data()); });
+
+    // Re-run the sphere test as the box test has overwritten the mask.
+    CullSpheres(frustum, spheres, visible.data(), inside.data());
+
+    std::size_t mismatches = 0, visibleCount = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        mismatches += TestMaskBit(visible.data(), i) != TestMaskBit(visibleRef.data(), i);
+        visibleCount += TestMaskBit(visible.data(), i);
+    }
+
+    cout << "Visible spheres: " << visibleCount << ", mismatches with the per-sphere loop: " << mismatches << endl;
+    cout << "Spheres, per-sphere loop: " << count / scalar / 1e6 << " M spheres/s" << endl;
+    cout << "Spheres, 4-wide batch:    " << count / batch / 1e6 << " M spheres/s" << endl;
+    cout << "Boxes, 4-wide batch:      " << count / batchBoxes / 1e6 << " M boxes/s" << endl;
+}
+
+namespace
+{
+    // Builds a quadtree over the square [x0, x0 + size] x [z0, z0 + size] on the ground. 
+    // Leaves are leafSize x leafSize boxes.
+    void BuildQuadtree(std::vector<BoundingBoxNode>& nodes, std::uint32_t index, float x0, float z0, float size, float leafSize)
+    {
+        float half = size / 2;
+        nodes[index].Center = XMFLOAT3(x0 + half, 0.f, z0 + half);
+        nodes[index].Extents = XMFLOAT3(half, 4.f, half);
+        nodes[index].FirstChild = 0;
+        nodes[index].ChildCount = 0;
+
+        if (size <= leafSize)
+            return;
+
+        // The four children are allocated together so they are contiguous.
+        auto first = static_cast<std::uint32_t>(nodes.size());
+        nodes.resize(nodes.size() + 4);
+        nodes[index].FirstChild = first;
+        nodes[index].ChildCount = 4;
+
+        BuildQuadtree(nodes, first + 0, x0, z0, half, leafSize);
+        BuildQuadtree(nodes, first + 1, x0 + half, z0, half, leafSize);
+        BuildQuadtree(nodes, first + 2, x0, z0 + half, half, leafSize);
+        BuildQuadtree(nodes, first + 3, x0 + half, z0 + half, half, leafSize);
+    }
+}
+
+void HierarchicalCulling()
+{
+    cout << "Cull a quadtree of boxes hierarchically." << endl;
+
+    std::vector<BoundingBoxNode> nodes(1);
+    BuildQuadtree(nodes, 0, -1024.f, -1024.f, 2048.f, 8.f);
+
+    // Collect the leaves for the flat test.
+    std::vector<std::uint32_t> leaves;
+    std::vector<float> cx, cy, cz, ex, ey, ez;
+    for (std::uint32_t i = 0; i < nodes.size(); ++i)
+    {
+        if (nodes[i].ChildCount != 0)
+            continue;
+
+        leaves.push_back(i);
+        cx.push_back(nodes[i].Center.x);
+        cy.push_back(nodes[i].Center.y);
+        cz.push_back(nodes[i].Center.z);
+        ex.push_back(nodes[i].Extents.x);
+        ey.push_back(nodes[i].Extents.y);
+        ez.push_back(nodes[i].Extents.z);
+    }
+
+    BoxesSoA boxes = { cx.data(), cy.data(), cz.data(), ex.data(), ey.data(), ez.data(), leaves.size() };
+
+    XMMATRIX view = XMMatrixLookAtLH(XMVectorSet(0.f, 20.f, 0.f, 1.f), XMVectorSet(100.f, 0.f, 100.f, 1.f), XMVectorSet(0.f, 1.f, 0.f, 0.f));
+    XMMATRIX projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.f / 9.f, 1.f, 400.f);
+    Frustum frustum = ExtractFrustum(view * projection);
+
+    std::vector<std::uint64_t> visible(MaskWords(leaves.size()));
+    std::vector<std::uint32_t> visibleLeaves;
+    CullStats stats;
+
+    double flat = TimeBestOf(5, [&]() { CullBoxes(frustum, boxes, visible.data()); });
+    double hierarchical = TimeBestOf(5, [&]() { visibleLeaves.clear(); stats = CullStats{}; CullHierarchy(frustum, nodes, 0, visibleLeaves, &stats); });
+
+    // Both methods find the same leaves because every box contains its children.
+    std::size_t flatCount = 0;
+    for (std::size_t i = 0; i < leaves.size(); ++i)
+        flatCount += TestMaskBit(visible.data(), i);
+
+    cout << "Leaves: " << leaves.size() << ", visible: " << visibleLeaves.size() << " (flat: " << flatCount << ")" << endl;
+    cout << "Flat:         " << leaves.size() * Frustum::PlaneCount << " box-plane tests, " << flat * 1e6 << " us" << endl;
+    cout << "Hierarchical: " << stats.PlaneTests << " box-plane tests, " << stats.NodesVisited << " nodes visited, " 
+         << hierarchical * 1e6 << " us" << endl;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint32_t, uint64_t
+#include <vector>
+
+#include <DirectXMath.h>
+
+/*
+Frustum culling.
+
+A view frustum is the part of the space visible to the camera. It is bounded by six planes: 
+left, right, bottom, top, near, and far. An object is visible if its bounding volume is not
+completely behind (in the negative half-space of) any of the planes.
+
+The planes can be extracted directly from the view-projection matrix M (the Gribb-Hartmann method).
+DirectXMath uses row vectors, so a point v = (x, y, z, 1) is transformed to the clip space as
+c = vM, i.e. c.x = v.col0, c.y = v.col1, c.z = v.col2, c.w = v.col3, where colN is the N-th column of M.
+A point is inside the frustum if:
+-c.w <= c.x <= c.w   ->   left = col3 + col0, right = col3 - col0
+-c.w <= c.y <= c.w   ->   bottom = col3 + col1, top = col3 - col1
+   0 <= c.z <= c.w   ->   near = col2, far = col3 - col2  (Direct3D depth range 0..1)
+Each plane is then normalized with XMPlaneNormalize so that XMPlaneDotCoord returns the signed 
+distance and can be compared with a bounding sphere radius. The normals point into the frustum.
+
+Bounding volumes are tested in batches of 4 using XMVECTOR arithmetic, with the volumes stored 
+in structure-of-arrays form (see PlaneClassification.h). The results are bitmasks, 64 volumes per word.
+
+Hierarchical culling tests a tree of bounding boxes. When a box is completely inside a plane,
+all its children are inside that plane as well, so the plane is not tested for them. When a box
+is completely inside all the planes, its whole subtree is visible without any further tests.
+*/
+
+// The planes of a frustum as (A, B, C, D), where Ax+By+Cz+D=0. The planes are normalized and
+// their normals point into the frustum.
+struct Frustum
+{
+    enum { Left, Right, Bottom, Top, Near, Far, PlaneCount };
+
+    DirectX::XMFLOAT4 Planes[PlaneCount];
+};
+
+// Bounding spheres in structure-of-arrays form: the i-th sphere has the centre (X[i], Y[i], Z[i])
+// and the radius Radius[i].
+struct SpheresSoA
+{
+    const float* X;
+    const float* Y;
+    const float* Z;
+    const float* Radius;
+    std::size_t Count;
+};
+
+// Axis-aligned bounding boxes in structure-of-arrays form: the i-th box has the centre
+// (CenterX[i], CenterY[i], CenterZ[i]) and the half-sizes (ExtentX[i], ExtentY[i], ExtentZ[i]),
+// the same representation as DirectX::BoundingBox.
+struct BoxesSoA
+{
+    const float* CenterX;
+    const float* CenterY;
+    const float* CenterZ;
+    const float* ExtentX;
+    const float* ExtentY;
+    const float* ExtentZ;
+    std::size_t Count;
+};
+
+// A node of a bounding box hierarchy. The children of a node are stored contiguously at 
+// [FirstChild, FirstChild + ChildCount). A node without children is a leaf.
+struct BoundingBoxNode
+{
+    DirectX::XMFLOAT3 Center;
+    DirectX::XMFLOAT3 Extents;
+    std::uint32_t FirstChild;
+    std::uint32_t ChildCount;
+};
+
+// ExtractFrustum returns the six normalized planes of the frustum defined by a view-projection matrix.
+// For a projection matrix alone, the planes are in the view space; for view * projection, in the world space.
+Frustum ExtractFrustum(DirectX::FXMMATRIX viewProjection);
+
+// CullSpheres sets bit i of visible if sphere i intersects or is inside the frustum. 
+// If inside is not null, bit i of inside is set if sphere i is completely inside the frustum.
+// Both masks have MaskWords(spheres.Count) words.
+void CullSpheres(const Frustum& frustum, const SpheresSoA& spheres, std::uint64_t* visible, std::uint64_t* inside = nullptr);
+
+// CullSpheresScalar is the per-sphere loop over XMPlaneDotCoord with an early exit. It is the reference implementation.
+void CullSpheresScalar(const Frustum& frustum, const SpheresSoA& spheres, std::uint64_t* visible);
+
+// CullBoxes is the same as CullSpheres for axis-aligned boxes.
+void CullBoxes(const Frustum& frustum, const BoxesSoA& boxes, std::uint64_t* visible, std::uint64_t* inside = nullptr);
+
+// Statistics of CullHierarchy.
+struct CullStats
+{
+    std::size_t NodesVisited = 0;   // nodes reached by the traversal
+    std::size_t PlaneTests = 0;     // box-plane tests
+};
+
+// CullHierarchy appends the indices of the visible leaves of a hierarchy rooted at nodes[root] to visibleLeaves.
+void CullHierarchy(const Frustum& frustum, const std::vector<BoundingBoxNode>& nodes, std::uint32_t root,
+    std::vector<std::uint32_t>& visibleLeaves, CullStats* stats = nullptr);
+
+void FrustumPlaneExtraction();
+void FrustumCullingBenchmark();
+void HierarchicalCulling();
@@ -9,6 +9,13 @@
 #include "Colors.h"
 #include "Operations.h"
 #include "Planes.h"
+#include "PlaneClassification.h"
+#include "FrustumCulling.h"
+#include "BatchTransform.h"
+#include "BulkColors.h"
+#include "TransformHierarchy.h"
+#include "BatchMath.h"
+#include "Swizzle.h"
 
 int main()
 {
@@ -24,6 +31,13 @@ int main()
     // 3 - colors
     // 4 - operations
     // 5 - planes
+    // 6 - batch plane classification
+    // 7 - frustum culling
+    // 8 - batch transform
+    // 9 - bulk color conversion
+    // 10 - transform hierarchy
+    // 11 - batch math functions
+    // 12 - compile-time swizzles
     int test = 1;
 
     switch (test)
@@ -72,6 +86,48 @@ int main()
         PlaneLineIntersection();
         ReflectionPlane();
         break;
+
+    case 6:
+        // batch plane classification
+        BatchPointPlaneClassification();
+        PlaneClassificationBenchmark();
+        break;
+
+    case 7:
+        // frustum culling
+        FrustumPlaneExtraction();
+        FrustumCullingBenchmark();
+        HierarchicalCulling();
+        break;
+
+    case 8:
+        // batch transform
+        BatchTransformBenchmark();
+        break;
+
+    case 9:
+        // bulk color conversion
+        BulkColorConversion();
+        BulkColorBenchmark();
+        break;
+
+    case 10:
+        // transform hierarchy
+        TransformHierarchyExample();
+        TransformHierarchyBenchmark();
+        break;
+
+    case 11:
+        // batch math functions
+        BatchMathExample();
+        BatchMathBenchmark();
+        break;
+
+    case 12:
+        // compile-time swizzles
+        SwizzleExample();
+        SwizzleBenchmark();
+        break;
     }
 
     return 0;
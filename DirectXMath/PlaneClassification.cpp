@@ -0,0 +1,346 @@
+#include <iostream>
+#include <vector>
+#include <random>
+
+#include "PlaneClassification.h"
+#include "Timing.h"
+
+#if defined(_XM_AVX_INTRINSICS_)
+#include <immintrin.h> // __m256
+#endif
+
+using namespace DirectX;
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+    // The three masks of a plane for a block of up to 64 points.
+    struct MaskWord
+    {
+        std::uint64_t Front;
+        std::uint64_t Back;
+        std::uint64_t On;
+    };
+
+    // Classify points [first, last) against a plane (a, b, c, d) one point at a time, without branches.
+    // Bit 0 of the word corresponds to the point first.
+    MaskWord ClassifyBlockScalar(const PointsSoA& points, std::size_t first, std::size_t last,
+        float a, float b, float c, float d, float epsilon)
+    {
+        MaskWord word = {};
+
+        for (std::size_t i = first; i < last; ++i)
+        {
+            float distance = a * points.X[i] + b * points.Y[i] + c * points.Z[i] + d;
+            std::uint64_t isFront = distance > epsilon;
+            std::uint64_t isBack = distance < -epsilon;
+            std::uint64_t bit = i - first;
+
+            word.Front |= isFront << bit;
+            word.Back |= isBack << bit;
+            word.On |= (1ull ^ isFront ^ isBack) << bit;
+        }
+
+        return word;
+    }
+
+#if defined(_XM_AVX_INTRINSICS_)
+    const std::size_t BatchWidth = 8;
+
+    // Classify 64 points starting at first against a plane, 8 points per iteration.
+    MaskWord ClassifyBlock(const PointsSoA& points, std::size_t first,
+        float a, float b, float c, float d, float epsilon)
+    {
+        const __m256 va = _mm256_set1_ps(a);
+        const __m256 vb = _mm256_set1_ps(b);
+        const __m256 vc = _mm256_set1_ps(c);
+        const __m256 vd = _mm256_set1_ps(d);
+        const __m256 vpos = _mm256_set1_ps(epsilon);
+        const __m256 vneg = _mm256_set1_ps(-epsilon);
+
+        MaskWord word = {};
+
+        for (std::size_t j = 0; j < 64; j += 8)
+        {
+            __m256 x = _mm256_loadu_ps(points.X + first + j);
+            __m256 y = _mm256_loadu_ps(points.Y + first + j);
+            __m256 z = _mm256_loadu_ps(points.Z + first + j);
+
+#if defined(_XM_FMA3_INTRINSICS_)
+            __m256 distance = _mm256_fmadd_ps(va, x, _mm256_fmadd_ps(vb, y, _mm256_fmadd_ps(vc, z, vd)));
+#else
+            __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(va, x), _mm256_mul_ps(vb, y)),
+                                            _mm256_add_ps(_mm256_mul_ps(vc, z), vd));
+#endif
+
+            // Each comparison gives 8 lanes of all ones or all zeros; movemask packs their sign bits into 8 bits.
+            std::uint64_t isFront = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(distance, vpos, _CMP_GT_OQ)));
+            std::uint64_t isBack = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(distance, vneg, _CMP_LT_OQ)));
+
+            word.Front |= isFront << j;
+            word.Back |= isBack << j;
+            word.On |= (0xFFull & ~(isFront | isBack)) << j;
+        }
+
+        return word;
+    }
+#elif defined(_XM_SSE_INTRINSICS_)
+    const std::size_t BatchWidth = 4;
+
+    // Classify 64 points starting at first against a plane, 4 points per iteration.
+    MaskWord ClassifyBlock(const PointsSoA& points, std::size_t first,
+        float a, float b, float c, float d, float epsilon)
+    {
+        const __m128 va = _mm_set1_ps(a);
+        const __m128 vb = _mm_set1_ps(b);
+        const __m128 vc = _mm_set1_ps(c);
+        const __m128 vd = _mm_set1_ps(d);
+        const __m128 vpos = _mm_set1_ps(epsilon);
+        const __m128 vneg = _mm_set1_ps(-epsilon);
+
+        MaskWord word = {};
+
+        for (std::size_t j = 0; j < 64; j += 4)
+        {
+            __m128 x = _mm_loadu_ps(points.X + first + j);
+            __m128 y = _mm_loadu_ps(points.Y + first + j);
+            __m128 z = _mm_loadu_ps(points.Z + first + j);
+
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(va, x), _mm_mul_ps(vb, y)),
+                                         _mm_add_ps(_mm_mul_ps(vc, z), vd));
+
+            // Each comparison gives 4 lanes of all ones or all zeros; movemask packs their sign bits into 4 bits.
+            std::uint64_t isFront = static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(distance, vpos)));
+            std::uint64_t isBack = static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(distance, vneg)));
+
+            word.Front |= isFront << j;
+            word.Back |= isBack << j;
+            word.On |= (0xFull & ~(isFront | isBack)) << j;
+        }
+
+        return word;
+    }
+#elif defined(_XM_ARM_NEON_INTRINSICS_)
+    const std::size_t BatchWidth = 4;
+
+    // NEON has no movemask. Keep one distinct bit per lane and add the lanes together.
+    inline std::uint64_t MoveMask(uint32x4_t mask)
+    {
+        static const uint32_t bits[4] = { 1, 2, 4, 8 };
+        uint32x4_t v = vandq_u32(mask, vld1q_u32(bits));
+#if defined(_M_ARM64) || defined(__aarch64__)
+        return vaddvq_u32(v);
+#else
+        uint32x2_t sum = vpadd_u32(vget_low_u32(v), vget_high_u32(v));
+        sum = vpadd_u32(sum, sum);
+        return vget_lane_u32(sum, 0);
+#endif
+    }
+
+    // Classify 64 points starting at first against a plane, 4 points per iteration.
+    MaskWord ClassifyBlock(const PointsSoA& points, std::size_t first,
+        float a, float b, float c, float d, float epsilon)
+    {
+        const float32x4_t va = vdupq_n_f32(a);
+        const float32x4_t vb = vdupq_n_f32(b);
+        const float32x4_t vc = vdupq_n_f32(c);
+        const float32x4_t vd = vdupq_n_f32(d);
+        const float32x4_t vpos = vdupq_n_f32(epsilon);
+        const float32x4_t vneg = vdupq_n_f32(-epsilon);
+
+        MaskWord word = {};
+
+        for (std::size_t j = 0; j < 64; j += 4)
+        {
+            float32x4_t x = vld1q_f32(points.X + first + j);
+            float32x4_t y = vld1q_f32(points.Y + first + j);
+            float32x4_t z = vld1q_f32(points.Z + first + j);
+
+            // distance = d + a*x + b*y + c*z
+            float32x4_t distance = vmlaq_f32(vmlaq_f32(vmlaq_f32(vd, va, x), vb, y), vc, z);
+
+            std::uint64_t isFront = MoveMask(vcgtq_f32(distance, vpos));
+            std::uint64_t isBack = MoveMask(vcltq_f32(distance, vneg));
+
+            word.Front |= isFront << j;
+            word.Back |= isBack << j;
+            word.On |= (0xFull & ~(isFront | isBack)) << j;
+        }
+
+        return word;
+    }
+#else
+    const std::size_t BatchWidth = 1;
+
+    MaskWord ClassifyBlock(const PointsSoA& points, std::size_t first,
+        float a, float b, float c, float d, float epsilon)
+    {
+        return ClassifyBlockScalar(points, first, first + 64, a, b, c, d, epsilon);
+    }
+#endif
+
+    void StoreMaskWord(const MaskWord& word, std::size_t index,
+        std::uint64_t* front, std::uint64_t* back, std::uint64_t* on)
+    {
+        if (front) front[index] = word.Front;
+        if (back) back[index] = word.Back;
+        if (on) on[index] = word.On;
+    }
+}
+
+void ClassifyPoints(
+    const PointsSoA& points,
+    const XMFLOAT4* planes, std::size_t planeCount,
+    std::uint64_t* front, std::uint64_t* back, std::uint64_t* on,
+    float epsilon)
+{
+    std::size_t words = MaskWords(points.Count);
+    std::size_t fullWords = points.Count / 64;
+
+    for (std::size_t k = 0; k < planeCount; ++k)
+    {
+        const XMFLOAT4& plane = planes[k];
+        std::size_t offset = k * words;
+
+        // Whole blocks of 64 points go through the SIMD kernel.
+        for (std::size_t w = 0; w < fullWords; ++w)
+        {
+            MaskWord word = ClassifyBlock(points, w * 64, plane.x, plane.y, plane.z, plane.w, epsilon);
+            StoreMaskWord(word, offset + w, front, back, on);
+        }
+
+        // The remaining points (fewer than 64) are classified one at a time.
+        if (fullWords != words)
+        {
+            MaskWord word = ClassifyBlockScalar(points, fullWords * 64, points.Count, plane.x, plane.y, plane.z, plane.w, epsilon);
+            StoreMaskWord(word, offset + fullWords, front, back, on);
+        }
+    }
+}
+
+void ClassifyPointsScalar(
+    const PointsSoA& points,
+    const XMFLOAT4* planes, std::size_t planeCount,
+    std::uint64_t* front, std::uint64_t* back, std::uint64_t* on,
+    float epsilon)
+{
+    std::size_t words = MaskWords(points.Count);
+
+    for (std::size_t k = 0; k < planeCount; ++k)
+    {
+        XMVECTOR p = XMLoadFloat4(&planes[k]);
+        std::size_t offset = k * words;
+
+        for (std::size_t w = offset; w < offset + words; ++w)
+        {
+            if (front) front[w] = 0;
+            if (back) back[w] = 0;
+            if (on) on[w] = 0;
+        }
+
+        for (std::size_t i = 0; i < points.Count; ++i)
+        {
+            XMVECTOR v = XMVectorSet(points.X[i], points.Y[i], points.Z[i], 1.f);
+            float x = XMVectorGetX(XMPlaneDotCoord(p, v));
+
+            std::uint64_t bit = 1ull << (i % 64);
+            std::size_t w = offset + i / 64;
+
+            if (x > epsilon)
+            {
+                if (front) front[w] |= bit;
+            }
+            else if (x < -epsilon)
+            {
+                if (back) back[w] |= bit;
+            }
+            else
+            {
+                if (on) on[w] |= bit;
+            }
+        }
+    }
+}
+
+void BatchPointPlaneClassification()
+{
+    cout << "Classify a batch of points against planes." << endl;
+
+    // The same points as in PointPlaneSpatialRelation, in structure-of-arrays form.
+    float x[] = { 3.f,  3.f, 3.f };
+    float y[] = { 5.f, -5.f, 0.f };
+    float z[] = { 2.f,  2.f, 2.f };
+    PointsSoA points = { x, y, z, 3 };
+
+    // Two planes: y = 0 and x = 3.
+    XMFLOAT4 planes[] = { XMFLOAT4(0.f, 1.f, 0.f, 0.f), XMFLOAT4(1.f, 0.f, 0.f, -3.f) };
+
+    std::size_t words = MaskWords(points.Count);
+    std::vector<std::uint64_t> front(2 * words), back(2 * words), on(2 * words);
+
+    ClassifyPoints(points, planes, 2, front.data(), back.data(), on.data());
+
+    for (std::size_t k = 0; k < 2; ++k)
+    {
+        for (std::size_t i = 0; i < points.Count; ++i)
+        {
+            cout << "plane " << k << ", v" << i + 1 << ": ";
+            if (TestMaskBit(&front[k * words], i)) cout << "in positive half-space" << endl;
+            if (TestMaskBit(&back[k * words], i)) cout << "in negative half-space" << endl;
+            if (TestMaskBit(&on[k * words], i)) cout << "coplanar" << endl;
+        }
+    }
+}
+
+void PlaneClassificationBenchmark()
+{
+    const std::size_t count = 1'000'000;
+    const std::size_t planeCount = 6;
+
+    cout << "Classify " << count << " points against " << planeCount << " planes." << endl;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> coordinate(-100.f, 100.f);
+
+    std::vector<float> x(count), y(count), z(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        x[i] = coordinate(gen);
+        y[i] = coordinate(gen);
+        z[i] = coordinate(gen);
+    }
+
+    // Put some points exactly on the first plane (y = 0).
+    for (std::size_t i = 0; i < count; i += 1000)
+        y[i] = 0.f;
+
+    PointsSoA points = { x.data(), y.data(), z.data(), count };
+
+    // The six planes of an axis-aligned box, normalized and facing inwards.
+    XMFLOAT4 planes[planeCount] =
+    {
+        XMFLOAT4( 0.f,  1.f,  0.f,  0.f),
+        XMFLOAT4( 0.f, -1.f,  0.f, 50.f),
+        XMFLOAT4( 1.f,  0.f,  0.f, 50.f),
+        XMFLOAT4(-1.f,  0.f,  0.f, 50.f),
+        XMFLOAT4( 0.f,  0.f,  1.f, 50.f),
+        XMFLOAT4( 0.f,  0.f, -1.f, 50.f),
+    };
+
+    std::size_t words = MaskWords(count) * planeCount;
+    std::vector<std::uint64_t> front(words), back(words), on(words);
+    std::vector<std::uint64_t> frontRef(words), backRef(words), onRef(words);
+
+    double scalar = TimeBestOf(5, [&]() { ClassifyPointsScalar(points, planes, planeCount, frontRef.data(), backRef.data(), onRef.data()); });
+    double batch = TimeBestOf(5, [&]() { ClassifyPoints(points, planes, planeCount, front.data(), back.data(), on.data()); });
+
+    bool same = front == frontRef && back == backRef && on == onRef;
+    cout << "Masks are " << (same ? "identical" : "DIFFERENT") << endl;
+
+    double evaluations = static_cast<double>(count * planeCount);
+    cout << "XMPlaneDotCoord per point: " << scalar * 1e9 / evaluations << " ns per point-plane test" << endl;
+    cout << BatchWidth << "-wide batch:             " << batch * 1e9 / evaluations << " ns per point-plane test" << endl;
+    cout << "Speed-up: " << scalar / batch << "x" << endl;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint64_t
+#include <cfloat> // FLT_EPSILON
+
+#include <DirectXMath.h>
+
+/*
+Batch classification of points against planes.
+
+PointPlaneSpatialRelation (Planes.cpp) classifies one point at a time: it loads the point into
+an XMVECTOR, calls XMPlaneDotCoord, extracts the result with XMVectorGetX, and branches on it.
+Only one lane of the SIMD register does useful work and every point costs a few branches.
+
+The batch API classifies many points at once:
+- The points are given in structure-of-arrays (SoA) form: separate arrays of x, y, and z.
+  This way a SIMD register holds the same coordinate of 4 (SSE, NEON) or 8 (AVX) points and
+  the plane equation a*x + b*y + c*z + d is evaluated for all of them with a few multiply-adds.
+- The results are bitmasks: for each plane, bit i says whether point i is in front of, behind, or 
+  on the plane. The comparison results are turned into bits with movemask and OR-ed into 64-bit
+  words without branches.
+
+The SIMD path is selected at compile time using the DirectXMath intrinsics macros:
+- _XM_AVX_INTRINSICS_ (/arch:AVX or /arch:AVX2): 8 points per iteration
+- _XM_SSE_INTRINSICS_ (the default on x86 and x64): 4 points per iteration
+- _XM_ARM_NEON_INTRINSICS_ (ARM and ARM64): 4 points per iteration
+- _XM_NO_INTRINSICS_: a portable scalar loop (still branch-free)
+*/
+
+// Points in structure-of-arrays form: the i-th point is (X[i], Y[i], Z[i]).
+struct PointsSoA
+{
+    const float* X;
+    const float* Y;
+    const float* Z;
+    std::size_t Count;
+};
+
+// The number of 64-bit words in a bitmask holding one bit per point.
+inline std::size_t MaskWords(std::size_t count)
+{
+    return (count + 63) / 64;
+}
+
+// Tests bit i of a bitmask.
+inline bool TestMaskBit(const std::uint64_t* mask, std::size_t i)
+{
+    return (mask[i / 64] >> (i % 64)) & 1;
+}
+
+// ClassifyPoints classifies each point against each plane (A, B, C, D), where Ax+By+Cz+D=0.
+// The masks for plane k start at front + k * MaskWords(points.Count) (the same for back and on).
+// For plane k and point i, exactly one of the three bits is set:
+// - front: the signed distance is greater than epsilon
+// - back:  the signed distance is less than -epsilon
+// - on:    otherwise
+// The unused bits of the last word of each mask are zero. Any of the mask pointers may be null.
+void ClassifyPoints(
+    const PointsSoA& points,
+    const DirectX::XMFLOAT4* planes, std::size_t planeCount,
+    std::uint64_t* front, std::uint64_t* back, std::uint64_t* on,
+    float epsilon = FLT_EPSILON);
+
+// ClassifyPointsScalar produces the same masks as ClassifyPoints using the per-point 
+// XMPlaneDotCoord approach from PointPlaneSpatialRelation. It is the reference implementation.
+void ClassifyPointsScalar(
+    const PointsSoA& points,
+    const DirectX::XMFLOAT4* planes, std::size_t planeCount,
+    std::uint64_t* front, std::uint64_t* back, std::uint64_t* on,
+    float epsilon = FLT_EPSILON);
+
+void BatchPointPlaneClassification();
+void PlaneClassificationBenchmark();
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <vector>
+
+#include "OutputOperators.h"
+#include "Swizzle.h"
+#include "Timing.h"
+
+using namespace DirectX;
+
+using std::cout;
+using std::endl;
+
+void SwizzleExample()
+{
+    // The swizzles of Swizzling, with the indices as template arguments.
+    XMVECTOR v = XMVectorSet(5.0f, 8.0f, 10.0f, 20.0f);
+    cout << Swizzle<0, 0, 1, 1>(v) << endl; // (5, 5, 8, 8): _mm_unpacklo_ps
+    cout << Swizzle<3, 3, 0, 2>(v) << endl; // (20, 20, 5, 10): _mm_shuffle_ps
+    cout << Swizzle<2, 1, 2, 3>(v) << endl; // (10, 8, 10, 20)
+
+    // The same with letters.
+    cout << Swz<"xxyy">(v) << endl; // (5, 5, 8, 8)
+    cout << Swz<"wwxz">(v) << endl; // (20, 20, 5, 10)
+    cout << Swz<"bgba">(v) << endl; // (10, 8, 10, 20)
+
+    // Permutes: lowercase letters are the elements of a, uppercase those of b.
+    XMVECTOR a = XMVectorSet(1.0f, 2.0f, 3.0f, 4.0f);
+    XMVECTOR b = XMVectorSet(5.0f, 6.0f, 7.0f, 8.0f);
+    cout << Permute<0, 1, 4, 5>(a, b) << endl; // (1, 2, 5, 6): _mm_movelh_ps
+    cout << Swz<"xXyY">(a, b) << endl;         // (1, 5, 2, 6): _mm_unpacklo_ps
+    cout << Swz<"xYzW">(a, b) << endl;         // (1, 6, 3, 8): _mm_blend_ps with SSE4.1
+    cout << Swz<"wzYX">(a, b) << endl;         // (4, 3, 6, 5): _mm_shuffle_ps
+
+    // Swz<"xxyq">(v) doesn't compile: 'q' is not an element.
+
+    cout << endl;
+}
+
+void SwizzleBenchmark()
+{
+    const std::size_t count = 10'000'000;
+
+    cout << "Add up three swizzles of " << count << " vectors." << endl;
+
+    std::vector<XMFLOAT4> vectors(count);
+    for (std::size_t i = 0; i < count; ++i)
+        vectors[i] = XMFLOAT4(static_cast<float>(i % 100), 1.f, static_cast<float>(i % 7), 2.f);
+
+    XMFLOAT4 sum1, sum2;
+
+    // The indices as function arguments.
+    double runtime = TimeBestOf(5, [&]()
+    {
+        XMVECTOR sum = XMVectorZero();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR v = XMLoadFloat4(&vectors[i]);
+            sum = XMVectorAdd(sum, XMVectorSwizzle(v, 0, 0, 1, 1));
+            sum = XMVectorAdd(sum, XMVectorSwizzle(v, 3, 2, 1, 0));
+            sum = XMVectorAdd(sum, XMVectorSwizzle(v, 2, 2, 3, 3));
+        }
+        XMStoreFloat4(&sum1, sum);
+    });
+
+    // The indices as template arguments.
+    double compileTime = TimeBestOf(5, [&]()
+    {
+        XMVECTOR sum = XMVectorZero();
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            XMVECTOR v = XMLoadFloat4(&vectors[i]);
+            sum = XMVectorAdd(sum, Swz<"xxyy">(v));
+            sum = XMVectorAdd(sum, Swz<"wzyx">(v));
+            sum = XMVectorAdd(sum, Swz<"zzww">(v));
+        }
+        XMStoreFloat4(&sum2, sum);
+    });
+
+    cout << "Sums: " << sum1 << ", " << sum2 << endl;
+    cout << "XMVectorSwizzle(v, 0, 0, 1, 1): " << runtime * 1e3 << " ms" << endl;
+    cout << "Swz<\"xxyy\">(v):                 " << compileTime * 1e3 << " ms" << endl;
+}
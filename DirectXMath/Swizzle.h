@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstdint> // uint32_t
+
+#include <DirectXMath.h>
+
+/*
+Swizzles and permutes with the element indices known at compile time.
+
+Swizzling calls XMVectorSwizzle(v, 0, 0, 1, 1). The indices are function arguments, so the function
+can't pick a shuffle instruction for them: with SSE it stores the vector and loads the elements
+back one at a time, with AVX it builds an index vector for vpermilps. In a shading loop that is
+several instructions and a trip through memory for what is one shuffle.
+
+Swizzle<X, Y, Z, W>(v) and Permute<X, Y, Z, W>(a, b) take the indices as template arguments and map
+each pattern to the cheapest instruction when the function is compiled:
+- SSE: _mm_movelh_ps, _mm_movehl_ps, _mm_unpacklo_ps, and _mm_unpackhi_ps for the patterns that
+  are whole halves of the vectors; _mm_moveldup_ps/_mm_movehdup_ps (SSE3) and _mm_blend_ps (SSE4.1)
+  when available; otherwise one _mm_shuffle_ps, which takes its two low elements from the first
+  operand and its two high elements from the second. With AVX a one-vector shuffle is vpermilps
+  (_mm_permute_ps), which doesn't overwrite its source, and a splat of element 0 is vbroadcastss (AVX2).
+- NEON: vextq_f32 for rotations, vzipq_f32 and vuzpq_f32 for interleaving, vrev64q_f32 for
+  swapping pairs, vdupq_lane_f32 for splats.
+- The other patterns go to the XMVectorSwizzle and XMVectorPermute templates of DirectXMath,
+  which handle them with two or three instructions.
+
+Swz<"xxyy">(v) names the elements by letters, as in HLSL: x, y, z, w (or r, g, b, a). Swz<"xyXY">(a, b)
+is a permute: lowercase letters are the elements of a, uppercase letters those of b. A pattern
+that is not four valid letters doesn't compile. This needs C++20 (a string literal as a template argument).
+
+SwizzleBenchmark adds up three swizzles of each of 10M vectors. An optimizer that inlines
+XMVectorSwizzle(v, 0, 0, 1, 1) and folds its constant arguments also ends up with one shuffle:
+built with GCC -O2, both loops take ~48 ms, the time of the chain of adds. The templates give the
+single instruction whatever the optimizer does, and in debug builds.
+*/
+
+namespace SwizzleDetail
+{
+    constexpr bool Is(std::uint32_t x, std::uint32_t y, std::uint32_t z, std::uint32_t w,
+        std::uint32_t ex, std::uint32_t ey, std::uint32_t ez, std::uint32_t ew)
+    {
+        return x == ex && y == ey && z == ez && w == ew;
+    }
+
+    // The element index of a letter: x, y, z, w or r, g, b, a for the first vector, in uppercase for the second.
+    // Any other character is an error: the throw makes the pattern not a constant expression.
+    constexpr std::uint32_t Component(char c)
+    {
+        switch (c)
+        {
+        case 'x': case 'r': return 0;
+        case 'y': case 'g': return 1;
+        case 'z': case 'b': return 2;
+        case 'w': case 'a': return 3;
+        case 'X': case 'R': return 4;
+        case 'Y': case 'G': return 5;
+        case 'Z': case 'B': return 6;
+        case 'W': case 'A': return 7;
+        default: throw "a swizzle pattern is made of the letters xyzw, rgba, XYZW, or RGBA";
+        }
+    }
+}
+
+// A swizzle pattern of four letters, such as "xxyy". It is a structural type, so it can be a template argument.
+struct SwizzlePattern
+{
+    std::uint32_t Index[4];
+
+    constexpr SwizzlePattern(const char (&pattern)[5])
+        : Index{ SwizzleDetail::Component(pattern[0]), SwizzleDetail::Component(pattern[1]),
+                 SwizzleDetail::Component(pattern[2]), SwizzleDetail::Component(pattern[3]) }
+    {
+    }
+};
+
+// Swizzle returns (v[X], v[Y], v[Z], v[W]).
+template <std::uint32_t X, std::uint32_t Y, std::uint32_t Z, std::uint32_t W>
+inline DirectX::XMVECTOR XM_CALLCONV Swizzle(DirectX::FXMVECTOR v) noexcept
+{
+    static_assert(X < 4 && Y < 4 && Z < 4 && W < 4, "the indices of a swizzle are 0 to 3");
+    using SwizzleDetail::Is;
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    if constexpr (Is(X, Y, Z, W, 0, 1, 2, 3))
+        return v;
+    else if constexpr (Is(X, Y, Z, W, 0, 1, 0, 1))
+        return _mm_movelh_ps(v, v);
+    else if constexpr (Is(X, Y, Z, W, 2, 3, 2, 3))
+        return _mm_movehl_ps(v, v);
+    else if constexpr (Is(X, Y, Z, W, 0, 0, 1, 1))
+        return _mm_unpacklo_ps(v, v);
+    else if constexpr (Is(X, Y, Z, W, 2, 2, 3, 3))
+        return _mm_unpackhi_ps(v, v);
+#if defined(_XM_SSE3_INTRINSICS_)
+    else if constexpr (Is(X, Y, Z, W, 0, 0, 2, 2))
+        return _mm_moveldup_ps(v);
+    else if constexpr (Is(X, Y, Z, W, 1, 1, 3, 3))
+        return _mm_movehdup_ps(v);
+#endif
+#if defined(_XM_AVX2_INTRINSICS_)
+    else if constexpr (Is(X, Y, Z, W, 0, 0, 0, 0))
+        return _mm_broadcastss_ps(v);
+#endif
+#if defined(_XM_AVX_INTRINSICS_)
+    else
+        return _mm_permute_ps(v, _MM_SHUFFLE(W, Z, Y, X));
+#else
+    else
+        return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+#endif
+#elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    if constexpr (Is(X, Y, Z, W, 0, 1, 2, 3))
+        return v;
+    else if constexpr (Is(X, Y, Z, W, 1, 2, 3, 0))
+        return vextq_f32(v, v, 1);
+    else if constexpr (Is(X, Y, Z, W, 2, 3, 0, 1))
+        return vextq_f32(v, v, 2);
+    else if constexpr (Is(X, Y, Z, W, 3, 0, 1, 2))
+        return vextq_f32(v, v, 3);
+    else if constexpr (Is(X, Y, Z, W, 1, 0, 3, 2))
+        return vrev64q_f32(v);
+    else if constexpr (Is(X, Y, Z, W, 0, 0, 1, 1))
+        return vzipq_f32(v, v).val[0];
+    else if constexpr (Is(X, Y, Z, W, 2, 2, 3, 3))
+        return vzipq_f32(v, v).val[1];
+    else if constexpr (Is(X, Y, Z, W, 0, 2, 0, 2))
+        return vuzpq_f32(v, v).val[0];
+    else if constexpr (Is(X, Y, Z, W, 1, 3, 1, 3))
+        return vuzpq_f32(v, v).val[1];
+    else if constexpr (X == Y && Y == Z && Z == W && X < 2)
+        return vdupq_lane_f32(vget_low_f32(v), X);
+    else if constexpr (X == Y && Y == Z && Z == W)
+        return vdupq_lane_f32(vget_high_f32(v), X - 2);
+    else
+        return DirectX::XMVectorSwizzle<X, Y, Z, W>(v);
+#else
+    return DirectX::XMVectorSwizzle<X, Y, Z, W>(v);
+#endif
+}
+
+// Permute returns four elements of the eight of (a, b): 0 to 3 are the elements of a, 4 to 7 those of b.
+template <std::uint32_t X, std::uint32_t Y, std::uint32_t Z, std::uint32_t W>
+inline DirectX::XMVECTOR XM_CALLCONV Permute(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b) noexcept
+{
+    static_assert(X < 8 && Y < 8 && Z < 8 && W < 8, "the indices of a permute are 0 to 7");
+    using SwizzleDetail::Is;
+
+    // A permute of a single vector is a swizzle.
+    if constexpr (X < 4 && Y < 4 && Z < 4 && W < 4)
+        return Swizzle<X, Y, Z, W>(a);
+    else if constexpr (X >= 4 && Y >= 4 && Z >= 4 && W >= 4)
+        return Swizzle<X - 4, Y - 4, Z - 4, W - 4>(b);
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    else if constexpr (Is(X, Y, Z, W, 0, 1, 4, 5))
+        return _mm_movelh_ps(a, b);
+    else if constexpr (Is(X, Y, Z, W, 4, 5, 0, 1))
+        return _mm_movelh_ps(b, a);
+    else if constexpr (Is(X, Y, Z, W, 6, 7, 2, 3))
+        return _mm_movehl_ps(a, b);
+    else if constexpr (Is(X, Y, Z, W, 2, 3, 6, 7))
+        return _mm_movehl_ps(b, a);
+    else if constexpr (Is(X, Y, Z, W, 0, 4, 1, 5))
+        return _mm_unpacklo_ps(a, b);
+    else if constexpr (Is(X, Y, Z, W, 4, 0, 5, 1))
+        return _mm_unpacklo_ps(b, a);
+    else if constexpr (Is(X, Y, Z, W, 2, 6, 3, 7))
+        return _mm_unpackhi_ps(a, b);
+    else if constexpr (Is(X, Y, Z, W, 6, 2, 7, 3))
+        return _mm_unpackhi_ps(b, a);
+#if defined(_XM_SSE4_INTRINSICS_)
+    // Every element stays in its lane: a blend takes each one from a or from b.
+    else if constexpr (X % 4 == 0 && Y % 4 == 1 && Z % 4 == 2 && W % 4 == 3)
+        return _mm_blend_ps(a, b, (X / 4) | (Y / 4) << 1 | (Z / 4) << 2 | (W / 4) << 3);
+#endif
+    else if constexpr (X < 4 && Y < 4 && Z >= 4 && W >= 4)
+        return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W - 4, Z - 4, Y, X));
+    else if constexpr (X >= 4 && Y >= 4 && Z < 4 && W < 4)
+        return _mm_shuffle_ps(b, a, _MM_SHUFFLE(W, Z, Y - 4, X - 4));
+#elif defined(_XM_ARM_NEON_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    // Four consecutive elements of a and b.
+    else if constexpr (X < 4 && Y == X + 1 && Z == X + 2 && W == X + 3)
+        return vextq_f32(a, b, X);
+    else if constexpr (X >= 4 && Y == (X + 1) % 8 && Z == (X + 2) % 8 && W == (X + 3) % 8)
+        return vextq_f32(b, a, X - 4);
+    else if constexpr (Is(X, Y, Z, W, 0, 4, 1, 5))
+        return vzipq_f32(a, b).val[0];
+    else if constexpr (Is(X, Y, Z, W, 2, 6, 3, 7))
+        return vzipq_f32(a, b).val[1];
+    else if constexpr (Is(X, Y, Z, W, 0, 2, 4, 6))
+        return vuzpq_f32(a, b).val[0];
+    else if constexpr (Is(X, Y, Z, W, 1, 3, 5, 7))
+        return vuzpq_f32(a, b).val[1];
+    else if constexpr (Is(X, Y, Z, W, 0, 1, 4, 5))
+        return vcombine_f32(vget_low_f32(a), vget_low_f32(b));
+    else if constexpr (Is(X, Y, Z, W, 2, 3, 6, 7))
+        return vcombine_f32(vget_high_f32(a), vget_high_f32(b));
+#endif
+    else
+        return DirectX::XMVectorPermute<X, Y, Z, W>(a, b);
+}
+
+// Swz<"xxyy">(v) is Swizzle<0, 0, 1, 1>(v).
+template <SwizzlePattern P>
+inline DirectX::XMVECTOR XM_CALLCONV Swz(DirectX::FXMVECTOR v) noexcept
+{
+    static_assert(P.Index[0] < 4 && P.Index[1] < 4 && P.Index[2] < 4 && P.Index[3] < 4,
+        "a swizzle of one vector is made of lowercase letters");
+    return Swizzle<P.Index[0], P.Index[1], P.Index[2], P.Index[3]>(v);
+}
+
+// Swz<"xyXY">(a, b) is Permute<0, 1, 4, 5>(a, b).
+template <SwizzlePattern P>
+inline DirectX::XMVECTOR XM_CALLCONV Swz(DirectX::FXMVECTOR a, DirectX::FXMVECTOR b) noexcept
+{
+    return Permute<P.Index[0], P.Index[1], P.Index[2], P.Index[3]>(a, b);
+}
+
+void SwizzleExample();
+void SwizzleBenchmark();
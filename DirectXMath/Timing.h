@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+
+/*
+A small timing helper used by the batch-processing examples to compare a per-element 
+DirectXMath loop with its batch counterpart.
+
+Each measurement runs the function several times and keeps the fastest run. The fastest run
+is the one least disturbed by other processes, interrupts, and cold caches.
+*/
+
+// TimeBestOf calls f() repeat times and returns the duration of the fastest call in seconds.
+template <typename Func>
+double TimeBestOf(int repeat, Func f)
+{
+    double best = 1e300;
+
+    for (int i = 0; i < repeat; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+
+        auto seconds = std::chrono::duration<double>(end - start).count();
+        if (seconds < best)
+            best = seconds;
+    }
+
+    return best;
+}
@@ -0,0 +1,303 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm> // fill, min
+#include <random>
+#include <cassert>
+#include <cmath> // fabs
+
+#include "TransformHierarchy.h"
+#include "Timing.h"
+
+using namespace DirectX;
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+    inline XMMATRIX XM_CALLCONV LocalMatrix(const LocalTransform& local)
+    {
+        return XMMatrixAffineTransformation(XMLoadFloat3(&local.Scale), XMVectorZero(),
+            XMLoadFloat4(&local.Rotation), XMLoadFloat3(&local.Translation));
+    }
+
+    // A barrier for a fixed number of threads that meet many times in a short while: the threads spin
+    // (yielding their time slice) instead of sleeping, as a level takes microseconds to update.
+    class SpinBarrier
+    {
+    public:
+        explicit SpinBarrier(unsigned threads) : m_threads(threads) {}
+
+        void Wait()
+        {
+            unsigned generation = m_generation.load(std::memory_order_acquire);
+            if (m_waiting.fetch_add(1, std::memory_order_acq_rel) + 1 == m_threads)
+            {
+                m_waiting.store(0, std::memory_order_relaxed);
+                m_generation.store(generation + 1, std::memory_order_release);
+                return;
+            }
+            while (m_generation.load(std::memory_order_acquire) == generation)
+                std::this_thread::yield();
+        }
+
+    private:
+        const unsigned m_threads;
+        std::atomic<unsigned> m_waiting{ 0 };
+        std::atomic<unsigned> m_generation{ 0 };
+    };
+}
+
+std::uint32_t TransformHierarchy::AddNode(std::uint32_t parent, const LocalTransform& local)
+{
+    std::uint32_t index = static_cast<std::uint32_t>(m_parents.size());
+    std::uint32_t level = parent == NoParent ? 0 : m_nodeLevels[parent] + 1;
+
+    assert(parent == NoParent || parent < index);
+    assert(m_levels.size() == level || m_levels.size() == level + 1);
+
+    if (m_levels.size() == level)
+        m_levels.push_back(index);
+
+    m_locals.push_back(local);
+    m_parents.push_back(parent);
+    m_worlds.emplace_back();
+    m_dirty.push_back(1);
+    m_nodeLevels.push_back(level);
+
+    m_firstDirty = std::min<std::size_t>(m_firstDirty, index);
+    return index;
+}
+
+void TransformHierarchy::SetLocal(std::uint32_t node, const LocalTransform& local)
+{
+    m_locals[node] = local;
+    m_dirty[node] = 1;
+    m_firstDirty = std::min<std::size_t>(m_firstDirty, node);
+}
+
+// UpdateRange updates the nodes [first, last) of a level. A recomputed node is left dirty, so that its
+// children are recomputed as well; Update clears the flags at the end.
+void TransformHierarchy::UpdateRange(std::size_t first, std::size_t last)
+{
+    for (std::size_t i = first; i < last; ++i)
+    {
+        std::uint32_t parent = m_parents[i];
+        bool parentDirty = parent != NoParent && m_dirty[parent];
+        if (!m_dirty[i] && !parentDirty)
+            continue;
+
+        XMMATRIX world = LocalMatrix(m_locals[i]);
+        if (parent != NoParent)
+            world = XMMatrixMultiply(world, XMLoadFloat4x4(&m_worlds[parent]));
+        XMStoreFloat4x4(&m_worlds[i], world);
+
+        if (parentDirty)
+            m_dirty[i] = 1;
+    }
+}
+
+std::size_t TransformHierarchy::Update(unsigned threads)
+{
+    const std::size_t size = m_parents.size();
+    const std::size_t first = m_firstDirty;
+    if (first >= size)
+        return 0;
+
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+
+    // The levels from the one of the first dirty node down. A level smaller than minRange nodes per thread
+    // is updated by the calling thread alone, while the others wait at the barrier.
+    const std::size_t firstLevel = m_nodeLevels[first];
+    const std::size_t levelCount = m_levels.size();
+    const std::size_t minRange = 2048;
+
+    auto levelEnd = [&](std::size_t level) { return level + 1 < levelCount ? m_levels[level + 1] : size; };
+
+    if (threads <= 1 || size - first < 2 * minRange)
+    {
+        UpdateRange(first, size);
+    }
+    else
+    {
+        SpinBarrier barrier(threads);
+        auto worker = [&](unsigned t)
+        {
+            for (std::size_t level = firstLevel; level < levelCount; ++level)
+            {
+                std::size_t begin = std::max(m_levels[level], first);
+                std::size_t end = levelEnd(level);
+                std::size_t n = end - begin;
+
+                if (n < threads * minRange)
+                {
+                    if (t == 0)
+                        UpdateRange(begin, end);
+                }
+                else
+                {
+                    // Chunks of a multiple of 64 nodes, so the threads seldom write to the same cache line of m_dirty.
+                    std::size_t chunk = (n / threads + 63) / 64 * 64;
+                    std::size_t chunkBegin = std::min(begin + t * chunk, end);
+                    std::size_t chunkEnd = t + 1 == threads ? end : std::min(chunkBegin + chunk, end);
+                    UpdateRange(chunkBegin, chunkEnd);
+                }
+
+                barrier.Wait();
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; ++t)
+            workers.emplace_back(worker, t);
+
+        worker(0);
+
+        for (auto& w : workers)
+            w.join();
+    }
+
+    std::size_t updated = static_cast<std::size_t>(std::count(m_dirty.begin() + first, m_dirty.end(), 1));
+    std::fill(m_dirty.begin() + first, m_dirty.end(), 0);
+    m_firstDirty = size;
+    return updated;
+}
+
+namespace
+{
+    LocalTransform MakeLocal(float scale, float yaw, float x, float y, float z)
+    {
+        LocalTransform local;
+        local.Scale = XMFLOAT3(scale, scale, scale);
+        XMStoreFloat4(&local.Rotation, XMQuaternionRotationRollPitchYaw(0.f, yaw, 0.f));
+        local.Translation = XMFLOAT3(x, y, z);
+        return local;
+    }
+
+    void PrintPosition(const char* name, const TransformHierarchy& hierarchy, std::uint32_t node)
+    {
+        XMVECTOR p = XMVector3Transform(XMVectorZero(), hierarchy.GetWorld(node));
+        cout << std::setw(6) << name << ": (" << XMVectorGetX(p) << ", " << XMVectorGetY(p) << ", " << XMVectorGetZ(p) << ")" << endl;
+    }
+}
+
+void TransformHierarchyExample()
+{
+    cout << std::fixed << std::setprecision(2);
+
+    // The sun at the origin, the earth 10 units away, the moon 2 units from the earth.
+    TransformHierarchy solarSystem;
+    std::uint32_t sun = solarSystem.AddNode(TransformHierarchy::NoParent, MakeLocal(1.f, 0.f, 0.f, 0.f, 0.f));
+    std::uint32_t earth = solarSystem.AddNode(sun, MakeLocal(1.f, 0.f, 10.f, 0.f, 0.f));
+    std::uint32_t moon = solarSystem.AddNode(earth, MakeLocal(1.f, 0.f, 2.f, 0.f, 0.f));
+
+    cout << "Updated " << solarSystem.Update() << " nodes" << endl; // 3
+    PrintPosition("earth", solarSystem, earth);  // (10.00, 0.00, 0.00)
+    PrintPosition("moon", solarSystem, moon);    // (12.00, 0.00, 0.00)
+
+    // Turn the earth by 90 degrees: the moon goes around it, the sun stays.
+    solarSystem.SetLocal(earth, MakeLocal(1.f, XM_PIDIV2, 10.f, 0.f, 0.f));
+    cout << "Updated " << solarSystem.Update() << " nodes" << endl; // 2
+    PrintPosition("earth", solarSystem, earth);  // (10.00, 0.00, 0.00)
+    PrintPosition("moon", solarSystem, moon);    // (10.00, 0.00, -2.00)
+
+    // Nothing has moved.
+    cout << "Updated " << solarSystem.Update() << " nodes" << endl; // 0
+
+    cout.unsetf(std::ios_base::floatfield);
+    cout << std::setprecision(6);
+}
+
+namespace
+{
+    // Recomputes every world matrix, following the parent indices: what is done without dirty flags.
+    void UpdateAll(const TransformHierarchy& hierarchy, std::vector<XMFLOAT4X4>& worlds)
+    {
+        for (std::uint32_t i = 0; i < hierarchy.Size(); ++i)
+        {
+            XMMATRIX world = LocalMatrix(hierarchy.GetLocal(i));
+            std::uint32_t parent = hierarchy.Parent(i);
+            if (parent != TransformHierarchy::NoParent)
+                world = XMMatrixMultiply(world, XMLoadFloat4x4(&worlds[parent]));
+            XMStoreFloat4x4(&worlds[i], world);
+        }
+    }
+
+    float MaxDifference(const TransformHierarchy& hierarchy, const std::vector<XMFLOAT4X4>& worlds)
+    {
+        float result = 0.f;
+        for (std::uint32_t i = 0; i < hierarchy.Size(); ++i)
+        {
+            XMFLOAT4X4 world;
+            XMStoreFloat4x4(&world, hierarchy.GetWorld(i));
+            for (int r = 0; r < 4; ++r)
+                for (int c = 0; c < 4; ++c)
+                    result = std::max(result, std::fabs(world.m[r][c] - worlds[i].m[r][c]));
+        }
+        return result;
+    }
+}
+
+void TransformHierarchyBenchmark()
+{
+    const std::uint32_t count = 50'000;
+    const std::uint32_t children = 8;
+
+    cout << "Update a hierarchy of " << count << " nodes with " << children << " children per node." << endl;
+
+    // Node i is a child of node (i - 1) / children: the nodes are numbered breadth-first.
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> offset(-2.f, 2.f), angle(-XM_PI, XM_PI);
+
+    TransformHierarchy hierarchy;
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        std::uint32_t parent = i == 0 ? TransformHierarchy::NoParent : (i - 1) / children;
+        hierarchy.AddNode(parent, MakeLocal(0.9f, angle(gen), offset(gen), offset(gen), offset(gen)));
+    }
+    hierarchy.Update();
+
+    std::vector<XMFLOAT4X4> worlds(count);
+    double all = TimeBestOf(5, [&]() { UpdateAll(hierarchy, worlds); });
+
+    // Moving some of the nodes; the nodes to move are picked in advance.
+    auto moveNodes = [&](std::uint32_t first, std::uint32_t last, unsigned threads)
+    {
+        std::uniform_int_distribution<std::uint32_t> pick(first, last - 1);
+        std::vector<std::uint32_t> moved(10);
+        for (auto& node : moved)
+            node = pick(gen);
+
+        std::size_t updated = 0;
+        double seconds = TimeBestOf(5, [&]()
+        {
+            for (auto node : moved)
+            {
+                LocalTransform local = hierarchy.GetLocal(node);
+                local.Translation.y += 0.01f;
+                hierarchy.SetLocal(node, local);
+            }
+            updated = hierarchy.Update(threads);
+        });
+        return std::make_pair(seconds, updated);
+    };
+
+    // The leaves are the last nodes; the nodes 9 to 72 are two levels below the root.
+    auto leaves = moveNodes(count - count / children, count, 1);
+    auto subtrees = moveNodes(1 + children, 1 + children + children * children, 1);
+    auto root = moveNodes(0, 1, 1);
+    auto rootThreaded = moveNodes(0, 1, 0);
+
+    UpdateAll(hierarchy, worlds);
+    cout << "Max difference from recomputing every node: " << MaxDifference(hierarchy, worlds) << endl;
+
+    cout << "Recompute every node:                    " << all * 1e6 << " us" << endl;
+    cout << "Update, 10 leaves moved:                 " << leaves.first * 1e6 << " us, " << leaves.second << " nodes" << endl;
+    cout << "Update, 10 nodes moved at level 2:       " << subtrees.first * 1e6 << " us, " << subtrees.second << " nodes" << endl;
+    cout << "Update, root moved:                      " << root.first * 1e6 << " us, " << root.second << " nodes" << endl;
+    cout << "Update, root moved, " << std::thread::hardware_concurrency() << " threads:           " << rootThreaded.first * 1e6 << " us" << endl;
+}
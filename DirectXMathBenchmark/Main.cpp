@@ -0,0 +1,342 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <random>
+
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h> // XMCOLOR
+
+#include "Timing.h" // TimeBestOf
+
+/*
+Benchmarks of the DirectXMath operations of the DirectXMath project (Vectors, Matrices, Planes,
+Colors, Operations), each applied in a loop over a large array, so that the compile flags can be
+chosen on evidence rather than by habit.
+
+DirectXMath picks its implementation when it is compiled, so each implementation is a separate build
+of this project:
+- Scalar|x64: _XM_NO_INTRINSICS_, plain C++ on the float members of XMVECTOR
+- SSE2|x64: the default on x64
+- AVX2|x64: /arch:AVX2, which also enables FMA3 and F16C in DirectXMath
+- NEON|ARM64: the default on ARM64
+e.g. msbuild DirectXMathBenchmark\DirectXMathBenchmark.vcxproj /p:Configuration=AVX2 /p:Platform=x64
+
+Each run prints the time per operation in nanoseconds (the fastest of 5 runs over the array) and
+adds its results to a CSV file, DirectXMathBenchmark.csv in the current directory or the file given
+on the command line, replacing the earlier results of the same build. It then prints the results of
+all the builds in the file side by side, with the speedup over the scalar build. Running the builds
+one after the other, on the same machine, gives the whole table. Results copied from another machine
+(e.g. an ARM64 device) can be appended to the file.
+
+The operations are independent from one element to the next, so these are throughput numbers. The
+arrays are sized to stay in L2 cache, so that the memory doesn't hide the differences of arithmetic.
+*/
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+using std::cout;
+using std::endl;
+
+namespace
+{
+#if defined(_XM_NO_INTRINSICS_)
+    const char* const Build = "scalar";
+#elif defined(_XM_ARM_NEON_INTRINSICS_)
+    const char* const Build = "NEON";
+#elif defined(_XM_AVX2_INTRINSICS_)
+    const char* const Build = "AVX2";
+#elif defined(_XM_SSE_INTRINSICS_)
+    const char* const Build = "SSE2";
+#else
+    const char* const Build = "unknown";
+#endif
+
+    // The builds in the order of the columns of the comparison.
+    const char* const Builds[] = { "scalar", "SSE2", "AVX2", "NEON" };
+
+    struct Operation
+    {
+        std::string Name;
+        std::size_t Count;              // the number of operations in a call of Run
+        std::function<void()> Run;
+    };
+
+    // The inputs, the outputs, and a checksum of the outputs, which is the same in every build
+    // (to the rounding of the last bits) and keeps the optimizer from dropping the loops.
+    struct Data
+    {
+        static const std::size_t Count = 16 * 1024;
+
+        std::vector<XMFLOAT4> A, B, Out;
+        std::vector<XMFLOAT3> Points, Points3Out;
+        std::vector<XMFLOAT4X4> Matrices, MatricesOut;
+        std::vector<XMCOLOR> Colors, ColorsOut;
+        std::vector<float> Scalars;
+        XMFLOAT4X4 Transform;
+        XMFLOAT4 Plane;
+
+        Data() : A(Count), B(Count), Out(Count), Points(Count), Points3Out(Count), Matrices(Count / 4), MatricesOut(Count / 4),
+            Colors(Count), ColorsOut(Count), Scalars(Count)
+        {
+            std::mt19937 gen(42);
+            std::uniform_real_distribution<float> value(-10.f, 10.f), unit(0.f, 1.f);
+
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                A[i] = XMFLOAT4(value(gen), value(gen), value(gen), value(gen));
+                B[i] = XMFLOAT4(value(gen), value(gen), value(gen), value(gen));
+                Points[i] = XMFLOAT3(value(gen), value(gen), value(gen));
+                Colors[i] = XMCOLOR(unit(gen), unit(gen), unit(gen), unit(gen));
+            }
+
+            // Invertible matrices: rotations, scalings, and translations.
+            for (auto& m : Matrices)
+            {
+                XMMATRIX r = XMMatrixRotationRollPitchYaw(value(gen), value(gen), value(gen));
+                XMMATRIX s = XMMatrixScaling(1.f + unit(gen), 1.f + unit(gen), 1.f + unit(gen));
+                XMStoreFloat4x4(&m, s * r * XMMatrixTranslation(value(gen), value(gen), value(gen)));
+            }
+
+            XMStoreFloat4x4(&Transform, XMMatrixRotationY(0.5f) * XMMatrixTranslation(1.f, 2.f, 3.f)
+                * XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.f / 9.f, 1.f, 100.f));
+            XMStoreFloat4(&Plane, XMPlaneFromPointNormal(XMVectorSet(1.f, 2.f, 3.f, 1.f), XMVector3Normalize(XMVectorSet(1.f, 1.f, 0.f, 0.f))));
+        }
+
+        double Checksum() const
+        {
+            double sum = 0;
+            for (std::size_t i = 0; i < Count; ++i)
+            {
+                sum += Out[i].x + Out[i].y + Out[i].z + Out[i].w + Points3Out[i].x + Points3Out[i].y + Points3Out[i].z + Scalars[i];
+                sum += ColorsOut[i].c & 0xFF;
+            }
+            for (auto& m : MatricesOut)
+                sum += m.m[0][0] + m.m[1][1] + m.m[2][2] + m.m[3][3] + m.m[3][0];
+            return sum;
+        }
+    };
+
+    std::vector<Operation> MakeOperations(Data& d)
+    {
+        const std::size_t n = Data::Count;
+        std::vector<Operation> operations;
+
+        // Vectors
+        operations.push_back({ "vector multiply-add", n, [&d, n]()
+        {
+            XMVECTOR c = XMVectorReplicate(0.5f);
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMVectorMultiplyAdd(XMLoadFloat4(&d.A[i]), XMLoadFloat4(&d.B[i]), c));
+        } });
+        operations.push_back({ "vector3 dot", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                d.Scalars[i] = XMVectorGetX(XMVector3Dot(XMLoadFloat4(&d.A[i]), XMLoadFloat4(&d.B[i])));
+        } });
+        operations.push_back({ "vector3 cross", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMVector3Cross(XMLoadFloat4(&d.A[i]), XMLoadFloat4(&d.B[i])));
+        } });
+        operations.push_back({ "vector3 normalize", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMVector3Normalize(XMLoadFloat4(&d.A[i])));
+        } });
+        operations.push_back({ "vector3 length", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                d.Scalars[i] = XMVectorGetX(XMVector3Length(XMLoadFloat4(&d.A[i])));
+        } });
+
+        // Matrices
+        operations.push_back({ "matrix multiply", n / 4, [&d, n]()
+        {
+            XMMATRIX m = XMLoadFloat4x4(&d.Transform);
+            for (std::size_t i = 0; i < n / 4; ++i)
+                XMStoreFloat4x4(&d.MatricesOut[i], XMMatrixMultiply(XMLoadFloat4x4(&d.Matrices[i]), m));
+        } });
+        operations.push_back({ "matrix transpose", n / 4, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n / 4; ++i)
+                XMStoreFloat4x4(&d.MatricesOut[i], XMMatrixTranspose(XMLoadFloat4x4(&d.Matrices[i])));
+        } });
+        operations.push_back({ "matrix inverse", n / 4, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n / 4; ++i)
+                XMStoreFloat4x4(&d.MatricesOut[i], XMMatrixInverse(nullptr, XMLoadFloat4x4(&d.Matrices[i])));
+        } });
+        operations.push_back({ "vector3 transform coord", n, [&d, n]()
+        {
+            XMMATRIX m = XMLoadFloat4x4(&d.Transform);
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat3(&d.Points3Out[i], XMVector3TransformCoord(XMLoadFloat3(&d.Points[i]), m));
+        } });
+
+        // Planes
+        operations.push_back({ "plane dot coord", n, [&d, n]()
+        {
+            XMVECTOR plane = XMLoadFloat4(&d.Plane);
+            for (std::size_t i = 0; i < n; ++i)
+                d.Scalars[i] = XMVectorGetX(XMPlaneDotCoord(plane, XMLoadFloat3(&d.Points[i])));
+        } });
+        operations.push_back({ "plane normalize", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMPlaneNormalize(XMLoadFloat4(&d.A[i])));
+        } });
+        operations.push_back({ "plane-line intersect", n, [&d, n]()
+        {
+            XMVECTOR plane = XMLoadFloat4(&d.Plane);
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMPlaneIntersectLine(plane, XMLoadFloat4(&d.A[i]), XMLoadFloat4(&d.B[i])));
+        } });
+
+        // Colors
+        operations.push_back({ "color load/modulate/store", n, [&d, n]()
+        {
+            XMVECTOR tint = XMVectorSet(1.f, 0.8f, 0.6f, 1.f);
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreColor(&d.ColorsOut[i], XMColorModulate(XMLoadColor(&d.Colors[i]), tint));
+        } });
+        operations.push_back({ "color RGB to HSV", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMColorRGBToHSV(XMLoadColor(&d.Colors[i])));
+        } });
+
+        // Operations
+        operations.push_back({ "vector sin/cos", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                XMVECTOR s, c;
+                XMVectorSinCos(&s, &c, XMLoadFloat4(&d.A[i]));
+                XMStoreFloat4(&d.Out[i], XMVectorAdd(s, c));
+            }
+        } });
+        operations.push_back({ "vector exp2/log2", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMVectorLog2(XMVectorExp2(XMLoadFloat4(&d.A[i]))));
+        } });
+        operations.push_back({ "vector sqrt", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                XMStoreFloat4(&d.Out[i], XMVectorSqrt(XMVectorAbs(XMLoadFloat4(&d.A[i]))));
+        } });
+        operations.push_back({ "vector swizzle", n, [&d, n]()
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                XMVECTOR v = XMLoadFloat4(&d.A[i]);
+                XMStoreFloat4(&d.Out[i], XMVectorAdd(XMVectorSwizzle<1, 0, 3, 2>(v), XMVectorSwizzle<2, 2, 3, 3>(v)));
+            }
+        } });
+
+        return operations;
+    }
+
+    // The results of the CSV file: the time per operation in nanoseconds by build and operation.
+    typedef std::map<std::string, std::map<std::string, double>> Results;
+
+    Results ReadResults(const std::string& filename)
+    {
+        Results results;
+        std::ifstream in(filename);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            std::istringstream fields(line);
+            std::string build, operation, ns;
+            if (std::getline(fields, build, ',') && std::getline(fields, operation, ',') && std::getline(fields, ns))
+                results[build][operation] = std::stod(ns);
+        }
+        return results;
+    }
+
+    void WriteResults(const std::string& filename, const Results& results)
+    {
+        std::ofstream out(filename);
+        for (auto& build : results)
+            for (auto& operation : build.second)
+                out << build.first << ',' << operation.first << ',' << operation.second << '\n';
+    }
+
+    void PrintComparison(const std::vector<Operation>& operations, const Results& results)
+    {
+        std::vector<std::string> builds;
+        for (auto build : Builds)
+        {
+            if (results.count(build) != 0)
+                builds.push_back(build);
+        }
+
+        const std::string baseline = results.count("scalar") != 0 ? "scalar" : builds.front();
+        cout << endl << "ns/op and speedup over the " << baseline << " build:" << endl;
+
+        cout << std::left << std::setw(28) << "operation" << std::right;
+        for (auto& build : builds)
+            cout << std::setw(16) << build;
+        cout << endl;
+
+        cout << std::fixed;
+        for (auto& operation : operations)
+        {
+            cout << std::left << std::setw(28) << operation.Name << std::right;
+            auto base = results.at(baseline).find(operation.Name);
+            for (auto& build : builds)
+            {
+                auto& times = results.at(build);
+                auto it = times.find(operation.Name);
+                if (it == times.end())
+                {
+                    cout << std::setw(16) << "-";
+                    continue;
+                }
+
+                std::ostringstream cell;
+                cell << std::fixed << std::setprecision(2) << it->second;
+                if (build != baseline && base != results.at(baseline).end())
+                    cell << " (" << std::setprecision(1) << base->second / it->second << "x)";
+                cout << std::setw(16) << cell.str();
+            }
+            cout << endl;
+        }
+        cout.unsetf(std::ios_base::floatfield);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::string filename = argc > 1 ? argv[1] : "DirectXMathBenchmark.csv";
+
+    cout << "DirectXMath benchmark, " << Build << " build, " << Data::Count << " elements per loop." << endl;
+
+    Data data;
+    auto operations = MakeOperations(data);
+
+    Results results = ReadResults(filename);
+    results[Build].clear();
+
+    cout << std::left << std::setw(28) << "operation" << std::right << std::setw(10) << "ns/op" << endl;
+    for (auto& operation : operations)
+    {
+        double ns = TimeBestOf(5, operation.Run) / operation.Count * 1e9;
+        results[Build][operation.Name] = ns;
+        cout << std::left << std::setw(28) << operation.Name << std::right << std::setw(10) << std::fixed << std::setprecision(2) << ns << endl;
+    }
+    cout.unsetf(std::ios_base::floatfield);
+    cout << "Checksum: " << std::setprecision(10) << data.Checksum() << std::setprecision(6) << endl;
+
+    WriteResults(filename, results);
+    PrintComparison(operations, results);
+
+    return 0;
+}
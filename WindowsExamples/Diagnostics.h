@@ -124,6 +124,7 @@ namespace Diagnostics
     // TRACE
     //
     #include <stdio.h> // printf variants provided by CRT
+    #include "TraceSink.h" // AsyncTracer, DefaultTraceSink
     
     // OutputDebugString - Windows provides the debugging hooks that Visual Studio relies on
     // This also has the benefit of allowing you to watch Trace output in something other than Visual Studio.
@@ -209,10 +210,18 @@ namespace Diagnostics
     };
     #endif
 
+    // TRACE_ASYNC captures the arguments into a per-thread ring buffer and lets a background thread
+    // format and write them (see TraceSink.h). It's available in all builds.
+    #define TRACE_ASYNC Diagnostics::AsyncTracer(__FILE__, __LINE__)
+
     // In Debug builds, we construct the Tracer object passing two arguments to its ctor.
-    // In Release builds, the __noop intrinsic specifies that no code should be generated.
-    #ifdef _DEBUG
+    // In Release builds, TRACE goes to the asynchronous sink, which costs tens of nanoseconds 
+    // rather than microseconds. Define NO_TRACE to compile it out: the __noop intrinsic specifies 
+    // that no code should be generated.
+    #if defined(_DEBUG)
     #define TRACE Diagnostics::Tracer(__FILE__, __LINE__)
+    #elif !defined(NO_TRACE)
+    #define TRACE TRACE_ASYNC
     #else
     #define TRACE __noop
     #endif
@@ -222,6 +231,25 @@ namespace Diagnostics
         // Invoke the Tracer's function call operator (the function object) and pass
         // the format string and a list of values.
         TRACE(L"1 + 2 = %d\n", 1 + 2);
+
+        // Strings are copied into the record, so a temporary buffer is fine.
+        wchar_t name[] = L"sink";
+        TRACE_ASYNC(L"%s: %d %.2f\n", name, 42, 3.14);
+
+        // Time the hot path. The ring holds 1024 records; the rest of a burst is dropped and counted.
+        const int count = 1000;
+        LARGE_INTEGER frequency, start, end;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&start);
+        for (int i = 0; i < count; ++i)
+            TRACE_ASYNC(L"i=%d\n", i);
+        QueryPerformanceCounter(&end);
+
+        auto ns = static_cast<double>(end.QuadPart - start.QuadPart) * 1e9 / frequency.QuadPart / count;
+        cout << "TRACE_ASYNC: " << ns << " ns per call ";
+
+        // Wait until the background thread has written everything.
+        DefaultTraceSink().Flush();
     }
 
 
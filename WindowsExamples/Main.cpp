@@ -1,6 +1,7 @@
 
 #include "Diagnostics.h"
 #include "SmartClasses.h"
+#include "AsyncFile.h"
 
 int main()
 {
@@ -12,5 +13,9 @@ int main()
     SmartClassesExamples::Test();
     cout << endl << endl;
 
+    cout << "*** Async file I/O ***" << endl;
+    SmartClassesExamples::AsyncFileDemo();
+    cout << endl << endl;
+
     return 0;
 }
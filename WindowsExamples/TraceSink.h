@@ -0,0 +1,501 @@
+#pragma once
+
+#include <windows.h>
+#include <stdio.h> // _snwprintf_s
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <memory> // shared_ptr
+#include <vector>
+#include <tuple>
+#include <utility> // index_sequence
+#include <type_traits>
+#include <cstring> // memcpy
+#include <cstdint> // uint64_t
+#include <cwchar> // wcslen
+
+/*
+    An asynchronous trace sink that can stay enabled in Release builds.
+
+    Tracer (in Diagnostics.h) formats the message with _snwprintf_s and calls OutputDebugString on
+    the calling thread. OutputDebugString alone costs microseconds, and much more when a debugger
+    is attached, so Tracer is compiled out in Release builds.
+
+    The sink splits the work between the traced thread and a background thread:
+    - The traced thread (the producer) only captures the format string pointer, __FILE__, __LINE__,
+      a timestamp and the raw bytes of the arguments into a fixed-size TraceRecord. Strings passed as
+      arguments are copied (and truncated to fit the record); everything else is memcpy'd as is.
+    - Each thread has its own ring buffer with a single producer (the thread) and a single consumer
+      (the background thread), so pushing a record is a few loads and one release store; no locks,
+      no read-modify-write atomics, no contention between threads.
+    - The background thread drains all the rings, formats the records with the same printf format
+      strings, and writes the lines out (OutputDebugString by default).
+    - Drop policy: when a ring is full, the new record is dropped and counted. The traced thread never
+      waits and never allocates, so the cost of TRACE is bounded even if the output can't keep up.
+      The number of dropped records is reported in the output.
+
+    Formatting on another thread needs the types of the arguments. They are known where TRACE is called,
+    so the producer stores a pointer to FormatRecord<Args...>, a function template instantiated for
+    exactly those types, which decodes the arguments and calls _snwprintf_s.
+
+    The format string and the file name are stored as pointers, so they need to be string literals
+    (or otherwise live until the sink is flushed). String arguments are truncated to leave room for
+    the arguments after them; if the arguments don't fit at all, the format string is written without them.
+*/
+namespace Diagnostics
+{
+    struct TraceRecord;
+
+    // Formats a record's message into a buffer. Returns the number of characters written or -1.
+    typedef int(*TraceFormatter)(TraceRecord const & record, wchar_t* buffer, size_t count);
+
+    struct TraceRecord
+    {
+        // The record is two cache lines; the payload takes what's left after the header.
+        static const size_t Size = 128;
+
+        LONGLONG Timestamp;     // QueryPerformanceCounter ticks; first, so there is no padding on x86 either
+        TraceFormatter Formatter;
+        wchar_t const * Format;
+        char const * File;
+        unsigned Line;
+        DWORD ThreadId;
+        unsigned char Payload[Size - sizeof(LONGLONG) - sizeof(TraceFormatter) - 2 * sizeof(void*) - sizeof(unsigned) - sizeof(DWORD)];
+    };
+
+    static_assert(sizeof(TraceRecord) == TraceRecord::Size, "unexpected padding in TraceRecord");
+
+    // TraceWriter appends the arguments to a record's payload.
+    struct TraceWriter
+    {
+        unsigned char* Data;
+        size_t Size;
+        size_t Used;
+        bool Ok;
+
+        void Write(void const * value, size_t size)
+        {
+            if (Used + size > Size)
+            {
+                Ok = false;
+                return;
+            }
+            memcpy(Data + Used, value, size);
+            Used += size;
+        }
+
+        // Strings are stored as a 16-bit length followed by the characters and a null terminator.
+        // A string that doesn't fit is truncated, leaving 'reserve' bytes for the arguments after it.
+        template <typename Char>
+        void WriteString(Char const * s, size_t length, size_t reserve)
+        {
+            // The length and the null terminator.
+            auto overhead = sizeof(unsigned short) + sizeof(Char);
+            if (Used + overhead + reserve > Size)
+            {
+                Ok = false;
+                return;
+            }
+
+            auto room = (Size - Used - overhead - reserve) / sizeof(Char);
+
+            if (length > room)
+                length = room;
+            if (length > 0xFFFF)
+                length = 0xFFFF;
+
+            auto n = static_cast<unsigned short>(length);
+            Write(&n, sizeof(n));
+            Write(s, n * sizeof(Char));
+            Char terminator = 0;
+            Write(&terminator, sizeof(terminator));
+        }
+    };
+
+    // TraceReader reads the arguments back from a record's payload.
+    struct TraceReader
+    {
+        unsigned char const * Data;
+        size_t Used;
+
+        template <typename T>
+        T Read()
+        {
+            T value;
+            memcpy(&value, Data + Used, sizeof(T));
+            Used += sizeof(T);
+            return value;
+        }
+
+        template <typename Char>
+        Char const * ReadString()
+        {
+            auto n = Read<unsigned short>();
+            auto s = reinterpret_cast<Char const *>(Data + Used);
+            Used += (n + 1) * sizeof(Char);
+            return s;
+        }
+    };
+
+    // TraceArg describes how an argument of type T is stored in a record.
+    // Numbers, enums and pointers are stored as they are.
+    template <typename T>
+    struct TraceArg
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "TRACE arguments must be trivially copyable");
+
+        typedef T Decoded;
+        static const size_t MinSize = sizeof(T);
+
+        static void Encode(TraceWriter& w, T const & value, size_t) { w.Write(&value, sizeof(T)); }
+        static T Decode(TraceReader& r) { return r.Read<T>(); }
+    };
+
+    // Strings are copied, because the buffer they point to may be gone before the record is formatted.
+    template <typename Char>
+    struct TraceStringArg
+    {
+        typedef Char const * Decoded;
+        static const size_t MinSize = sizeof(unsigned short) + sizeof(Char); // an empty string
+
+        static size_t Length(char const * s) { return s != nullptr ? strlen(s) : 0; }
+        static size_t Length(wchar_t const * s) { return s != nullptr ? wcslen(s) : 0; }
+
+        static void Encode(TraceWriter& w, Char const * s, size_t reserve) { w.WriteString(s, Length(s), reserve); }
+        static Char const * Decode(TraceReader& r) { return r.ReadString<Char>(); }
+    };
+
+    template <> struct TraceArg<wchar_t const *> : TraceStringArg<wchar_t> {};
+    template <> struct TraceArg<wchar_t*> : TraceStringArg<wchar_t> {};
+    template <> struct TraceArg<char const *> : TraceStringArg<char> {};
+    template <> struct TraceArg<char*> : TraceStringArg<char> {};
+
+    // TraceArgsSize is the smallest payload the arguments can be encoded in.
+    template <typename... Args>
+    struct TraceArgsSize;
+
+    template <>
+    struct TraceArgsSize<>
+    {
+        static const size_t Value = 0;
+    };
+
+    template <typename First, typename... Rest>
+    struct TraceArgsSize<First, Rest...>
+    {
+        static const size_t Value = TraceArg<First>::MinSize + TraceArgsSize<Rest...>::Value;
+    };
+
+    // EncodeArgs writes the arguments in order. A string leaves room for the arguments after it.
+    inline void EncodeArgs(TraceWriter&)
+    {
+    }
+
+    template <typename First, typename... Rest>
+    void EncodeArgs(TraceWriter& w, First const & first, Rest const &... rest)
+    {
+        TraceArg<First>::Encode(w, first, TraceArgsSize<Rest...>::Value);
+        EncodeArgs(w, rest...);
+    }
+
+    template <typename Tuple, size_t... I>
+    int FormatArgs(wchar_t* buffer, size_t count, wchar_t const * format, Tuple const & args, std::index_sequence<I...>)
+    {
+        return _snwprintf_s(buffer, count, _TRUNCATE, format, std::get<I>(args)...);
+    }
+
+    // FormatVerbatim writes the format string as it is. It's used when the arguments didn't fit in the record.
+    inline int FormatVerbatim(TraceRecord const & record, wchar_t* buffer, size_t count)
+    {
+        return _snwprintf_s(buffer, count, _TRUNCATE, L"%s", record.Format);
+    }
+
+    // FormatRecord decodes the arguments of a record and formats its message.
+    // It's instantiated for each combination of argument types passed to TRACE.
+    template <typename... Args>
+    int FormatRecord(TraceRecord const & record, wchar_t* buffer, size_t count)
+    {
+        TraceReader reader{ record.Payload, 0 };
+
+        // The elements of a braced initializer list are evaluated from left to right,
+        // so the arguments are read in the order they were written.
+        std::tuple<typename TraceArg<Args>::Decoded...> args{ TraceArg<Args>::Decode(reader)... };
+
+        return FormatArgs(buffer, count, record.Format, args, std::index_sequence_for<Args...>{});
+    }
+
+    // TraceRing is a single-producer single-consumer ring buffer of records.
+    // The producer only writes m_head and the consumer only writes m_tail. They are on separate
+    // cache lines so the two threads don't keep stealing the same line from each other (false sharing).
+    class TraceRing
+    {
+    public:
+        static const size_t Capacity = 1024; // a power of 2
+
+        // BeginPush is called by the owning thread. It returns a slot to fill in or nullptr if the ring is full.
+        TraceRecord* BeginPush()
+        {
+            auto head = m_head.load(std::memory_order_relaxed);
+
+            // m_cachedTail avoids reading the consumer's cache line on every push.
+            if (head - m_cachedTail == Capacity)
+            {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+                if (head - m_cachedTail == Capacity)
+                {
+                    m_dropped.store(m_dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+            }
+
+            return &m_records[head & (Capacity - 1)];
+        }
+
+        // EndPush publishes the slot returned by BeginPush.
+        void EndPush()
+        {
+            m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // TryPop is called by the consumer. It copies the oldest record out of the ring.
+        bool TryPop(TraceRecord& record)
+        {
+            auto tail = m_tail.load(std::memory_order_relaxed);
+            if (tail == m_head.load(std::memory_order_acquire))
+                return false;
+
+            record = m_records[tail & (Capacity - 1)];
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool Empty() const
+        {
+            return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_acquire);
+        }
+
+        // TakeDropped returns the number of records dropped since the last call.
+        // Only the consumer calls it; the producer only increments the counter.
+        uint64_t TakeDropped()
+        {
+            auto dropped = m_dropped.load(std::memory_order_relaxed);
+            auto result = dropped - m_reportedDropped;
+            m_reportedDropped = dropped;
+            return result;
+        }
+
+        // Set when the owning thread exits; the consumer removes the ring once it's drained.
+        std::atomic<bool> Closed{ false };
+
+    private:
+        TraceRecord m_records[Capacity];
+
+        // The producer's fields. The padding puts them on a cache line of their own
+        // (alignas would do the same, but the rings are allocated with new, which doesn't honour it before C++17).
+        char m_padding0[64];
+        std::atomic<size_t> m_head{ 0 };
+        size_t m_cachedTail = 0;
+        std::atomic<uint64_t> m_dropped{ 0 };
+
+        // The consumer's fields.
+        char m_padding1[64];
+        std::atomic<size_t> m_tail{ 0 };
+        uint64_t m_reportedDropped = 0;
+    };
+
+    // TraceSink owns the rings of all the threads and the background thread that drains them.
+    class TraceSink
+    {
+    public:
+        typedef void(*LineWriter)(wchar_t const * line);
+
+        TraceSink()
+        {
+            QueryPerformanceFrequency(&m_frequency);
+            QueryPerformanceCounter(&m_start);
+            m_thread = std::thread([this] { Run(); });
+        }
+
+        ~TraceSink()
+        {
+            m_stop = true;
+            m_thread.join();
+        }
+
+        TraceSink(TraceSink const &) = delete;
+        TraceSink& operator=(TraceSink const &) = delete;
+
+        // SetWriter replaces OutputDebugString as the destination of the formatted lines.
+        // The writer is called on the background thread.
+        void SetWriter(LineWriter writer)
+        {
+            m_writer = writer;
+        }
+
+        // Ring returns the calling thread's ring, creating it on the first call.
+        TraceRing& Ring()
+        {
+            struct Holder
+            {
+                std::shared_ptr<TraceRing> Ring;
+                ~Holder() { if (Ring) Ring->Closed = true; }
+            };
+            thread_local Holder holder;
+
+            if (!holder.Ring)
+            {
+                holder.Ring = std::make_shared<TraceRing>();
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_rings.push_back(holder.Ring);
+            }
+            return *holder.Ring;
+        }
+
+        // Flush waits until all the records pushed so far have been written.
+        void Flush()
+        {
+            for (;;)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    bool empty = true;
+                    for (auto const & ring : m_rings)
+                        empty = empty && ring->Empty();
+                    if (empty && !m_busy)
+                        return;
+                }
+                std::this_thread::yield();
+            }
+        }
+
+    private:
+        std::mutex m_mutex; // protects m_rings; taken once per thread by producers and once per pass by the consumer
+        std::vector<std::shared_ptr<TraceRing>> m_rings;
+        std::atomic<bool> m_stop{ false };
+        std::atomic<bool> m_busy{ false };
+        LineWriter m_writer = [](wchar_t const * line) { OutputDebugStringW(line); };
+        LARGE_INTEGER m_frequency;
+        LARGE_INTEGER m_start;
+        std::thread m_thread;
+
+        void Run()
+        {
+            std::vector<std::shared_ptr<TraceRing>> rings;
+            TraceRecord record;
+
+            for (;;)
+            {
+                // Take a snapshot of the rings so the lock is not held while formatting.
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_busy = true;
+
+                    // Remove the rings of the threads that have exited and whose records have been written.
+                    for (size_t i = 0; i < m_rings.size();)
+                    {
+                        if (m_rings[i]->Closed && m_rings[i]->Empty())
+                        {
+                            m_rings[i] = m_rings.back();
+                            m_rings.pop_back();
+                        }
+                        else
+                        {
+                            ++i;
+                        }
+                    }
+                    rings = m_rings;
+                }
+
+                bool stop = m_stop;
+                size_t written = 0;
+
+                for (auto const & ring : rings)
+                {
+                    // A bounded number of records per ring per pass, so a busy thread doesn't starve the others.
+                    for (size_t i = 0; i < TraceRing::Capacity && ring->TryPop(record); ++i)
+                    {
+                        Write(record);
+                        ++written;
+                    }
+
+                    if (auto dropped = ring->TakeDropped())
+                    {
+                        wchar_t line[64];
+                        _snwprintf_s(line, _countof(line), _TRUNCATE, L"TRACE: %llu records dropped\n", dropped);
+                        m_writer(line);
+                    }
+                }
+
+                m_busy = false;
+
+                // Stop only after a pass that found nothing left to write.
+                if (stop && written == 0)
+                    return;
+
+                // Polling keeps the producers' hot path free of any wake-up call.
+                if (written == 0)
+                    Sleep(1);
+            }
+        }
+
+        void Write(TraceRecord const & record)
+        {
+            wchar_t buffer[512];
+            auto ms = static_cast<double>(record.Timestamp - m_start.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart);
+
+            auto count = _snwprintf_s(buffer, _countof(buffer), _TRUNCATE, L"%S(%u): [%lu %.3f ms] ", record.File, record.Line, record.ThreadId, ms);
+            if (count < 0)
+                count = 0;
+
+            record.Formatter(record, buffer + count, _countof(buffer) - count);
+            m_writer(buffer);
+        }
+    };
+
+    // The sink used by TRACE_ASYNC. It's created on first use and flushed when the program exits.
+    inline TraceSink& DefaultTraceSink()
+    {
+        static TraceSink sink;
+        return sink;
+    }
+
+    // AsyncTracer is the hot-path side of the sink: it fills in a record of the calling thread's ring.
+    struct AsyncTracer
+    {
+        char const * m_filename;
+        unsigned m_line;
+
+        AsyncTracer(char const * filename, unsigned const line) :
+            m_filename{ filename },
+            m_line{ line }
+        { }
+
+        template <typename... Args>
+        void operator()(wchar_t const * format, Args... args) const
+        {
+            auto& ring = DefaultTraceSink().Ring();
+            auto record = ring.BeginPush();
+            if (record == nullptr)
+                return; // the ring is full; the record is dropped and counted
+
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+
+            record->Formatter = &FormatRecord<Args...>;
+            record->Format = format;
+            record->File = m_filename;
+            record->Line = m_line;
+            record->ThreadId = GetCurrentThreadId();
+            record->Timestamp = now.QuadPart;
+
+            TraceWriter writer{ record->Payload, sizeof(record->Payload), 0, true };
+            EncodeArgs(writer, args...);
+
+            // If the arguments don't fit, trace the format string itself rather than garbage.
+            if (!writer.Ok)
+                record->Formatter = &FormatVerbatim;
+
+            ring.EndPush();
+        }
+    };
+}